@@ -4233,7 +4233,7 @@ void CClientShadowMgr::UpdateShadowDirectionFromLocalLightSource(ClientShadowHan
         float flMinBrightnessSqr = r_worldlight_mincastintensity.GetFloat();
         flMinBrightnessSqr *= flMinBrightnessSqr;
 
-        if (g_pWorldLights->GetBrightestLightSource(pRenderable->GetRenderOrigin(), lightPos, lightBrightness) == false ||
+        if (g_pWorldLights->GetBrightestLightSource(shadow.m_Entity, pRenderable->GetRenderOrigin(), lightPos, lightBrightness) == false ||
             lightBrightness.LengthSqr() < flMinBrightnessSqr)
         {
             // didn't find a light source at all, use default shadow direction
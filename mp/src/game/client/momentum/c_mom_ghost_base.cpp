@@ -1,6 +1,7 @@
 #include "cbase.h"
 
 #include "c_mom_ghost_base.h"
+#include "mom_ghost_lod.h"
 
 #include "steam/isteamutils.h"
 
@@ -41,9 +42,28 @@ void C_MomentumGhostBaseEntity::PostDataUpdate(DataUpdateType_t updateType)
         {
             m_SteamID = CSteamID(m_AccountID, k_EUniversePublic, SteamUtils()->GetConnectedUniverse(), k_EAccountTypeIndividual).ConvertToUint64();
         }
+
+        g_pGhostLOD->AddGhost(this);
     }
 }
 
+void C_MomentumGhostBaseEntity::UpdateOnRemove()
+{
+    g_pGhostLOD->RemoveGhost(this);
+
+    BaseClass::UpdateOnRemove();
+}
+
+bool C_MomentumGhostBaseEntity::ShouldDraw()
+{
+    return g_pGhostLOD->ShouldDrawModel(this) && BaseClass::ShouldDraw();
+}
+
+ShadowType_t C_MomentumGhostBaseEntity::ShadowCastType()
+{
+    return g_pGhostLOD->ShouldDrawEffects(this) ? BaseClass::ShadowCastType() : SHADOWS_NONE;
+}
+
 float C_MomentumGhostBaseEntity::GetCurrentRunTime()
 {
     return 0.0f;
@@ -13,6 +13,11 @@ public:
 
     bool IsValidIDTarget() OVERRIDE{ return true; }
     void PostDataUpdate(DataUpdateType_t updateType) override;
+    void UpdateOnRemove() OVERRIDE;
+
+    // Far away ghosts are left to the ghost LOD system, see mom_ghost_lod.h
+    bool ShouldDraw() OVERRIDE;
+    ShadowType_t ShadowCastType() OVERRIDE;
 
     virtual bool IsReplayGhost() const { return false; }
     virtual bool IsOnlineGhost() const { return false; }
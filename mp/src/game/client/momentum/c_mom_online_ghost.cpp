@@ -3,6 +3,7 @@
 #include "steam/steam_api.h"
 #include "GhostEntityPanel.h"
 #include "flashlighteffect.h"
+#include "mom_ghost_lod.h"
 
 #include "tier0/memdbgon.h"
 
@@ -47,8 +48,8 @@ void C_MomentumOnlineGhostEntity::Simulate()
 {
     BaseClass::Simulate();
 
-    // The dim light is the flashlight.
-    if (IsEffectActive(EF_DIMLIGHT))
+    // The dim light is the flashlight. Far away ghosts don't get one.
+    if (IsEffectActive(EF_DIMLIGHT) && g_pGhostLOD->ShouldDrawEffects(this))
     {
         if (!m_pFlashlight)
         {
@@ -6,22 +6,35 @@
 
 #include "mom_shareddefs.h"
 #include "dt_utlvector_recv.h"
-#include "debugoverlay_shared.h"
 
 #include "tier0/memdbgon.h"
 
-static MAKE_TOGGLE_CONVAR(mom_zone_start_outline_enable, "1", FCVAR_CLIENTCMD_CAN_EXECUTE | FCVAR_ARCHIVE, "Enable drawing an outline for start zone.");
-static MAKE_TOGGLE_CONVAR(mom_zone_end_outline_enable, "1", FCVAR_CLIENTCMD_CAN_EXECUTE | FCVAR_ARCHIVE, "Enable outline for end zone.");
-static MAKE_TOGGLE_CONVAR(mom_zone_stage_outline_enable, "1", FCVAR_CLIENTCMD_CAN_EXECUTE | FCVAR_ARCHIVE, "Enable outline for stage zone(s).");
-static MAKE_TOGGLE_CONVAR(mom_zone_checkpoint_outline_enable, "1", FCVAR_CLIENTCMD_CAN_EXECUTE | FCVAR_ARCHIVE, "Enable outline for checkpoint zone(s).");
+static void ZoneOutlineSettingsCallback(IConVar *var, const char *pOldValue, float flOldValue)
+{
+    g_pZoneOutlines->UpdateSettings();
+}
+
+static MAKE_TOGGLE_CONVAR_C(mom_zone_start_outline_enable, "1", FCVAR_CLIENTCMD_CAN_EXECUTE | FCVAR_ARCHIVE, "Enable drawing an outline for start zone.", ZoneOutlineSettingsCallback);
+static MAKE_TOGGLE_CONVAR_C(mom_zone_end_outline_enable, "1", FCVAR_CLIENTCMD_CAN_EXECUTE | FCVAR_ARCHIVE, "Enable outline for end zone.", ZoneOutlineSettingsCallback);
+static MAKE_TOGGLE_CONVAR_C(mom_zone_stage_outline_enable, "1", FCVAR_CLIENTCMD_CAN_EXECUTE | FCVAR_ARCHIVE, "Enable outline for stage zone(s).", ZoneOutlineSettingsCallback);
+static MAKE_TOGGLE_CONVAR_C(mom_zone_checkpoint_outline_enable, "1", FCVAR_CLIENTCMD_CAN_EXECUTE | FCVAR_ARCHIVE, "Enable outline for checkpoint zone(s).", ZoneOutlineSettingsCallback);
+
+static ConVar mom_zone_start_outline_color("mom_zone_start_outline_color", "00FF00FF", FCVAR_CLIENTCMD_CAN_EXECUTE | FCVAR_ARCHIVE, "Color of the start zone.", ZoneOutlineSettingsCallback);
+static ConVar mom_zone_end_outline_color("mom_zone_end_outline_color", "FF0000FF", FCVAR_CLIENTCMD_CAN_EXECUTE | FCVAR_ARCHIVE, "Color of the end zone.", ZoneOutlineSettingsCallback);
+static ConVar mom_zone_stage_outline_color("mom_zone_stage_outline_color", "0000FFFF", FCVAR_CLIENTCMD_CAN_EXECUTE | FCVAR_ARCHIVE, "Color of the stage zone(s).", ZoneOutlineSettingsCallback);
+static ConVar mom_zone_checkpoint_outline_color("mom_zone_checkpoint_outline_color", "FFFF00FF", FCVAR_CLIENTCMD_CAN_EXECUTE | FCVAR_ARCHIVE, "Color of the checkpoint zone(s).", ZoneOutlineSettingsCallback);
+
+// In ZoneOutlineType_t order
+static ConVar *const s_pOutlineEnableVars[] = { &mom_zone_start_outline_enable, &mom_zone_end_outline_enable, &mom_zone_stage_outline_enable, &mom_zone_checkpoint_outline_enable };
+static ConVar *const s_pOutlineColorVars[] = { &mom_zone_start_outline_color, &mom_zone_end_outline_color, &mom_zone_stage_outline_color, &mom_zone_checkpoint_outline_color };
+COMPILE_TIME_ASSERT(ARRAYSIZE(s_pOutlineEnableVars) == ZONE_OUTLINE_COUNT && ARRAYSIZE(s_pOutlineColorVars) == ZONE_OUTLINE_COUNT);
 
-static ConVar mom_zone_start_outline_color("mom_zone_start_outline_color", "00FF00FF", FCVAR_CLIENTCMD_CAN_EXECUTE | FCVAR_ARCHIVE, "Color of the start zone.");
-static ConVar mom_zone_end_outline_color("mom_zone_end_outline_color", "FF0000FF", FCVAR_CLIENTCMD_CAN_EXECUTE | FCVAR_ARCHIVE, "Color of the end zone.");
-static ConVar mom_zone_stage_outline_color("mom_zone_stage_outline_color", "0000FFFF", FCVAR_CLIENTCMD_CAN_EXECUTE | FCVAR_ARCHIVE, "Color of the stage zone(s).");
-static ConVar mom_zone_checkpoint_outline_color("mom_zone_checkpoint_outline_color", "FFFF00FF", FCVAR_CLIENTCMD_CAN_EXECUTE | FCVAR_ARCHIVE, "Color of the checkpoint zone(s).");
+// Most lines put into a single static mesh
+#define ZONE_OUTLINE_MAX_MESH_LINES 16384
 
 CTriggerOutlineRenderer::CTriggerOutlineRenderer()
 {
+    m_pLines = nullptr;
     m_pVertices = nullptr;
     m_vertexCount = 0;
 }
@@ -45,27 +58,242 @@ bool CTriggerOutlineRenderer::RenderBrushModelSurface(IClientEntity* pBaseEntity
             m_pVertices = static_cast<BrushVertex_t *>(MemAlloc_AllocAligned(sizeof(BrushVertex_t) * m_vertexCount, 64));
     }
     pBrushSurface->GetVertexData(m_pVertices);
+
+    if (m_pLines)
+    {
+        const matrix3x4_t &toWorld = pBaseEntity->RenderableToWorldTransform();
+        for (int i = 0; i < vertices; i++)
+        {
+            Vector cur, next;
+            VectorTransform(m_pVertices[i].m_Pos, toWorld, cur);
+            VectorTransform(m_pVertices[(i + 1) % vertices].m_Pos, toWorld, next);
+            m_pLines->AddToTail(cur);
+            m_pLines->AddToTail(next);
+        }
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+// Hands the draw call for all of the outlines to CZoneOutlineSystem
+//-----------------------------------------------------------------------------
+class CZoneOutlineRenderable : public CDefaultClientRenderable
+{
+public:
+    void SetBounds(const Vector &vecMins, const Vector &vecMaxs)
+    {
+        m_vecMins = vecMins;
+        m_vecMaxs = vecMaxs;
+
+        if (m_hRenderHandle == INVALID_CLIENT_RENDER_HANDLE)
+            ClientLeafSystem()->AddRenderable(this, RENDER_GROUP_TRANSLUCENT_ENTITY);
+        else
+            ClientLeafSystem()->RenderableChanged(m_hRenderHandle);
+    }
+
+    void Remove()
+    {
+        if (m_hRenderHandle != INVALID_CLIENT_RENDER_HANDLE)
+            ClientLeafSystem()->RemoveRenderable(m_hRenderHandle);
+    }
+
+    const Vector &GetRenderOrigin() OVERRIDE { return vec3_origin; }
+    const QAngle &GetRenderAngles() OVERRIDE { return vec3_angle; }
+    const matrix3x4_t &RenderableToWorldTransform() OVERRIDE
+    {
+        static matrix3x4_t mat;
+        SetIdentityMatrix(mat);
+        return mat;
+    }
+    bool ShouldDraw() OVERRIDE { return true; }
+    bool IsTransparent() OVERRIDE { return true; }
+    bool ShouldReceiveProjectedTextures(int flags) OVERRIDE { return false; }
+    void GetRenderBounds(Vector &mins, Vector &maxs) OVERRIDE
+    {
+        mins = m_vecMins;
+        maxs = m_vecMaxs;
+    }
+
+    int DrawModel(int flags) OVERRIDE
+    {
+        g_pZoneOutlines->DrawOutlines();
+        return 1;
+    }
+
+private:
+    Vector m_vecMins, m_vecMaxs;
+};
+
+// Static meshes don't survive the device being lost
+static void ZoneOutlineReleaseFunc()
+{
+    g_pZoneOutlines->DestroyMeshes();
+}
+
+static void ZoneOutlineRestoreFunc(int nChangeFlags)
+{
+    g_pZoneOutlines->MarkDirty();
+}
+
+CZoneOutlineSystem::CZoneOutlineSystem() : CAutoGameSystemPerFrame("CZoneOutlineSystem")
+{
+    m_bDirty = false;
+    for (int i = 0; i < ZONE_OUTLINE_COUNT; i++)
+        m_bEnabled[i] = false;
+    m_pRenderable = new CZoneOutlineRenderable;
+}
+
+bool CZoneOutlineSystem::Init()
+{
+    materials->AddReleaseFunc(ZoneOutlineReleaseFunc);
+    materials->AddRestoreFunc(ZoneOutlineRestoreFunc);
+    UpdateSettings();
+    return true;
+}
+
+void CZoneOutlineSystem::Shutdown()
+{
+    materials->RemoveReleaseFunc(ZoneOutlineReleaseFunc);
+    materials->RemoveRestoreFunc(ZoneOutlineRestoreFunc);
+    DestroyMeshes();
+    m_Material.Shutdown();
+    delete m_pRenderable;
+    m_pRenderable = nullptr;
+}
+
+void CZoneOutlineSystem::LevelShutdownPostEntity()
+{
+    m_vecZones.RemoveAll();
+    DestroyMeshes();
+    m_pRenderable->Remove();
+}
+
+void CZoneOutlineSystem::PreRender()
+{
+    if (m_bDirty)
+        BuildMeshes();
+}
+
+void CZoneOutlineSystem::AddZone(C_BaseMomZoneTrigger *pZone)
+{
+    if (!m_vecZones.HasElement(pZone))
+        m_vecZones.AddToTail(pZone);
+    m_bDirty = true;
+}
+
+void CZoneOutlineSystem::RemoveZone(C_BaseMomZoneTrigger *pZone)
+{
+    if (m_vecZones.FindAndFastRemove(pZone))
+        m_bDirty = true;
+}
+
+void CZoneOutlineSystem::UpdateSettings()
+{
+    for (int i = 0; i < ZONE_OUTLINE_COUNT; i++)
+        m_bEnabled[i] = s_pOutlineEnableVars[i]->GetBool() && MomUtil::GetColorFromHex(s_pOutlineColorVars[i]->GetString(), m_Colors[i]);
+
+    m_bDirty = true;
+}
+
+void CZoneOutlineSystem::DestroyMeshes()
+{
+    if (m_vecMeshes.IsEmpty())
+        return;
+
     CMatRenderContextPtr pRenderContext(materials);
+    FOR_EACH_VEC(m_vecMeshes, i)
+        pRenderContext->DestroyStaticMesh(m_vecMeshes[i]);
+    m_vecMeshes.RemoveAll();
+
+    m_bDirty = true;
+}
 
+void CZoneOutlineSystem::BuildMeshes()
+{
+    DestroyMeshes();
+    m_bDirty = false;
+
+    if (!m_Material.IsValid())
+        m_Material.Init("momentum/zone_outline", TEXTURE_GROUP_OTHER);
+
+    int iLines = 0;
+    Vector vecMins(FLT_MAX, FLT_MAX, FLT_MAX), vecMaxs(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    FOR_EACH_VEC(m_vecZones, i)
+    {
+        if (!IsOutlineEnabled(m_vecZones[i]->GetOutlineType()))
+            continue;
+
+        const CUtlVector<Vector> &vecLines = m_vecZones[i]->GetOutlineLines();
+        iLines += vecLines.Count() / 2;
+        FOR_EACH_VEC(vecLines, j)
+        {
+            VectorMin(vecMins, vecLines[j], vecMins);
+            VectorMax(vecMaxs, vecLines[j], vecMaxs);
+        }
+    }
+
+    if (!iLines)
+    {
+        m_pRenderable->Remove();
+        return;
+    }
+
+    CMatRenderContextPtr pRenderContext(materials);
     CMeshBuilder builder;
-    builder.Begin(pRenderContext->GetDynamicMesh(true, nullptr, nullptr, 
-                                                 materials->FindMaterial("momentum/zone_outline", TEXTURE_GROUP_OTHER)),
-                    MATERIAL_LINE_LOOP, vertices);
+    int iMeshLines = 0;
 
-    for (int i = 0; i < vertices; i++)
+    FOR_EACH_VEC(m_vecZones, i)
     {
-        const BrushVertex_t& vertex = m_pVertices[i];
+        const ZoneOutlineType_t type = m_vecZones[i]->GetOutlineType();
+        if (!IsOutlineEnabled(type))
+            continue;
+
+        const Color &color = m_Colors[type];
+        const CUtlVector<Vector> &vecLines = m_vecZones[i]->GetOutlineLines();
+        for (int j = 0; j + 1 < vecLines.Count(); j += 2)
+        {
+            if (iMeshLines == 0)
+            {
+                IMesh *pMesh = pRenderContext->CreateStaticMesh(m_Material->GetVertexFormat(), TEXTURE_GROUP_STATIC_VERTEX_BUFFER_OTHER, m_Material);
+                m_vecMeshes.AddToTail(pMesh);
+                builder.Begin(pMesh, MATERIAL_LINES, Min(iLines, ZONE_OUTLINE_MAX_MESH_LINES));
+            }
 
-        builder.Position3fv(vertex.m_Pos.Base());
-        builder.Normal3fv(vertex.m_Normal.Base());
-        builder.Color4ub(outlineColor.r(), outlineColor.g(), outlineColor.b(), outlineColor.a());
-        builder.AdvanceVertex();
+            for (int k = j; k < j + 2; k++)
+            {
+                builder.Position3fv(vecLines[k].Base());
+                builder.Normal3f(0.0f, 0.0f, 1.0f);
+                builder.Color4ub(color.r(), color.g(), color.b(), color.a());
+                builder.AdvanceVertex();
+            }
+
+            iLines--;
+            if (++iMeshLines == ZONE_OUTLINE_MAX_MESH_LINES || iLines == 0)
+            {
+                builder.End();
+                iMeshLines = 0;
+            }
+        }
     }
 
-    builder.End(false, true);
-    return false;
+    m_pRenderable->SetBounds(vecMins, vecMaxs);
 }
 
+void CZoneOutlineSystem::DrawOutlines()
+{
+    if (m_vecMeshes.IsEmpty())
+        return;
+
+    CMatRenderContextPtr pRenderContext(materials);
+    pRenderContext->Bind(m_Material);
+    FOR_EACH_VEC(m_vecMeshes, i)
+        m_vecMeshes[i]->Draw();
+}
+
+static CZoneOutlineSystem s_ZoneOutlines;
+CZoneOutlineSystem *g_pZoneOutlines = &s_ZoneOutlines;
+
 IMPLEMENT_CLIENTCLASS_DT(C_BaseMomZoneTrigger, DT_BaseMomZoneTrigger, CBaseMomZoneTrigger)
 RecvPropInt(RECVINFO(m_iTrackNumber)),
 RecvPropUtlVector(RECVINFO_UTLVECTOR(m_vecZonePoints), 32, RecvPropVector(NULL, 0, sizeof(Vector))),
@@ -76,39 +304,70 @@ C_BaseMomZoneTrigger::C_BaseMomZoneTrigger()
 {
     m_flZoneHeight = 0.0f;
     m_iTrackNumber = -1; // TRACK_ALL
+    m_bOutlineBuilt = false;
+    m_flOutlineHeight = 0.0f;
+    m_vecOutlineOrigin.Init();
 }
 
-void C_BaseMomZoneTrigger::DrawOutlineModel(const Color& outlineColor)
+void C_BaseMomZoneTrigger::OnDataChanged(DataUpdateType_t updateType)
 {
+    BaseClass::OnDataChanged(updateType);
+
+    if (updateType == DATA_UPDATE_CREATED)
+        g_pZoneOutlines->AddZone(this);
+    else if (m_vecOutlineOrigin == GetAbsOrigin() && m_flOutlineHeight == m_flZoneHeight &&
+             m_vecOutlinePoints.Count() == m_vecZonePoints.Count() &&
+             !V_memcmp(m_vecOutlinePoints.Base(), m_vecZonePoints.Base(), m_vecZonePoints.Count() * sizeof(Vector)))
+        return;
+
+    m_vecOutlineOrigin = GetAbsOrigin();
+    m_flOutlineHeight = m_flZoneHeight;
+    m_vecOutlinePoints.CopyArray(m_vecZonePoints.Base(), m_vecZonePoints.Count());
+
+    // Brush zones get their outline from their surfaces the next time they are drawn
+    m_bOutlineBuilt = false;
+    m_vecOutlineLines.RemoveAll();
+    if (!GetModel())
+        BuildPointOutline();
+
+    g_pZoneOutlines->MarkDirty();
+}
+
+void C_BaseMomZoneTrigger::UpdateOnRemove()
+{
+    g_pZoneOutlines->RemoveZone(this);
+
+    BaseClass::UpdateOnRemove();
+}
+
+void C_BaseMomZoneTrigger::BuildPointOutline()
+{
+    m_bOutlineBuilt = true;
+
     const int iNum = m_vecZonePoints.Count();
 
     if (iNum <= 2)
         return;
 
-    // Bottom
-    for (int i = 0; i < iNum; i++)
-    {
-        const auto cur = m_vecZonePoints[i];
-        const auto next = i == (iNum - 1) ? m_vecZonePoints[0] : m_vecZonePoints[i+1];
-        debugoverlay->AddLineOverlayAlpha(cur, next, outlineColor.r(), outlineColor.g(), outlineColor.b(), outlineColor.a(), false, 0.0f);
-    }
-
-    // Connecting lines
+    m_vecOutlineLines.EnsureCapacity(iNum * 6);
     for (int i = 0; i < iNum; i++)
     {
         const Vector &cur = m_vecZonePoints[i];
-        const Vector next(cur.x, cur.y, cur.z + m_flZoneHeight);
-        debugoverlay->AddLineOverlayAlpha(cur, next, outlineColor.r(), outlineColor.g(), outlineColor.b(), outlineColor.a(), false, 0.0f);
-    }
+        const Vector &next = m_vecZonePoints[(i + 1) % iNum];
+        const Vector curUp(cur.x, cur.y, cur.z + m_flZoneHeight);
+        const Vector nextUp(next.x, next.y, next.z + m_flZoneHeight);
 
-    // Top
-    for (int i = 0; i < iNum; i++)
-    {
-        auto cur = m_vecZonePoints[i];
-        auto next = i == (iNum - 1) ? m_vecZonePoints[0] : m_vecZonePoints[i + 1];
-        Vector curUp(cur.x, cur.y, cur.z + m_flZoneHeight);
-        Vector nextUp(next.x, next.y, next.z + m_flZoneHeight);
-        debugoverlay->AddLineOverlayAlpha(curUp, nextUp, outlineColor.r(), outlineColor.g(), outlineColor.b(), outlineColor.a(), false, 0.0f);
+        // Bottom
+        m_vecOutlineLines.AddToTail(cur);
+        m_vecOutlineLines.AddToTail(next);
+
+        // Connecting lines
+        m_vecOutlineLines.AddToTail(cur);
+        m_vecOutlineLines.AddToTail(curUp);
+
+        // Top
+        m_vecOutlineLines.AddToTail(curUp);
+        m_vecOutlineLines.AddToTail(nextUp);
     }
 }
 
@@ -119,25 +378,23 @@ bool C_BaseMomZoneTrigger::ShouldDraw()
 
 int C_BaseMomZoneTrigger::DrawModel(int flags)
 {
-    if (ShouldDrawOutline())
+    if ((flags & STUDIO_RENDER) && (flags & STUDIO_SHADOWDEPTHTEXTURE) == 0)
     {
-        if ((flags & STUDIO_RENDER) && (flags & (STUDIO_SHADOWDEPTHTEXTURE | STUDIO_SHADOWDEPTHTEXTURE)) == 0)
+        if (!m_bOutlineBuilt && GetModel())
         {
-            if (GetOutlineColor())
-            {
-                if (GetModel())
-                {
-                    render->InstallBrushSurfaceRenderer(&m_OutlineRenderer);
-                    BaseClass::DrawModel(flags);
-                    render->InstallBrushSurfaceRenderer(nullptr);
-                }
-                else
-                {
-                    DrawOutlineModel(m_OutlineRenderer.outlineColor);
-                    return 1;
-                }
-            }
+            m_OutlineRenderer.m_pLines = &m_vecOutlineLines;
+            render->InstallBrushSurfaceRenderer(&m_OutlineRenderer);
+            BaseClass::DrawModel(flags);
+            render->InstallBrushSurfaceRenderer(nullptr);
+            m_OutlineRenderer.m_pLines = nullptr;
+
+            m_bOutlineBuilt = true;
+            g_pZoneOutlines->MarkDirty();
         }
+
+        // The outline is drawn along with every other zone's by g_pZoneOutlines
+        if (g_pZoneOutlines->IsOutlineEnabled(GetOutlineType()))
+            return 1;
     }
 
     if (IsEffectActive(EF_NODRAW))
@@ -151,14 +408,9 @@ LINK_ENTITY_TO_CLASS(trigger_momentum_timer_start, C_TriggerTimerStart);
 IMPLEMENT_CLIENTCLASS_DT(C_TriggerTimerStart, DT_TriggerTimerStart, CTriggerTimerStart)
 END_RECV_TABLE();
 
-bool C_TriggerTimerStart::ShouldDrawOutline()
+ZoneOutlineType_t C_TriggerTimerStart::GetOutlineType()
 {
-    return mom_zone_start_outline_enable.GetBool();
-}
-
-bool C_TriggerTimerStart::GetOutlineColor()
-{
-    return MomUtil::GetColorFromHex(mom_zone_start_outline_color.GetString(), m_OutlineRenderer.outlineColor);
+    return ZONE_OUTLINE_START;
 }
 
 LINK_ENTITY_TO_CLASS(trigger_momentum_timer_stop, C_TriggerTimerStop);
@@ -166,14 +418,9 @@ LINK_ENTITY_TO_CLASS(trigger_momentum_timer_stop, C_TriggerTimerStop);
 IMPLEMENT_CLIENTCLASS_DT(C_TriggerTimerStop, DT_TriggerTimerStop, CTriggerTimerStop)
 END_RECV_TABLE();
 
-bool C_TriggerTimerStop::ShouldDrawOutline()
+ZoneOutlineType_t C_TriggerTimerStop::GetOutlineType()
 {
-    return mom_zone_end_outline_enable.GetBool();
-}
-
-bool C_TriggerTimerStop::GetOutlineColor()
-{
-    return MomUtil::GetColorFromHex(mom_zone_end_outline_color.GetString(), m_OutlineRenderer.outlineColor);
+    return ZONE_OUTLINE_END;
 }
 
 LINK_ENTITY_TO_CLASS(trigger_momentum_timer_stage, C_TriggerStage);
@@ -181,14 +428,9 @@ LINK_ENTITY_TO_CLASS(trigger_momentum_timer_stage, C_TriggerStage);
 IMPLEMENT_CLIENTCLASS_DT(C_TriggerStage, DT_TriggerStage, CTriggerStage)
 END_RECV_TABLE();
 
-bool C_TriggerStage::ShouldDrawOutline()
-{
-    return mom_zone_stage_outline_enable.GetBool();
-}
-
-bool C_TriggerStage::GetOutlineColor()
+ZoneOutlineType_t C_TriggerStage::GetOutlineType()
 {
-    return MomUtil::GetColorFromHex(mom_zone_stage_outline_color.GetString(), m_OutlineRenderer.outlineColor);
+    return ZONE_OUTLINE_STAGE;
 }
 
 LINK_ENTITY_TO_CLASS(trigger_momentum_timer_checkpoint, C_TriggerCheckpoint);
@@ -196,14 +438,9 @@ LINK_ENTITY_TO_CLASS(trigger_momentum_timer_checkpoint, C_TriggerCheckpoint);
 IMPLEMENT_CLIENTCLASS_DT(C_TriggerCheckpoint, DT_TriggerCheckpoint, CTriggerCheckpoint)
 END_RECV_TABLE();
 
-bool C_TriggerCheckpoint::ShouldDrawOutline()
-{
-    return mom_zone_checkpoint_outline_enable.GetBool();
-}
-
-bool C_TriggerCheckpoint::GetOutlineColor()
+ZoneOutlineType_t C_TriggerCheckpoint::GetOutlineType()
 {
-    return MomUtil::GetColorFromHex(mom_zone_checkpoint_outline_color.GetString(), m_OutlineRenderer.outlineColor);
+    return ZONE_OUTLINE_CHECKPOINT;
 }
 
 LINK_ENTITY_TO_CLASS(trigger_momentum_slide, C_TriggerSlide);
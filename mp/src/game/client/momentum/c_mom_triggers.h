@@ -1,17 +1,75 @@
 #pragma once
 
+#include "igamesystem.h"
+#include "materialsystem/MaterialSystemUtil.h"
+
+class C_BaseMomZoneTrigger;
+class CZoneOutlineRenderable;
+
+enum ZoneOutlineType_t
+{
+    ZONE_OUTLINE_NONE = -1,
+    ZONE_OUTLINE_START = 0,
+    ZONE_OUTLINE_END,
+    ZONE_OUTLINE_STAGE,
+    ZONE_OUTLINE_CHECKPOINT,
+
+    ZONE_OUTLINE_COUNT
+};
+
+// Collects the edges of a brush zone's surfaces, in world space, instead of drawing them
 class CTriggerOutlineRenderer : public IBrushRenderer
 {
 public:
     CTriggerOutlineRenderer();
     virtual ~CTriggerOutlineRenderer();
     bool RenderBrushModelSurface(IClientEntity* pBaseEntity, IBrushSurface* pBrushSurface) OVERRIDE;
-    Color outlineColor;
+    CUtlVector<Vector> *m_pLines; // Line end points, in pairs
 private:
     BrushVertex_t *m_pVertices;
     int m_vertexCount;
 };
 
+// Draws the outlines of all zones in a single pass. The outlines are built into static meshes
+// when a zone is added or changes, or an outline color or toggle changes, not every frame.
+// The meshes are (re)built before rendering, which is also what puts the outlines in the leaf system.
+class CZoneOutlineSystem : public CAutoGameSystemPerFrame
+{
+public:
+    CZoneOutlineSystem();
+
+    bool Init() OVERRIDE;
+    void Shutdown() OVERRIDE;
+    void LevelShutdownPostEntity() OVERRIDE;
+    void PreRender() OVERRIDE;
+
+    void AddZone(C_BaseMomZoneTrigger *pZone);
+    void RemoveZone(C_BaseMomZoneTrigger *pZone);
+    void MarkDirty() { m_bDirty = true; }
+
+    // Refreshes the cached colors and toggles from the convars
+    void UpdateSettings();
+    bool IsOutlineEnabled(ZoneOutlineType_t type) const { return type > ZONE_OUTLINE_NONE && type < ZONE_OUTLINE_COUNT && m_bEnabled[type]; }
+
+    void DrawOutlines();
+    void DestroyMeshes();
+
+private:
+    void BuildMeshes();
+
+    CUtlVector<C_BaseMomZoneTrigger *> m_vecZones;
+    CUtlVector<IMesh *> m_vecMeshes;
+    bool m_bDirty;
+
+    bool m_bEnabled[ZONE_OUTLINE_COUNT];
+    Color m_Colors[ZONE_OUTLINE_COUNT];
+
+    CMaterialReference m_Material;
+    CZoneOutlineRenderable *m_pRenderable;
+};
+
+extern CZoneOutlineSystem *g_pZoneOutlines;
+
 class C_BaseMomZoneTrigger : public C_BaseEntity
 {
     DECLARE_CLASS(C_BaseMomZoneTrigger, C_BaseEntity);
@@ -20,10 +78,13 @@ class C_BaseMomZoneTrigger : public C_BaseEntity
 public:
     C_BaseMomZoneTrigger();
 
-    virtual bool ShouldDrawOutline() { return false; }
-    virtual bool GetOutlineColor() { return false; }
+    virtual ZoneOutlineType_t GetOutlineType() { return ZONE_OUTLINE_NONE; }
+
+    // Line end points of the outline in world space, in pairs
+    const CUtlVector<Vector> &GetOutlineLines() const { return m_vecOutlineLines; }
 
-    void DrawOutlineModel(const Color &outlineColor);
+    void OnDataChanged(DataUpdateType_t updateType) OVERRIDE;
+    void UpdateOnRemove() OVERRIDE;
     bool ShouldDraw() OVERRIDE;
     int DrawModel(int flags) OVERRIDE;
 
@@ -33,7 +94,16 @@ public:
     float m_flZoneHeight;
 
 protected:
+    void BuildPointOutline();
+
     CTriggerOutlineRenderer m_OutlineRenderer;
+    CUtlVector<Vector> m_vecOutlineLines;
+    bool m_bOutlineBuilt;
+
+    // What the outline was built from, so it's only rebuilt when the zone changes
+    CUtlVector<Vector> m_vecOutlinePoints;
+    float m_flOutlineHeight;
+    Vector m_vecOutlineOrigin;
 };
 
 class C_TriggerTimerStart : public C_BaseMomZoneTrigger
@@ -41,8 +111,7 @@ class C_TriggerTimerStart : public C_BaseMomZoneTrigger
   public:
     DECLARE_CLASS(C_TriggerTimerStart, C_BaseMomZoneTrigger);
     DECLARE_CLIENTCLASS();
-    bool ShouldDrawOutline() OVERRIDE;
-    bool GetOutlineColor() OVERRIDE;
+    ZoneOutlineType_t GetOutlineType() OVERRIDE;
 };
 
 class C_TriggerTimerStop : public C_BaseMomZoneTrigger
@@ -51,8 +120,7 @@ class C_TriggerTimerStop : public C_BaseMomZoneTrigger
     DECLARE_CLASS(C_TriggerTimerStop, C_BaseMomZoneTrigger);
     DECLARE_CLIENTCLASS();
 
-    bool ShouldDrawOutline() OVERRIDE;
-    bool GetOutlineColor() OVERRIDE;
+    ZoneOutlineType_t GetOutlineType() OVERRIDE;
 };
 
 class C_TriggerStage : public C_BaseMomZoneTrigger
@@ -61,8 +129,7 @@ public:
     DECLARE_CLASS(C_TriggerStage, C_BaseMomZoneTrigger);
     DECLARE_CLIENTCLASS();
 
-    bool ShouldDrawOutline() OVERRIDE;
-    bool GetOutlineColor() OVERRIDE;
+    ZoneOutlineType_t GetOutlineType() OVERRIDE;
 };
 
 class C_TriggerCheckpoint : public C_BaseMomZoneTrigger
@@ -71,8 +138,7 @@ public:
     DECLARE_CLASS(C_TriggerCheckpoint, C_BaseMomZoneTrigger);
     DECLARE_CLIENTCLASS();
 
-    bool ShouldDrawOutline() OVERRIDE;
-    bool GetOutlineColor() OVERRIDE;
+    ZoneOutlineType_t GetOutlineType() OVERRIDE;
 };
 
 class C_TriggerSlide : public C_BaseMomZoneTrigger
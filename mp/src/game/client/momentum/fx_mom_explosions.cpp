@@ -3,6 +3,8 @@
 #include "engine/IEngineSound.h"
 #include "weapon/weapon_def.h"
 #include "mom_shareddefs.h"
+#include "mom_effect_budget.h"
+#include "mom_explosive.h"
 
 #include "tier0/memdbgon.h"
 
@@ -72,6 +74,14 @@ void C_TETFExplosion::PostDataUpdate(DataUpdateType_t updateType)
             C_BaseEntity::EmitSound(filter, SOUND_FROM_WORLD, pWeaponInfo->pKVWeaponSounds->GetString("explosion"), &m_vecOrigin);
         }
 
+        if (bDispatchParticles)
+        {
+            // Explosions this close to the local player are most likely theirs, and they're the ones that matter
+            const auto pLocal = C_BasePlayer::GetLocalPlayer();
+            const bool bPriority = pLocal && pLocal->GetAbsOrigin().DistToSqr(m_vecOrigin) < Square(MOM_EXPLOSIVE_RADIUS);
+            bDispatchParticles = g_pEffectBudget->RequestEffect(EFFECT_BUDGET_EXPLOSION, m_vecOrigin, bPriority);
+        }
+
         if (bDispatchParticles)
         {
             const char *pszEffect;
@@ -7,6 +7,7 @@
 #include "decals.h"
 #include "fx_impact.h"
 #include "iefx.h"
+#include "mom_paint_system.h"
 #include "util/mom_util.h"
 
 #include "tier0/vprof.h"
@@ -79,46 +80,6 @@ void ImpactCallback(const CEffectData &data)
 }
 DECLARE_CLIENT_EFFECT("Impact", ImpactCallback);
 
-//-----------------------------------------------------------------------------
-// Purpose: Handle weapon impacts
-//-----------------------------------------------------------------------------
-bool Painting(Vector &vecOrigin, Vector &vecStart, int iHitbox, C_BaseEntity *pEntity, trace_t &tr,
-              Color color = Color(255, 255, 255, 255), int nFlags = 0)
-{
-    VPROF("Painting");
-
-    Assert(pEntity);
-
-    // Clear out the trace
-    memset(&tr, 0, sizeof(trace_t));
-    tr.fraction = 1.0f;
-
-    // Setup our shot information
-    Vector shotDir = vecOrigin - vecStart;
-    float flLength = VectorNormalize(shotDir);
-    Vector traceExt;
-    VectorMA(vecStart, flLength + 8.0f, shotDir, traceExt);
-
-    int decalNumber = decalsystem->GetDecalIndexForName("Painting");
-
-    if (decalNumber == -1)
-        return false;
-
-    if (!pEntity)
-        return false;
-
-    if (pEntity->entindex() == 0 && iHitbox != 0)
-    {
-        staticpropmgr->AddColorDecalToStaticProp(vecStart, traceExt, iHitbox - 1, decalNumber, true, tr, true, color);
-    }
-    else
-    {
-        pEntity->AddColoredDecal(vecStart, traceExt, vecOrigin, iHitbox, decalNumber, true, tr, color, ADDDECAL_TO_ALL_LODS, nFlags);
-    }
-
-    return true;
-}
-
 void PaintingCallback(const CEffectData &data)
 {
     VPROF_BUDGET("PaintingCallback", VPROF_BUDGETGROUP_PARTICLE_RENDERING);
@@ -141,29 +102,26 @@ void PaintingCallback(const CEffectData &data)
         return;
 
     Color color;
+    float flScale;
 
     // Are we an online entity?
     if (data.m_bCustomColors)
     {
         color.SetRawColor(iDamageType);
-        MomUtil::UpdatePaintDecalScale(data.m_flScale);
+        flScale = data.m_flScale;
     }
     else
     {
         ConVarRef mom_paintgun_color("mom_paintgun_color"), paintgun_scale("mom_paintgun_scale");
         MomUtil::GetColorFromHex(mom_paintgun_color.GetString(), color);
-        MomUtil::UpdatePaintDecalScale(paintgun_scale.GetFloat());
+        flScale = paintgun_scale.GetFloat();
     }
 
-    // If we hit, perform our custom effects and play the sound
-    if (Painting(vecOrigin, vecStart, iHitbox, pEntity, tr, color, data.m_bCustomColors ? 0 : 0x01))
-    {
-        // Check for custom effects based on the Decal index
-        // MOM_TODO: Custom impact effects here? Or at least pass no flecks as a flag
-        //PerformCustomEffects(vecOrigin, tr, vecShotDir, iMaterial, 1.0);
-    }
+    // Applied in batches, see CPaintSystem
+    g_pPaintSystem->QueueSplat(pEntity, vecOrigin, vecStart, iHitbox, color, flScale, !data.m_bCustomColors);
 
-    // MOM_TODO: Custom impact sounds here?
+    // MOM_TODO: Custom impact effects and sounds here? Or at least pass no flecks as a flag
+    //PerformCustomEffects(vecOrigin, tr, vecShotDir, iMaterial, 1.0);
     //PlayImpactSound(pEntity, tr, vecOrigin, nSurfaceProp);
 }
 
@@ -9,6 +9,7 @@
 #include "c_te_legacytempents.h"
 #include "tempent.h"
 #include "mom_shareddefs.h"
+#include "mom_effect_budget.h"
 #include "tier0/vprof.h"
 
 #include "tier0/memdbgon.h"
@@ -58,6 +59,12 @@ void C_TETFParticleEffect::PostDataUpdate(DataUpdateType_t updateType)
 {
     VPROF("C_TETFParticleEffect::PostDataUpdate");
 
+    // Effects attached to an entity are where the entity is
+    C_BaseEntity *pEntity = m_hEntity != INVALID_EHANDLE_INDEX ? ClientEntityList().GetBaseEntityFromHandle(m_hEntity) : nullptr;
+    if (!g_pEffectBudget->RequestEffect(EFFECT_BUDGET_PARTICLE, pEntity ? pEntity->GetAbsOrigin() : m_vecOrigin,
+                                        CEffectBudget::IsLocalPlayerEffect(pEntity)))
+        return;
+
     CEffectData data;
 
     data.m_nHitBox = m_iParticleSystemIndex;
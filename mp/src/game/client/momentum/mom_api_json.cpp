@@ -0,0 +1,571 @@
+#include "cbase.h"
+
+#include "mom_api_json.h"
+#include "util/jsontokv.h"
+#include "filesystem.h"
+#include "fmtstr.h"
+#include "utlbuffer.h"
+
+#include "tier0/valve_minmax_off.h"
+// This is wrapped by minmax_off due to Valve making a macro for min and max...
+#include "rapidjson/reader.h"
+// Now we can unwrap
+#include "tier0/valve_minmax_on.h"
+
+#include "tier0/memdbgon.h"
+
+using namespace rapidjson;
+
+// What the object or array currently being read is
+enum JsonFrameType_t
+{
+    FRAME_IGNORE = 0, // Not something we read, everything inside of it is skipped
+    FRAME_ROOT,
+    FRAME_MAP_LIST,
+    FRAME_MAP,
+    FRAME_USER,
+    FRAME_INFO,
+    FRAME_TRACK,
+    FRAME_IMAGE,
+    FRAME_IMAGE_LIST,
+    FRAME_CREDIT,
+    FRAME_CREDIT_LIST,
+    FRAME_RANK,
+    FRAME_RUN,
+    FRAME_NON_EMPTY, // An array that only matters for whether it has any objects in it
+};
+
+struct JsonFrame_t
+{
+    JsonFrameType_t m_eType;
+    void *m_pTarget;
+};
+
+// A single JSON value. Numbers can come as strings too (64 bit IDs), nulls are empty strings, like KeyValues has them.
+struct JsonScalar_t
+{
+    const char *m_pString;
+    int64 m_iValue;
+    double m_flValue;
+
+    int64 AsInt64() const { return m_pString ? V_atoi64(m_pString) : m_iValue; }
+    int AsInt() const { return (int) AsInt64(); }
+    float AsFloat() const { return m_pString ? V_atof(m_pString) : (float) m_flValue; }
+    bool AsBool() const { return AsInt64() != 0; }
+
+    template <size_t maxLenInChars>
+    void AsString(char (&pOut)[maxLenInChars]) const
+    {
+        if (m_pString)
+            Q_strncpy(pOut, m_pString, maxLenInChars);
+        else if (m_flValue == (double) m_iValue)
+            Q_snprintf(pOut, maxLenInChars, "%lld", m_iValue);
+        else
+            Q_snprintf(pOut, maxLenInChars, "%f", m_flValue);
+    }
+};
+
+// The fields each model reads, mirroring their FromKV
+static void ReadField(MapData *pMap, const char *pKey, const JsonScalar_t &value)
+{
+    if (FStrEq(pKey, "id"))
+        pMap->m_uID = value.AsInt();
+    else if (FStrEq(pKey, "type"))
+        pMap->m_eType = (GameMode_t) value.AsInt();
+    else if (FStrEq(pKey, "statusFlag"))
+        pMap->m_eMapStatus = (MapUploadStatus_t) value.AsInt();
+    else if (FStrEq(pKey, "hash"))
+        value.AsString(pMap->m_szHash);
+    else if (FStrEq(pKey, "downloadURL"))
+        value.AsString(pMap->m_szDownloadURL);
+    else if (FStrEq(pKey, "updatedAt"))
+        value.AsString(pMap->m_szLastUpdated);
+    else if (FStrEq(pKey, "createdAt"))
+        value.AsString(pMap->m_szCreatedAt);
+    else if (FStrEq(pKey, "name"))
+        value.AsString(pMap->m_szMapName);
+}
+
+static void ReadField(User *pUser, const char *pKey, const JsonScalar_t &value)
+{
+    if (FStrEq(pKey, "id"))
+        pUser->m_uMainID = value.AsInt64();
+    else if (FStrEq(pKey, "steamID"))
+        pUser->m_uSteamID = value.AsInt64();
+    else if (FStrEq(pKey, "alias"))
+        value.AsString(pUser->m_szAlias);
+}
+
+static void ReadField(MapInfo *pInfo, const char *pKey, const JsonScalar_t &value)
+{
+    if (FStrEq(pKey, "description"))
+        value.AsString(pInfo->m_szDescription);
+    else if (FStrEq(pKey, "numTracks"))
+        pInfo->m_iNumTracks = value.AsInt();
+    else if (FStrEq(pKey, "creationDate"))
+        value.AsString(pInfo->m_szCreationDate);
+}
+
+static void ReadField(MapTrack *pTrack, const char *pKey, const JsonScalar_t &value)
+{
+    if (FStrEq(pKey, "trackNum"))
+        pTrack->m_iTrackNum = (uint8) value.AsInt();
+    else if (FStrEq(pKey, "difficulty"))
+        pTrack->m_iDifficulty = (uint8) value.AsInt();
+    else if (FStrEq(pKey, "numZones"))
+        pTrack->m_iNumZones = (uint8) value.AsInt();
+    else if (FStrEq(pKey, "isLinear"))
+        pTrack->m_bIsLinear = value.AsBool();
+}
+
+static void ReadField(MapImage *pImage, const char *pKey, const JsonScalar_t &value)
+{
+    if (FStrEq(pKey, "id"))
+        pImage->m_uID = value.AsInt();
+    else if (FStrEq(pKey, "small"))
+        value.AsString(pImage->m_szURLSmall);
+    else if (FStrEq(pKey, "medium"))
+        value.AsString(pImage->m_szURLMedium);
+    else if (FStrEq(pKey, "large"))
+        value.AsString(pImage->m_szURLLarge);
+    else if (FStrEq(pKey, "updatedAt"))
+        value.AsString(pImage->m_szLastUpdatedDate);
+}
+
+static void ReadField(MapCredit *pCredit, const char *pKey, const JsonScalar_t &value)
+{
+    if (FStrEq(pKey, "id"))
+        pCredit->m_uID = value.AsInt();
+    else if (FStrEq(pKey, "type"))
+        pCredit->m_eType = (MapCreditType_t) value.AsInt();
+}
+
+static void ReadField(MapRank *pRank, const char *pKey, const JsonScalar_t &value)
+{
+    if (FStrEq(pKey, "rank"))
+        pRank->m_iRank = value.AsInt();
+    else if (FStrEq(pKey, "rankXP"))
+        pRank->m_iRankXP = value.AsInt();
+}
+
+static void ReadField(Run *pRun, const char *pKey, const JsonScalar_t &value)
+{
+    if (FStrEq(pKey, "id"))
+        pRun->m_uID = value.AsInt64();
+    else if (FStrEq(pKey, "isPersonalBest"))
+        pRun->m_bIsPersonalBest = value.AsBool();
+    else if (FStrEq(pKey, "tickRate"))
+        pRun->m_fTickRate = value.AsFloat();
+    else if (FStrEq(pKey, "createdAt"))
+        value.AsString(pRun->m_szDateAchieved);
+    else if (FStrEq(pKey, "time"))
+        pRun->m_fTime = value.AsFloat();
+    else if (FStrEq(pKey, "flags"))
+        pRun->m_uFlags = value.AsInt();
+    else if (FStrEq(pKey, "file"))
+        value.AsString(pRun->m_szDownloadURL);
+    else if (FStrEq(pKey, "hash"))
+        value.AsString(pRun->m_szFileHash);
+}
+
+// Later entries with the same ID replace earlier ones, like FromKV does for credits and images
+template <class T>
+static void RemoveDuplicateTail(CUtlVector<T> *pVec)
+{
+    const int iLast = pVec->Count() - 1;
+    for (int i = 0; i < iLast; i++)
+    {
+        if (pVec->Element(i) == pVec->Element(iLast))
+        {
+            pVec->Element(i) = pVec->Element(iLast);
+            pVec->Remove(iLast);
+            return;
+        }
+    }
+}
+
+// SAX handler that fills MapData objects as the JSON is read
+class CMapListHandler : public BaseReaderHandler<UTF8<>, CMapListHandler>
+{
+  public:
+    CMapListHandler(APIModelSource source, CUtlVector<MapData *> &vecMaps, KeyValues *pKvOut)
+        : m_eSource(source), m_vecMaps(vecMaps), m_pKvOut(pKvOut)
+    {
+        m_szKey[0] = '\0';
+    }
+
+    ~CMapListHandler()
+    {
+        // Only non-empty if parsing failed part way through a map
+        FOR_EACH_VEC(m_vecFrames, i)
+        {
+            if (m_vecFrames[i].m_eType == FRAME_MAP)
+                delete static_cast<MapData *>(m_vecFrames[i].m_pTarget);
+        }
+    }
+
+    bool Null()
+    {
+        const JsonScalar_t value = {"", 0, 0.0};
+        return Value(value);
+    }
+    bool Bool(bool b)
+    {
+        const JsonScalar_t value = {nullptr, b, b ? 1.0 : 0.0};
+        return Value(value);
+    }
+    bool Int(int i) { return Int64(i); }
+    bool Uint(unsigned u) { return Int64(u); }
+    bool Int64(int64_t i)
+    {
+        const JsonScalar_t value = {nullptr, i, (double) i};
+        return Value(value);
+    }
+    bool Uint64(uint64_t u) { return Int64((int64_t) u); }
+    bool Double(double d)
+    {
+        const JsonScalar_t value = {nullptr, (int64) d, d};
+        return Value(value);
+    }
+    bool String(const char *pStr, SizeType, bool)
+    {
+        const JsonScalar_t value = {pStr, 0, 0.0};
+        return Value(value);
+    }
+    bool Key(const char *pStr, SizeType, bool)
+    {
+        Q_strncpy(m_szKey, pStr, sizeof(m_szKey));
+        return true;
+    }
+    bool StartObject() { return Push(true); }
+    bool EndObject(SizeType) { return Pop(); }
+    bool StartArray() { return Push(false); }
+    bool EndArray(SizeType) { return Pop(); }
+
+  private:
+    JsonFrame_t ChildOfMap(MapData *pMap, bool bObject) const;
+    bool Push(bool bObject);
+    bool Pop();
+    bool Value(const JsonScalar_t &value);
+
+    APIModelSource m_eSource;
+    CUtlVector<MapData *> &m_vecMaps;
+    KeyValues *m_pKvOut;
+
+    CUtlVector<JsonFrame_t> m_vecFrames;
+    char m_szKey[64];
+};
+
+JsonFrame_t CMapListHandler::ChildOfMap(MapData *pMap, bool bObject) const
+{
+    JsonFrame_t frame = {FRAME_IGNORE, nullptr};
+    if (bObject)
+    {
+        if (FStrEq(m_szKey, "info"))
+            frame = {FRAME_INFO, &pMap->m_Info};
+        else if (FStrEq(m_szKey, "mainTrack"))
+            frame = {FRAME_TRACK, &pMap->m_MainTrack};
+        else if (FStrEq(m_szKey, "submitter"))
+            frame = {FRAME_USER, &pMap->m_Submitter};
+        else if (FStrEq(m_szKey, "thumbnail"))
+            frame = {FRAME_IMAGE, &pMap->m_Thumbnail};
+        else if (FStrEq(m_szKey, "personalBest"))
+            frame = {FRAME_RANK, &pMap->m_PersonalBest};
+        else if (FStrEq(m_szKey, "worldRecord"))
+            frame = {FRAME_RANK, &pMap->m_WorldRecord};
+    }
+    else
+    {
+        if (FStrEq(m_szKey, "credits"))
+            frame = {FRAME_CREDIT_LIST, &pMap->m_vecCredits};
+        else if (FStrEq(m_szKey, "images"))
+            frame = {FRAME_IMAGE_LIST, &pMap->m_vecImages};
+        else if (FStrEq(m_szKey, "favorites"))
+            frame = {FRAME_NON_EMPTY, &pMap->m_bInFavorites};
+        else if (FStrEq(m_szKey, "libraryEntries"))
+            frame = {FRAME_NON_EMPTY, &pMap->m_bInLibrary};
+    }
+
+    return frame;
+}
+
+bool CMapListHandler::Push(bool bObject)
+{
+    if (m_vecFrames.IsEmpty())
+    {
+        if (!bObject)
+            return false;
+
+        const JsonFrame_t root = {FRAME_ROOT, nullptr};
+        m_vecFrames.AddToTail(root);
+        return true;
+    }
+
+    const JsonFrame_t &top = m_vecFrames.Tail();
+    JsonFrame_t frame = {FRAME_IGNORE, nullptr};
+    switch (top.m_eType)
+    {
+    case FRAME_ROOT:
+        if (!bObject && FStrEq(m_szKey, "maps"))
+            frame = {FRAME_MAP_LIST, nullptr};
+        break;
+    case FRAME_MAP_LIST:
+        if (bObject)
+        {
+            MapData *pMap = new MapData;
+            pMap->m_eSource = m_eSource;
+            pMap->m_eMapStatus = STATUS_UNKNOWN;
+            pMap->m_bInFavorites = m_eSource == MODEL_FROM_FAVORITES_API_CALL;
+            pMap->m_bInLibrary = pMap->m_bMapFileNeedsUpdate = m_eSource == MODEL_FROM_LIBRARY_API_CALL;
+            frame = {FRAME_MAP, pMap};
+        }
+        break;
+    case FRAME_MAP:
+        frame = ChildOfMap(static_cast<MapData *>(top.m_pTarget), bObject);
+        break;
+    case FRAME_CREDIT_LIST:
+        if (bObject)
+        {
+            const auto pCredits = static_cast<CUtlVector<MapCredit> *>(top.m_pTarget);
+            frame = {FRAME_CREDIT, &pCredits->Element(pCredits->AddToTail())};
+        }
+        break;
+    case FRAME_IMAGE_LIST:
+        if (bObject)
+        {
+            const auto pImages = static_cast<CUtlVector<MapImage> *>(top.m_pTarget);
+            frame = {FRAME_IMAGE, &pImages->Element(pImages->AddToTail())};
+        }
+        break;
+    case FRAME_CREDIT:
+        if (bObject && FStrEq(m_szKey, "user"))
+            frame = {FRAME_USER, &static_cast<MapCredit *>(top.m_pTarget)->m_User};
+        break;
+    case FRAME_RANK:
+        if (bObject && FStrEq(m_szKey, "run"))
+            frame = {FRAME_RUN, &static_cast<MapRank *>(top.m_pTarget)->m_Run};
+        else if (bObject && FStrEq(m_szKey, "user"))
+            frame = {FRAME_USER, &static_cast<MapRank *>(top.m_pTarget)->m_User};
+        break;
+    case FRAME_NON_EMPTY:
+        if (bObject)
+            *static_cast<bool *>(top.m_pTarget) = true;
+        break;
+    default:
+        break;
+    }
+
+    m_vecFrames.AddToTail(frame);
+    return true;
+}
+
+bool CMapListHandler::Pop()
+{
+    if (m_vecFrames.IsEmpty())
+        return false;
+
+    const JsonFrame_t frame = m_vecFrames.Tail();
+    m_vecFrames.RemoveMultipleFromTail(1);
+
+    switch (frame.m_eType)
+    {
+    case FRAME_MAP:
+        {
+            MapData *pMap = static_cast<MapData *>(frame.m_pTarget);
+            pMap->m_bValid = pMap->m_uID > 0;
+            if (pMap->m_bValid)
+                m_vecMaps.AddToTail(pMap);
+            else
+                delete pMap;
+        }
+        break;
+    case FRAME_USER:
+        {
+            User *pUser = static_cast<User *>(frame.m_pTarget);
+            pUser->m_bValid = pUser->m_uMainID > 0 && pUser->m_szAlias[0];
+        }
+        break;
+    case FRAME_INFO:
+        {
+            MapInfo *pInfo = static_cast<MapInfo *>(frame.m_pTarget);
+            pInfo->m_bValid = pInfo->m_iNumTracks && pInfo->m_szDescription[0];
+        }
+        break;
+    case FRAME_TRACK:
+        {
+            MapTrack *pTrack = static_cast<MapTrack *>(frame.m_pTarget);
+            pTrack->m_bValid = pTrack->m_iNumZones && pTrack->m_iDifficulty;
+        }
+        break;
+    case FRAME_IMAGE:
+        {
+            MapImage *pImage = static_cast<MapImage *>(frame.m_pTarget);
+            pImage->m_bValid = pImage->m_uID > 0;
+            if (m_vecFrames.Tail().m_eType == FRAME_IMAGE_LIST)
+                RemoveDuplicateTail(static_cast<CUtlVector<MapImage> *>(m_vecFrames.Tail().m_pTarget));
+        }
+        break;
+    case FRAME_CREDIT:
+        {
+            MapCredit *pCredit = static_cast<MapCredit *>(frame.m_pTarget);
+            pCredit->m_bValid = pCredit->m_uID > 0;
+            RemoveDuplicateTail(static_cast<CUtlVector<MapCredit> *>(m_vecFrames.Tail().m_pTarget));
+        }
+        break;
+    case FRAME_RANK:
+        {
+            MapRank *pRank = static_cast<MapRank *>(frame.m_pTarget);
+            pRank->m_bValid = pRank->m_iRank > 0;
+        }
+        break;
+    case FRAME_RUN:
+        {
+            Run *pRun = static_cast<Run *>(frame.m_pTarget);
+            pRun->m_bValid = pRun->m_uID > 0;
+        }
+        break;
+    default:
+        break;
+    }
+
+    return true;
+}
+
+bool CMapListHandler::Value(const JsonScalar_t &value)
+{
+    if (m_vecFrames.IsEmpty())
+        return false;
+
+    const JsonFrame_t &top = m_vecFrames.Tail();
+    switch (top.m_eType)
+    {
+    case FRAME_ROOT:
+        if (value.m_pString)
+            m_pKvOut->SetString(m_szKey, value.m_pString);
+        else if (value.m_flValue == (double) value.m_iValue)
+            m_pKvOut->SetUint64(m_szKey, value.m_iValue);
+        else
+            m_pKvOut->SetFloat(m_szKey, value.m_flValue);
+        break;
+    case FRAME_MAP:
+        ReadField(static_cast<MapData *>(top.m_pTarget), m_szKey, value);
+        break;
+    case FRAME_USER:
+        ReadField(static_cast<User *>(top.m_pTarget), m_szKey, value);
+        break;
+    case FRAME_INFO:
+        ReadField(static_cast<MapInfo *>(top.m_pTarget), m_szKey, value);
+        break;
+    case FRAME_TRACK:
+        ReadField(static_cast<MapTrack *>(top.m_pTarget), m_szKey, value);
+        break;
+    case FRAME_IMAGE:
+        ReadField(static_cast<MapImage *>(top.m_pTarget), m_szKey, value);
+        break;
+    case FRAME_CREDIT:
+        ReadField(static_cast<MapCredit *>(top.m_pTarget), m_szKey, value);
+        break;
+    case FRAME_RANK:
+        ReadField(static_cast<MapRank *>(top.m_pTarget), m_szKey, value);
+        break;
+    case FRAME_RUN:
+        ReadField(static_cast<Run *>(top.m_pTarget), m_szKey, value);
+        break;
+    default:
+        break;
+    }
+
+    return true;
+}
+
+bool CAPIJsonReader::ReadMapList(char *pJson, APIModelSource source, CUtlVector<MapData *> &vecMaps, KeyValues *pKvOut)
+{
+    CMapListHandler handler(source, vecMaps, pKvOut);
+    InsituStringStream stream(pJson);
+    Reader reader;
+    const ParseResult result = reader.Parse<kParseInsituFlag>(stream, handler);
+    if (result.IsError())
+    {
+        pKvOut->SetString("err_parse", CFmtStr("Error parsing JSON object! Code: %d", result.Code()).Get());
+        return false;
+    }
+
+    return true;
+}
+
+CON_COMMAND_F(mom_api_benchmark_map_list, "Times reading a saved map list response through KeyValues and through CAPIJsonReader.\n"
+                                          "Usage: mom_api_benchmark_map_list <json file> [iterations]\n", FCVAR_DEVELOPMENTONLY)
+{
+    if (args.ArgC() < 2)
+    {
+        Msg("%s", mom_api_benchmark_map_list_command.GetHelpText());
+        return;
+    }
+
+    CUtlBuffer bufFile(0, 0, CUtlBuffer::TEXT_BUFFER);
+    if (!g_pFullFileSystem->ReadFile(args[1], "GAME", bufFile))
+    {
+        Warning("Could not read %s!\n", args[1]);
+        return;
+    }
+
+    const int iIterations = args.ArgC() > 2 ? Max(atoi(args[2]), 1) : 10;
+    const int iSize = bufFile.TellPut();
+    char *pJson = new char[iSize + 1];
+
+    int iMapsKv = 0;
+    double flKvTime = 0.0;
+    for (int i = 0; i < iIterations; i++)
+    {
+        V_memcpy(pJson, bufFile.Base(), iSize);
+        pJson[iSize] = '\0';
+
+        const double flStart = Plat_FloatTime();
+        {
+            KeyValuesAD pKvData("data");
+            CJsonToKeyValues::ConvertJsonToKeyValues(pJson, pKvData);
+
+            CUtlVector<MapData *> vecMaps;
+            KeyValues *pKvMaps = pKvData->FindKey("maps");
+            if (pKvMaps)
+            {
+                FOR_EACH_SUBKEY(pKvMaps, pKvMap)
+                {
+                    MapData *pData = new MapData;
+                    pData->m_eSource = MODEL_FROM_SEARCH_API_CALL;
+                    pData->FromKV(pKvMap);
+                    vecMaps.AddToTail(pData);
+                }
+            }
+
+            iMapsKv = vecMaps.Count();
+            vecMaps.PurgeAndDeleteElements();
+        }
+        flKvTime += Plat_FloatTime() - flStart;
+    }
+
+    int iMapsDirect = 0;
+    double flDirectTime = 0.0;
+    for (int i = 0; i < iIterations; i++)
+    {
+        V_memcpy(pJson, bufFile.Base(), iSize);
+        pJson[iSize] = '\0';
+
+        const double flStart = Plat_FloatTime();
+        {
+            KeyValuesAD pKvData("data");
+            CUtlVector<MapData *> vecMaps;
+            CAPIJsonReader::ReadMapList(pJson, MODEL_FROM_SEARCH_API_CALL, vecMaps, pKvData);
+
+            iMapsDirect = vecMaps.Count();
+            vecMaps.PurgeAndDeleteElements();
+        }
+        flDirectTime += Plat_FloatTime() - flStart;
+    }
+
+    delete[] pJson;
+
+    Msg("%i iterations of %i bytes:\n", iIterations, iSize);
+    Msg("  KeyValues: %i maps, %.3f ms avg\n", iMapsKv, flKvTime * 1000.0 / iIterations);
+    Msg("  Direct:    %i maps, %.3f ms avg\n", iMapsDirect, flDirectTime * 1000.0 / iIterations);
+}
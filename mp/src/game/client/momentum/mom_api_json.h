@@ -0,0 +1,15 @@
+#pragma once
+
+#include "mom_api_models.h"
+
+// Reads API responses straight from JSON into the API models, without going through a rapidjson DOM
+// and a KeyValues tree first. Only used for the responses that can be large, everything else still
+// goes through CJsonToKeyValues.
+class CAPIJsonReader
+{
+  public:
+    // Parses a map list response ({"count": N, "maps": [...]}) into vecMaps, the caller owns the MapData.
+    // Top level values other than the map list are set on pKvOut, parse errors are set as "err_parse" on it.
+    // pJson is parsed in place, so it is modified!
+    static bool ReadMapList(char *pJson, APIModelSource source, CUtlVector<MapData *> &vecMaps, KeyValues *pKvOut);
+};
@@ -2,9 +2,11 @@
 
 #include "mom_api_models.h"
 
+#include "mom_map_cache.h"
 #include "mom_modulecomms.h"
 #include "filesystem.h"
 #include "fmtstr.h"
+#include "utlbuffer.h"
 
 #include "tier0/memdbgon.h"
 
@@ -32,6 +34,22 @@ void User::ToKV(KeyValues* pKv) const
     pKv->SetString("alias", m_szAlias);
 }
 
+void User::FromBinary(CUtlBuffer &buf)
+{
+    m_bValid = buf.GetUnsignedChar() != 0;
+    m_uMainID = buf.GetUnsignedInt();
+    m_uSteamID = buf.GetInt64();
+    buf.GetString(m_szAlias);
+}
+
+void User::ToBinary(CUtlBuffer &buf) const
+{
+    buf.PutUnsignedChar(m_bValid);
+    buf.PutUnsignedInt(m_uMainID);
+    buf.PutInt64(m_uSteamID);
+    buf.PutString(m_szAlias);
+}
+
 User& User::operator=(const User& src)
 {
     if (src.m_bValid)
@@ -73,6 +91,22 @@ void MapInfo::ToKV(KeyValues* pKv) const
     pKv->SetString("creationDate", m_szCreationDate);
 }
 
+void MapInfo::FromBinary(CUtlBuffer &buf)
+{
+    m_bValid = buf.GetUnsignedChar() != 0;
+    buf.GetString(m_szDescription);
+    m_iNumTracks = buf.GetInt();
+    buf.GetString(m_szCreationDate);
+}
+
+void MapInfo::ToBinary(CUtlBuffer &buf) const
+{
+    buf.PutUnsignedChar(m_bValid);
+    buf.PutString(m_szDescription);
+    buf.PutInt(m_iNumTracks);
+    buf.PutString(m_szCreationDate);
+}
+
 MapInfo& MapInfo::operator=(const MapInfo& other)
 {
     if (other.m_bValid)
@@ -121,6 +155,26 @@ void MapImage::ToKV(KeyValues* pKv) const
     pKv->SetString("updatedAt", m_szLastUpdatedDate);
 }
 
+void MapImage::FromBinary(CUtlBuffer &buf)
+{
+    m_bValid = buf.GetUnsignedChar() != 0;
+    m_uID = buf.GetUnsignedInt();
+    buf.GetString(m_szURLSmall);
+    buf.GetString(m_szURLMedium);
+    buf.GetString(m_szURLLarge);
+    buf.GetString(m_szLastUpdatedDate);
+}
+
+void MapImage::ToBinary(CUtlBuffer &buf) const
+{
+    buf.PutUnsignedChar(m_bValid);
+    buf.PutUnsignedInt(m_uID);
+    buf.PutString(m_szURLSmall);
+    buf.PutString(m_szURLMedium);
+    buf.PutString(m_szURLLarge);
+    buf.PutString(m_szLastUpdatedDate);
+}
+
 bool MapImage::operator==(const MapImage &other) const
 {
     return m_uID == other.m_uID;
@@ -168,6 +222,22 @@ void MapCredit::ToKV(KeyValues* pKv) const
     }
 }
 
+void MapCredit::FromBinary(CUtlBuffer &buf)
+{
+    m_bValid = buf.GetUnsignedChar() != 0;
+    m_uID = buf.GetUnsignedInt();
+    m_eType = (MapCreditType_t) buf.GetInt();
+    m_User.FromBinary(buf);
+}
+
+void MapCredit::ToBinary(CUtlBuffer &buf) const
+{
+    buf.PutUnsignedChar(m_bValid);
+    buf.PutUnsignedInt(m_uID);
+    buf.PutInt(m_eType);
+    m_User.ToBinary(buf);
+}
+
 bool MapCredit::operator==(const MapCredit& other) const
 {
     return m_uID == other.m_uID;
@@ -218,6 +288,32 @@ void Run::ToKV(KeyValues* pKv) const
     pKv->SetString("hash", m_szFileHash);
 }
 
+void Run::FromBinary(CUtlBuffer &buf)
+{
+    m_bValid = buf.GetUnsignedChar() != 0;
+    m_uID = buf.GetInt64();
+    m_bIsPersonalBest = buf.GetUnsignedChar() != 0;
+    m_fTickRate = buf.GetFloat();
+    buf.GetString(m_szDateAchieved);
+    m_fTime = buf.GetFloat();
+    m_uFlags = buf.GetUnsignedInt();
+    buf.GetString(m_szDownloadURL);
+    buf.GetString(m_szFileHash);
+}
+
+void Run::ToBinary(CUtlBuffer &buf) const
+{
+    buf.PutUnsignedChar(m_bValid);
+    buf.PutInt64(m_uID);
+    buf.PutUnsignedChar(m_bIsPersonalBest);
+    buf.PutFloat(m_fTickRate);
+    buf.PutString(m_szDateAchieved);
+    buf.PutFloat(m_fTime);
+    buf.PutUnsignedInt(m_uFlags);
+    buf.PutString(m_szDownloadURL);
+    buf.PutString(m_szFileHash);
+}
+
 bool Run::operator==(const Run& other) const
 {
     return m_uID == other.m_uID;
@@ -295,6 +391,24 @@ void MapRank::ToKV(KeyValues* pKv) const
     }
 }
 
+void MapRank::FromBinary(CUtlBuffer &buf)
+{
+    m_bValid = buf.GetUnsignedChar() != 0;
+    m_iRank = buf.GetUnsignedInt();
+    m_iRankXP = buf.GetUnsignedInt();
+    m_Run.FromBinary(buf);
+    m_User.FromBinary(buf);
+}
+
+void MapRank::ToBinary(CUtlBuffer &buf) const
+{
+    buf.PutUnsignedChar(m_bValid);
+    buf.PutUnsignedInt(m_iRank);
+    buf.PutUnsignedInt(m_iRankXP);
+    m_Run.ToBinary(buf);
+    m_User.ToBinary(buf);
+}
+
 bool MapRank::operator==(const MapRank& other) const
 {
     return m_Run == other.m_Run && m_iRank == other.m_iRank && m_iRankXP == other.m_iRankXP;
@@ -340,6 +454,24 @@ void MapTrack::ToKV(KeyValues *pKv) const
     pKv->SetBool("isLinear", m_bIsLinear);
 }
 
+void MapTrack::FromBinary(CUtlBuffer &buf)
+{
+    m_bValid = buf.GetUnsignedChar() != 0;
+    m_iTrackNum = buf.GetUnsignedChar();
+    m_iDifficulty = buf.GetUnsignedChar();
+    m_iNumZones = buf.GetUnsignedChar();
+    m_bIsLinear = buf.GetUnsignedChar() != 0;
+}
+
+void MapTrack::ToBinary(CUtlBuffer &buf) const
+{
+    buf.PutUnsignedChar(m_bValid);
+    buf.PutUnsignedChar(m_iTrackNum);
+    buf.PutUnsignedChar(m_iDifficulty);
+    buf.PutUnsignedChar(m_iNumZones);
+    buf.PutUnsignedChar(m_bIsLinear);
+}
+
 bool MapTrack::operator==(const MapTrack &other) const
 {
     return m_iTrackNum == other.m_iTrackNum && m_iDifficulty == other.m_iDifficulty &&
@@ -376,10 +508,14 @@ MapData::MapData()
     m_szDownloadURL[0] = '\0';
     m_bMapFileNeedsUpdate = false;
     m_tLastPlayed = 0;
+    m_iDetailsOffset = -1;
 }
 
 MapData::MapData(const MapData& src)
 {
+    // The details offset only means something to the map cache's own copy, so bring them in before copying
+    const_cast<MapData &>(src).LoadDetails();
+
     m_uID = src.m_uID;
     m_eType = src.m_eType;
     m_eMapStatus = src.m_eMapStatus;
@@ -405,6 +541,7 @@ MapData::MapData(const MapData& src)
     m_PersonalBest = src.m_PersonalBest;
     m_WorldRecord = src.m_WorldRecord;
     m_tLastPlayed = src.m_tLastPlayed;
+    m_iDetailsOffset = -1;
     m_bValid = src.m_bValid;
 }
 
@@ -438,6 +575,8 @@ void MapData::ResetUpdate()
 
 bool MapData::GetCreditString(CUtlString *pOut, MapCreditType_t creditType)
 {
+    LoadDetails();
+
     if (m_vecCredits.IsEmpty() || !pOut)
         return false;
 
@@ -647,6 +786,86 @@ void MapData::ToKV(KeyValues* pKv) const
     }
 }
 
+void MapData::FromBinary(CUtlBuffer &buf)
+{
+    m_bValid = buf.GetUnsignedChar() != 0;
+    m_uID = buf.GetUnsignedInt();
+    buf.GetString(m_szMapName);
+    buf.GetString(m_szHash);
+    m_eType = (GameMode_t) buf.GetInt();
+    m_eMapStatus = (MapUploadStatus_t) buf.GetInt();
+    buf.GetString(m_szDownloadURL);
+    buf.GetString(m_szLastUpdated);
+    buf.GetString(m_szCreatedAt);
+    m_bInFavorites = buf.GetUnsignedChar() != 0;
+    m_bInLibrary = buf.GetUnsignedChar() != 0;
+    m_bMapFileExists = buf.GetUnsignedChar() != 0;
+    m_bMapFileNeedsUpdate = buf.GetUnsignedChar() != 0;
+    m_tLastPlayed = buf.GetInt64();
+
+    m_Submitter.FromBinary(buf);
+    m_Info.FromBinary(buf);
+    m_MainTrack.FromBinary(buf);
+    m_Thumbnail.FromBinary(buf);
+    m_PersonalBest.FromBinary(buf);
+    m_WorldRecord.FromBinary(buf);
+}
+
+void MapData::ToBinary(CUtlBuffer &buf) const
+{
+    buf.PutUnsignedChar(m_bValid);
+    buf.PutUnsignedInt(m_uID);
+    buf.PutString(m_szMapName);
+    buf.PutString(m_szHash);
+    buf.PutInt(m_eType);
+    buf.PutInt(m_eMapStatus);
+    buf.PutString(m_szDownloadURL);
+    buf.PutString(m_szLastUpdated);
+    buf.PutString(m_szCreatedAt);
+    buf.PutUnsignedChar(m_bInFavorites);
+    buf.PutUnsignedChar(m_bInLibrary);
+    buf.PutUnsignedChar(m_bMapFileExists);
+    buf.PutUnsignedChar(m_bMapFileNeedsUpdate);
+    buf.PutInt64(m_tLastPlayed);
+
+    m_Submitter.ToBinary(buf);
+    m_Info.ToBinary(buf);
+    m_MainTrack.ToBinary(buf);
+    m_Thumbnail.ToBinary(buf);
+    m_PersonalBest.ToBinary(buf);
+    m_WorldRecord.ToBinary(buf);
+}
+
+void MapData::DetailsFromBinary(CUtlBuffer &buf)
+{
+    m_vecCredits.RemoveAll();
+    const int iCredits = buf.GetInt();
+    for (int i = 0; i < iCredits && buf.IsValid(); i++)
+        m_vecCredits[m_vecCredits.AddToTail()].FromBinary(buf);
+
+    m_vecImages.RemoveAll();
+    const int iImages = buf.GetInt();
+    for (int i = 0; i < iImages && buf.IsValid(); i++)
+        m_vecImages[m_vecImages.AddToTail()].FromBinary(buf);
+}
+
+void MapData::DetailsToBinary(CUtlBuffer &buf) const
+{
+    buf.PutInt(m_vecCredits.Count());
+    FOR_EACH_VEC(m_vecCredits, i)
+        m_vecCredits[i].ToBinary(buf);
+
+    buf.PutInt(m_vecImages.Count());
+    FOR_EACH_VEC(m_vecImages, i)
+        m_vecImages[i].ToBinary(buf);
+}
+
+void MapData::LoadDetails()
+{
+    if (m_iDetailsOffset >= 0)
+        g_pMapCache->LoadMapDetails(this);
+}
+
 MapData& MapData::operator=(const MapData& src)
 {
     if (src.m_bValid)
@@ -680,6 +899,14 @@ MapData& MapData::operator=(const MapData& src)
     m_Submitter = src.m_Submitter;
     m_PersonalBest = src.m_PersonalBest;
     m_WorldRecord = src.m_WorldRecord;
+
+    // Same as the copy constructor, the offset isn't copied so the source's details have to be loaded first
+    const_cast<MapData &>(src).LoadDetails();
+
+    // Don't let lazily loaded details overwrite the new ones later
+    if (src.m_vecCredits.Count() || src.m_vecImages.Count())
+        LoadDetails();
+
     if (src.m_vecCredits.Count())
     {
         m_vecCredits.RemoveAll();
@@ -2,6 +2,8 @@
 
 #include "mom_shareddefs.h"
 
+class CUtlBuffer;
+
 enum APIModelSource
 {
     MODEL_FROM_DISK = 0,
@@ -21,6 +23,9 @@ public:
     APIModelSource m_eSource;
     virtual void FromKV(KeyValues *pKv) = 0;
     virtual void ToKV(KeyValues *pKv) const = 0;
+    // Used by the map cache file
+    virtual void FromBinary(CUtlBuffer &buf) = 0;
+    virtual void ToBinary(CUtlBuffer &buf) const = 0;
 };
 
 struct User : APIModel
@@ -32,6 +37,8 @@ struct User : APIModel
 
     void FromKV(KeyValues* pKv) OVERRIDE;
     void ToKV(KeyValues* pKv) const OVERRIDE;
+    void FromBinary(CUtlBuffer &buf) OVERRIDE;
+    void ToBinary(CUtlBuffer &buf) const OVERRIDE;
     User& operator=(const User& src);
     bool operator==(const User &other) const;
 };
@@ -45,6 +52,8 @@ struct MapInfo : APIModel
 
     void FromKV(KeyValues *pKv) OVERRIDE;
     void ToKV(KeyValues* pKv) const OVERRIDE;
+    void FromBinary(CUtlBuffer &buf) OVERRIDE;
+    void ToBinary(CUtlBuffer &buf) const OVERRIDE;
     MapInfo& operator=(const MapInfo& other);
     bool operator==(const MapInfo &other) const;
 };
@@ -58,6 +67,8 @@ struct MapImage : APIModel
 
     void FromKV(KeyValues* pKv) OVERRIDE;
     void ToKV(KeyValues* pKv) const OVERRIDE;
+    void FromBinary(CUtlBuffer &buf) OVERRIDE;
+    void ToBinary(CUtlBuffer &buf) const OVERRIDE;
     bool operator==(const MapImage &other) const;
     MapImage& operator=(const MapImage& other);
 };
@@ -71,6 +82,8 @@ struct MapCredit : APIModel
 
     void FromKV(KeyValues* pKv) OVERRIDE;
     void ToKV(KeyValues* pKv) const OVERRIDE;
+    void FromBinary(CUtlBuffer &buf) OVERRIDE;
+    void ToBinary(CUtlBuffer &buf) const OVERRIDE;
     bool operator==(const MapCredit& other) const;
     MapCredit& operator=(const MapCredit& other);
 };
@@ -89,6 +102,8 @@ struct Run : APIModel
 
     void FromKV(KeyValues* pKv) OVERRIDE;
     void ToKV(KeyValues* pKv) const OVERRIDE;
+    void FromBinary(CUtlBuffer &buf) OVERRIDE;
+    void ToBinary(CUtlBuffer &buf) const OVERRIDE;
     bool operator==(const Run& other) const;
     Run& operator=(const Run& other);
 };
@@ -105,6 +120,8 @@ struct MapRank : APIModel
     void ResetUpdate();
     void FromKV(KeyValues* pKv) OVERRIDE;
     void ToKV(KeyValues* pKv) const OVERRIDE;
+    void FromBinary(CUtlBuffer &buf) OVERRIDE;
+    void ToBinary(CUtlBuffer &buf) const OVERRIDE;
     bool operator==(const MapRank& other) const;
     MapRank& operator=(const MapRank& other);
 };
@@ -119,6 +136,8 @@ struct MapTrack : APIModel
 
     void FromKV(KeyValues *pKv) OVERRIDE;
     void ToKV(KeyValues *pKv) const OVERRIDE;
+    void FromBinary(CUtlBuffer &buf) OVERRIDE;
+    void ToBinary(CUtlBuffer &buf) const OVERRIDE;
     bool operator==(const MapTrack &other) const;
     MapTrack &operator=(const MapTrack &other);
 };
@@ -150,6 +169,7 @@ struct MapData : APIModel
     bool m_bMapFileExists;
     bool m_bMapFileNeedsUpdate;
     time_t m_tLastPlayed;
+    int m_iDetailsOffset; // Where the credits and images are in the map cache file, -1 if loaded. Never copied
     MapData();
     MapData(const MapData& src);
 
@@ -160,6 +180,13 @@ struct MapData : APIModel
     void DeleteMapFile();
     void FromKV(KeyValues* pMap) OVERRIDE;
     void ToKV(KeyValues* pKv) const OVERRIDE;
+    // Everything but the credits and images, which are stored separately so they can be loaded lazily
+    void FromBinary(CUtlBuffer &buf) OVERRIDE;
+    void ToBinary(CUtlBuffer &buf) const OVERRIDE;
+    void DetailsFromBinary(CUtlBuffer &buf);
+    void DetailsToBinary(CUtlBuffer &buf) const;
+    // Loads the credits and images from the map cache file if they haven't been yet
+    void LoadDetails();
     MapData& operator=(const MapData& src);
     bool operator==(const MapData& other) const;
 };
\ No newline at end of file
@@ -1,15 +1,25 @@
 #include "cbase.h"
 
 #include "mom_api_requests.h"
+#include "mom_api_json.h"
 #include "util/jsontokv.h"
 #include "fmtstr.h"
 #include "mom_shareddefs.h"
 #include "filesystem.h"
 
 #include "MessageboxPanel.h"
+#include "util/mom_file_hash.h"
+
+#include "tier0/valve_minmax_off.h"
+// These are wrapped by minmax_off/on due to Valve making a macro for min and max...
+#include "cryptopp/sha.h"
+// Now we can unwrap
+#include "tier0/valve_minmax_on.h"
 
 #include "tier0/memdbgon.h"
 
+static MAKE_TOGGLE_CONVAR(mom_api_cache_enable, "1", FCVAR_ARCHIVE,
+                          "If 1, API responses are cached and revalidated with conditional requests, and identical requests in flight are merged.\n");
 static MAKE_TOGGLE_CONVAR(mom_api_log_requests, "0", FCVAR_ARCHIVE | FCVAR_REPLICATED, "If 1, API requests will be logged to console.\n");
 static MAKE_TOGGLE_CONVAR(mom_api_log_requests_sensitive, "0", FCVAR_ARCHIVE | FCVAR_REPLICATED, "If 1, API requests that are sensitive will also be logged to console.\n"
 "!!!!!!! DANGER! Only set this if you know what you are doing! This could potentially expose an API key! !!!!!!!");
@@ -32,7 +42,7 @@ static const char* const s_pHTTPMethods[] = {
 };
 
 CAPIRequests::CAPIRequests() : CAutoGameSystem("CAPIRequests"), 
-m_hAuthTicket(k_HAuthTicketInvalid), m_bufAuthBuffer(nullptr),
+m_dictInFlightCalls(k_eDictCompareTypeCaseSensitive), m_hAuthTicket(k_HAuthTicketInvalid), m_bufAuthBuffer(nullptr),
 m_iAuthActualSize(0), m_pAPIKey(nullptr)
 {
     m_szAPIKeyHeader[0] = '\0';
@@ -61,14 +71,16 @@ bool CAPIRequests::GetMaps(KeyValues *pKvFilters, CallbackFunc func)
     APIRequest *req = new APIRequest;
     if (CreateAPIRequest(req, API_REQ("maps"), k_EHTTPMethodGET))
     {
+        req->m_bReadMapList = true;
+        req->m_eMapListSource = MODEL_FROM_SEARCH_API_CALL;
+
         if (pKvFilters && !pKvFilters->IsEmpty())
         {
             FOR_EACH_VALUE(pKvFilters, pKvFilter)
-                SteamHTTP()->SetHTTPRequestGetOrPostParameter(req->handle, pKvFilter->GetName(), pKvFilter->GetString());
+                AddRequestParameter(req, pKvFilter->GetName(), pKvFilter->GetString());
         }
 
-        SteamHTTP()->SetHTTPRequestGetOrPostParameter(req->handle, "expand", 
-                                                      "info,thumbnail,credits,inLibrary,inFavorites,personalBest,worldRecord");
+        AddRequestParameter(req, "expand", "info,thumbnail,credits,inLibrary,inFavorites,personalBest,worldRecord");
 
         return SendAPIRequest(req, func, __FUNCTION__);
     }
@@ -85,7 +97,7 @@ bool CAPIRequests::GetTop10MapTimes(uint32 mapID, CallbackFunc func, KeyValues *
         if (pKvFilters)
         {
             FOR_EACH_VALUE(pKvFilters, pKvFilter)
-                SteamHTTP()->SetHTTPRequestGetOrPostParameter(req->handle, pKvFilter->GetName(), pKvFilter->GetString());
+                AddRequestParameter(req, pKvFilter->GetName(), pKvFilter->GetString());
         }
         return SendAPIRequest(req, func, __FUNCTION__);
     }
@@ -101,7 +113,7 @@ bool CAPIRequests::GetFriendsTimes(uint32 mapID, CallbackFunc func, KeyValues *p
         if (pKvFilters)
         {
             FOR_EACH_VALUE(pKvFilters, pKvFilter)
-                SteamHTTP()->SetHTTPRequestGetOrPostParameter(req->handle, pKvFilter->GetName(), pKvFilter->GetString());
+                AddRequestParameter(req, pKvFilter->GetName(), pKvFilter->GetString());
         }
         return SendAPIRequest(req, func, __FUNCTION__);
     }
@@ -117,7 +129,7 @@ bool CAPIRequests::GetAroundTimes(uint32 mapID, CallbackFunc func, KeyValues *pK
         if (pKvFilters)
         {
             FOR_EACH_VALUE(pKvFilters, pKvFilter)
-                SteamHTTP()->SetHTTPRequestGetOrPostParameter(req->handle, pKvFilter->GetName(), pKvFilter->GetString());
+                AddRequestParameter(req, pKvFilter->GetName(), pKvFilter->GetString());
         }
         return SendAPIRequest(req, func, __FUNCTION__);
     }
@@ -130,7 +142,7 @@ bool CAPIRequests::GetMapInfo(uint32 mapID, CallbackFunc func)
     APIRequest *req = new APIRequest;
     if (CreateAPIRequest(req, API_REQ(CFmtStr("maps/%u", mapID).Get()), k_EHTTPMethodGET))
     {
-        SteamHTTP()->SetHTTPRequestGetOrPostParameter(req->handle, "expand", "info,credits,inLibrary,inFavorites,submitter,images,personalBest,worldRecord");
+        AddRequestParameter(req, "expand", "info,credits,inLibrary,inFavorites,submitter,images,personalBest,worldRecord");
         return SendAPIRequest(req, func, __FUNCTION__);
     }
     delete req;
@@ -142,8 +154,8 @@ bool CAPIRequests::GetMapByName(const char *pMapName, CallbackFunc func)
     APIRequest *req = new APIRequest;
     if (CreateAPIRequest(req, API_REQ("maps"), k_EHTTPMethodGET))
     {
-        SteamHTTP()->SetHTTPRequestGetOrPostParameter(req->handle, "search", pMapName);
-        SteamHTTP()->SetHTTPRequestGetOrPostParameter(req->handle, "limit", "1");
+        AddRequestParameter(req, "search", pMapName);
+        AddRequestParameter(req, "limit", "1");
         return SendAPIRequest(req, func, __FUNCTION__);
     }
     delete req;
@@ -166,8 +178,8 @@ bool CAPIRequests::GetUserMapLibrary(CallbackFunc func)
     APIRequest *req = new APIRequest;
     if (CreateAPIRequest(req, API_REQ("user/maps/library"), k_EHTTPMethodGET))
     {
-        SteamHTTP()->SetHTTPRequestGetOrPostParameter(req->handle, "expand", "info,thumbnail,inFavorites,personalBest,worldRecord");
-        SteamHTTP()->SetHTTPRequestGetOrPostParameter(req->handle, "limit", "0");
+        AddRequestParameter(req, "expand", "info,thumbnail,inFavorites,personalBest,worldRecord");
+        AddRequestParameter(req, "limit", "0");
 
         return SendAPIRequest(req, func, __FUNCTION__);
     }
@@ -191,8 +203,8 @@ bool CAPIRequests::GetUserMapFavorites(CallbackFunc func)
     APIRequest *req = new APIRequest;
     if (CreateAPIRequest(req, API_REQ("user/maps/favorites"), k_EHTTPMethodGET))
     {
-        SteamHTTP()->SetHTTPRequestGetOrPostParameter(req->handle, "limit", "0");
-        SteamHTTP()->SetHTTPRequestGetOrPostParameter(req->handle, "expand", "info,inLibrary,worldRecord,personalBest");
+        AddRequestParameter(req, "limit", "0");
+        AddRequestParameter(req, "expand", "info,inLibrary,worldRecord,personalBest");
 
         return SendAPIRequest(req, func, __FUNCTION__);
     }
@@ -275,13 +287,13 @@ bool CAPIRequests::GetUserStatsAndMapRank(uint64 profileID, uint32 mapID, Callba
     const auto pReqStr = profileID == 0 ? "user" : "users";
     if (CreateAPIRequest(req, API_REQ(pReqStr), k_EHTTPMethodGET))
     {
-        SteamHTTP()->SetHTTPRequestGetOrPostParameter(req->handle, "expand", "userStats");
+        AddRequestParameter(req, "expand", "userStats");
 
         if (profileID != 0)
-            SteamHTTP()->SetHTTPRequestGetOrPostParameter(req->handle, "playerID", CFmtStr("%llu", profileID).Get());
+            AddRequestParameter(req, "playerID", CFmtStr("%llu", profileID).Get());
 
         if (mapID != 0)
-            SteamHTTP()->SetHTTPRequestGetOrPostParameter(req->handle, "mapRank", CFmtStr("%u", mapID).Get());
+            AddRequestParameter(req, "mapRank", CFmtStr("%u", mapID).Get());
         
         return SendAPIRequest(req, func, __FUNCTION__);
     }
@@ -289,32 +301,84 @@ bool CAPIRequests::GetUserStatsAndMapRank(uint64 profileID, uint32 mapID, Callba
     return false;
 }
 
+DownloadRequest::~DownloadRequest()
+{
+    if (completeResult)
+        delete completeResult;
+
+    if (m_hPartFile != FILESYSTEM_INVALID_HANDLE)
+        g_pFullFileSystem->Close(m_hPartFile);
+
+    delete m_pHash;
+}
+
+// Feeds what's already in the part file into the hash, so the hash of a resumed download is of the whole file
+static bool HashPartFile(CryptoPP::SHA1 *pHash, const char *pFileName, const char *pPathID)
+{
+    const FileHandle_t hFile = g_pFullFileSystem->Open(pFileName, "rb", pPathID);
+    if (!hFile)
+        return false;
+
+    CUtlMemory<byte> chunk(0, FILE_HASH_CHUNK_SIZE);
+
+    int iRead;
+    while ((iRead = g_pFullFileSystem->Read(chunk.Base(), FILE_HASH_CHUNK_SIZE, hFile)) > 0)
+        pHash->Update(chunk.Base(), iRead);
+
+    g_pFullFileSystem->Close(hFile);
+    return true;
+}
+
 HTTPRequestHandle CAPIRequests::DownloadFile(const char* pszURL, CallbackFunc size, CallbackFunc prog, CallbackFunc end, 
-                                             const char *pFileName, const char *pFilePathID /* = "GAME"*/, bool bAuth /*= false*/)
+                                             const char *pFileName, const char *pFilePathID /* = "GAME"*/, bool bAuth /*= false*/,
+                                             const char *pExpectedHash /* = nullptr*/)
 {
     HTTPRequestHandle handle = INVALID_HTTPREQUEST_HANDLE;
     APIRequest *req = new APIRequest;
     if (CreateAPIRequest(req, pszURL, k_EHTTPMethodGET, bAuth))
     {
         handle = req->handle;
-        SteamAPICall_t apiHandle;
-        if (SteamHTTP()->SendHTTPRequestAndStreamResponse(handle, &apiHandle))
+
+        DownloadRequest *callback = new DownloadRequest();
+        callback->handle = handle;
+        callback->sizeFunc = size;
+        callback->progressFunc = prog;
+        callback->completeFunc = end;
+        if (pFileName == nullptr)
         {
-            DownloadRequest *callback = new DownloadRequest();
-            callback->handle = handle;
-            callback->sizeFunc = size;
-            callback->progressFunc = prog;
-            callback->completeFunc = end;
-            callback->m_dSentTime = Plat_FloatTime();
-            if (pFileName == nullptr)
+            callback->m_bSaveToFile = false;
+        }
+        else
+        {
+            V_FixupPathName(callback->m_szFileName, sizeof(callback->m_szFileName), pFileName);
+            Q_snprintf(callback->m_szPartFileName, sizeof(callback->m_szPartFileName), "%s.part", callback->m_szFileName);
+            Q_strncpy(callback->m_szFilePathID, pFilePathID, sizeof(callback->m_szFilePathID));
+            if (pExpectedHash)
+                Q_strncpy(callback->m_szExpectedHash, pExpectedHash, sizeof(callback->m_szExpectedHash));
+
+            callback->m_hPartFile = g_pFullFileSystem->Open(callback->m_szPartFileName, "ab", pFilePathID);
+            if (callback->m_hPartFile == FILESYSTEM_INVALID_HANDLE)
             {
-                callback->m_bSaveToFile = false;
+                Warning("%s --- Failed to open %s for writing!\n", __FUNCTION__, callback->m_szPartFileName);
+                SteamHTTP()->ReleaseHTTPRequest(handle);
+                delete callback;
+                delete req;
+                return INVALID_HTTPREQUEST_HANDLE;
             }
-            else
+
+            callback->m_pHash = new CryptoPP::SHA1;
+            callback->m_uResumeOffset = g_pFullFileSystem->Size(callback->m_hPartFile);
+            if (callback->m_uResumeOffset)
             {
-                V_FixupPathName(callback->m_szFileName, sizeof(callback->m_szFileName), pFileName);
-                Q_strncpy(callback->m_szFilePathID, pFilePathID, sizeof(callback->m_szFilePathID));
+                SteamHTTP()->SetHTTPRequestHeaderValue(handle, "Range", CFmtStr("bytes=%llu-", callback->m_uResumeOffset));
+                DevLog("Resuming download of %s from byte %llu\n", callback->m_szFileName, callback->m_uResumeOffset);
             }
+        }
+
+        SteamAPICall_t apiHandle;
+        if (SteamHTTP()->SendHTTPRequestAndStreamResponse(handle, &apiHandle))
+        {
+            callback->m_dSentTime = Plat_FloatTime();
             callback->completeResult = new CCallResult<CAPIRequests, HTTPRequestCompleted_t>();
             callback->completeResult->Set(apiHandle, this, &CAPIRequests::OnDownloadHTTPComplete);
             m_mapDownloadCalls.Insert(handle, callback);
@@ -324,6 +388,7 @@ HTTPRequestHandle CAPIRequests::DownloadFile(const char* pszURL, CallbackFunc si
             Warning("%s --- Failed to send HTTP request for downloading!\n", __FUNCTION__);
             SteamHTTP()->ReleaseHTTPRequest(handle); // GC
             handle = INVALID_HTTPREQUEST_HANDLE;
+            delete callback;
         }
     }
 
@@ -367,7 +432,10 @@ void CAPIRequests::Shutdown()
         delete[] m_pAPIKey;
     }
 
+    m_ResponseCache.Save();
+
     // This also cancels any outstanding API/download requests
+    m_dictInFlightCalls.RemoveAll();
     m_mapAPICalls.PurgeAndDeleteElements();
     m_mapDownloadCalls.PurgeAndDeleteElements();
 }
@@ -449,6 +517,25 @@ bool CAPIRequests::IsAuthenticated() const
     return m_pAPIKey != nullptr;
 }
 
+// Whether the response's Content-Range ("bytes <start>-<end>/<total>") picks up right where the part file left off
+static bool ResponseResumesAt(HTTPRequestHandle hRequest, uint64 uOffset)
+{
+    uint32 size;
+    char szRange[128];
+    if (!SteamHTTP()->GetHTTPResponseHeaderSize(hRequest, "Content-Range", &size) || !size || size >= sizeof(szRange))
+        return false;
+
+    if (!SteamHTTP()->GetHTTPResponseHeaderValue(hRequest, "Content-Range", reinterpret_cast<uint8 *>(szRange), size))
+        return false;
+    szRange[size] = '\0';
+
+    unsigned long long uStart, uEnd;
+    if (sscanf(szRange, "bytes %llu-%llu/", &uStart, &uEnd) != 2)
+        return false;
+
+    return uStart == uOffset && uEnd >= uStart;
+}
+
 void CAPIRequests::OnDownloadHTTPHeader(HTTPRequestHeadersReceived_t* pCallback)
 {
     const uint16 downloadCallbackIndx = m_mapDownloadCalls.Find(pCallback->m_hRequest);
@@ -467,12 +554,29 @@ void CAPIRequests::OnDownloadHTTPHeader(HTTPRequestHeadersReceived_t* pCallback)
 
                 if (fileSize)
                 {
+                    DownloadRequest *call = m_mapDownloadCalls[downloadCallbackIndx];
+                    if (call->m_uResumeOffset)
+                    {
+                        // No Content-Range means the server ignored the range and is sending the whole file, and a range
+                        // that doesn't start at the end of the part file can't be appended to it, so start over for both
+                        if (!ResponseResumesAt(pCallback->m_hRequest, call->m_uResumeOffset) ||
+                            !HashPartFile(call->m_pHash, call->m_szPartFileName, call->m_szFilePathID))
+                        {
+                            g_pFullFileSystem->Close(call->m_hPartFile);
+                            call->m_hPartFile = g_pFullFileSystem->Open(call->m_szPartFileName, "wb", call->m_szFilePathID);
+                            call->m_pHash->Restart();
+                            call->m_uResumeOffset = 0;
+                            call->m_bWriteFailed = call->m_hPartFile == FILESYSTEM_INVALID_HANDLE;
+                        }
+                    }
+
                     KeyValuesAD headers("Headers");
                     headers->SetUint64("request", pCallback->m_hRequest);
-                    headers->SetUint64("size", fileSize);
+                    // Content-Length of a resumed download is only what's left of the file
+                    headers->SetUint64("size", fileSize + call->m_uResumeOffset);
 
-                    DownloadRequest *call = m_mapDownloadCalls[downloadCallbackIndx];
-                    call->m_bufFileData.EnsureCapacity(fileSize);
+                    if (!call->m_bSaveToFile)
+                        call->m_bufFileData.EnsureCapacity(fileSize);
                     call->sizeFunc(headers);
                 }
             }
@@ -492,15 +596,28 @@ void CAPIRequests::OnDownloadHTTPData(HTTPRequestDataReceived_t* pCallback)
         if (SteamHTTP()->GetHTTPStreamingResponseBodyData(pCallback->m_hRequest, pCallback->m_cOffset, pDataTemp, pCallback->m_cBytesReceived))
         {
             DownloadRequest *call = m_mapDownloadCalls[downloadCallbackIndx];
-            // Add the data to the download buffer
-            call->m_bufFileData.Put(pDataTemp, pCallback->m_cBytesReceived);
+            if (call->m_bSaveToFile)
+            {
+                // Straight to disk, so only one chunk is ever held in memory
+                if (!call->m_bWriteFailed)
+                {
+                    call->m_pHash->Update(pDataTemp, pCallback->m_cBytesReceived);
+                    const int iWritten = g_pFullFileSystem->Write(pDataTemp, pCallback->m_cBytesReceived, call->m_hPartFile);
+                    call->m_bWriteFailed = iWritten != (int) pCallback->m_cBytesReceived;
+                }
+            }
+            else
+            {
+                // Add the data to the download buffer
+                call->m_bufFileData.Put(pDataTemp, pCallback->m_cBytesReceived);
+            }
 
             KeyValuesAD prog("Progress");
             prog->SetUint64("request", pCallback->m_hRequest);
             float percent = 0.0f;
             if (SteamHTTP()->GetHTTPDownloadProgressPct(pCallback->m_hRequest, &percent))
                 prog->SetFloat("percent", percent);
-            prog->SetInt("offset", pCallback->m_cOffset);
+            prog->SetInt("offset", pCallback->m_cOffset + call->m_uResumeOffset);
             prog->SetInt("size", pCallback->m_cBytesReceived);
             call->progressFunc(prog);
         }
@@ -517,19 +634,55 @@ void CAPIRequests::OnDownloadHTTPComplete(HTTPRequestCompleted_t* pCallback, boo
     {
         DownloadRequest *call = m_mapDownloadCalls[downloadCallbackIndx];
 
+        if (call->m_hPartFile != FILESYSTEM_INVALID_HANDLE)
+        {
+            g_pFullFileSystem->Close(call->m_hPartFile);
+            call->m_hPartFile = FILESYSTEM_INVALID_HANDLE;
+        }
+
+        const EHTTPStatusCode eExpectedCode = call->m_uResumeOffset ? k_EHTTPStatusCode206PartialContent : k_EHTTPStatusCode200OK;
+
         KeyValuesAD comp("Complete");
         comp->SetUint64("request", pCallback->m_hRequest);
         comp->SetFloat("duration", Plat_FloatTime() - call->m_dSentTime);
-        if (bIO || !pCallback->m_bRequestSuccessful || pCallback->m_eStatusCode != k_EHTTPStatusCode200OK)
+        if (bIO || !pCallback->m_bRequestSuccessful || pCallback->m_eStatusCode != eExpectedCode)
         {
             comp->SetBool("error", true);
             comp->SetInt("code", pCallback->m_eStatusCode);
             comp->SetBool("bIO", bIO);
+
+            // Keep what was downloaded if the connection just dropped, so the next try can resume
+            const bool bCancelled = bIO && pCallback->m_eStatusCode == k_EHTTPStatusCode410Gone;
+            if (call->m_bSaveToFile && (bCancelled || pCallback->m_bRequestSuccessful))
+                g_pFullFileSystem->RemoveFile(call->m_szPartFileName, call->m_szFilePathID);
         }
         else if (call->m_bSaveToFile)
         {
-            bool bWrote = g_pFullFileSystem->WriteFile(call->m_szFileName, call->m_szFilePathID, call->m_bufFileData);
-            comp->SetBool("error", !bWrote);
+            byte digest[CryptoPP::SHA1::DIGESTSIZE];
+            call->m_pHash->Final(digest);
+            char szHash[41];
+            V_binarytohex(digest, sizeof(digest), szHash, sizeof(szHash));
+            comp->SetString("hash", szHash);
+
+            const bool bBadHash = call->m_szExpectedHash[0] && Q_stricmp(call->m_szExpectedHash, szHash) != 0;
+            if (call->m_bWriteFailed || bBadHash)
+            {
+                if (bBadHash)
+                    Warning("Downloaded file %s does not match its hash, deleting it!\n", call->m_szFileName);
+
+                g_pFullFileSystem->RemoveFile(call->m_szPartFileName, call->m_szFilePathID);
+                comp->SetBool("error", true);
+                comp->SetBool("badhash", bBadHash);
+            }
+            else
+            {
+                g_pFullFileSystem->RemoveFile(call->m_szFileName, call->m_szFilePathID);
+                const bool bRenamed = g_pFullFileSystem->RenameFile(call->m_szPartFileName, call->m_szFileName, call->m_szFilePathID);
+                if (bRenamed)
+                    g_pFileHashCache->SetFileHash(call->m_szFileName, call->m_szFilePathID, szHash);
+
+                comp->SetBool("error", !bRenamed);
+            }
         }
         else
         {
@@ -543,6 +696,21 @@ void CAPIRequests::OnDownloadHTTPComplete(HTTPRequestCompleted_t* pCallback, boo
     SteamHTTP()->ReleaseHTTPRequest(pCallback->m_hRequest);
 }
 
+// Copies a response header into pOut, empty if the response doesn't have it
+static void GetResponseHeader(HTTPRequestHandle handle, const char *pName, char *pOut, uint32 outSize)
+{
+    pOut[0] = '\0';
+
+    uint32 size;
+    if (SteamHTTP()->GetHTTPResponseHeaderSize(handle, pName, &size) && size < outSize)
+    {
+        if (SteamHTTP()->GetHTTPResponseHeaderValue(handle, pName, reinterpret_cast<uint8 *>(pOut), size))
+            pOut[size] = '\0';
+        else
+            pOut[0] = '\0';
+    }
+}
+
 void CAPIRequests::OnHTTPResp(HTTPRequestCompleted_t* pCallback, bool bIOFailure)
 {
     // Firstly, let's find the callback that corresponds to the API request we made
@@ -552,31 +720,87 @@ void CAPIRequests::OnHTTPResp(HTTPRequestCompleted_t* pCallback, bool bIOFailure
         // Okay cool, callback found
         APIRequest *req = m_mapAPICalls[callbackIndx];
 
+        // Any identical request from now on has to be sent again
+        if (!req->m_strCacheKey.IsEmpty())
+        {
+            const auto inFlightIndx = m_dictInFlightCalls.Find(req->m_strCacheKey);
+            if (m_dictInFlightCalls.IsValidIndex(inFlightIndx) && m_dictInFlightCalls[inFlightIndx] == req)
+                m_dictInFlightCalls.RemoveAt(inFlightIndx);
+        }
+
+        // A 304 means the response we have cached is still the current one
+        const CAPIResponseCache::CachedResponse_t *pCached = nullptr;
+        if (!bIOFailure && pCallback->m_eStatusCode == k_EHTTPStatusCode304NotModified && !req->m_strCacheKey.IsEmpty())
+        {
+            pCached = m_ResponseCache.Find(req->m_strCacheKey);
+
+            // It was evicted while the request was in flight, so ask for the whole response instead
+            if (!pCached && !req->m_bUnconditional && ResendUnconditional(req))
+            {
+                m_mapAPICalls.RemoveAt(callbackIndx);
+                delete req;
+                return;
+            }
+        }
+
         // Let's create our main KeyValues object to operate on and properly clean it up out of this scope
         KeyValuesAD response(req->m_szCallingFunc);
         response->UsesEscapeSequences(true);
 
         // Secondly, let's set the code, method, URL, and ping of the response. Even if it's an IO error.
-        response->SetInt("code", pCallback->m_eStatusCode);
+        response->SetInt("code", pCached ? k_EHTTPStatusCode200OK : pCallback->m_eStatusCode);
+        response->SetBool("cached", pCached != nullptr);
         response->SetString("method", req->m_szMethod);
         response->SetString("URL", req->m_szURL);
         response->SetString("ping", CFmtStr("%.3f ms", (Plat_FloatTime() - req->m_dSentTime) * 1000.0f));
 
         // Thirdly, check if there are any errors
-        bool bRequestOK = CheckAPIResponse(pCallback, bIOFailure);
+        bool bRequestOK = pCached || CheckAPIResponse(pCallback, bIOFailure);
 
         // Fourthly, knowing if there's an error or not, create the proper data
         KeyValues *pKvBodyData = new KeyValues(bRequestOK ? "data" : "error");
-        if (pCallback->m_unBodySize > 0)
+        const uint32 bodySize = pCached ? pCached->m_bufBody.TellPut() : pCallback->m_unBodySize;
+        if (bodySize > 0)
         {
             // Fourthly-A, read the body properly
-            uint8 *pData = new uint8[pCallback->m_unBodySize + 1];
-            SteamHTTP()->GetHTTPResponseBodyData(pCallback->m_hRequest, pData, pCallback->m_unBodySize);
-            pData[pCallback->m_unBodySize] = 0; // Make sure to null terminate
+            uint8 *pData = new uint8[bodySize + 1];
+            if (pCached)
+            {
+                V_memcpy(pData, pCached->m_bufBody.Base(), bodySize);
+            }
+            else
+            {
+                SteamHTTP()->GetHTTPResponseBodyData(pCallback->m_hRequest, pData, bodySize);
+
+                // Cache it before it's parsed, parsing happens in place
+                if (bRequestOK && !req->m_strCacheKey.IsEmpty())
+                {
+                    char szETag[128], szLastModified[64];
+                    GetResponseHeader(pCallback->m_hRequest, "ETag", szETag, sizeof(szETag));
+                    GetResponseHeader(pCallback->m_hRequest, "Last-Modified", szLastModified, sizeof(szLastModified));
+                    if (szETag[0] || szLastModified[0])
+                        m_ResponseCache.Store(req->m_strCacheKey, szETag, szLastModified, pData, bodySize);
+                    else
+                        m_ResponseCache.Remove(req->m_strCacheKey);
+                }
+            }
+            pData[bodySize] = 0; // Make sure to null terminate
 
             // Fourthly-B, parse this JSON and convert to KeyValues
             char *pDataPtr = reinterpret_cast<char*>(pData);
-            if (!CJsonToKeyValues::ConvertJsonToKeyValues(pDataPtr, pKvBodyData))
+            bool bParsed;
+            if (bRequestOK && req->m_bReadMapList)
+            {
+                bParsed = CAPIJsonReader::ReadMapList(pDataPtr, req->m_eMapListSource, req->m_vecMaps, pKvBodyData);
+                if (bParsed)
+                    pKvBodyData->SetPtr("maps", &req->m_vecMaps);
+            }
+            else
+            {
+                bParsed = CJsonToKeyValues::ConvertJsonToKeyValues(pDataPtr, pKvBodyData);
+            }
+
+            if (!bParsed)
             {
                 pKvBodyData->SetName("error"); // Ensure it's passed as an error
                 Warning("Failed to parse! %s\n", pKvBodyData->GetString("err_parse"));
@@ -621,6 +845,8 @@ void CAPIRequests::OnHTTPResp(HTTPRequestCompleted_t* pCallback, bool bIOFailure
         // Sixthly, actually call the callback. It should be reading the body by using `pKvResponse->FindKey("data")`
         // or any errors by using `pKvResponse->FindKey("error")`
         req->callbackFunc(response);
+        FOR_EACH_VEC(req->m_vecCoalescedFuncs, i)
+            req->m_vecCoalescedFuncs[i](response);
 
         // And remove it from the map
         m_mapAPICalls.RemoveAt(callbackIndx);
@@ -653,6 +879,7 @@ bool CAPIRequests::CreateAPIRequest(APIRequest *request, const char* pszURL, EHT
     Q_strncpy(request->m_szURL, pszURL, sizeof(request->m_szURL));
     request->handle = SteamHTTP()->CreateHTTPRequest(kMethod, pszURL);
     request->m_bSensitive = bSensitive;
+    request->m_bAuth = bAuth;
 
     // Add the API key
     if (bAuth)
@@ -661,8 +888,80 @@ bool CAPIRequests::CreateAPIRequest(APIRequest *request, const char* pszURL, EHT
     return request->handle != INVALID_HTTPREQUEST_HANDLE;
 }
 
+void CAPIRequests::AddRequestParameter(APIRequest *request, const char *pName, const char *pValue)
+{
+    SteamHTTP()->SetHTTPRequestGetOrPostParameter(request->handle, pName, pValue);
+
+    request->m_strParams.Append(request->m_strParams.IsEmpty() ? "?" : "&");
+    request->m_strParams.Append(pName);
+    request->m_strParams.Append("=");
+    request->m_strParams.Append(pValue);
+
+    request->m_vecParams.AddToTail(pName);
+    request->m_vecParams.AddToTail(pValue);
+}
+
+void CAPIRequests::PrepareCachedRequest(APIRequest *request)
+{
+    if (!mom_api_cache_enable.GetBool() || request->m_bSensitive || !FStrEq(request->m_szMethod, "GET"))
+        return;
+
+    // Authorized responses can differ per user
+    const uint64 uScope = request->m_bAuth && SteamUser() ? SteamUser()->GetSteamID().ConvertToUint64() : 0;
+    request->m_strCacheKey.Format("%s %s%s|%llu", request->m_szMethod, request->m_szURL, request->m_strParams.Get(), uScope);
+
+    if (request->m_bUnconditional)
+        return;
+
+    const CAPIResponseCache::CachedResponse_t *pCached = m_ResponseCache.Find(request->m_strCacheKey);
+    if (pCached)
+    {
+        if (pCached->m_szETag[0])
+            SteamHTTP()->SetHTTPRequestHeaderValue(request->handle, "If-None-Match", pCached->m_szETag);
+        if (pCached->m_szLastModified[0])
+            SteamHTTP()->SetHTTPRequestHeaderValue(request->handle, "If-Modified-Since", pCached->m_szLastModified);
+    }
+}
+
+bool CAPIRequests::ResendUnconditional(APIRequest *request)
+{
+    APIRequest *req = new APIRequest;
+    if (!CreateAPIRequest(req, request->m_szURL, k_EHTTPMethodGET, request->m_bAuth, request->m_bSensitive))
+    {
+        delete req;
+        return false;
+    }
+
+    for (int i = 0; i + 1 < request->m_vecParams.Count(); i += 2)
+        AddRequestParameter(req, request->m_vecParams[i], request->m_vecParams[i + 1]);
+
+    req->m_bUnconditional = true;
+    req->m_bReadMapList = request->m_bReadMapList;
+    req->m_eMapListSource = request->m_eMapListSource;
+    req->m_vecCoalescedFuncs.AddVectorToTail(request->m_vecCoalescedFuncs);
+
+    return SendAPIRequest(req, request->callbackFunc, request->m_szCallingFunc);
+}
+
 bool CAPIRequests::SendAPIRequest(APIRequest *req, CallbackFunc func, const char* pCallingFunc, bool bPrioritize /*= false*/)
 {
+    PrepareCachedRequest(req);
+
+    // Map lists are handed over to the callback, so those can't be shared
+    const bool bCanCoalesce = !req->m_strCacheKey.IsEmpty() && !req->m_bReadMapList;
+    // A resent request already carries its own coalesced callbacks, it can't be folded into another one
+    if (bCanCoalesce && !req->m_bUnconditional)
+    {
+        const auto inFlightIndx = m_dictInFlightCalls.Find(req->m_strCacheKey);
+        if (m_dictInFlightCalls.IsValidIndex(inFlightIndx))
+        {
+            m_dictInFlightCalls[inFlightIndx]->m_vecCoalescedFuncs.AddToTail(func);
+            SteamHTTP()->ReleaseHTTPRequest(req->handle);
+            delete req;
+            return true;
+        }
+    }
+
     SteamAPICall_t apiHandle;
     if (SteamHTTP()->SendHTTPRequest(req->handle, &apiHandle))
     {
@@ -675,6 +974,8 @@ bool CAPIRequests::SendAPIRequest(APIRequest *req, CallbackFunc func, const char
         req->callResult = new CCallResult<CAPIRequests, HTTPRequestCompleted_t>();
         req->callResult->Set(apiHandle, this, &CAPIRequests::OnHTTPResp);
         m_mapAPICalls.Insert(req->handle, req);
+        if (bCanCoalesce)
+            m_dictInFlightCalls.Insert(req->m_strCacheKey, req);
         return true;
     }
 
@@ -1,14 +1,19 @@
 #pragma once
 
+#include "filesystem.h"
 #include "igamesystem.h"
 #include "steam/steam_api_common.h"
 #include "steam/isteamhttp.h"
 #include "steam/isteamuser.h"
 #include "utldelegate.h"
+#include "mom_api_models.h"
+#include "mom_api_response_cache.h"
+#include "utlstring.h"
 
 typedef CUtlDelegate<void (KeyValues *pKv)> CallbackFunc;
 
 class CAPIRequests;
+namespace CryptoPP { class SHA1; }
 
 struct APIRequest
 {
@@ -18,21 +23,42 @@ struct APIRequest
         m_szMethod[0] = '\0';
         m_szCallingFunc[0] = '\0';
         m_bSensitive = false;
+        m_bAuth = false;
         m_dSentTime = -1;
+        m_bReadMapList = false;
+        m_eMapListSource = MODEL_FROM_SEARCH_API_CALL;
+        m_bUnconditional = false;
     }
     ~APIRequest()
     {
         if (callResult)
             delete callResult; // Should call cancel if still in progress
+
+        m_vecMaps.PurgeAndDeleteElements();
     }
     char m_szCallingFunc[256];
     char m_szURL[256];
     char m_szMethod[12];
     bool m_bSensitive;
+    bool m_bAuth;
     double m_dSentTime;
     HTTPRequestHandle handle;
     CallbackFunc callbackFunc;
+    // The GET parameters of the request, as a query string, since they're part of the cache key
+    CUtlString m_strParams;
+    // The same parameters as name/value pairs, to send the request again
+    CUtlVector<CUtlString> m_vecParams;
+    // Set if the response can be cached, see CAPIResponseCache
+    CUtlString m_strCacheKey;
+    // Sent without the conditional headers, because the cached response they were for is gone
+    bool m_bUnconditional;
+    // Identical requests made while this one was in flight, they get the same response
+    CUtlVector<CallbackFunc> m_vecCoalescedFuncs;
     CCallResult<CAPIRequests, HTTPRequestCompleted_t> *callResult;
+    // Map list responses are read straight into MapData instead of KeyValues, see CAPIJsonReader
+    bool m_bReadMapList;
+    APIModelSource m_eMapListSource;
+    CUtlVector<MapData *> m_vecMaps;
     bool operator==(const APIRequest &other) const
     {
         return handle == other.handle;
@@ -41,18 +67,18 @@ struct APIRequest
 
 struct DownloadRequest
 {
-    DownloadRequest() : handle(INVALID_HTTPREQUEST_HANDLE), completeResult(nullptr), m_bSaveToFile(true)
+    DownloadRequest() : handle(INVALID_HTTPREQUEST_HANDLE), completeResult(nullptr), m_bSaveToFile(true),
+        m_hPartFile(FILESYSTEM_INVALID_HANDLE), m_pHash(nullptr), m_uResumeOffset(0), m_bWriteFailed(false)
     {
         m_szFileName[0] = '\0';
+        m_szPartFileName[0] = '\0';
         m_szFilePathID[0] = '\0';
         m_szURL[0] = '\0';
+        m_szExpectedHash[0] = '\0';
     }
 
-    ~DownloadRequest()
-    {
-        if (completeResult)
-            delete completeResult;
-    }
+    // Closes the partial file if it's still open, it is kept on disk so the download can be resumed
+    ~DownloadRequest();
     HTTPRequestHandle handle;
     CCallResult<CAPIRequests, HTTPRequestCompleted_t> *completeResult;
 
@@ -75,15 +101,28 @@ struct DownloadRequest
     //  "code"      (int)       The HTTP status code of the request if it failed, otherwise 0
     //  "duration"  (float)     The amount of time in seconds it took to download the file
     //  "buf"       (pointer)   If the request was created with a nullptr filename, a pointer to the buffer is passed here
+    //  "hash"      (string)    If the request was saved to a file, the SHA1 of the file
+    //  "badhash"   (bool)      If the file did not match the expected hash, it is deleted and "error" is true
     CallbackFunc completeFunc;
 
     char m_szURL[256];
     char m_szFileName[MAX_PATH];
+    char m_szPartFileName[MAX_PATH];
     char m_szFilePathID[16];
+    char m_szExpectedHash[41];
     bool m_bSaveToFile;
     double m_dSentTime;
+    // Only used when not saving to a file, files are written to the part file as the data arrives
     CUtlBuffer m_bufFileData;
 
+    // The file being written to, renamed to m_szFileName once the download completes
+    FileHandle_t m_hPartFile;
+    // SHA1 of everything written so far, including what was resumed from
+    CryptoPP::SHA1 *m_pHash;
+    // How much of the file was already downloaded by an earlier request
+    uint64 m_uResumeOffset;
+    bool m_bWriteFailed;
+
     bool operator==(const DownloadRequest &other) const
     {
         return handle == other.handle;
@@ -109,6 +148,10 @@ public:
     //      "error"             An error object, parsed JSON represented as KeyValues
     //          "err_parse"     If any parsing issue happens with JSON, it will be logged here as a string, inside error
     //
+    // Requests that return map lists (GetMaps) don't convert the maps to KeyValues. Their "data" has the other values
+    // of the response, and "maps" as a pointer to a CUtlVector<MapData*>. Whoever keeps maps has to remove them from
+    // the vector, the rest are deleted after the callback.
+    //
     // All API requests return `true` if the call succeeded in sending, else `false`.
 
     // ==== Auth ====
@@ -163,10 +206,16 @@ public:
      *                      end CallbackFunc, fetched by `->GetPtr("buf");`, and will not be saved to disk.
      * @param pFilePathID   (Optional) The pathID of where the file should be stored. Defaults to "GAME".
      * @param bAuth         (Optional) Whether this request should be authenticated. Defaults to false.
+     * @param pExpectedHash (Optional) The SHA1 the file should have. If it doesn't match, the file is deleted
+     *                      and the download fails.
      * @return The handle of the request, will be an invalid handle if the request fails
+     *
+     * Files are written to "<pFileName>.part" as the data comes in, and renamed once complete. If a part file is
+     * already there from an earlier download, only the rest of the file is requested.
      */
     HTTPRequestHandle DownloadFile(const char *pszURL, CallbackFunc size, CallbackFunc prog, CallbackFunc end,
-                                   const char *pFileName, const char *pFilePathID = "GAME", bool bAuth = false);
+                                   const char *pFileName, const char *pFilePathID = "GAME", bool bAuth = false,
+                                   const char *pExpectedHash = nullptr);
 
     /**
      * @param handle    The handle of the request to cancel
@@ -198,9 +247,18 @@ private:
     bool SendAPIRequest(APIRequest *request, CallbackFunc func, const char *pCallingFunction, bool bPrioritize = false);
     // Check the response for errors
     bool CheckAPIResponse(HTTPRequestCompleted_t *pCallback, bool bIOFailure);
+    // Sets a GET/POST parameter on the request, use this instead of calling SteamHTTP directly
+    void AddRequestParameter(APIRequest *request, const char *pName, const char *pValue);
+    // Sets the cache key of GET requests, and the conditional headers if there is a cached response for it
+    void PrepareCachedRequest(APIRequest *request);
+    // Sends a request that got a 304 for a response that was evicted since again, without the conditional headers
+    bool ResendUnconditional(APIRequest *request);
 
     CUtlMap<HTTPRequestHandle, APIRequest*> m_mapAPICalls;
     CUtlMap<HTTPRequestHandle, DownloadRequest*> m_mapDownloadCalls;
+    // In flight GET requests by cache key, for coalescing identical requests
+    CUtlDict<APIRequest*> m_dictInFlightCalls;
+    CAPIResponseCache m_ResponseCache;
 
     // Auth ticket impl
     HAuthTicket m_hAuthTicket;
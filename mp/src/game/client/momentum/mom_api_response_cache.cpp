@@ -0,0 +1,154 @@
+#include "cbase.h"
+
+#include <ctime>
+
+#include "filesystem.h"
+#include "mom_api_response_cache.h"
+
+#include "tier0/memdbgon.h"
+
+CAPIResponseCache::CAPIResponseCache() : m_bLoaded(false), m_bDirty(false),
+    m_dictResponses(k_eDictCompareTypeCaseSensitive)
+{
+}
+
+CAPIResponseCache::~CAPIResponseCache()
+{
+    m_dictResponses.PurgeAndDeleteElements();
+}
+
+CAPIResponseCache::CachedResponse_t *CAPIResponseCache::Find(const char *pKey)
+{
+    Load();
+
+    const auto index = m_dictResponses.Find(pKey);
+    if (!m_dictResponses.IsValidIndex(index))
+        return nullptr;
+
+    CachedResponse_t *pResponse = m_dictResponses[index];
+    // Not worth rewriting the whole cache for, the new time goes out with the next store or eviction
+    pResponse->m_iLastUsed = time(nullptr);
+    return pResponse;
+}
+
+void CAPIResponseCache::Store(const char *pKey, const char *pETag, const char *pLastModified, const uint8 *pBody, uint32 bodySize)
+{
+    Load();
+
+    if (bodySize > API_RESPONSE_CACHE_MAX_BODY_SIZE)
+    {
+        Remove(pKey);
+        return;
+    }
+
+    auto index = m_dictResponses.Find(pKey);
+    if (!m_dictResponses.IsValidIndex(index))
+    {
+        if (m_dictResponses.Count() >= API_RESPONSE_CACHE_MAX_ENTRIES)
+            RemoveLeastRecentlyUsed();
+
+        index = m_dictResponses.Insert(pKey, new CachedResponse_t);
+    }
+
+    CachedResponse_t *pResponse = m_dictResponses[index];
+    Q_strncpy(pResponse->m_szETag, pETag, sizeof(pResponse->m_szETag));
+    Q_strncpy(pResponse->m_szLastModified, pLastModified, sizeof(pResponse->m_szLastModified));
+    pResponse->m_iLastUsed = time(nullptr);
+    pResponse->m_bufBody.Purge();
+    pResponse->m_bufBody.Put(pBody, bodySize);
+
+    m_bDirty = true;
+}
+
+void CAPIResponseCache::Remove(const char *pKey)
+{
+    const auto index = m_dictResponses.Find(pKey);
+    if (m_dictResponses.IsValidIndex(index))
+    {
+        delete m_dictResponses[index];
+        m_dictResponses.RemoveAt(index);
+        m_bDirty = true;
+    }
+}
+
+void CAPIResponseCache::RemoveLeastRecentlyUsed()
+{
+    auto oldest = m_dictResponses.InvalidIndex();
+    FOR_EACH_DICT_FAST(m_dictResponses, i)
+    {
+        if (!m_dictResponses.IsValidIndex(oldest) || m_dictResponses[i]->m_iLastUsed < m_dictResponses[oldest]->m_iLastUsed)
+            oldest = i;
+    }
+
+    if (m_dictResponses.IsValidIndex(oldest))
+    {
+        delete m_dictResponses[oldest];
+        m_dictResponses.RemoveAt(oldest);
+        m_bDirty = true;
+    }
+}
+
+void CAPIResponseCache::Load()
+{
+    if (m_bLoaded)
+        return;
+
+    m_bLoaded = true;
+
+    CUtlBuffer buf;
+    if (!g_pFullFileSystem->ReadFile(API_RESPONSE_CACHE_FILE, "MOD", buf))
+        return;
+
+    if (buf.GetUnsignedInt() != API_RESPONSE_CACHE_MAGIC || buf.GetUnsignedChar() != API_RESPONSE_CACHE_VERSION)
+        return;
+
+    const int iCount = buf.GetInt();
+    for (int i = 0; i < iCount && buf.IsValid(); i++)
+    {
+        char szKey[1024];
+        CachedResponse_t *pResponse = new CachedResponse_t;
+        buf.GetStringManualCharCount(szKey, sizeof(szKey));
+        buf.GetStringManualCharCount(pResponse->m_szETag, sizeof(pResponse->m_szETag));
+        buf.GetStringManualCharCount(pResponse->m_szLastModified, sizeof(pResponse->m_szLastModified));
+        pResponse->m_iLastUsed = buf.GetInt64();
+
+        const int iBodySize = buf.GetInt();
+        if (!buf.IsValid() || iBodySize < 0 || iBodySize > buf.GetBytesRemaining())
+        {
+            delete pResponse;
+            break;
+        }
+
+        pResponse->m_bufBody.Put(buf.PeekGet(), iBodySize);
+        buf.SeekGet(CUtlBuffer::SEEK_CURRENT, iBodySize);
+
+        m_dictResponses.Insert(szKey, pResponse);
+    }
+}
+
+void CAPIResponseCache::Save()
+{
+    if (!m_bDirty)
+        return;
+
+    CUtlBuffer buf;
+    buf.PutUnsignedInt(API_RESPONSE_CACHE_MAGIC);
+    buf.PutUnsignedChar(API_RESPONSE_CACHE_VERSION);
+    buf.PutInt(m_dictResponses.Count());
+    FOR_EACH_DICT_FAST(m_dictResponses, i)
+    {
+        const CachedResponse_t *pResponse = m_dictResponses[i];
+        buf.PutString(m_dictResponses.GetElementName(i));
+        buf.PutString(pResponse->m_szETag);
+        buf.PutString(pResponse->m_szLastModified);
+        buf.PutInt64(pResponse->m_iLastUsed);
+        buf.PutInt(pResponse->m_bufBody.TellPut());
+        buf.Put(pResponse->m_bufBody.Base(), pResponse->m_bufBody.TellPut());
+    }
+
+    g_pFullFileSystem->CreateDirHierarchy("cache", "MOD");
+    if (g_pFullFileSystem->WriteFile(API_RESPONSE_CACHE_FILE, "MOD", buf))
+        m_bDirty = false;
+    else
+        Warning("Failed to write the API response cache %s!\n", API_RESPONSE_CACHE_FILE);
+}
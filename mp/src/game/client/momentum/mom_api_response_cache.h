@@ -0,0 +1,46 @@
+#pragma once
+
+#include "utlbuffer.h"
+#include "utldict.h"
+
+#define API_RESPONSE_CACHE_FILE "cache/api_responses.dat"
+#define API_RESPONSE_CACHE_MAGIC 0x43495041 // "APIC"
+#define API_RESPONSE_CACHE_VERSION 1
+
+// Most entries kept, the least recently used ones are dropped past this
+#define API_RESPONSE_CACHE_MAX_ENTRIES 256
+// Bigger responses are not cached
+#define API_RESPONSE_CACHE_MAX_BODY_SIZE (1024 * 1024)
+
+// Bodies of API GET responses that came with an ETag or Last-Modified header, keyed by the
+// method, URL, parameters and auth scope of the request. They are only ever used after the API
+// confirms them with a 304 to a conditional request, so they can't go stale.
+class CAPIResponseCache
+{
+  public:
+    CAPIResponseCache();
+    ~CAPIResponseCache();
+
+    struct CachedResponse_t
+    {
+        char m_szETag[128];
+        char m_szLastModified[64];
+        int64 m_iLastUsed;
+        CUtlBuffer m_bufBody;
+    };
+
+    // nullptr if the request was never cached
+    CachedResponse_t *Find(const char *pKey);
+    void Store(const char *pKey, const char *pETag, const char *pLastModified, const uint8 *pBody, uint32 bodySize);
+    void Remove(const char *pKey);
+
+    void Save();
+
+  private:
+    void Load();
+    void RemoveLeastRecentlyUsed();
+
+    bool m_bLoaded;
+    bool m_bDirty;
+    CUtlDict<CachedResponse_t *> m_dictResponses;
+};
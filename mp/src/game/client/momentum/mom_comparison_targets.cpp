@@ -0,0 +1,339 @@
+#include "cbase.h"
+
+#include "mom_comparison_targets.h"
+
+#include "filesystem.h"
+#include "fmtstr.h"
+#include "mom_api_requests.h"
+#include "mom_map_cache.h"
+#include "mom_shareddefs.h"
+#include "run/mom_replay_base.h"
+#include "run/mom_replay_factory.h"
+#include "util/mom_util.h"
+#include "vstdlib/jobthread.h"
+
+#include "tier0/memdbgon.h"
+
+static CComparisonTargets s_ComparisonTargets;
+CComparisonTargets *g_pComparisonTargets = &s_ComparisonTargets;
+
+CComparisonTargets::CComparisonTargets() : CAutoGameSystemPerFrame("CComparisonTargets"), m_iVersion(0)
+{
+    SetDefLessFunc(m_mapDownloads);
+
+    for (int i = 0; i < COMPARISON_TARGET_COUNT; i++)
+    {
+        Target_t &target = m_Targets[i];
+        target.m_szMapName[0] = '\0';
+        target.m_iTrack = 0;
+        target.m_flTickRate = 0.0f;
+        target.m_iFlags = 0;
+        target.m_eState = TARGET_STATE_NONE;
+        target.m_iGeneration = 0;
+        target.m_iTimesGeneration = -1;
+        target.m_pResult = nullptr;
+    }
+}
+
+void CComparisonTargets::Shutdown()
+{
+    // The API is already gone by now, so downloads are just forgotten instead of cancelled
+    FOR_EACH_MAP_FAST(m_mapDownloads, i)
+        delete m_mapDownloads[i];
+    m_mapDownloads.RemoveAll();
+
+    CancelAll();
+}
+
+void CComparisonTargets::LevelShutdownPostEntity()
+{
+    CancelAll();
+}
+
+void CComparisonTargets::Update(float frametime)
+{
+    FOR_EACH_VEC_BACK(m_vecLoads, i)
+    {
+        const LoadJob_t *pLoad = m_vecLoads[i];
+        if (!pLoad->m_pJob || pLoad->m_pJob->IsFinished())
+            FinishLoad(i);
+    }
+}
+
+void CComparisonTargets::Request(ComparisonTarget_t target, const char *pMapName, int track, float tickRate, int flags)
+{
+    Target_t &t = m_Targets[target];
+    if (t.m_eState != TARGET_STATE_NONE && FStrEq(t.m_szMapName, pMapName) && t.m_iTrack == track &&
+        CloseEnough(t.m_flTickRate, tickRate) && t.m_iFlags == flags)
+        return;
+
+    Q_strncpy(t.m_szMapName, pMapName, sizeof(t.m_szMapName));
+    t.m_iTrack = track;
+    t.m_flTickRate = tickRate;
+    t.m_iFlags = flags;
+
+    t.m_iGeneration++;
+    delete t.m_pResult;
+    t.m_pResult = nullptr;
+    t.m_eState = TARGET_STATE_LOADING;
+
+    StartRequest(target);
+}
+
+void CComparisonTargets::Invalidate(ComparisonTarget_t target)
+{
+    Target_t &t = m_Targets[target];
+    t.m_iGeneration++;
+    delete t.m_pResult;
+    t.m_pResult = nullptr;
+    t.m_eState = TARGET_STATE_NONE;
+}
+
+void CComparisonTargets::StartRequest(ComparisonTarget_t target)
+{
+    Target_t &t = m_Targets[target];
+
+    if (target == COMPARISON_TARGET_PB)
+    {
+        // MOM_TODO: this may not be a PB, for now it is, but we'll load times from online.
+        LoadJob_t *pLoad = CreateLoadJob(target, "Personal Best", nullptr);
+
+        // The filesystem's find handles aren't safe to use next to the main thread's, so only the loading is threaded
+        MomUtil::FindReplayFiles(t.m_szMapName, pLoad->m_vecPBPaths);
+        QueueLoad(pLoad);
+        return;
+    }
+
+    const uint32 mapID = g_pMapCache->GetCurrentMapID();
+    if (!mapID)
+    {
+        SetUnavailable(target, t.m_iGeneration);
+        return;
+    }
+
+    // Already waiting on the leaderboards, the callback asks again for the new category
+    if (t.m_iTimesGeneration != -1)
+        return;
+
+    KeyValuesAD pFilters("Filters");
+    pFilters->SetInt("trackNum", t.m_iTrack);
+    pFilters->SetInt("flags", t.m_iFlags);
+
+    bool bSent;
+    if (target == COMPARISON_TARGET_WR)
+        bSent = g_pAPIRequests->GetTop10MapTimes(mapID, UtlMakeDelegate(this, &CComparisonTargets::OnTop10TimesCallback), pFilters);
+    else
+        bSent = g_pAPIRequests->GetFriendsTimes(mapID, UtlMakeDelegate(this, &CComparisonTargets::OnFriendsTimesCallback), pFilters);
+
+    if (bSent)
+        t.m_iTimesGeneration = t.m_iGeneration;
+    else
+        SetUnavailable(target, t.m_iGeneration);
+}
+
+bool CComparisonTargets::IsCurrent(ComparisonTarget_t target, int generation) const
+{
+    return m_Targets[target].m_iGeneration == generation && m_Targets[target].m_eState == TARGET_STATE_LOADING;
+}
+
+void CComparisonTargets::SetUnavailable(ComparisonTarget_t target, int generation)
+{
+    if (!IsCurrent(target, generation))
+        return;
+
+    m_Targets[target].m_eState = TARGET_STATE_UNAVAILABLE;
+    m_iVersion++;
+}
+
+CComparisonTargets::LoadJob_t *CComparisonTargets::CreateLoadJob(ComparisonTarget_t target, const char *pRunName, const char *pReplayPath)
+{
+    LoadJob_t *pLoad = new LoadJob_t;
+    pLoad->m_eTarget = target;
+    pLoad->m_iGeneration = m_Targets[target].m_iGeneration;
+    pLoad->m_Category = m_Targets[target];
+    pLoad->m_Category.m_pResult = nullptr;
+    Q_strncpy(pLoad->m_szReplayPath, pReplayPath ? pReplayPath : "", sizeof(pLoad->m_szReplayPath));
+    Q_strncpy(pLoad->m_szRunName, pRunName, sizeof(pLoad->m_szRunName));
+    pLoad->m_pResult = nullptr;
+    pLoad->m_pJob = nullptr;
+    return pLoad;
+}
+
+void CComparisonTargets::QueueLoad(LoadJob_t *pLoad)
+{
+    if (g_pThreadPool && g_pThreadPool->NumThreads() > 0)
+        pLoad->m_pJob = g_pThreadPool->QueueCall(this, &CComparisonTargets::RunLoadJob, pLoad);
+    else
+        RunLoadJob(pLoad);
+
+    m_vecLoads.AddToTail(pLoad);
+}
+
+// Runs on a worker thread, only touches its own job
+void CComparisonTargets::RunLoadJob(LoadJob_t *pLoad)
+{
+    const Target_t &category = pLoad->m_Category;
+
+    CMomReplayBase *pReplay;
+    if (pLoad->m_szReplayPath[0])
+        pReplay = g_ReplayFactory.LoadReplayFile(pLoad->m_szReplayPath, false);
+    else
+        pReplay = MomUtil::GetBestTime(pLoad->m_vecPBPaths, category.m_flTickRate, category.m_iTrack, category.m_iFlags);
+
+    if (!pReplay)
+        return;
+
+    // Online runs come from the leaderboards of the category, but make sure the replay actually is one
+    if (pReplay->GetRunFlags() == static_cast<uint32>(category.m_iFlags) && pReplay->GetTrackNumber() == category.m_iTrack &&
+        CloseEnough(category.m_flTickRate, pReplay->GetTickInterval(), FLT_EPSILON))
+    {
+        pLoad->m_pResult = new RunCompare_t();
+        MomUtil::FillRunComparison(pLoad->m_szRunName, pReplay->GetRunStats(), pLoad->m_pResult);
+    }
+
+    delete pReplay;
+}
+
+void CComparisonTargets::FinishLoad(int index)
+{
+    LoadJob_t *pLoad = m_vecLoads[index];
+    if (pLoad->m_pJob)
+        pLoad->m_pJob->WaitForFinishAndRelease();
+
+    m_vecLoads.Remove(index);
+
+    if (IsCurrent(pLoad->m_eTarget, pLoad->m_iGeneration))
+    {
+        Target_t &t = m_Targets[pLoad->m_eTarget];
+        t.m_pResult = pLoad->m_pResult;
+        t.m_eState = pLoad->m_pResult ? TARGET_STATE_LOADED : TARGET_STATE_UNAVAILABLE;
+        m_iVersion++;
+
+        if (pLoad->m_pResult)
+            DevLog("Loaded run comparisons for %s !\n", pLoad->m_szRunName);
+    }
+    else
+    {
+        delete pLoad->m_pResult;
+    }
+
+    delete pLoad;
+}
+
+void CComparisonTargets::CancelAll()
+{
+    for (int i = 0; i < COMPARISON_TARGET_COUNT; i++)
+        Invalidate(static_cast<ComparisonTarget_t>(i));
+
+    // Cancelling calls OnReplayDownloadEnd, which cleans up the now stale downloads
+    CUtlVector<HTTPRequestHandle> vecHandles;
+    FOR_EACH_MAP_FAST(m_mapDownloads, i)
+        vecHandles.AddToTail(m_mapDownloads.Key(i));
+    FOR_EACH_VEC(vecHandles, i)
+        g_pAPIRequests->CancelDownload(vecHandles[i]);
+
+    FOR_EACH_MAP_FAST(m_mapDownloads, i)
+        delete m_mapDownloads[i];
+    m_mapDownloads.RemoveAll();
+
+    FOR_EACH_VEC_BACK(m_vecLoads, i)
+        FinishLoad(i);
+}
+
+void CComparisonTargets::OnTop10TimesCallback(KeyValues *pKv)
+{
+    OnTimes(COMPARISON_TARGET_WR, pKv);
+}
+
+void CComparisonTargets::OnFriendsTimesCallback(KeyValues *pKv)
+{
+    OnTimes(COMPARISON_TARGET_FRIEND, pKv);
+}
+
+void CComparisonTargets::OnTimes(ComparisonTarget_t target, KeyValues *pKv)
+{
+    Target_t &t = m_Targets[target];
+    const int generation = t.m_iTimesGeneration;
+    t.m_iTimesGeneration = -1;
+
+    if (generation != t.m_iGeneration)
+    {
+        // The category changed while the request was out
+        if (t.m_eState == TARGET_STATE_LOADING)
+            StartRequest(target);
+        return;
+    }
+
+    KeyValues *pData = pKv->FindKey("data");
+    KeyValues *pRanks = pData ? pData->FindKey("ranks") : nullptr;
+    if (!pRanks)
+    {
+        SetUnavailable(target, generation);
+        return;
+    }
+
+    const uint64 localSteamID = SteamUser() ? SteamUser()->GetSteamID().ConvertToUint64() : 0;
+
+    // Ranks come sorted, so the first usable one is the fastest
+    FOR_EACH_SUBKEY(pRanks, pRank)
+    {
+        KeyValues *pRun = pRank->FindKey("run");
+        KeyValues *pUser = pRank->FindKey("user");
+        if (!pRun || !pUser)
+            continue;
+
+        if (target == COMPARISON_TARGET_FRIEND && pUser->GetUint64("steamID") == localSteamID)
+            continue;
+
+        const uint64 runID = pRun->GetUint64("id");
+        const char *pHash = pRun->GetString("hash");
+        CFmtStr replayPath("%s/%s/%s-%lld%s", RECORDING_PATH, RECORDING_ONLINE_PATH, t.m_szMapName, runID, EXT_RECORDING_FILE);
+
+        LoadJob_t *pLoad = CreateLoadJob(target, target == COMPARISON_TARGET_WR ? "World Record" : pUser->GetString("alias"), replayPath.Get());
+
+        if (MomUtil::FileExists(replayPath.Get(), pHash, "MOD"))
+        {
+            QueueLoad(pLoad);
+            return;
+        }
+
+        const HTTPRequestHandle handle = g_pAPIRequests->DownloadFile(pRun->GetString("file"),
+                                                                      UtlMakeDelegate(this, &CComparisonTargets::OnReplayDownloadSize),
+                                                                      UtlMakeDelegate(this, &CComparisonTargets::OnReplayDownloadProgress),
+                                                                      UtlMakeDelegate(this, &CComparisonTargets::OnReplayDownloadEnd),
+                                                                      replayPath.Get(), "MOD", true, pHash);
+        if (handle != INVALID_HTTPREQUEST_HANDLE)
+        {
+            m_mapDownloads.Insert(handle, pLoad);
+            return;
+        }
+
+        Warning("Failed to try to download the replay %lld to compare against!\n", runID);
+        delete pLoad;
+        break;
+    }
+
+    SetUnavailable(target, generation);
+}
+
+void CComparisonTargets::OnReplayDownloadEnd(KeyValues *pKv)
+{
+    const auto index = m_mapDownloads.Find(pKv->GetUint64("request"));
+    if (!m_mapDownloads.IsValidIndex(index))
+        return;
+
+    LoadJob_t *pLoad = m_mapDownloads[index];
+    m_mapDownloads.RemoveAt(index);
+
+    if (pKv->GetBool("error") || !IsCurrent(pLoad->m_eTarget, pLoad->m_iGeneration))
+    {
+        if (pKv->GetBool("error") && IsCurrent(pLoad->m_eTarget, pLoad->m_iGeneration))
+            Warning("Could not download the replay to compare against! Error code: %i\n", pKv->GetInt("code"));
+
+        SetUnavailable(pLoad->m_eTarget, pLoad->m_iGeneration);
+        delete pLoad;
+        return;
+    }
+
+    QueueLoad(pLoad);
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "igamesystem.h"
+#include "steam/isteamhttp.h"
+#include "utlmap.h"
+#include "run/run_compare.h"
+
+class CJob;
+
+enum ComparisonTarget_t
+{
+    COMPARISON_TARGET_PB = 0, // Fastest local replay
+    COMPARISON_TARGET_WR,     // Rank 1 on the online leaderboards
+    COMPARISON_TARGET_FRIEND, // Fastest friend on the online leaderboards
+
+    COMPARISON_TARGET_COUNT
+};
+
+enum ComparisonTargetState_t
+{
+    TARGET_STATE_NONE = 0,
+    TARGET_STATE_LOADING,
+    TARGET_STATE_LOADED,
+    TARGET_STATE_UNAVAILABLE, // No run of the category to compare against
+};
+
+// Resolves the runs the comparisons panel compares against. Looking for the PB scans every local replay and
+// the WR/friend runs need a leaderboard request and a replay download, so all of it happens in the
+// background (web requests and the thread pool) and the results are picked up on the main thread.
+class CComparisonTargets : public CAutoGameSystemPerFrame
+{
+  public:
+    CComparisonTargets();
+
+    void Shutdown() OVERRIDE;
+    void LevelShutdownPostEntity() OVERRIDE;
+    void Update(float frametime) OVERRIDE;
+
+    // Starts resolving the target for the run category, if it isn't already resolved or resolving for it
+    void Request(ComparisonTarget_t target, const char *pMapName, int track, float tickRate, int flags);
+    // Makes the next Request resolve the target again, like when a new PB was just saved
+    void Invalidate(ComparisonTarget_t target);
+
+    ComparisonTargetState_t GetState(ComparisonTarget_t target) const { return m_Targets[target].m_eState; }
+    // Null unless the target is loaded
+    RunCompare_t *GetResult(ComparisonTarget_t target) const { return m_Targets[target].m_pResult; }
+
+    // Bumped every time a target finishes resolving, loaded or not
+    int GetVersion() const { return m_iVersion; }
+
+  private:
+    struct Target_t
+    {
+        char m_szMapName[MAX_PATH];
+        int m_iTrack;
+        float m_flTickRate;
+        int m_iFlags;
+
+        ComparisonTargetState_t m_eState;
+        int m_iGeneration;      // Bumped by every new request, anything still in flight for older ones is dropped
+        int m_iTimesGeneration; // Generation the leaderboard request in flight was sent for, -1 if there is none
+        RunCompare_t *m_pResult;
+    };
+
+    struct LoadJob_t
+    {
+        ComparisonTarget_t m_eTarget;
+        int m_iGeneration;
+        Target_t m_Category;
+
+        char m_szReplayPath[MAX_PATH]; // Empty for the PB, which picks the fastest of m_vecPBPaths instead
+        CUtlStringList m_vecPBPaths;   // Local replays of the map, found on the main thread
+        char m_szRunName[32];
+
+        RunCompare_t *m_pResult; // Null if no replay of the category was found
+        CJob *m_pJob;
+    };
+
+    void StartRequest(ComparisonTarget_t target);
+    void SetUnavailable(ComparisonTarget_t target, int generation);
+    bool IsCurrent(ComparisonTarget_t target, int generation) const;
+
+    LoadJob_t *CreateLoadJob(ComparisonTarget_t target, const char *pRunName, const char *pReplayPath);
+    void QueueLoad(LoadJob_t *pLoad);
+    void RunLoadJob(LoadJob_t *pLoad);
+    void FinishLoad(int index);
+    void CancelAll();
+
+    void OnTop10TimesCallback(KeyValues *pKv);
+    void OnFriendsTimesCallback(KeyValues *pKv);
+    void OnTimes(ComparisonTarget_t target, KeyValues *pKv);
+
+    void OnReplayDownloadSize(KeyValues *pKv) {}
+    void OnReplayDownloadProgress(KeyValues *pKv) {}
+    void OnReplayDownloadEnd(KeyValues *pKv);
+
+    Target_t m_Targets[COMPARISON_TARGET_COUNT];
+    CUtlVector<LoadJob_t *> m_vecLoads;
+    CUtlMap<HTTPRequestHandle, LoadJob_t *> m_mapDownloads;
+    int m_iVersion;
+};
+
+extern CComparisonTargets *g_pComparisonTargets;
@@ -0,0 +1,152 @@
+#include "cbase.h"
+
+#include "mom_effect_budget.h"
+#include "mom_shareddefs.h"
+#include "view.h"
+
+#include "tier0/memdbgon.h"
+
+static MAKE_TOGGLE_CONVAR(mom_fx_budget_enable, "1", FCVAR_ARCHIVE,
+                          "Toggles limiting the number of explosive trails and particle effects. 0 = OFF, 1 = ON\n");
+static MAKE_CONVAR(mom_fx_budget_max_trails, "32", FCVAR_ARCHIVE,
+                   "Max number of projectile trails at once, the local player's trails are always created.\n", 0, 1024);
+static MAKE_CONVAR(mom_fx_budget_max_explosions, "16", FCVAR_ARCHIVE,
+                   "Max number of explosion effects within mom_fx_budget_transient_time seconds, the local player's "
+                   "explosions are always created.\n", 0, 1024);
+static MAKE_CONVAR(mom_fx_budget_max_particles, "32", FCVAR_ARCHIVE,
+                   "Max number of other particle effects within mom_fx_budget_transient_time seconds.\n", 0, 1024);
+static MAKE_CONVAR(mom_fx_budget_transient_time, "1.0", FCVAR_ARCHIVE,
+                   "Seconds an explosion or one-off particle effect counts against its budget.\n", 0.1f, 10.0f);
+static MAKE_CONVAR(mom_fx_budget_cull_distance, "4096", FCVAR_ARCHIVE,
+                   "Effects further than this from the view are not created, unless they're the local player's. 0 = OFF\n",
+                   0, 32768);
+
+static const char *const s_pCategoryNames[EFFECT_BUDGET_COUNT] = {"Trails", "Explosions", "Particles"};
+
+static CEffectBudget s_EffectBudget;
+CEffectBudget *g_pEffectBudget = &s_EffectBudget;
+
+CEffectBudget::CEffectBudget() : CAutoGameSystemPerFrame("CEffectBudget"), m_iActiveTrails(0)
+{
+    ResetCounters();
+}
+
+void CEffectBudget::LevelShutdownPostEntity()
+{
+    m_iActiveTrails = 0;
+    for (int i = 0; i < EFFECT_BUDGET_COUNT; i++)
+        m_vecTransients[i].RemoveAll();
+}
+
+void CEffectBudget::Update(float frametime)
+{
+    const float flNow = gpGlobals->realtime;
+    for (int i = 0; i < EFFECT_BUDGET_COUNT; i++)
+    {
+        CUtlVector<float> &vecTransients = m_vecTransients[i];
+        FOR_EACH_VEC_BACK(vecTransients, j)
+        {
+            if (vecTransients[j] <= flNow)
+                vecTransients.FastRemove(j);
+        }
+    }
+}
+
+int CEffectBudget::GetCap(EffectBudgetCategory_t category) const
+{
+    switch (category)
+    {
+    case EFFECT_BUDGET_TRAIL:
+        return mom_fx_budget_max_trails.GetInt();
+    case EFFECT_BUDGET_EXPLOSION:
+        return mom_fx_budget_max_explosions.GetInt();
+    case EFFECT_BUDGET_PARTICLE:
+        return mom_fx_budget_max_particles.GetInt();
+    default:
+        return 0;
+    }
+}
+
+int CEffectBudget::GetActiveCount(EffectBudgetCategory_t category) const
+{
+    return category == EFFECT_BUDGET_TRAIL ? m_iActiveTrails : m_vecTransients[category].Count();
+}
+
+bool CEffectBudget::IsLocalPlayerEffect(C_BaseEntity *pEntity)
+{
+    const auto pLocal = C_BasePlayer::GetLocalPlayer();
+    if (!pEntity || !pLocal)
+        return false;
+
+    C_BaseEntity *pOwner = pEntity->GetOwnerEntity();
+    if (pEntity == pLocal || pOwner == pLocal)
+        return true;
+
+    C_BaseEntity *pTarget = pLocal->GetObserverTarget();
+    return pTarget && (pEntity == pTarget || pOwner == pTarget);
+}
+
+bool CEffectBudget::RequestEffect(EffectBudgetCategory_t category, const Vector &vecOrigin, bool bPriority)
+{
+    CategoryCounters_t &counters = m_Counters[category];
+    counters.m_iRequested++;
+
+    if (mom_fx_budget_enable.GetBool() && !bPriority)
+    {
+        const float flCullDist = mom_fx_budget_cull_distance.GetFloat();
+        if (flCullDist > 0.0f && MainViewOrigin().DistToSqr(vecOrigin) > flCullDist * flCullDist)
+        {
+            counters.m_iCulledDistance++;
+            return false;
+        }
+
+        if (GetActiveCount(category) >= GetCap(category))
+        {
+            counters.m_iCulledBudget++;
+            return false;
+        }
+    }
+
+    if (category == EFFECT_BUDGET_TRAIL)
+        m_iActiveTrails++;
+    else
+        m_vecTransients[category].AddToTail(gpGlobals->realtime + mom_fx_budget_transient_time.GetFloat());
+
+    counters.m_iCreated++;
+    counters.m_iPeakActive = Max(counters.m_iPeakActive, GetActiveCount(category));
+    return true;
+}
+
+void CEffectBudget::ReleaseEffect(EffectBudgetCategory_t category)
+{
+    if (category == EFFECT_BUDGET_TRAIL)
+        m_iActiveTrails = Max(m_iActiveTrails - 1, 0);
+}
+
+void CEffectBudget::PrintCounters() const
+{
+    Msg("%-12s %8s %8s %8s %8s %8s %8s %8s\n", "Category", "Active", "Cap", "Peak", "Request", "Created", "Dist", "Budget");
+    for (int i = 0; i < EFFECT_BUDGET_COUNT; i++)
+    {
+        const auto category = static_cast<EffectBudgetCategory_t>(i);
+        const CategoryCounters_t &counters = m_Counters[i];
+        Msg("%-12s %8i %8i %8i %8i %8i %8i %8i\n", s_pCategoryNames[i], GetActiveCount(category), GetCap(category),
+            counters.m_iPeakActive, counters.m_iRequested, counters.m_iCreated, counters.m_iCulledDistance,
+            counters.m_iCulledBudget);
+    }
+}
+
+void CEffectBudget::ResetCounters()
+{
+    V_memset(m_Counters, 0, sizeof(m_Counters));
+}
+
+CON_COMMAND(mom_fx_budget_print, "Prints how many effects were created and culled per effect budget category.\n")
+{
+    g_pEffectBudget->PrintCounters();
+}
+
+CON_COMMAND(mom_fx_budget_reset, "Resets the effect budget counters.\n")
+{
+    g_pEffectBudget->ResetCounters();
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "igamesystem.h"
+
+enum EffectBudgetCategory_t
+{
+    EFFECT_BUDGET_TRAIL = 0,  // Projectile trails, counted until their projectile is removed
+    EFFECT_BUDGET_EXPLOSION,  // Explosion particles, counted for a short while after being created
+    EFFECT_BUDGET_PARTICLE,   // Other one-off particle effects (sticky pulses, particle temp ents)
+
+    EFFECT_BUDGET_COUNT
+};
+
+// Caps how many explosive effects exist at once, so lobbies full of ghosts firing rockets and stickies
+// don't make the particle count (and with it the frame time) blow up. Effects far away from the view are
+// culled outright, and the local player's own effects always get through.
+class CEffectBudget : public CAutoGameSystemPerFrame
+{
+  public:
+    CEffectBudget();
+
+    void LevelShutdownPostEntity() OVERRIDE;
+    void Update(float frametime) OVERRIDE;
+
+    // Returns true if the effect may be created, in which case it now counts against the category.
+    // Priority effects (the local player's) are always allowed.
+    bool RequestEffect(EffectBudgetCategory_t category, const Vector &vecOrigin, bool bPriority);
+    // For EFFECT_BUDGET_TRAIL, once the effect is gone
+    void ReleaseEffect(EffectBudgetCategory_t category);
+
+    // True if the entity is, or is owned by, the local player or whoever they're spectating
+    static bool IsLocalPlayerEffect(C_BaseEntity *pEntity);
+
+    int GetActiveCount(EffectBudgetCategory_t category) const;
+
+    void PrintCounters() const;
+    void ResetCounters();
+
+  private:
+    struct CategoryCounters_t
+    {
+        int m_iRequested;
+        int m_iCreated;
+        int m_iCulledDistance;
+        int m_iCulledBudget;
+        int m_iPeakActive;
+    };
+
+    int GetCap(EffectBudgetCategory_t category) const;
+
+    int m_iActiveTrails;
+    // Expiry times of the transient effects still counted, per category
+    CUtlVector<float> m_vecTransients[EFFECT_BUDGET_COUNT];
+    CategoryCounters_t m_Counters[EFFECT_BUDGET_COUNT];
+};
+
+extern CEffectBudget *g_pEffectBudget;
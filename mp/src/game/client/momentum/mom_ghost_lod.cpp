@@ -0,0 +1,409 @@
+#include "cbase.h"
+
+#include "mom_ghost_lod.h"
+#include "mom_shareddefs.h"
+#include "materialsystem/MaterialSystemUtil.h"
+#include "view.h"
+
+#include "tier0/memdbgon.h"
+
+static MAKE_TOGGLE_CONVAR(mom_ghost_lod_enable, "1", FCVAR_ARCHIVE,
+                          "If 1, ghosts far away from the camera are drawn with less detail. 0 = OFF, 1 = ON\n");
+static MAKE_CONVAR(mom_ghost_lod_reduced_dist, "1024", FCVAR_ARCHIVE,
+                   "Distance from the camera past which ghosts are drawn without shadows or flashlights.\n", 0, 32768);
+static MAKE_CONVAR(mom_ghost_lod_impostor_dist, "3072", FCVAR_ARCHIVE,
+                   "Distance from the camera past which ghosts are drawn as flat impostors.\n", 0, 32768);
+
+// How far past a LOD distance a ghost has to go back before it switches back, so ghosts right on the edge don't flicker
+#define GHOST_LOD_HYSTERESIS 0.1f
+
+// How long the benchmark lets the ghosts settle before timing
+#define GHOST_LOD_BENCHMARK_WARMUP 1.0f
+
+//-----------------------------------------------------------------------------
+// Draws the impostors of all far away ghosts in one mesh
+//-----------------------------------------------------------------------------
+class CGhostImpostorRenderer : public CDefaultClientRenderable
+{
+  public:
+    struct Impostor_t
+    {
+        Vector m_vecOrigin; // Bottom center
+        float m_flHalfWidth;
+        float m_flHeight;
+        color32 m_Color;
+    };
+
+    void SetImpostors(const CUtlVector<Impostor_t> &vecImpostors, const Vector &vecMins, const Vector &vecMaxs)
+    {
+        m_vecImpostors.CopyArray(vecImpostors.Base(), vecImpostors.Count());
+        m_vecMins = vecMins;
+        m_vecMaxs = vecMaxs;
+
+        if (m_vecImpostors.IsEmpty())
+        {
+            if (m_hRenderHandle != INVALID_CLIENT_RENDER_HANDLE)
+                ClientLeafSystem()->RemoveRenderable(m_hRenderHandle);
+        }
+        else if (m_hRenderHandle == INVALID_CLIENT_RENDER_HANDLE)
+        {
+            ClientLeafSystem()->AddRenderable(this, RENDER_GROUP_TRANSLUCENT_ENTITY);
+        }
+        else
+        {
+            ClientLeafSystem()->RenderableChanged(m_hRenderHandle);
+        }
+    }
+
+    const Vector &GetRenderOrigin() OVERRIDE { return vec3_origin; }
+    const QAngle &GetRenderAngles() OVERRIDE { return vec3_angle; }
+    const matrix3x4_t &RenderableToWorldTransform() OVERRIDE
+    {
+        static matrix3x4_t mat;
+        SetIdentityMatrix(mat);
+        return mat;
+    }
+    bool ShouldDraw() OVERRIDE { return !m_vecImpostors.IsEmpty(); }
+    bool IsTransparent() OVERRIDE { return true; }
+    bool ShouldReceiveProjectedTextures(int flags) OVERRIDE { return false; }
+    void GetRenderBounds(Vector &mins, Vector &maxs) OVERRIDE
+    {
+        mins = m_vecMins;
+        maxs = m_vecMaxs;
+    }
+
+    int DrawModel(int flags) OVERRIDE
+    {
+        if (m_vecImpostors.IsEmpty())
+            return 0;
+
+        if (!m_Material.IsValid())
+            m_Material.Init("debug/debugtranslucentvertexcolor", TEXTURE_GROUP_OTHER);
+
+        CMatRenderContextPtr pRenderContext(materials);
+        const int iMaxQuads = Max(pRenderContext->GetMaxVerticesToRender(m_Material) / 4, 1);
+        const Vector &vecViewOrigin = CurrentViewOrigin();
+
+        int iDrawn = 0;
+        while (iDrawn < m_vecImpostors.Count())
+        {
+            const int iQuads = Min(m_vecImpostors.Count() - iDrawn, iMaxQuads);
+            IMesh *pMesh = pRenderContext->GetDynamicMesh(true, nullptr, nullptr, m_Material);
+
+            CMeshBuilder builder;
+            builder.Begin(pMesh, MATERIAL_QUADS, iQuads);
+
+            for (int i = iDrawn; i < iDrawn + iQuads; i++)
+            {
+                const Impostor_t &impostor = m_vecImpostors[i];
+
+                // Upright billboard, turned to face the camera
+                Vector vecToView = vecViewOrigin - impostor.m_vecOrigin;
+                vecToView.z = 0.0f;
+                if (vecToView.NormalizeInPlace() < 1.0f)
+                    vecToView.Init(1.0f, 0.0f, 0.0f);
+
+                const Vector vecRight(-vecToView.y * impostor.m_flHalfWidth, vecToView.x * impostor.m_flHalfWidth, 0.0f);
+                const Vector vecUp(0.0f, 0.0f, impostor.m_flHeight);
+
+                const Vector vecCorners[4] =
+                {
+                    impostor.m_vecOrigin - vecRight,
+                    impostor.m_vecOrigin - vecRight + vecUp,
+                    impostor.m_vecOrigin + vecRight + vecUp,
+                    impostor.m_vecOrigin + vecRight,
+                };
+
+                for (int j = 0; j < 4; j++)
+                {
+                    builder.Position3fv(vecCorners[j].Base());
+                    builder.Color4ub(impostor.m_Color.r, impostor.m_Color.g, impostor.m_Color.b, impostor.m_Color.a);
+                    builder.TexCoord2f(0, (j == 2 || j == 3) ? 1.0f : 0.0f, (j == 1 || j == 2) ? 0.0f : 1.0f);
+                    builder.AdvanceVertex();
+                }
+            }
+
+            builder.End();
+            pMesh->Draw();
+
+            iDrawn += iQuads;
+        }
+
+        return 1;
+    }
+
+  private:
+    CUtlVector<Impostor_t> m_vecImpostors;
+    Vector m_vecMins, m_vecMaxs;
+    CMaterialReference m_Material;
+};
+
+//-----------------------------------------------------------------------------
+// Client-side stand-in for a ghost, used by mom_ghost_lod_benchmark
+//-----------------------------------------------------------------------------
+class C_GhostLODBenchmarkEntity : public C_BaseAnimating
+{
+    DECLARE_CLASS(C_GhostLODBenchmarkEntity, C_BaseAnimating);
+
+  public:
+    bool ShouldDraw() OVERRIDE { return g_pGhostLOD->ShouldDrawModel(this) && BaseClass::ShouldDraw(); }
+    ShadowType_t ShadowCastType() OVERRIDE
+    {
+        return g_pGhostLOD->ShouldDrawEffects(this) ? BaseClass::ShadowCastType() : SHADOWS_NONE;
+    }
+    void UpdateOnRemove() OVERRIDE
+    {
+        g_pGhostLOD->RemoveGhost(this);
+        BaseClass::UpdateOnRemove();
+    }
+};
+
+CGhostLODSystem::CGhostLODSystem() : CAutoGameSystemPerFrame("CGhostLODSystem")
+{
+    SetDefLessFunc(m_mapGhosts);
+    m_pImpostorRenderer = new CGhostImpostorRenderer;
+    m_eBenchmarkStage = BENCHMARK_NONE;
+    m_flBenchmarkStageTime = 0.0f;
+    m_flBenchmarkSeconds = 0.0f;
+}
+
+CGhostLODSystem::~CGhostLODSystem()
+{
+    delete m_pImpostorRenderer;
+}
+
+void CGhostLODSystem::LevelShutdownPreEntity()
+{
+    if (m_eBenchmarkStage != BENCHMARK_NONE)
+    {
+        Warning("The ghost LOD benchmark was interrupted by the level shutting down\n");
+        EndBenchmark();
+    }
+}
+
+void CGhostLODSystem::LevelShutdownPostEntity()
+{
+    m_mapGhosts.RemoveAll();
+    m_pImpostorRenderer->SetImpostors(CUtlVector<CGhostImpostorRenderer::Impostor_t>(), vec3_origin, vec3_origin);
+}
+
+void CGhostLODSystem::Update(float frametime)
+{
+    UpdateLODs();
+
+    if (m_eBenchmarkStage != BENCHMARK_NONE)
+        UpdateBenchmark(gpGlobals->absoluteframetime);
+}
+
+void CGhostLODSystem::AddGhost(C_BaseAnimating *pGhost)
+{
+    if (m_mapGhosts.Find(pGhost) == m_mapGhosts.InvalidIndex())
+        m_mapGhosts.Insert(pGhost, GHOST_LOD_FULL);
+}
+
+void CGhostLODSystem::RemoveGhost(C_BaseAnimating *pGhost)
+{
+    m_mapGhosts.Remove(pGhost);
+    m_vecBenchmarkGhosts.FindAndFastRemove(pGhost);
+}
+
+GhostLOD_t CGhostLODSystem::GetLOD(C_BaseAnimating *pGhost) const
+{
+    const auto indx = m_mapGhosts.Find(pGhost);
+    return m_mapGhosts.IsValidIndex(indx) ? m_mapGhosts[indx] : GHOST_LOD_FULL;
+}
+
+bool CGhostLODSystem::IsLODEnabled() const
+{
+    if (m_eBenchmarkStage == BENCHMARK_LOD_OFF)
+        return false;
+
+    return m_eBenchmarkStage == BENCHMARK_LOD_ON || mom_ghost_lod_enable.GetBool();
+}
+
+void CGhostLODSystem::UpdateLODs()
+{
+    CUtlVector<CGhostImpostorRenderer::Impostor_t> vecImpostors;
+    Vector vecMins(FLT_MAX, FLT_MAX, FLT_MAX), vecMaxs(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+    const bool bEnabled = IsLODEnabled();
+    const Vector &vecViewOrigin = MainViewOrigin();
+
+    FOR_EACH_MAP_FAST(m_mapGhosts, i)
+    {
+        C_BaseAnimating *pGhost = m_mapGhosts.Key(i);
+        GhostLOD_t &eLOD = m_mapGhosts[i];
+        const GhostLOD_t eOldLOD = eLOD;
+
+        if (!bEnabled)
+        {
+            eLOD = GHOST_LOD_FULL;
+        }
+        else
+        {
+            // Lean towards the current LOD
+            float flReducedDist = mom_ghost_lod_reduced_dist.GetFloat();
+            float flImpostorDist = mom_ghost_lod_impostor_dist.GetFloat();
+            flReducedDist *= eLOD >= GHOST_LOD_REDUCED ? 1.0f - GHOST_LOD_HYSTERESIS : 1.0f + GHOST_LOD_HYSTERESIS;
+            flImpostorDist *= eLOD >= GHOST_LOD_IMPOSTOR ? 1.0f - GHOST_LOD_HYSTERESIS : 1.0f + GHOST_LOD_HYSTERESIS;
+
+            const float flDistSqr = vecViewOrigin.DistToSqr(pGhost->GetAbsOrigin());
+            if (flDistSqr > flImpostorDist * flImpostorDist)
+                eLOD = GHOST_LOD_IMPOSTOR;
+            else if (flDistSqr > flReducedDist * flReducedDist)
+                eLOD = GHOST_LOD_REDUCED;
+            else
+                eLOD = GHOST_LOD_FULL;
+        }
+
+        if (eLOD != eOldLOD)
+        {
+            // ShouldDraw and ShadowCastType are only looked at when these are updated
+            pGhost->UpdateVisibility();
+            pGhost->CreateShadow();
+        }
+
+        // Hidden ghosts stay hidden
+        if (eLOD != GHOST_LOD_IMPOSTOR || pGhost->IsEffectActive(EF_NODRAW) || pGhost->IsDormant())
+            continue;
+
+        const Vector &vecGhostMins = pGhost->WorldAlignMins();
+        const Vector &vecGhostMaxs = pGhost->WorldAlignMaxs();
+        const color32 color = pGhost->GetRenderColor();
+
+        CGhostImpostorRenderer::Impostor_t impostor;
+        impostor.m_vecOrigin = pGhost->GetAbsOrigin();
+        impostor.m_vecOrigin.z += vecGhostMins.z;
+        impostor.m_flHalfWidth = Max(vecGhostMaxs.x - vecGhostMins.x, vecGhostMaxs.y - vecGhostMins.y) * 0.5f;
+        impostor.m_flHeight = vecGhostMaxs.z - vecGhostMins.z;
+        impostor.m_Color.r = color.r;
+        impostor.m_Color.g = color.g;
+        impostor.m_Color.b = color.b;
+        impostor.m_Color.a = pGhost->GetRenderMode() == kRenderNormal ? 255 : color.a;
+        vecImpostors.AddToTail(impostor);
+
+        const Vector vecExtent(impostor.m_flHalfWidth, impostor.m_flHalfWidth, 0.0f);
+        VectorMin(vecMins, impostor.m_vecOrigin - vecExtent, vecMins);
+        VectorMax(vecMaxs, impostor.m_vecOrigin + vecExtent + Vector(0.0f, 0.0f, impostor.m_flHeight), vecMaxs);
+    }
+
+    m_pImpostorRenderer->SetImpostors(vecImpostors, vecMins, vecMaxs);
+}
+
+void CGhostLODSystem::StartBenchmark(int iGhosts, float flSeconds)
+{
+    C_BasePlayer *pPlayer = C_BasePlayer::GetLocalPlayer();
+    if (!pPlayer)
+    {
+        Warning("The ghost LOD benchmark needs a map to be loaded!\n");
+        return;
+    }
+
+    if (m_eBenchmarkStage != BENCHMARK_NONE)
+        EndBenchmark();
+
+    // Spread the ghosts over a grid in front of the player that reaches well past the impostor distance
+    Vector vecForward, vecRight;
+    AngleVectors(QAngle(0.0f, pPlayer->EyeAngles().y, 0.0f), &vecForward, &vecRight, nullptr);
+
+    const int iColumns = Max(static_cast<int>(ceilf(sqrtf(static_cast<float>(iGhosts)))), 1);
+    const float flSpacing = Max(64.0f, mom_ghost_lod_impostor_dist.GetFloat() * 2.0f / iColumns);
+
+    for (int i = 0; i < iGhosts; i++)
+    {
+        auto pGhost = new C_GhostLODBenchmarkEntity;
+        if (!pGhost->InitializeAsClientEntity(ENTITY_MODEL, RENDER_GROUP_OPAQUE_ENTITY))
+        {
+            pGhost->Release();
+            Warning("Failed to create ghost LOD benchmark entity!\n");
+            break;
+        }
+
+        const float flRow = static_cast<float>(i / iColumns + 1);
+        const float flColumn = static_cast<float>(i % iColumns) - (iColumns - 1) * 0.5f;
+        pGhost->SetAbsOrigin(pPlayer->GetAbsOrigin() + vecForward * flRow * flSpacing + vecRight * flColumn * flSpacing);
+        pGhost->SetAbsAngles(QAngle(0.0f, pPlayer->EyeAngles().y + 180.0f, 0.0f));
+        pGhost->SetRenderMode(kRenderTransColor);
+        pGhost->SetRenderColor(RandomInt(0, 255), RandomInt(0, 255), RandomInt(0, 255), 255);
+
+        AddGhost(pGhost);
+        m_vecBenchmarkGhosts.AddToTail(pGhost);
+    }
+
+    V_memset(m_BenchmarkTimings, 0, sizeof(m_BenchmarkTimings));
+    m_flBenchmarkSeconds = flSeconds;
+    m_flBenchmarkStageTime = 0.0f;
+    m_eBenchmarkStage = BENCHMARK_WARMUP;
+
+    Msg("Timing %i ghosts for %.1f seconds without LOD, then %.1f seconds with LOD...\n", m_vecBenchmarkGhosts.Count(),
+        flSeconds, flSeconds);
+}
+
+void CGhostLODSystem::UpdateBenchmark(float flFrameTime)
+{
+    m_flBenchmarkStageTime += flFrameTime;
+
+    if (m_eBenchmarkStage == BENCHMARK_WARMUP)
+    {
+        if (m_flBenchmarkStageTime >= GHOST_LOD_BENCHMARK_WARMUP)
+        {
+            m_eBenchmarkStage = BENCHMARK_LOD_OFF;
+            m_flBenchmarkStageTime = 0.0f;
+        }
+        return;
+    }
+
+    BenchmarkTiming_t &timing = m_BenchmarkTimings[m_eBenchmarkStage == BENCHMARK_LOD_ON];
+    timing.m_iFrames++;
+    timing.m_flTotalTime += flFrameTime;
+    FOR_EACH_MAP_FAST(m_mapGhosts, i)
+        timing.m_iLODFrames[m_mapGhosts[i]]++;
+
+    if (m_flBenchmarkStageTime < m_flBenchmarkSeconds)
+        return;
+
+    if (m_eBenchmarkStage == BENCHMARK_LOD_OFF)
+    {
+        m_eBenchmarkStage = BENCHMARK_LOD_ON;
+        m_flBenchmarkStageTime = 0.0f;
+        return;
+    }
+
+    static const char *const s_pStageNames[] = {"Without LOD", "With LOD"};
+    for (int i = 0; i < 2; i++)
+    {
+        const BenchmarkTiming_t &result = m_BenchmarkTimings[i];
+        const int iFrames = Max(result.m_iFrames, 1);
+        Msg("%s: %i frames, %.3f ms per frame (%.1f full, %.1f reduced, %.1f impostor ghosts per frame)\n", s_pStageNames[i],
+            result.m_iFrames, result.m_flTotalTime * 1000.0f / iFrames, float(result.m_iLODFrames[GHOST_LOD_FULL]) / iFrames,
+            float(result.m_iLODFrames[GHOST_LOD_REDUCED]) / iFrames, float(result.m_iLODFrames[GHOST_LOD_IMPOSTOR]) / iFrames);
+    }
+
+    EndBenchmark();
+}
+
+void CGhostLODSystem::EndBenchmark()
+{
+    m_eBenchmarkStage = BENCHMARK_NONE;
+
+    // Releasing them removes them from the list
+    while (!m_vecBenchmarkGhosts.IsEmpty())
+        m_vecBenchmarkGhosts.Tail()->Release();
+}
+
+CON_COMMAND_F(mom_ghost_lod_benchmark, "Spawns client-side ghosts in front of you and times frames without and then with ghost LOD.\n"
+                                       "Usage: mom_ghost_lod_benchmark <ghosts> [seconds]\n", FCVAR_DEVELOPMENTONLY)
+{
+    if (args.ArgC() < 2)
+    {
+        Msg("%s", mom_ghost_lod_benchmark_command.GetHelpText());
+        return;
+    }
+
+    const int iGhosts = clamp(atoi(args[1]), 1, 2048);
+    const float flSeconds = args.ArgC() > 2 ? Max(static_cast<float>(atof(args[2])), 1.0f) : 5.0f;
+    g_pGhostLOD->StartBenchmark(iGhosts, flSeconds);
+}
+
+static CGhostLODSystem s_GhostLOD;
+CGhostLODSystem *g_pGhostLOD = &s_GhostLOD;
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "igamesystem.h"
+#include "utlmap.h"
+
+class C_BaseAnimating;
+class CGhostImpostorRenderer;
+
+enum GhostLOD_t
+{
+    GHOST_LOD_FULL = 0, // Model, shadow and flashlight
+    GHOST_LOD_REDUCED,  // Model only
+    GHOST_LOD_IMPOSTOR, // A flat billboard, drawn along with every other impostor in one mesh
+
+    GHOST_LOD_COUNT
+};
+
+// Picks a level of detail for every ghost by its distance from the camera, so lobbies with lots of
+// ghosts don't spend the frame setting up models and shadows for ghosts that are a few pixels tall.
+class CGhostLODSystem : public CAutoGameSystemPerFrame
+{
+  public:
+    CGhostLODSystem();
+    ~CGhostLODSystem();
+
+    void LevelShutdownPreEntity() OVERRIDE;
+    void LevelShutdownPostEntity() OVERRIDE;
+    void Update(float frametime) OVERRIDE;
+
+    void AddGhost(C_BaseAnimating *pGhost);
+    void RemoveGhost(C_BaseAnimating *pGhost);
+    GhostLOD_t GetLOD(C_BaseAnimating *pGhost) const;
+
+    // For the ghosts' ShouldDraw and ShadowCastType
+    bool ShouldDrawModel(C_BaseAnimating *pGhost) const { return GetLOD(pGhost) != GHOST_LOD_IMPOSTOR; }
+    bool ShouldDrawEffects(C_BaseAnimating *pGhost) const { return GetLOD(pGhost) == GHOST_LOD_FULL; }
+
+    // Spawns iGhosts client-side ghosts in front of the local player and times frames without and then with LOD
+    void StartBenchmark(int iGhosts, float flSeconds);
+
+  private:
+    enum BenchmarkStage_t
+    {
+        BENCHMARK_NONE = 0,
+        BENCHMARK_WARMUP,
+        BENCHMARK_LOD_OFF,
+        BENCHMARK_LOD_ON,
+    };
+
+    struct BenchmarkTiming_t
+    {
+        int m_iFrames;
+        float m_flTotalTime;
+        int m_iLODFrames[GHOST_LOD_COUNT]; // Sum of the ghosts at each LOD over the frames
+    };
+
+    void UpdateLODs();
+    void UpdateBenchmark(float flFrameTime);
+    void EndBenchmark();
+
+    bool IsLODEnabled() const;
+
+    CUtlMap<C_BaseAnimating *, GhostLOD_t> m_mapGhosts;
+    CGhostImpostorRenderer *m_pImpostorRenderer;
+
+    BenchmarkStage_t m_eBenchmarkStage;
+    float m_flBenchmarkStageTime;
+    float m_flBenchmarkSeconds;
+    BenchmarkTiming_t m_BenchmarkTimings[2]; // LOD off, LOD on
+    CUtlVector<C_BaseAnimating *> m_vecBenchmarkGhosts;
+};
+
+extern CGhostLODSystem *g_pGhostLOD;
@@ -20,7 +20,12 @@
 
 #include "tier0/memdbgon.h"
 
-#define MAP_CACHE_FILE_NAME "map_cache.dat"
+#define MAP_CACHE_FILE_NAME "map_cache.bin"
+#define MAP_CACHE_KV_FILE_NAME "map_cache.dat" // Before the binary format
+#define MAP_CACHE_MAGIC 0x4843434D // "MCCH"
+#define MAP_CACHE_FILE_VERSION 1
+// Bump this when MapData's binary format changes, records of other versions are skipped
+#define MAP_CACHE_RECORD_VERSION 1
 
 void DownloadQueueCallback(IConVar *var, const char *pOldValue, float flOldValue)
 {
@@ -35,13 +40,15 @@ void DownloadQueueParallelCallback(IConVar *var, const char *pOldValue, float fl
 MAKE_TOGGLE_CONVAR(mom_map_delete_queue, "1", FCVAR_ARCHIVE | FCVAR_REPLICATED, "If 1, maps will be queued to be deleted upon game close.\nIf 0, maps are deleted the moment they are confirmed to have been removed from library.\n");
 MAKE_TOGGLE_CONVAR(mom_map_download_auto, "0", FCVAR_ARCHIVE | FCVAR_REPLICATED, "If 1, maps will automatically download when updated/added to library.\n");
 MAKE_TOGGLE_CONVAR_C(mom_map_download_queue, "1", FCVAR_ARCHIVE | FCVAR_REPLICATED, "If 1, maps will be queued to download, allowing mom_map_download_queue_parallel parallel downloads.\n", DownloadQueueCallback);
-MAKE_CONVAR_C(mom_map_download_queue_parallel, "3", FCVAR_ARCHIVE | FCVAR_REPLICATED, "The number of parallel map downloads if mom_map_download_queue is 1.\n", 1, 3, DownloadQueueParallelCallback);
+MAKE_CONVAR_C(mom_map_download_queue_parallel, "3", FCVAR_ARCHIVE | FCVAR_REPLICATED, "The number of parallel map downloads if mom_map_download_queue is 1.\n", 1, 8, DownloadQueueParallelCallback);
 MAKE_TOGGLE_CONVAR(mom_map_download_cancel_confirm, "1", FCVAR_ARCHIVE | FCVAR_REPLICATED, "If 1, a messagebox will be created to ask to confirm cancelling downloads.\n");
 
 // =============================================================================================
 
-CMapCache::CMapCache() : CAutoGameSystem("CMapCache"), m_pCurrentMapData(nullptr)
+CMapCache::CMapCache() : CAutoGameSystem("CMapCache"), m_pCurrentMapData(nullptr), m_iStaleRecords(0), m_bRewriteFile(true)
 {
+    SetDefLessFunc(m_treeMapsOnDisk);
+    SetDefLessFunc(m_treeDirtyMaps);
     SetDefLessFunc(m_mapMapCache);
     SetDefLessFunc(m_mapFileDownloads);
     SetDefLessFunc(m_mapQueuedDelete);
@@ -146,7 +153,7 @@ bool CMapCache::StartDownloadingMap(MapData* pData)
                                                             UtlMakeDelegate(this, &CMapCache::MapDownloadSize),
                                                             UtlMakeDelegate(this, &CMapCache::MapDownloadProgress),
                                                             UtlMakeDelegate(this, &CMapCache::MapDownloadEnd),
-                                                            pFilePath, "GAME", true);
+                                                            pFilePath, "GAME", true, pData->m_szHash);
     if (handle != INVALID_HTTPREQUEST_HANDLE)
     {
         m_mapFileDownloads.Insert(handle, pData->m_uID);
@@ -304,17 +311,47 @@ bool CMapCache::AddMapsToCache(KeyValues* pData, APIModelSource source)
     return true;
 }
 
+bool CMapCache::AddMapsToCache(CUtlVector<MapData*>& vecMaps, APIModelSource source)
+{
+    if (vecMaps.IsEmpty())
+        return false;
+
+    FOR_EACH_VEC(vecMaps, i)
+    {
+        vecMaps[i]->m_eSource = source;
+        AddMapToCache(vecMaps[i]);
+    }
+
+    // The cache owns them now
+    vecMaps.RemoveAll();
+
+    if (source != MODEL_FROM_DISK)
+    {
+        FireMapCacheUpdateEvent(source);
+    }
+
+    return true;
+}
+
 void CMapCache::AddMapToCache(KeyValues* pMap, APIModelSource source)
 {
     MapData *pData = new MapData;
     pData->m_eSource = source;
     pData->FromKV(pMap);
 
+    AddMapToCache(pData);
+}
+
+void CMapCache::AddMapToCache(MapData* pData)
+{
+    const APIModelSource source = pData->m_eSource;
+
     const auto indx = m_mapMapCache.Find(pData->m_uID);
     if (m_mapMapCache.IsValidIndex(indx))
     {
         // Update it
         *m_mapMapCache[indx] = *pData;
+        m_SearchIndex.UpdateMap(m_mapMapCache[indx]);
         // Update other UI about this update if need be
         if (m_mapMapCache[indx]->WasUpdated())
             m_mapMapCache[indx]->SendDataUpdate();
@@ -325,6 +362,7 @@ void CMapCache::AddMapToCache(KeyValues* pMap, APIModelSource source)
     {
         m_dictMapNames.Insert(pData->m_szMapName, pData->m_uID);
         m_mapMapCache.Insert(pData->m_uID, pData);
+        m_SearchIndex.UpdateMap(pData);
 
         // Force an update event if not from disk
         if (source != MODEL_FROM_DISK)
@@ -340,6 +378,8 @@ void CMapCache::AddMapToCache(KeyValues* pMap, APIModelSource source)
 
 void CMapCache::FireMapCacheUpdateEvent(APIModelSource source)
 {
+    SaveDirtyMaps();
+
     KeyValues *pEvent = new KeyValues("map_cache_updated");
     pEvent->SetInt("source", source);
     g_pModuleComms->FireEvent(pEvent, FIRE_LOCAL_ONLY);
@@ -537,12 +577,10 @@ void CMapCache::MapDownloadSize(KeyValues* pKvHeader)
     auto indx = m_mapFileDownloads.Find(pKvHeader->GetUint64("request"));
     if (m_mapFileDownloads.IsValidIndex(indx))
     {
-        uint32 id = m_mapFileDownloads[indx];
-
-        KeyValues *pEvent = pKvHeader->MakeCopy();
-        pEvent->SetName("map_download_size");
-        pEvent->SetInt("id", id);
-        g_pModuleComms->FireEvent(pEvent, FIRE_LOCAL_ONLY);
+        MapDownloadSizeEvent_t event;
+        event.m_uMapID = m_mapFileDownloads[indx];
+        event.m_uSize = pKvHeader->GetUint64("size");
+        g_pModuleComms->FireEvent(event, FIRE_LOCAL_ONLY);
     }
 }
 
@@ -551,11 +589,11 @@ void CMapCache::MapDownloadProgress(KeyValues* pKvProgress)
     auto fileIndx = m_mapFileDownloads.Find(pKvProgress->GetUint64("request"));
     if (fileIndx != m_mapFileDownloads.InvalidIndex())
     {
-        uint32 id = m_mapFileDownloads[fileIndx];
-        KeyValues *pEvent = pKvProgress->MakeCopy();
-        pEvent->SetName("map_download_progress");
-        pEvent->SetInt("id", id);
-        g_pModuleComms->FireEvent(pEvent, FIRE_LOCAL_ONLY);
+        // Fired for every chunk, so this goes through a typed event
+        MapDownloadProgressEvent_t event;
+        event.m_uMapID = m_mapFileDownloads[fileIndx];
+        event.m_uDownloaded = pKvProgress->GetUint64("offset") + pKvProgress->GetUint64("size");
+        g_pModuleComms->FireEvent(event, FIRE_LOCAL_ONLY);
     }
 }
 
@@ -571,6 +609,8 @@ void CMapCache::MapDownloadEnd(KeyValues* pKvComplete)
             int code = pKvComplete->GetInt("code");
             if (pKvComplete->GetBool("bIO") && code == k_EHTTPStatusCode410Gone) // This is internal for cancelled
                 Log("Download of map %u cancelled successfully.\n", id);
+            else if (pKvComplete->GetBool("badhash"))
+                Warning("Could not download map! The downloaded file did not match the map's hash.\n");
             else
                 Warning("Could not download map! Error code: %i\n", code);
         }
@@ -581,6 +621,7 @@ void CMapCache::MapDownloadEnd(KeyValues* pKvComplete)
             {
                 pMap->m_bMapFileNeedsUpdate = false;
                 pMap->m_bMapFileExists = true;
+                m_treeDirtyMaps.InsertIfNotFound(id);
             }
 
             DevLog("Successfully downloaded the map with ID: %i\n", id);
@@ -593,9 +634,8 @@ void CMapCache::MapDownloadEnd(KeyValues* pKvComplete)
         pEvent->SetInt("id", id);
         g_pModuleComms->FireEvent(pEvent, FIRE_LOCAL_ONLY);
 
-        // Check and add to download
-        if (m_mapQueuedDownload.Count())
-            DownloadMap(m_mapQueuedDownload.Key(m_mapQueuedDownload.FirstInorder()));
+        // Fill the free download slots from the queue
+        OnDownloadQueueSizeChanged();
     }
 }
 
@@ -677,6 +717,7 @@ void CMapCache::PostInit()
     ListenForGameEvent("site_auth");
 
     g_pModuleComms->ListenForEvent("pre_level_init", UtlMakeDelegate(this, &CMapCache::PreLevelInit));
+    g_pModuleComms->ListenForEvent("map_data_update", UtlMakeDelegate(this, &CMapCache::OnMapDataUpdate));
 
     // Load the cache from disk
     LoadMapCacheFromDisk();
@@ -738,7 +779,8 @@ void CMapCache::LevelShutdownPostEntity()
     }
 
     m_pCurrentMapData = nullptr;
-    // MOM_TODO redundant save to disk?
+
+    SaveDirtyMaps();
 }
 
 void CMapCache::Shutdown()
@@ -748,50 +790,249 @@ void CMapCache::Shutdown()
         FOR_EACH_MAP_FAST(m_mapQueuedDelete, i)
         {
             m_mapQueuedDelete[i]->DeleteMapFile();
+            m_treeDirtyMaps.InsertIfNotFound(m_mapQueuedDelete[i]->m_uID);
         }
     }
 
-    SaveMapCacheToDisk();
+    SaveDirtyMaps();
+}
+
+void CMapCache::OnMapDataUpdate(KeyValues *pKv)
+{
+    m_treeDirtyMaps.InsertIfNotFound(pKv->GetInt("id"));
+
+    MapData *pData = GetMapDataByID(pKv->GetInt("id"));
+    if (pData)
+        m_SearchIndex.UpdateMap(pData);
 }
 
 void CMapCache::LoadMapCacheFromDisk()
 {
-    KeyValuesAD pMapData("MapCacheData");
-    pMapData->UsesEscapeSequences(true);
-    if (pMapData->LoadFromFile(g_pFullFileSystem, MAP_CACHE_FILE_NAME, "MOD"))
+    if (!g_pFullFileSystem->ReadFile(MAP_CACHE_FILE_NAME, "MOD", m_bufDisk))
+    {
+        if (!LoadMapCacheFromKeyValues())
+            Log("Map cache file doesn't exist, creating it...\n");
+        return;
+    }
+
+    char szVersion[32];
+    if (m_bufDisk.GetUnsignedInt() != MAP_CACHE_MAGIC || m_bufDisk.GetUnsignedChar() != MAP_CACHE_FILE_VERSION)
+    {
+        Warning("Map cache file is invalid, ignoring it...\n");
+        m_bufDisk.Purge();
+        return;
+    }
+
+    m_bufDisk.GetString(szVersion);
+    if (!FStrEq(szVersion, MOM_CURRENT_VERSION))
     {
-        KeyValues *pVersion = pMapData->FindKey(MOM_CURRENT_VERSION);
-        if (pVersion)
+        Log("Map cache file exists but is an older version, ignoring it...\n");
+        m_bufDisk.Purge();
+        return;
+    }
+
+    m_bRewriteFile = false;
+
+    // Records are appended when a map changes, so a later record for the same map replaces the earlier one
+    while (m_bufDisk.GetBytesRemaining() > 0)
+    {
+        const uint32 uID = m_bufDisk.GetUnsignedInt();
+        const uint8 iVersion = m_bufDisk.GetUnsignedChar();
+        const int iCoreSize = m_bufDisk.GetInt();
+        const int iCoreStart = m_bufDisk.TellGet();
+        if (!m_bufDisk.IsValid() || iCoreSize < 0 || iCoreSize + (int)sizeof(int) > m_bufDisk.GetBytesRemaining())
+        {
+            // Cut off mid-append, drop it
+            m_bRewriteFile = true;
+            break;
+        }
+
+        m_bufDisk.SeekGet(CUtlBuffer::SEEK_HEAD, iCoreStart + iCoreSize);
+        const int iDetailsSize = m_bufDisk.GetInt();
+        const int iDetailsStart = m_bufDisk.TellGet();
+        if (iDetailsSize < 0 || iDetailsSize > m_bufDisk.GetBytesRemaining())
+        {
+            m_bRewriteFile = true;
+            break;
+        }
+
+        m_bufDisk.SeekGet(CUtlBuffer::SEEK_HEAD, iDetailsStart + iDetailsSize);
+
+        if (iVersion != MAP_CACHE_RECORD_VERSION)
+        {
+            m_iStaleRecords++;
+            continue;
+        }
+
+        const int iRecordEnd = m_bufDisk.TellGet();
+
+        MapData *pData = new MapData;
+        pData->m_eSource = MODEL_FROM_DISK;
+        m_bufDisk.SeekGet(CUtlBuffer::SEEK_HEAD, iCoreStart);
+        pData->FromBinary(m_bufDisk);
+        pData->m_iDetailsOffset = iDetailsStart;
+        pData->ResetUpdate();
+        m_bufDisk.SeekGet(CUtlBuffer::SEEK_HEAD, iRecordEnd);
+
+        if (!pData->m_bValid || pData->m_uID != uID)
         {
-            AddMapsToCache(pVersion, MODEL_FROM_DISK);
+            delete pData;
+            m_iStaleRecords++;
+            continue;
+        }
+
+        const auto indx = m_mapMapCache.Find(uID);
+        if (m_mapMapCache.IsValidIndex(indx))
+        {
+            m_dictMapNames.Remove(m_mapMapCache[indx]->m_szMapName);
+            delete m_mapMapCache[indx];
+            m_mapMapCache[indx] = pData;
+            m_iStaleRecords++;
         }
         else
         {
-            Log("Map cache file exists but is an older version, ignoring it...\n");
+            m_mapMapCache.Insert(uID, pData);
+            m_treeMapsOnDisk.Insert(uID);
         }
+
+        m_dictMapNames.Insert(pData->m_szMapName, uID);
+        m_SearchIndex.UpdateMap(pData);
+    }
+}
+
+bool CMapCache::LoadMapCacheFromKeyValues()
+{
+    KeyValuesAD pMapData("MapCacheData");
+    pMapData->UsesEscapeSequences(true);
+    if (!pMapData->LoadFromFile(g_pFullFileSystem, MAP_CACHE_KV_FILE_NAME, "MOD"))
+        return false;
+
+    KeyValues *pVersion = pMapData->FindKey(MOM_CURRENT_VERSION);
+    if (pVersion)
+    {
+        AddMapsToCache(pVersion, MODEL_FROM_DISK);
+        Log("Converting the map cache file to the binary format...\n");
     }
     else
     {
-        Log("Map cache file doesn't exist, creating it...\n");
+        Log("Map cache file exists but is an older version, ignoring it...\n");
     }
+
+    return true;
+}
+
+void CMapCache::LoadMapDetails(MapData *pData)
+{
+    if (pData->m_iDetailsOffset < 0)
+        return;
+
+    m_bufDisk.SeekGet(CUtlBuffer::SEEK_HEAD, pData->m_iDetailsOffset);
+    pData->m_iDetailsOffset = -1;
+    pData->DetailsFromBinary(m_bufDisk);
+}
+
+// Writes the size of the block that started at iSizePos, which was filled with a placeholder
+static void FinishSizedBlock(CUtlBuffer &buf, int iSizePos)
+{
+    const int iEnd = buf.TellPut();
+    buf.SeekPut(CUtlBuffer::SEEK_HEAD, iSizePos);
+    buf.PutInt(iEnd - iSizePos - sizeof(int));
+    buf.SeekPut(CUtlBuffer::SEEK_HEAD, iEnd);
+}
+
+void CMapCache::WriteMapRecord(MapData *pData, CUtlBuffer &buf)
+{
+    LoadMapDetails(pData);
+
+    buf.PutUnsignedInt(pData->m_uID);
+    buf.PutUnsignedChar(MAP_CACHE_RECORD_VERSION);
+
+    const int iCoreSizePos = buf.TellPut();
+    buf.PutInt(0);
+    pData->ToBinary(buf);
+    FinishSizedBlock(buf, iCoreSizePos);
+
+    const int iDetailsSizePos = buf.TellPut();
+    buf.PutInt(0);
+    pData->DetailsToBinary(buf);
+    FinishSizedBlock(buf, iDetailsSizePos);
 }
 
 void CMapCache::SaveMapCacheToDisk()
 {
-    KeyValuesAD pMapData("MapCacheData");
-    pMapData->UsesEscapeSequences(true);
+    CUtlBuffer buf;
+    buf.PutUnsignedInt(MAP_CACHE_MAGIC);
+    buf.PutUnsignedChar(MAP_CACHE_FILE_VERSION);
+    buf.PutString(MOM_CURRENT_VERSION);
+
+    m_treeMapsOnDisk.RemoveAll();
+    FOR_EACH_MAP_FAST(m_mapMapCache, i)
+    {
+        WriteMapRecord(m_mapMapCache[i], buf);
+        m_treeMapsOnDisk.Insert(m_mapMapCache.Key(i));
+    }
+
+    m_treeDirtyMaps.RemoveAll();
+
+    if (!g_pFullFileSystem->WriteFile(MAP_CACHE_FILE_NAME, "MOD", buf))
+    {
+        DevLog("Failed to log map cache out to file\n");
+        return;
+    }
 
-    KeyValues *pVersion = new KeyValues(MOM_CURRENT_VERSION);
-    pMapData->AddSubKey(pVersion);
+    // Every map's details were loaded to write them, the old file contents aren't needed anymore
+    m_bufDisk.Purge();
+    m_iStaleRecords = 0;
+    m_bRewriteFile = false;
+}
 
-    FOR_EACH_MAP(m_mapMapCache, i)
+void CMapCache::SaveDirtyMaps()
+{
+    // Compact the file once most of it is superseded records
+    if (m_bRewriteFile || m_iStaleRecords > m_mapMapCache.Count())
     {
-        KeyValues *pMap = pVersion->CreateNewKey();
-        m_mapMapCache[i]->ToKV(pMap);
+        SaveMapCacheToDisk();
+        return;
     }
 
-    if (!pMapData->SaveToFile(g_pFullFileSystem, MAP_CACHE_FILE_NAME, "MOD"))
+    if (!m_treeDirtyMaps.Count())
+        return;
+
+    CUtlBuffer buf;
+    FOR_EACH_RBTREE(m_treeDirtyMaps, i)
+    {
+        const uint32 uID = m_treeDirtyMaps[i];
+        MapData *pData = GetMapDataByID(uID);
+        if (!pData)
+            continue;
+
+        WriteMapRecord(pData, buf);
+
+        if (m_treeMapsOnDisk.Find(uID) != m_treeMapsOnDisk.InvalidIndex())
+            m_iStaleRecords++;
+        else
+            m_treeMapsOnDisk.Insert(uID);
+    }
+
+    m_treeDirtyMaps.RemoveAll();
+
+    const FileHandle_t hFile = g_pFullFileSystem->Open(MAP_CACHE_FILE_NAME, "ab", "MOD");
+    if (!hFile)
+    {
         DevLog("Failed to log map cache out to file\n");
+        m_bRewriteFile = true;
+        return;
+    }
+
+    const int iWritten = g_pFullFileSystem->Write(buf.Base(), buf.TellPut(), hFile);
+    g_pFullFileSystem->Close(hFile);
+
+    // A partial record at the end of the file gets rejected on load, rewrite the whole thing next time
+    if (iWritten != buf.TellPut())
+    {
+        DevLog("Failed to log map cache out to file\n");
+        m_bRewriteFile = true;
+    }
 }
 
 CMapCache s_mapCache;
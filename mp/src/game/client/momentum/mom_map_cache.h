@@ -1,8 +1,10 @@
 #pragma once
 
 #include "mom_api_models.h"
+#include "mom_map_search_index.h"
 #include "steam/isteamhttp.h"
 #include "IMapList.h"
+#include "utlbuffer.h"
 
 enum MapDownloadResponse
 {
@@ -37,10 +39,18 @@ public:
     MapData *GetCurrentMapData() const { return m_pCurrentMapData; }
     uint32 GetCurrentMapID() const { return m_pCurrentMapData ? m_pCurrentMapData->m_uID : 0; }
     MapData *GetMapDataByID(uint32 uMapID);
+    // Parses the credits and images of a map out of the cache file, they're only loaded when needed
+    void LoadMapDetails(MapData *pData);
 
     void GetMapList(CUtlVector<MapData*> &vecMaps, MapListType_e type);
+    // IDs of the cached maps that pass the filters, in ascending order, see CMapSearchIndex
+    void FindMaps(const MapFilters_t &filters, CUtlVector<uint32> &vecIDs) const { m_SearchIndex.FindMaps(filters, vecIDs); }
     bool AddMapsToCache(KeyValues *pData, APIModelSource source);
+    // Takes ownership of the maps, the vector is emptied
+    bool AddMapsToCache(CUtlVector<MapData*> &vecMaps, APIModelSource source);
     void AddMapToCache(KeyValues *pMap, APIModelSource source);
+    // Takes ownership of pData, it is deleted if the map was already cached
+    void AddMapToCache(MapData *pData);
     void FireMapCacheUpdateEvent(APIModelSource source);
 
     bool UpdateMapInfo(uint32 uMapID);
@@ -48,6 +58,7 @@ public:
 
     bool IsMapDownloading(uint32 uMapID);
     bool IsMapQueuedToDownload(uint32 uMapID) const;
+    bool HasActiveDownloads() const { return m_mapFileDownloads.Count() > 0 || m_mapQueuedDownload.Count() > 0; }
     void OnDownloadQueueSizeChanged();
     void OnDownloadQueueToggled();
     void RemoveMapFromDownloadQueue(uint32 uMapID, bool bSendEvent = false);
@@ -59,7 +70,11 @@ protected:
     void Shutdown() OVERRIDE;
 
     void LoadMapCacheFromDisk();
+    bool LoadMapCacheFromKeyValues(); // The old text format, only read to convert it
+    // Writes the whole file, dropping stale records
     void SaveMapCacheToDisk();
+    // Appends a record for every map that changed since the last save
+    void SaveDirtyMaps();
 
     void SetMapGamemode(const char *pMapName = nullptr);
 
@@ -86,6 +101,9 @@ private:
     bool StartDownloadingMap(MapData *pData);
     bool AddMapToDownloadQueue(MapData *pData);
 
+    void OnMapDataUpdate(KeyValues *pKv);
+    void WriteMapRecord(MapData *pData, CUtlBuffer &buf);
+
     MapData *m_pCurrentMapData;
 
     CUtlDict<uint32> m_dictMapNames;
@@ -93,6 +111,14 @@ private:
     CUtlMap<uint32, MapData*> m_mapQueuedDelete;
     CUtlMap<uint32, MapData*> m_mapQueuedDownload;
     CUtlMap<HTTPRequestHandle, uint32> m_mapFileDownloads;
+    CMapSearchIndex m_SearchIndex;
+
+    // Contents of the cache file, kept around for the map details that have not been loaded yet
+    CUtlBuffer m_bufDisk;
+    CUtlRBTree<uint32> m_treeMapsOnDisk; // Maps that have a record in the file
+    CUtlRBTree<uint32> m_treeDirtyMaps; // Maps that changed since their record was written
+    int m_iStaleRecords; // Records in the file that were superseded by a later one
+    bool m_bRewriteFile;
 };
 
 extern CMapCache* g_pMapCache;
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include "cbase.h"
+
+#include "mom_map_prefetch.h"
+#include "mom_map_cache.h"
+#include "mom_modulecomms.h"
+#include "mom_shareddefs.h"
+
+#include "tier0/memdbgon.h"
+
+// How often to look for a map to prefetch when nothing is being prefetched
+#define PREFETCH_CHECK_INTERVAL 5.0
+
+static MAKE_TOGGLE_CONVAR(mom_map_prefetch_enable, "0", FCVAR_ARCHIVE,
+                          "If 1, maps from the library and favorites are downloaded in the background before they are played.\n");
+static MAKE_CONVAR(mom_map_prefetch_max_maps, "5", FCVAR_ARCHIVE,
+                   "The max number of maps to prefetch per game session.\n", 1, 50);
+static MAKE_CONVAR(mom_map_prefetch_disk_budget, "1024", FCVAR_ARCHIVE,
+                   "The max amount of map data, in MB, to prefetch per game session.\n", 0, 16384);
+static MAKE_CONVAR(mom_map_prefetch_bandwidth, "1024", FCVAR_ARCHIVE,
+                   "The average bandwidth, in KB/s, that prefetching maps may use. The next map waits until the average is under this.\n",
+                   16, 102400);
+
+CMapPrefetcher::CMapPrefetcher() : CAutoGameSystemPerFrame("CMapPrefetcher")
+{
+    m_iDownloadSizeIndx = -1;
+    m_iDownloadEndIndx = -1;
+    m_dNextCheckTime = 0.0;
+    m_uCurrentID = 0;
+    m_dStartTime = 0.0;
+    m_uCurrentSize = 0;
+    m_iMapsPrefetched = 0;
+    m_uBytesPrefetched = 0;
+    SetDefLessFunc(m_treeAttempted);
+}
+
+void CMapPrefetcher::PostInit()
+{
+    m_iDownloadSizeIndx = g_pModuleComms->ListenForEvent(UtlMakeDelegate(this, &CMapPrefetcher::OnMapDownloadSize));
+    m_iDownloadEndIndx = g_pModuleComms->ListenForEvent("map_download_end", UtlMakeDelegate(this, &CMapPrefetcher::OnMapDownloadEnd));
+
+    // Give the library and favorites a chance to be fetched first
+    m_dNextCheckTime = Plat_FloatTime() + PREFETCH_CHECK_INTERVAL;
+}
+
+void CMapPrefetcher::Shutdown()
+{
+    g_pModuleComms->RemoveListener(MapDownloadSizeEvent_t::EVENT, m_iDownloadSizeIndx);
+    g_pModuleComms->RemoveListener("map_download_end", m_iDownloadEndIndx);
+}
+
+void CMapPrefetcher::Update(float frametime)
+{
+    if (!mom_map_prefetch_enable.GetBool() || m_uCurrentID)
+        return;
+
+    const double dNow = Plat_FloatTime();
+    if (dNow < m_dNextCheckTime)
+        return;
+
+    m_dNextCheckTime = dNow + PREFETCH_CHECK_INTERVAL;
+
+    if (m_iMapsPrefetched >= mom_map_prefetch_max_maps.GetInt() ||
+        m_uBytesPrefetched >= (uint64)mom_map_prefetch_disk_budget.GetInt() * 1024 * 1024)
+        return;
+
+    // Never get in the way of downloads the player asked for
+    if (g_pMapCache->HasActiveDownloads())
+        return;
+
+    MapData *pData = FindNextMap();
+    if (pData)
+        StartPrefetch(pData);
+}
+
+static int PrefetchPrioritySort(MapData * const *ppLeft, MapData * const *ppRight)
+{
+    const MapData *pLeft = *ppLeft, *pRight = *ppRight;
+
+    // Favorites first, then whatever was played most recently
+    if (pLeft->m_bInFavorites != pRight->m_bInFavorites)
+        return pLeft->m_bInFavorites ? -1 : 1;
+
+    if (pLeft->m_tLastPlayed != pRight->m_tLastPlayed)
+        return pLeft->m_tLastPlayed > pRight->m_tLastPlayed ? -1 : 1;
+
+    return pLeft->m_uID < pRight->m_uID ? -1 : (pLeft->m_uID > pRight->m_uID);
+}
+
+MapData *CMapPrefetcher::FindNextMap()
+{
+    CUtlVector<MapData *> vecLibrary, vecFavorites;
+    g_pMapCache->GetMapList(vecLibrary, MAP_LIST_LIBRARY);
+    g_pMapCache->GetMapList(vecFavorites, MAP_LIST_FAVORITES);
+
+    CUtlVector<MapData *> vecCandidates;
+    vecCandidates.EnsureCapacity(vecLibrary.Count() + vecFavorites.Count());
+
+    const auto AddCandidate = [&](MapData *pData)
+    {
+        if (pData->m_bMapFileExists)
+            return;
+
+        if (!pData->m_szDownloadURL[0] || pData == g_pMapCache->GetCurrentMapData())
+            return;
+
+        if (m_treeAttempted.HasElement(pData->m_uID) || vecCandidates.HasElement(pData))
+            return;
+
+        vecCandidates.AddToTail(pData);
+    };
+
+    FOR_EACH_VEC(vecFavorites, i)
+        AddCandidate(vecFavorites[i]);
+    FOR_EACH_VEC(vecLibrary, i)
+        AddCandidate(vecLibrary[i]);
+
+    if (vecCandidates.IsEmpty())
+        return nullptr;
+
+    vecCandidates.Sort(PrefetchPrioritySort);
+    return vecCandidates[0];
+}
+
+void CMapPrefetcher::StartPrefetch(MapData *pData)
+{
+    m_treeAttempted.Insert(pData->m_uID);
+
+    // Never overwrite anything, a same-named map on disk could be the player's own build, which is for them to decide on
+    const MapDownloadResponse response = g_pMapCache->DownloadMap(pData->m_uID, false);
+    if (response != MAP_DL_OK)
+    {
+        // Already there, or would overwrite an existing file (MAP_DL_WILL_OVERWRITE_EXISTING), try the next one on the next check
+        DevLog("Not prefetching map %s (%i)\n", pData->m_szMapName, response);
+        return;
+    }
+
+    DevLog("Prefetching map %s\n", pData->m_szMapName);
+    m_iMapsPrefetched++;
+    m_uCurrentID = pData->m_uID;
+    m_uCurrentSize = 0;
+    m_dStartTime = Plat_FloatTime();
+}
+
+void CMapPrefetcher::OnMapDownloadSize(const MapDownloadSizeEvent_t &event)
+{
+    if (!m_uCurrentID || event.m_uMapID != m_uCurrentID)
+        return;
+
+    m_uCurrentSize = event.m_uSize;
+
+    const uint64 uBudget = (uint64)mom_map_prefetch_disk_budget.GetInt() * 1024 * 1024;
+    if (m_uBytesPrefetched + m_uCurrentSize > uBudget)
+    {
+        DevLog("Prefetching map %u would go over the disk budget, cancelling it\n", m_uCurrentID);
+        m_uCurrentSize = 0;
+        g_pMapCache->CancelDownload(m_uCurrentID);
+    }
+}
+
+void CMapPrefetcher::OnMapDownloadEnd(KeyValues *pKv)
+{
+    if (!m_uCurrentID || pKv->GetInt("id") != (int) m_uCurrentID)
+        return;
+
+    const double dNow = Plat_FloatTime();
+    if (!pKv->GetBool("error"))
+        m_uBytesPrefetched += m_uCurrentSize;
+
+    // Wait long enough that this download, averaged over the time it took plus the wait, is within the bandwidth budget
+    const double dMinDuration = double(m_uCurrentSize) / (mom_map_prefetch_bandwidth.GetFloat() * 1024.0);
+    m_dNextCheckTime = max(dNow + PREFETCH_CHECK_INTERVAL, m_dStartTime + dMinDuration);
+
+    m_uCurrentID = 0;
+    m_uCurrentSize = 0;
+}
+
+static CMapPrefetcher s_MapPrefetcher;
+CMapPrefetcher *g_pMapPrefetcher = &s_MapPrefetcher;
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "igamesystem.h"
+
+struct MapData;
+struct MapDownloadSizeEvent_t;
+
+// Downloads the maps the player is likely to play next (favorites, library, recently played)
+// in the background, one at a time, so they don't have to be downloaded when they are picked.
+// Opt-in with mom_map_prefetch_enable, and kept under a bandwidth and disk budget.
+class CMapPrefetcher : public CAutoGameSystemPerFrame
+{
+  public:
+    CMapPrefetcher();
+
+    void PostInit() OVERRIDE;
+    void Shutdown() OVERRIDE;
+    void Update(float frametime) OVERRIDE;
+
+  private:
+    // The map that should be prefetched next, or nullptr if there is none
+    MapData *FindNextMap();
+    void StartPrefetch(MapData *pData);
+
+    void OnMapDownloadSize(const MapDownloadSizeEvent_t &event);
+    void OnMapDownloadEnd(KeyValues *pKv);
+
+    int m_iDownloadSizeIndx;
+    int m_iDownloadEndIndx;
+
+    double m_dNextCheckTime;
+
+    // The map currently being prefetched, 0 if none
+    uint32 m_uCurrentID;
+    double m_dStartTime;
+    uint64 m_uCurrentSize;
+
+    // Maps the prefetcher started downloading this session, counted against mom_map_prefetch_max_maps
+    int m_iMapsPrefetched;
+    // Bytes downloaded by the prefetcher this session, counted against mom_map_prefetch_disk_budget
+    uint64 m_uBytesPrefetched;
+
+    // Maps that were already tried this session, whatever the result
+    CUtlRBTree<uint32> m_treeAttempted;
+};
+
+extern CMapPrefetcher *g_pMapPrefetcher;
@@ -0,0 +1,253 @@
+#include "cbase.h"
+
+#include "mom_map_search_index.h"
+#include "mom_api_models.h"
+#include "IMapList.h"
+
+#include "tier0/memdbgon.h"
+
+#define MAKE_TRIGRAM(a, b, c) ((uint32(uint8(a)) << 16) | (uint32(uint8(b)) << 8) | uint32(uint8(c)))
+
+// First index in the sorted vector whose element is not less than val
+template <class T>
+static int LowerBound(const CUtlVector<T> &vec, T val)
+{
+    int iLow = 0, iHigh = vec.Count();
+    while (iLow < iHigh)
+    {
+        const int iMid = (iLow + iHigh) / 2;
+        if (vec[iMid] < val)
+            iLow = iMid + 1;
+        else
+            iHigh = iMid;
+    }
+    return iLow;
+}
+
+template <class T>
+static void InsertSorted(CUtlVector<T> &vec, T val)
+{
+    const int i = LowerBound(vec, val);
+    if (i == vec.Count() || vec[i] != val)
+        vec.InsertBefore(i, val);
+}
+
+template <class T>
+static void RemoveSorted(CUtlVector<T> &vec, T val)
+{
+    const int i = LowerBound(vec, val);
+    if (i < vec.Count() && vec[i] == val)
+        vec.Remove(i);
+}
+
+// Calls func for every distinct lowercase trigram of the string
+template <class F>
+static void ForEachTrigram(const char *pStr, F func)
+{
+    char szLower[MAX_MAP_NAME];
+    Q_strncpy(szLower, pStr, sizeof(szLower));
+    Q_strlower(szLower);
+
+    CUtlVector<uint32> vecSeen;
+    const int iLen = Q_strlen(szLower);
+    for (int i = 0; i + 2 < iLen; i++)
+    {
+        const uint32 trigram = MAKE_TRIGRAM(szLower[i], szLower[i + 1], szLower[i + 2]);
+        if (vecSeen.HasElement(trigram))
+            continue;
+
+        vecSeen.AddToTail(trigram);
+        func(trigram);
+    }
+}
+
+static uint64 DifficultyKey(uint8 iDifficulty, uint32 uID)
+{
+    return (uint64(iDifficulty) << 32) | uID;
+}
+
+CMapSearchIndex::CMapSearchIndex()
+{
+    SetDefLessFunc(m_mapIndexed);
+    SetDefLessFunc(m_mapTrigrams);
+}
+
+CMapSearchIndex::~CMapSearchIndex()
+{
+    Clear();
+}
+
+void CMapSearchIndex::Clear()
+{
+    m_mapIndexed.RemoveAll();
+    m_mapTrigrams.PurgeAndDeleteElements();
+    m_vecByDifficulty.RemoveAll();
+    for (int i = 0; i < GAMEMODE_COUNT; i++)
+        m_vecByGameMode[i].RemoveAll();
+    m_vecByLayout[0].RemoveAll();
+    m_vecByLayout[1].RemoveAll();
+}
+
+void CMapSearchIndex::UpdateMap(const MapData *pData)
+{
+    IndexedMap_t map;
+    Q_strncpy(map.m_szName, pData->m_szMapName, sizeof(map.m_szName));
+    map.m_iDifficulty = pData->m_MainTrack.m_iDifficulty;
+    map.m_bIsLinear = pData->m_MainTrack.m_bIsLinear;
+    map.m_eType = pData->m_eType;
+
+    const auto indx = m_mapIndexed.Find(pData->m_uID);
+    if (m_mapIndexed.IsValidIndex(indx))
+    {
+        const IndexedMap_t &old = m_mapIndexed[indx];
+        if (FStrEq(old.m_szName, map.m_szName) && old.m_iDifficulty == map.m_iDifficulty &&
+            old.m_bIsLinear == map.m_bIsLinear && old.m_eType == map.m_eType)
+            return;
+
+        RemoveFromIndex(pData->m_uID, old);
+        m_mapIndexed[indx] = map;
+    }
+    else
+    {
+        m_mapIndexed.Insert(pData->m_uID, map);
+    }
+
+    AddToIndex(pData->m_uID, map);
+}
+
+void CMapSearchIndex::AddToIndex(uint32 uID, const IndexedMap_t &map)
+{
+    ForEachTrigram(map.m_szName, [&](uint32 trigram)
+    {
+        auto indx = m_mapTrigrams.Find(trigram);
+        if (!m_mapTrigrams.IsValidIndex(indx))
+            indx = m_mapTrigrams.Insert(trigram, new CUtlVector<uint32>);
+
+        InsertSorted(*m_mapTrigrams[indx], uID);
+    });
+
+    InsertSorted(m_vecByDifficulty, DifficultyKey(map.m_iDifficulty, uID));
+    if (map.m_eType >= 0 && map.m_eType < GAMEMODE_COUNT)
+        InsertSorted(m_vecByGameMode[map.m_eType], uID);
+    InsertSorted(m_vecByLayout[map.m_bIsLinear], uID);
+}
+
+void CMapSearchIndex::RemoveFromIndex(uint32 uID, const IndexedMap_t &map)
+{
+    ForEachTrigram(map.m_szName, [&](uint32 trigram)
+    {
+        const auto indx = m_mapTrigrams.Find(trigram);
+        if (m_mapTrigrams.IsValidIndex(indx))
+            RemoveSorted(*m_mapTrigrams[indx], uID);
+    });
+
+    RemoveSorted(m_vecByDifficulty, DifficultyKey(map.m_iDifficulty, uID));
+    if (map.m_eType >= 0 && map.m_eType < GAMEMODE_COUNT)
+        RemoveSorted(m_vecByGameMode[map.m_eType], uID);
+    RemoveSorted(m_vecByLayout[map.m_bIsLinear], uID);
+}
+
+// The exact filter checks, the buckets only narrow down which maps get here
+bool CMapSearchIndex::PassesFilters(const IndexedMap_t &map, const MapFilters_t &filters) const
+{
+    if (filters.m_szMapName[0] && !Q_strstr(map.m_szName, filters.m_szMapName))
+        return false;
+
+    if (filters.m_iDifficultyLow && map.m_iDifficulty < filters.m_iDifficultyLow)
+        return false;
+
+    if (filters.m_iDifficultyHigh && map.m_iDifficulty > filters.m_iDifficultyHigh)
+        return false;
+
+    if (filters.m_iGameMode && filters.m_iGameMode != map.m_eType)
+        return false;
+
+    if (filters.m_iMapLayout && map.m_bIsLinear + 1 != filters.m_iMapLayout)
+        return false;
+
+    return true;
+}
+
+void CMapSearchIndex::FindMaps(const MapFilters_t &filters, CUtlVector<uint32> &vecIDs) const
+{
+    // Narrow it down to the smallest list of candidates any of the filters gives, then check those
+    const CUtlVector<uint32> *pCandidates = nullptr;
+
+    if (Q_strlen(filters.m_szMapName) >= 3)
+    {
+        bool bAllFound = true;
+        ForEachTrigram(filters.m_szMapName, [&](uint32 trigram)
+        {
+            const auto indx = m_mapTrigrams.Find(trigram);
+            if (!m_mapTrigrams.IsValidIndex(indx))
+            {
+                bAllFound = false;
+                return;
+            }
+
+            const CUtlVector<uint32> *pList = m_mapTrigrams[indx];
+            if (!pCandidates || pList->Count() < pCandidates->Count())
+                pCandidates = pList;
+        });
+
+        if (!bAllFound)
+            return;
+    }
+
+    if (filters.m_iGameMode > 0 && filters.m_iGameMode < GAMEMODE_COUNT)
+    {
+        const CUtlVector<uint32> *pList = &m_vecByGameMode[filters.m_iGameMode];
+        if (!pCandidates || pList->Count() < pCandidates->Count())
+            pCandidates = pList;
+    }
+
+    if (filters.m_iMapLayout == 1 || filters.m_iMapLayout == 2)
+    {
+        const CUtlVector<uint32> *pList = &m_vecByLayout[filters.m_iMapLayout - 1];
+        if (!pCandidates || pList->Count() < pCandidates->Count())
+            pCandidates = pList;
+    }
+
+    CUtlVector<uint32> vecDifficulty;
+    if (filters.m_iDifficultyLow > 0 || filters.m_iDifficultyHigh > 0)
+    {
+        const uint8 iLow = (uint8) clamp(filters.m_iDifficultyLow, 0, 255);
+        const uint8 iHigh = filters.m_iDifficultyHigh > 0 ? (uint8) clamp(filters.m_iDifficultyHigh, 0, 255) : 255;
+
+        const int iStart = LowerBound(m_vecByDifficulty, DifficultyKey(iLow, 0));
+        const int iEnd = iHigh < 255 ? LowerBound(m_vecByDifficulty, DifficultyKey(iHigh + 1, 0)) : m_vecByDifficulty.Count();
+        if (iEnd <= iStart)
+            return;
+
+        if (!pCandidates || iEnd - iStart < pCandidates->Count())
+        {
+            vecDifficulty.EnsureCapacity(iEnd - iStart);
+            for (int i = iStart; i < iEnd; i++)
+                vecDifficulty.AddToTail(uint32(m_vecByDifficulty[i] & 0xFFFFFFFF));
+
+            vecDifficulty.Sort([](const uint32 *pLeft, const uint32 *pRight) { return *pLeft < *pRight ? -1 : (*pLeft > *pRight); });
+            pCandidates = &vecDifficulty;
+        }
+    }
+
+    if (pCandidates)
+    {
+        vecIDs.EnsureCapacity(pCandidates->Count());
+        FOR_EACH_VEC(*pCandidates, i)
+        {
+            const auto indx = m_mapIndexed.Find(pCandidates->Element(i));
+            if (m_mapIndexed.IsValidIndex(indx) && PassesFilters(m_mapIndexed[indx], filters))
+                vecIDs.AddToTail(pCandidates->Element(i));
+        }
+    }
+    else
+    {
+        // Nothing to narrow it down with, every map gets checked
+        vecIDs.EnsureCapacity(m_mapIndexed.Count());
+        for (auto indx = m_mapIndexed.FirstInorder(); m_mapIndexed.IsValidIndex(indx); indx = m_mapIndexed.NextInorder(indx))
+        {
+            if (PassesFilters(m_mapIndexed[indx], filters))
+                vecIDs.AddToTail(m_mapIndexed.Key(indx));
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "mom_shareddefs.h"
+
+struct MapData;
+struct MapFilters_t;
+
+// Index over the maps in the map cache for the map selector filters, so a filter change doesn't have
+// to compare every map. Names are indexed by trigram, difficulty is kept as a sorted column, and
+// game mode and layout are bucketed. Every list of IDs in here is kept sorted.
+class CMapSearchIndex
+{
+  public:
+    CMapSearchIndex();
+    ~CMapSearchIndex();
+
+    // Adds the map, or re-indexes it if any of the indexed fields changed
+    void UpdateMap(const MapData *pData);
+    void Clear();
+
+    // Fills vecIDs, in ascending order, with the maps that pass the name, difficulty, game mode and
+    // layout filters. Anything that changes often (like completion) is left to the caller.
+    void FindMaps(const MapFilters_t &filters, CUtlVector<uint32> &vecIDs) const;
+
+  private:
+    struct IndexedMap_t
+    {
+        char m_szName[MAX_MAP_NAME];
+        uint8 m_iDifficulty;
+        bool m_bIsLinear;
+        GameMode_t m_eType;
+    };
+
+    void AddToIndex(uint32 uID, const IndexedMap_t &map);
+    void RemoveFromIndex(uint32 uID, const IndexedMap_t &map);
+
+    bool PassesFilters(const IndexedMap_t &map, const MapFilters_t &filters) const;
+
+    CUtlMap<uint32, IndexedMap_t> m_mapIndexed;
+
+    // Lowercase name trigram -> maps with it in their name
+    CUtlMap<uint32, CUtlVector<uint32> *> m_mapTrigrams;
+    // (difficulty << 32 | ID), sorted, so a difficulty range is a contiguous run
+    CUtlVector<uint64> m_vecByDifficulty;
+    CUtlVector<uint32> m_vecByGameMode[GAMEMODE_COUNT];
+    CUtlVector<uint32> m_vecByLayout[2]; // Staged, linear
+};
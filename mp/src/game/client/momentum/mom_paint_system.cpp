@@ -0,0 +1,299 @@
+#include "cbase.h"
+
+#include "mom_paint_system.h"
+#include "decals.h"
+#include "iefx.h"
+#include "util/mom_util.h"
+
+#include "tier0/vprof.h"
+
+#include "tier0/memdbgon.h"
+
+static MAKE_CONVAR(mom_paint_max_per_frame, "8", FCVAR_ARCHIVE,
+                   "Max number of paint decals applied per frame, the rest wait for the next frames. 0 = no limit\n", 0, 256);
+static MAKE_CONVAR(mom_paint_max_queued, "128", FCVAR_ARCHIVE,
+                   "Max number of paint decals waiting to be applied, the oldest ones from other players are dropped "
+                   "past this.\n", 1, 4096);
+static MAKE_CONVAR(mom_paint_merge_history, "256", FCVAR_ARCHIVE,
+                   "Number of recently applied paint decals a new one is checked against before being applied. 0 = OFF\n",
+                   0, 4096);
+static MAKE_CONVAR(mom_paint_merge_distance, "0.25", FCVAR_ARCHIVE,
+                   "A paint decal this close to a recent one of the same color and size, as a fraction of its size, "
+                   "is not applied.\n", 0.0f, 1.0f);
+static MAKE_CONVAR(mom_paint_max_decals, "512", FCVAR_ARCHIVE,
+                   "Max number of paint decals kept on the map. Past this, decals are cleared and all but the oldest "
+                   "quarter of the paint is applied again. 0 = no limit\n", 0, 2048);
+
+// Radius of the paint decal material at a scale of 1.0
+#define PAINT_DECAL_BASE_RADIUS 16.0f
+
+static CPaintSystem s_PaintSystem;
+CPaintSystem *g_pPaintSystem = &s_PaintSystem;
+
+CPaintSystem::CPaintSystem() : CAutoGameSystemPerFrame("CPaintSystem"), m_iQueuedLocal(0), m_iHistoryHead(0),
+    m_iHistoryCount(0), m_flLastScale(-1.0f)
+{
+    ResetCounters();
+}
+
+void CPaintSystem::LevelShutdownPostEntity()
+{
+    m_vecQueue.Purge();
+    m_iQueuedLocal = 0;
+    m_vecLive.Purge();
+    m_iHistoryHead = 0;
+    m_iHistoryCount = 0;
+}
+
+void CPaintSystem::QueueSplat(C_BaseEntity *pEntity, const Vector &vecOrigin, const Vector &vecStart, int iHitbox,
+                              const Color &color, float flScale, bool bLocal)
+{
+    m_iQueued++;
+
+    const int iMaxQueued = mom_paint_max_queued.GetInt();
+    if (m_vecQueue.Count() >= iMaxQueued)
+    {
+        // The oldest splat of other players is the first one after our own
+        int iDrop = m_iQueuedLocal;
+        if (iDrop >= m_vecQueue.Count())
+        {
+            // The queue is all our own paint, which is the one we keep the newest of
+            if (!bLocal)
+            {
+                m_iDropped++;
+                return;
+            }
+
+            iDrop = 0;
+        }
+
+        if (iDrop < m_iQueuedLocal)
+            m_iQueuedLocal--;
+
+        m_vecQueue.Remove(iDrop);
+        m_iDropped++;
+    }
+
+    // Our own paint goes ahead of everyone else's, so a busy lobby doesn't delay it
+    const int iIndex = bLocal ? m_vecQueue.InsertBefore(m_iQueuedLocal++) : m_vecQueue.AddToTail();
+    PaintSplat_t &splat = m_vecQueue[iIndex];
+    splat.m_hEntity = pEntity;
+    splat.m_vecOrigin = vecOrigin;
+    splat.m_vecStart = vecStart;
+    splat.m_iHitbox = iHitbox;
+    splat.m_Color = color;
+    splat.m_flScale = flScale;
+    splat.m_bLocal = bLocal;
+
+    m_iPeakQueue = Max(m_iPeakQueue, m_vecQueue.Count());
+}
+
+void CPaintSystem::Update(float frametime)
+{
+    if (m_vecQueue.IsEmpty())
+        return;
+
+    VPROF_BUDGET("CPaintSystem::Update", VPROF_BUDGETGROUP_PARTICLE_RENDERING);
+
+    ResizeHistory();
+
+    // Other code (like the paint gun settings preview) sets the material scale too, so only trust it within a batch
+    m_flLastScale = -1.0f;
+
+    const int iMaxPerFrame = mom_paint_max_per_frame.GetInt();
+    const int iMaxDecals = mom_paint_max_decals.GetInt();
+    if (!iMaxDecals)
+        m_vecLive.Purge();
+
+    int iProcessed = 0;
+    int iApplied = 0;
+    while (iProcessed < m_vecQueue.Count() && (iMaxPerFrame == 0 || iApplied < iMaxPerFrame))
+    {
+        const PaintSplat_t &splat = m_vecQueue[iProcessed++];
+
+        if (IsCoveredByRecent(splat))
+        {
+            m_iMerged++;
+            continue;
+        }
+
+        if (iMaxDecals && m_vecLive.Count() >= iMaxDecals)
+            EvictOldest(iMaxDecals);
+
+        if (ApplySplat(splat))
+        {
+            RememberSplat(splat);
+            if (iMaxDecals)
+                m_vecLive.AddToTail(splat);
+            iApplied++;
+        }
+    }
+
+    m_vecQueue.RemoveMultipleFromHead(iProcessed);
+    m_iQueuedLocal = Max(m_iQueuedLocal - iProcessed, 0);
+    m_iApplied += iApplied;
+}
+
+bool CPaintSystem::IsCoveredByRecent(const PaintSplat_t &splat) const
+{
+    if (!m_iHistoryCount || !splat.m_hEntity.Get())
+        return false;
+
+    const int iEntIndex = splat.m_hEntity->entindex();
+    const float flRadius = PAINT_DECAL_BASE_RADIUS * splat.m_flScale;
+    const float flMergeDist = mom_paint_merge_distance.GetFloat() * flRadius;
+    const float flMergeDistSqr = flMergeDist * flMergeDist;
+
+    // Newest first, a different splat painted over the spot since means this one would still show
+    const int iSize = m_vecHistory.Count();
+    for (int i = 1; i <= m_iHistoryCount; i++)
+    {
+        const AppliedSplat_t &applied = m_vecHistory[(m_iHistoryHead - i + iSize) % iSize];
+        if (applied.m_iEntIndex != iEntIndex)
+            continue;
+
+        const float flDistSqr = applied.m_vecOrigin.DistToSqr(splat.m_vecOrigin);
+        if (applied.m_Color == splat.m_Color && CloseEnough(applied.m_flScale, splat.m_flScale))
+        {
+            if (flDistSqr <= flMergeDistSqr)
+                return true;
+        }
+        else
+        {
+            const float flOverlapDist = flRadius + PAINT_DECAL_BASE_RADIUS * applied.m_flScale;
+            if (flDistSqr < flOverlapDist * flOverlapDist)
+                return false;
+        }
+    }
+
+    return false;
+}
+
+bool CPaintSystem::ApplySplat(const PaintSplat_t &splat)
+{
+    C_BaseEntity *pEntity = splat.m_hEntity.Get();
+    if (!pEntity)
+        return false;
+
+    const int decalNumber = decalsystem->GetDecalIndexForName("Painting");
+    if (decalNumber == -1)
+        return false;
+
+    // The scale lives on the shared paint material, so only touch it when it actually changes
+    if (!CloseEnough(m_flLastScale, splat.m_flScale))
+    {
+        MomUtil::UpdatePaintDecalScale(splat.m_flScale);
+        m_flLastScale = splat.m_flScale;
+    }
+
+    // Setup our shot information
+    Vector shotDir = splat.m_vecOrigin - splat.m_vecStart;
+    const float flLength = VectorNormalize(shotDir);
+    Vector traceExt;
+    VectorMA(splat.m_vecStart, flLength + 8.0f, shotDir, traceExt);
+
+    trace_t tr;
+    memset(&tr, 0, sizeof(trace_t));
+    tr.fraction = 1.0f;
+
+    if (pEntity->entindex() == 0 && splat.m_iHitbox != 0)
+    {
+        staticpropmgr->AddColorDecalToStaticProp(splat.m_vecStart, traceExt, splat.m_iHitbox - 1, decalNumber, true, tr,
+                                                 true, splat.m_Color);
+    }
+    else
+    {
+        pEntity->AddColoredDecal(splat.m_vecStart, traceExt, splat.m_vecOrigin, splat.m_iHitbox, decalNumber, true, tr,
+                                 splat.m_Color, ADDDECAL_TO_ALL_LODS, splat.m_bLocal ? 0x01 : 0);
+    }
+
+    return true;
+}
+
+void CPaintSystem::RememberSplat(const PaintSplat_t &splat)
+{
+    if (m_vecHistory.IsEmpty())
+        return;
+
+    AppliedSplat_t &applied = m_vecHistory[m_iHistoryHead];
+    applied.m_iEntIndex = splat.m_hEntity->entindex();
+    applied.m_vecOrigin = splat.m_vecOrigin;
+    applied.m_Color = splat.m_Color;
+    applied.m_flScale = splat.m_flScale;
+
+    m_iHistoryHead = (m_iHistoryHead + 1) % m_vecHistory.Count();
+    m_iHistoryCount = Min(m_iHistoryCount + 1, m_vecHistory.Count());
+}
+
+void CPaintSystem::ResizeHistory()
+{
+    const int iSize = mom_paint_merge_history.GetInt();
+    if (iSize == m_vecHistory.Count())
+        return;
+
+    // Forget what was remembered rather than reshuffle the ring, it only costs a few unmerged splats
+    m_vecHistory.SetCount(iSize);
+    m_iHistoryHead = 0;
+    m_iHistoryCount = 0;
+}
+
+void CPaintSystem::EvictOldest(int iMaxDecals)
+{
+    VPROF_BUDGET("CPaintSystem::EvictOldest", VPROF_BUDGETGROUP_PARTICLE_RENDERING);
+
+    // Make room for a quarter of the cap at once, so this only happens every so often
+    const int iEvict = Min(m_vecLive.Count() - iMaxDecals + Max(iMaxDecals / 4, 1), m_vecLive.Count());
+    m_vecLive.RemoveMultipleFromHead(iEvict);
+    m_iEvicted += iEvict;
+    m_iEvictions++;
+
+    // The engine can't remove a single decal, so clear them all and paint back the ones we keep, oldest first
+    engine->ExecuteClientCmd("r_cleardecals");
+
+    // The merge history could point at decals that are gone now
+    m_iHistoryHead = 0;
+    m_iHistoryCount = 0;
+
+    for (int i = 0; i < m_vecLive.Count();)
+    {
+        if (ApplySplat(m_vecLive[i]))
+        {
+            RememberSplat(m_vecLive[i]);
+            i++;
+        }
+        else
+        {
+            // Whatever it was painted on is gone
+            m_vecLive.Remove(i);
+        }
+    }
+}
+
+void CPaintSystem::PrintCounters() const
+{
+    Msg("Queued: %i (peak %i), applied: %i, merged: %i, dropped: %i\n", m_vecQueue.Count(), m_iPeakQueue, m_iApplied,
+        m_iMerged, m_iDropped);
+    Msg("Live: %i, evicted: %i (in %i clears)\n", m_vecLive.Count(), m_iEvicted, m_iEvictions);
+    Msg("Total splats received: %i\n", m_iQueued);
+}
+
+void CPaintSystem::ResetCounters()
+{
+    m_iQueued = 0;
+    m_iApplied = 0;
+    m_iMerged = 0;
+    m_iDropped = 0;
+    m_iEvicted = 0;
+    m_iEvictions = 0;
+    m_iPeakQueue = 0;
+}
+
+CON_COMMAND(mom_paint_print, "Prints how many paint decals were applied, merged, dropped and evicted.\n")
+{
+    g_pPaintSystem->PrintCounters();
+}
+
+CON_COMMAND(mom_paint_reset, "Resets the paint decal counters.\n")
+{
+    g_pPaintSystem->ResetCounters();
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "igamesystem.h"
+
+// Batches paint gun decals. Every splat used to be pushed into the engine the moment its effect arrived,
+// so a lobby painting together would spend a frame's worth of decal work whenever several players fired at
+// once, and fill the engine's decal pool with splats painted over the exact same spot. Splats are now
+// queued and applied a capped number per frame, and a splat landing on top of a recent one of the same
+// color and size is dropped since it wouldn't change what's on the surface. The number of paint decals on
+// the map is capped too, so they don't push out each other (and every other decal) in whatever order the
+// engine's decal pools recycle them.
+class CPaintSystem : public CAutoGameSystemPerFrame
+{
+  public:
+    CPaintSystem();
+
+    void LevelShutdownPostEntity() OVERRIDE;
+    void Update(float frametime) OVERRIDE;
+
+    // bLocal splats are the local player's own, which go ahead of other players' and are never dropped from a full queue
+    void QueueSplat(C_BaseEntity *pEntity, const Vector &vecOrigin, const Vector &vecStart, int iHitbox,
+                    const Color &color, float flScale, bool bLocal);
+
+    void PrintCounters() const;
+    void ResetCounters();
+
+  private:
+    struct PaintSplat_t
+    {
+        EHANDLE m_hEntity;
+        Vector m_vecOrigin;
+        Vector m_vecStart;
+        int m_iHitbox;
+        Color m_Color;
+        float m_flScale;
+        bool m_bLocal;
+    };
+
+    // Applied splats remembered for merging, just enough to recognize a repeat
+    struct AppliedSplat_t
+    {
+        int m_iEntIndex;
+        Vector m_vecOrigin;
+        Color m_Color;
+        float m_flScale;
+    };
+
+    bool IsCoveredByRecent(const PaintSplat_t &splat) const;
+    bool ApplySplat(const PaintSplat_t &splat);
+    void RememberSplat(const PaintSplat_t &splat);
+    void ResizeHistory();
+    void EvictOldest(int iMaxDecals);
+
+    CUtlVector<PaintSplat_t> m_vecQueue;
+    int m_iQueuedLocal; // The local player's splats are kept at the head of the queue, this many of them
+
+    CUtlVector<PaintSplat_t> m_vecLive; // Applied splats that should still be on the map, oldest first
+
+    CUtlVector<AppliedSplat_t> m_vecHistory; // Ring buffer, sized by mom_paint_merge_history
+    int m_iHistoryHead;
+    int m_iHistoryCount;
+
+    float m_flLastScale; // Scale the paint material was set to during this batch, -1 if not yet
+
+    int m_iQueued;
+    int m_iApplied;
+    int m_iMerged;
+    int m_iDropped;
+    int m_iEvicted;
+    int m_iEvictions;
+    int m_iPeakQueue;
+};
+
+extern CPaintSystem *g_pPaintSystem;
@@ -0,0 +1,117 @@
+#include "cbase.h"
+
+#include "mom_run_splits.h"
+
+#include "tier0/memdbgon.h"
+
+int SplitStatForComparison(ComparisonString_t type)
+{
+    for (int i = 0; i < SPLIT_STAT_COUNT; i++)
+    {
+        if (type == (1 << i))
+            return i;
+    }
+
+    return -1;
+}
+
+CRunSplitTable::CRunSplitTable() : m_iZones(0), m_pRun(nullptr), m_bRunVel2D(false), m_iRunZone(0)
+{
+    V_memset(&m_ScratchSplit, 0, sizeof(m_ScratchSplit));
+}
+
+// Same values C_RunComparisons::GetComparisonString always read out of the stats
+void CRunSplitTable::GetStats(CMomRunStats *pStats, int zone, bool bVel2D, float *pOut)
+{
+    pOut[SPLIT_TIME_OVERALL] = pStats->GetZoneEnterTick(zone + 1);
+    pOut[SPLIT_ZONE_TIME] = pStats->GetZoneTicks(zone);
+    pOut[SPLIT_VELOCITY_AVERAGE] = pStats->GetZoneVelocityAvg(zone, bVel2D);
+    pOut[SPLIT_VELOCITY_MAX] = pStats->GetZoneVelocityMax(zone, bVel2D);
+    pOut[SPLIT_VELOCITY_ENTER] = pStats->GetZoneEnterSpeed(zone, bVel2D);
+    pOut[SPLIT_VELOCITY_EXIT] = pStats->GetZoneExitSpeed(zone, bVel2D);
+    pOut[SPLIT_ZONE_SYNC1] = pStats->GetZoneStrafeSyncAvg(zone);
+    pOut[SPLIT_ZONE_SYNC2] = pStats->GetZoneStrafeSync2Avg(zone);
+    pOut[SPLIT_ZONE_JUMPS] = pStats->GetZoneJumps(zone);
+    pOut[SPLIT_ZONE_STRAFES] = pStats->GetZoneStrafes(zone);
+}
+
+void CRunSplitTable::SetComparison(RunCompare_t *pCompare)
+{
+    Clear();
+
+    if (!pCompare)
+        return;
+
+    CMomRunStats *pStats = &pCompare->runStats;
+    m_iZones = pStats->GetTotalZones();
+    m_vecCompare.SetCount(m_iZones * 2 * SPLIT_STAT_COUNT);
+    for (int zone = 0; zone < m_iZones; zone++)
+    {
+        GetStats(pStats, zone, false, &m_vecCompare[(zone * 2) * SPLIT_STAT_COUNT]);
+        GetStats(pStats, zone, true, &m_vecCompare[(zone * 2 + 1) * SPLIT_STAT_COUNT]);
+    }
+}
+
+void CRunSplitTable::Clear()
+{
+    m_vecCompare.RemoveAll();
+    m_iZones = 0;
+
+    m_pRun = nullptr;
+    m_iRunZone = 0;
+    m_vecRunSplits.RemoveAll();
+}
+
+void CRunSplitTable::ComputeSplit(CMomRunStats *pRun, int zone, bool bVel2D, ZoneSplit_t &split) const
+{
+    GetStats(pRun, zone, bVel2D, split.m_flActual);
+
+    if (zone >= 0 && zone < m_iZones)
+    {
+        const float *pCompare = &m_vecCompare[(zone * 2 + bVel2D) * SPLIT_STAT_COUNT];
+        for (int i = 0; i < SPLIT_STAT_COUNT; i++)
+            split.m_flDelta[i] = split.m_flActual[i] - pCompare[i];
+    }
+    else
+    {
+        // The comparison never got this far
+        for (int i = 0; i < SPLIT_STAT_COUNT; i++)
+            split.m_flDelta[i] = split.m_flActual[i];
+    }
+}
+
+void CRunSplitTable::UpdateRun(CMomRunStats *pRun, int iCurrentZone, bool bVel2D)
+{
+    if (!pRun || !HasComparison())
+        return;
+
+    const int iLastZone = Min(iCurrentZone - 1, MAX_ZONES - 1);
+
+    // Different run, or this one restarted: nothing cached can be trusted
+    if (pRun != m_pRun || bVel2D != m_bRunVel2D || iLastZone < m_iRunZone)
+    {
+        m_pRun = pRun;
+        m_bRunVel2D = bVel2D;
+        m_iRunZone = 0;
+    }
+
+    if (iLastZone < 1)
+        return;
+
+    if (m_vecRunSplits.Count() <= iLastZone)
+        m_vecRunSplits.SetCount(iLastZone + 1);
+
+    for (int zone = Max(m_iRunZone, 1); zone <= iLastZone; zone++)
+        ComputeSplit(pRun, zone, bVel2D, m_vecRunSplits[zone]);
+
+    m_iRunZone = iLastZone;
+}
+
+const ZoneSplit_t &CRunSplitTable::GetSplit(CMomRunStats *pRun, int zone, bool bVel2D)
+{
+    if (pRun == m_pRun && bVel2D == m_bRunVel2D && zone >= 1 && zone <= m_iRunZone)
+        return m_vecRunSplits[zone];
+
+    ComputeSplit(pRun, zone, bVel2D, m_ScratchSplit);
+    return m_ScratchSplit;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "run/run_compare.h"
+
+// Index of each comparable stat in a split, in the same order as the ComparisonString_t bits
+enum SplitStat_t
+{
+    SPLIT_TIME_OVERALL = 0,
+    SPLIT_ZONE_TIME,
+    SPLIT_VELOCITY_AVERAGE,
+    SPLIT_VELOCITY_MAX,
+    SPLIT_VELOCITY_ENTER,
+    SPLIT_VELOCITY_EXIT,
+    SPLIT_ZONE_SYNC1,
+    SPLIT_ZONE_SYNC2,
+    SPLIT_ZONE_JUMPS,
+    SPLIT_ZONE_STRAFES,
+
+    SPLIT_STAT_COUNT
+};
+
+// The SplitStat_t of a comparison string, -1 for the ones that are only labels
+int SplitStatForComparison(ComparisonString_t type);
+
+struct ZoneSplit_t
+{
+    float m_flActual[SPLIT_STAT_COUNT]; // Times are in ticks
+    float m_flDelta[SPLIT_STAT_COUNT];  // Actual minus the comparison's
+};
+
+// A comparison run's stats flattened into a zone x stat table, along with the current run's splits
+// against it. The run's splits are cached per zone and only the zones it has just left get computed.
+class CRunSplitTable
+{
+  public:
+    CRunSplitTable();
+
+    void SetComparison(RunCompare_t *pCompare);
+    void Clear();
+    bool HasComparison() const { return m_iZones > 0; }
+
+    // Brings the cached splits of pRun, which is currently in iCurrentZone, up to date. The zone that was
+    // just left is recomputed on every call as well, since its stats can settle a tick after the zone change.
+    void UpdateRun(CMomRunStats *pRun, int iCurrentZone, bool bVel2D);
+
+    // The split of pRun for the zone. The run given to UpdateRun gets its cached split for zones it has
+    // left, anything else (like the zone it's still in) is computed on the spot.
+    const ZoneSplit_t &GetSplit(CMomRunStats *pRun, int zone, bool bVel2D);
+
+  private:
+    void ComputeSplit(CMomRunStats *pRun, int zone, bool bVel2D, ZoneSplit_t &split) const;
+    static void GetStats(CMomRunStats *pStats, int zone, bool bVel2D, float *pOut);
+
+    // [zone][vel2D][stat] of the comparison run
+    CUtlVector<float> m_vecCompare;
+    int m_iZones;
+
+    CMomRunStats *m_pRun;
+    bool m_bRunVel2D;
+    int m_iRunZone; // The splits of zones 1 up to this one are cached
+    CUtlVector<ZoneSplit_t> m_vecRunSplits;
+
+    ZoneSplit_t m_ScratchSplit;
+};
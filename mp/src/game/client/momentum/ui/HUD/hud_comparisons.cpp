@@ -13,6 +13,7 @@
 #include "mom_shareddefs.h"
 #include "momentum/util/mom_util.h"
 #include "c_mom_replay_entity.h"
+#include "mom_comparison_targets.h"
 
 #include "tier0/memdbgon.h"
 
@@ -21,6 +22,11 @@ using namespace vgui;
 // Overall visibility
 static MAKE_TOGGLE_CONVAR(mom_comparisons, "1", FLAG_HUD_CVAR, "Shows the run comparison panel. 0 = OFF, 1 = ON");
 
+// Target
+static MAKE_CONVAR(mom_comparisons_target, "0", FLAG_HUD_CVAR,
+                   "Run to compare against: 0 = personal best, 1 = world record, 2 = fastest friend. "
+                   "The personal best is shown while the others load, or if there are none.", 0, 2);
+
 // Max stages
 static MAKE_CONVAR(mom_comparisons_max_zones, "4", FLAG_HUD_CVAR,
                    "Max number of zones to show on the comparison panel.", 1, 10);
@@ -91,10 +97,17 @@ C_RunComparisons::C_RunComparisons(const char *pElementName, Panel *pParent /* =
     m_nCurrentBogusPulse = 0;
     m_fLoadedTickRate = 0.0f;
     m_iLoadedRunFlags = 0;
+    m_iLoadedTrack = -1;
+    m_iLoadedTarget = COMPARISON_TARGET_PB;
+    m_iTargetsVersion = 0;
     m_bLoadedBogusComparison = false;
     m_pRunStats = nullptr;
     m_pBogusRunStats = nullptr;
+    m_rcCurrentComparison = nullptr;
     m_rcBogusComparison = nullptr;
+    m_iComparisonVersion = 0;
+    m_pRunData = nullptr;
+    m_iTextCount = 0;
 }
 
 C_RunComparisons::~C_RunComparisons() { UnloadComparisons(); }
@@ -130,6 +143,7 @@ void C_RunComparisons::Reset()
     m_iMaxWide = m_iDefaultWidth;
     m_iWidestLabel = 0;
     m_iWidestValue = 0;
+    m_TextDeps.Invalidate();
 
     // LOCALIZE STUFF HERE
     FIND_LOCALIZATION(m_wStage, "#MOM_Stage");
@@ -157,14 +171,62 @@ void C_RunComparisons::LoadComparisons()
 
         const float tickRate = pRunData->m_flTickRate;
         const int runFlags = pRunData->m_iRunFlags;
+        const int track = pRunData->m_iCurrentTrack;
+
+        if (!CloseEnough(tickRate, m_fLoadedTickRate) || runFlags != m_iLoadedRunFlags || track != m_iLoadedTrack)
+        {
+            // What's loaded is for another category
+            UnloadComparisons();
+            m_fLoadedTickRate = tickRate;
+            m_iLoadedRunFlags = runFlags;
+            m_iLoadedTrack = track;
+        }
+
+        // These load in the background, UpdateComparisonTarget picks them up when they're done
+        const auto target = static_cast<ComparisonTarget_t>(mom_comparisons_target.GetInt());
+        g_pComparisonTargets->Request(target, szMapName, track, tickRate, runFlags);
+        if (target != COMPARISON_TARGET_PB)
+            g_pComparisonTargets->Request(COMPARISON_TARGET_PB, szMapName, track, tickRate, runFlags);
+
+        m_iLoadedTarget = target;
+        UpdateComparisonTarget();
+    }
+}
 
-        if (!m_bLoadedComparison || !CloseEnough(tickRate, m_fLoadedTickRate) || runFlags != m_iLoadedRunFlags)
+void C_RunComparisons::ReloadComparisons()
+{
+    g_pComparisonTargets->Invalidate(COMPARISON_TARGET_PB);
+    LoadComparisons();
+}
+
+void C_RunComparisons::UpdateComparisonTarget()
+{
+    m_iTargetsVersion = g_pComparisonTargets->GetVersion();
+
+    RunCompare_t *pResult = g_pComparisonTargets->GetResult(static_cast<ComparisonTarget_t>(m_iLoadedTarget));
+    if (!pResult)
+        pResult = g_pComparisonTargets->GetResult(COMPARISON_TARGET_PB);
+
+    if (!pResult)
+    {
+        // Keep showing what we have while something is still loading, but drop it once there's nothing
+        // to compare against anymore (like after deleting the only replay)
+        if (g_pComparisonTargets->GetState(static_cast<ComparisonTarget_t>(m_iLoadedTarget)) != TARGET_STATE_LOADING &&
+            g_pComparisonTargets->GetState(COMPARISON_TARGET_PB) != TARGET_STATE_LOADING)
         {
             UnloadComparisons();
-            m_rcCurrentComparison = new RunCompare_t();
-            m_bLoadedComparison = MomUtil::GetRunComparison(szMapName, tickRate, pRunData->m_iCurrentTrack, runFlags, m_rcCurrentComparison);
         }
+        return;
     }
+
+    if (!m_rcCurrentComparison)
+        m_rcCurrentComparison = new RunCompare_t();
+
+    MomUtil::FillRunComparison(pResult->runName, &pResult->runStats, m_rcCurrentComparison);
+    m_bLoadedComparison = true;
+    m_iComparisonVersion++;
+    m_Splits.SetComparison(m_rcCurrentComparison);
+    m_TextDeps.Invalidate();
 }
 
 inline void GenerateBogusRunStats(CMomRunStats *pStatsOut)
@@ -207,6 +269,9 @@ void C_RunComparisons::LoadBogusComparisons()
     Q_strncpy(m_rcBogusComparison->runName, bogusRunANSI, sizeof(m_rcBogusComparison->runName));
 
     m_bLoadedBogusComparison = true;
+    m_iComparisonVersion++;
+    m_Splits.SetComparison(m_rcBogusComparison);
+    m_TextDeps.Invalidate();
 }
 
 void C_RunComparisons::UnloadBogusComparisons()
@@ -221,6 +286,8 @@ void C_RunComparisons::UnloadBogusComparisons()
     m_rcBogusComparison = nullptr;
 
     m_bLoadedBogusComparison = false;
+    m_iComparisonVersion++;
+    m_Splits.Clear();
 }
 
 void C_RunComparisons::UnloadComparisons()
@@ -231,6 +298,8 @@ void C_RunComparisons::UnloadComparisons()
     m_rcCurrentComparison = nullptr;
 
     m_bLoadedComparison = false;
+    m_iComparisonVersion++;
+    m_Splits.Clear();
 }
 
 void C_RunComparisons::LevelInitPostEntity()
@@ -251,14 +320,19 @@ void C_RunComparisons::FireGameEvent(IGameEvent *event)
     if (event->GetBool("save"))
     {
         // Reload upon setting a new run (ideally this would be if it's a PB but meh)
-        LoadComparisons();
+        ReloadComparisons();
     }
 }
 
 void C_RunComparisons::OnThink()
 {
-    if (!m_bLoadedComparison)
+    HUD_PROFILE_SCOPE("Comparisons", HUD_PROFILE_THINK);
+
+    if (m_bLoadedBogusComparison)
+    {
+        m_Splits.UpdateRun(m_pBogusRunStats, GetCurrentZone(), m_cvarVelType.GetBool());
         return;
+    }
 
     const auto pPlayer = C_MomentumPlayer::GetLocalMomPlayer();
     if (pPlayer)
@@ -267,6 +341,22 @@ void C_RunComparisons::OnThink()
         m_pRunData = pPlayer->GetCurrentUIEntData();
     }
 
+    if (m_pRunData && (!CloseEnough(m_pRunData->m_flTickRate, m_fLoadedTickRate) || m_pRunData->m_iRunFlags != m_iLoadedRunFlags ||
+                       m_pRunData->m_iCurrentTrack != m_iLoadedTrack || mom_comparisons_target.GetInt() != m_iLoadedTarget))
+    {
+        LoadComparisons();
+    }
+    else if (g_pComparisonTargets->GetVersion() != m_iTargetsVersion)
+    {
+        UpdateComparisonTarget();
+    }
+
+    if (!m_bLoadedComparison)
+        return;
+
+    // Only does the zones the run just left, the panel and the other HUD elements read the splits from here
+    m_Splits.UpdateRun(m_pRunStats, GetCurrentZone(), m_cvarVelType.GetBool());
+
     if (!mom_comparisons_time_show_overall.GetBool() && !mom_comparisons_time_show_perzone.GetBool())
     {
         // Uh oh, both overall and perstage were turned off, let's turn back on the one they want to compare
@@ -364,32 +454,20 @@ void C_RunComparisons::GetComparisonString(ComparisonString_t type, CMomRunStats
 {
     if (!stats)
         return;
-    int velType = m_cvarVelType.GetInt(); // Type of velocity comparison we're making (3D vs Horizontal)
-    float diff = 0.0f;                 // Difference between the current and the compared-to.
-    float act;                         // Actual value that the player has for this zone.
+    const int stat = SplitStatForComparison(type);
+    if (stat < 0)
+        return;
+
+    // The velocity stats depend on the type of velocity comparison we're making (3D vs Horizontal)
+    const ZoneSplit_t &split = m_Splits.GetSplit(stats, zone, m_cvarVelType.GetBool());
+    const float act = split.m_flActual[stat]; // Actual value that the player has for this zone.
+    float diff = LoadedComparison() ? split.m_flDelta[stat] : 0.0f; // Difference between the current and the compared-to.
     char tempANSITimeOutput[BUFSIZETIME],
         tempANSITimeActual[BUFSIZETIME]; // Only used for time comparisons, ignored otherwise.
     char diffChar = '\0';                // The character used for showing the diff: + or -
 
-    switch (type)
+    if (type == TIME_OVERALL || type == ZONE_TIME)
     {
-    case TIME_OVERALL:
-    case ZONE_TIME:
-        // Get the time difference in seconds.
-        act = type == TIME_OVERALL ? stats->GetZoneEnterTick(zone + 1) : stats->GetZoneTicks(zone);
-
-        if (LoadedComparison())
-        {
-            if (type == TIME_OVERALL)
-            {
-                diff = act - GetRunComparisons()->runStats.GetZoneEnterTick(zone + 1);
-            }
-            else
-            {
-                diff = act - GetRunComparisons()->runStats.GetZoneTicks(zone);
-            }
-        }
-
         // Are we losing time compared to the run?
         // If diff > 0, that means you're falling behind (losing time to) your PB!
 
@@ -397,50 +475,6 @@ void C_RunComparisons::GetComparisonString(ComparisonString_t type, CMomRunStats
         MomUtil::FormatTime(act * gpGlobals->interval_per_tick, tempANSITimeActual);
         if (LoadedComparison())
             MomUtil::FormatTime(diff * gpGlobals->interval_per_tick, tempANSITimeOutput);
-        break;
-    case VELOCITY_AVERAGE:
-        // Get the vel difference
-        act = stats->GetZoneVelocityAvg(zone, velType);
-        if (LoadedComparison())
-            diff = act - GetRunComparisons()->runStats.GetZoneVelocityAvg(zone, velType);
-        break;
-    case VELOCITY_EXIT:
-        act = stats->GetZoneExitSpeed(zone, velType);
-        if (LoadedComparison())
-            diff = act - GetRunComparisons()->runStats.GetZoneExitSpeed(zone, velType);
-        break;
-    case VELOCITY_MAX:
-        act = stats->GetZoneVelocityMax(zone, velType);
-        if (LoadedComparison())
-            diff = act - GetRunComparisons()->runStats.GetZoneVelocityMax(zone, velType);
-        break;
-    case VELOCITY_ENTER:
-        act = stats->GetZoneEnterSpeed(zone, velType);
-        if (LoadedComparison())
-            diff = act - GetRunComparisons()->runStats.GetZoneEnterSpeed(zone, velType);
-        break;
-    case ZONE_SYNC1:
-        act = stats->GetZoneStrafeSyncAvg(zone);
-        if (LoadedComparison())
-            diff = act - GetRunComparisons()->runStats.GetZoneStrafeSyncAvg(zone);
-        break;
-    case ZONE_SYNC2:
-        act = stats->GetZoneStrafeSync2Avg(zone);
-        if (LoadedComparison())
-            diff = act - GetRunComparisons()->runStats.GetZoneStrafeSync2Avg(zone);
-        break;
-    case ZONE_JUMPS:
-        act = stats->GetZoneJumps(zone);
-        if (LoadedComparison())
-            diff = act - GetRunComparisons()->runStats.GetZoneJumps(zone);
-        break;
-    case ZONE_STRAFES:
-        act = stats->GetZoneStrafes(zone);
-        if (LoadedComparison())
-            diff = act - GetRunComparisons()->runStats.GetZoneStrafes(zone);
-        break;
-    default:
-        return;
     }
 
     if (LoadedComparison())
@@ -484,22 +518,13 @@ void C_RunComparisons::GetComparisonString(ComparisonString_t type, CMomRunStats
     }
 }
 
-void C_RunComparisons::DrawComparisonString(ComparisonString_t string, int stage, int Ypos)
+void C_RunComparisons::AddComparisonString(ComparisonString_t string, int stage, int Ypos)
 {
     Color fgColor = GetFgColor();
-    // We override the color here from HUD animations, if this is a bogus comparisons panel
-    if (m_bLoadedBogusComparison)
-    {
-        int alpha = (m_nCurrentBogusPulse & string) ? bogus_alpha : fgColor.a();
-        fgColor = Color(fgColor.r(), fgColor.g(), fgColor.b(), alpha);
-    }
     Color compareColor = fgColor;
     char actualValueANSI[BUFSIZELOCL],       // The actual value of the run
         compareTypeANSI[BUFSIZELOCL],        // The label of the comparison "Velocity: " etc
         compareValueANSI[BUFSIZELOCL];       // The comparison string (+/- XX)
-    wchar_t actualValueUnicode[BUFSIZELOCL], // Unicode of actual value
-        compareTypeUnicode[BUFSIZELOCL],     // Unicode of the label of the comparison type
-        compareValueUnicode[BUFSIZELOCL];    // Unicode of the comparison value
     char *localized = nullptr;
     switch (string)
     {
@@ -538,38 +563,27 @@ void C_RunComparisons::DrawComparisonString(ComparisonString_t string, int stage
 
     if (!localized)
     {
-        DevWarning("C_HudComparisons::DrawComparisonString: localized was not set!!!\n");
+        DevWarning("C_HudComparisons::AddComparisonString: localized was not set!!!\n");
         return;
     }
 
     // Obtain the actual value, comparison string, and corresponding color
     GetComparisonString(string, GetRunStats(), stage, actualValueANSI, compareValueANSI, &compareColor);
 
-    // Override the color if we're a bogus panel
-    if (m_bLoadedBogusComparison)
-    {
-        int alphaComp = (m_nCurrentBogusPulse & string) ? bogus_alpha : compareColor.a();
-        compareColor = Color(compareColor.r(), compareColor.g(), compareColor.b(), alphaComp);
-    }
-
     // Pad the compare type with a couple spaces in front.
     V_snprintf(compareTypeANSI, BUFSIZELOCL, "  %s", localized);
 
-    // Convert compare type to Unicode
-    ANSI_TO_UNICODE(compareTypeANSI, compareTypeUnicode);
+    // The compare type "Velocity:"/"Stage Time:" etc, standard color and position
+    ComparisonText_t &compareType = AddText(text_xpos, Ypos, fgColor, string);
+    compareType.m_Text.SetText(compareTypeANSI);
 
-    // Print the compare type "Velocity:"/"Stage Time:" etc
-    surface()->DrawSetTextColor(fgColor);       // Standard text color
-    surface()->DrawSetTextPos(text_xpos, Ypos); // Standard position
-    surface()->DrawPrintText(compareTypeUnicode, wcslen(compareTypeUnicode));
-
-    // Convert actual value ANSI to unicode
-    ANSI_TO_UNICODE(actualValueANSI, actualValueUnicode);
+    ComparisonText_t &actualValue = AddText(0, Ypos, fgColor, string);
+    actualValue.m_Text.SetText(actualValueANSI);
 
     // Find the x position for the actual value and comparison value
     int newXPosActual, newXPosComparison;
-    int widthOfCompareType = UTIL_ComputeStringWidth(m_hTextFont, compareTypeANSI);
-    int widthOfActualValue = UTIL_ComputeStringWidth(m_hTextFont, actualValueANSI);
+    int widthOfCompareType = compareType.m_Text.GetWidth(m_hTextFont);
+    int widthOfActualValue = actualValue.m_Text.GetWidth(m_hTextFont);
 
     // Now we need to decide if we're formatting or not.
     if (mom_comparisons_format_output.GetBool())
@@ -591,23 +605,14 @@ void C_RunComparisons::DrawComparisonString(ComparisonString_t string, int stage
         newXPosComparison = newXPosActual + widthOfActualValue + 2;
     }
 
-    // Draw the actual value
-    surface()->DrawSetTextPos(newXPosActual, Ypos);
-    surface()->DrawPrintText(actualValueUnicode, wcslen(actualValueUnicode));
-
-    // Draw the comparison value
-    // But first see if this changes our max width for the panel
-    SetMaxWide(newXPosComparison                                        // X pos for the comparison
-               + UTIL_ComputeStringWidth(m_hTextFont, compareValueANSI) // Width of the compare string
-               + 2);                                                    // Padding
+    actualValue.m_iXPos = newXPosActual;
 
-    // Convert the comparison value to unicode
-    ANSI_TO_UNICODE(compareValueANSI, compareValueUnicode);
+    // The comparison, in the gain/loss color
+    ComparisonText_t &compareValue = AddText(newXPosComparison, Ypos, compareColor, string);
+    compareValue.m_Text.SetText(compareValueANSI);
 
-    // Print the comparison
-    surface()->DrawSetTextColor(compareColor);                                  // Set the color to gain/loss color
-    surface()->DrawSetTextPos(newXPosComparison, Ypos);                         // Set pos to calculated width X
-    surface()->DrawPrintText(compareValueUnicode, wcslen(compareValueUnicode)); // print string
+    // See if this changes our max width for the panel
+    SetMaxWide(newXPosComparison + compareValue.m_Text.GetWidth(m_hTextFont) + 2);
 }
 
 void C_RunComparisons::SetMaxWide(int newWide)
@@ -627,6 +632,7 @@ void C_RunComparisons::ApplySchemeSettings(vgui::IScheme* pScheme)
     GetSize(m_iDefaultWidth, m_iDefaultTall); //gets "wide" and "tall" from scheme .res file
     m_iMaxWide = m_iDefaultWidth;
     GetPos(m_iDefaultXPos, m_iDefaultYPos); //gets "xpos" and "ypos" from scheme .res file
+    m_TextDeps.Invalidate();
 }
 
 int C_RunComparisons::GetCurrentZone() const
@@ -634,17 +640,9 @@ int C_RunComparisons::GetCurrentZone() const
     return m_bLoadedBogusComparison ? m_pBogusRunStats->GetTotalZones() - 1 : (m_bLoadedComparison && m_pRunData) ? m_pRunData->m_iCurrentZone : 0;
 }
 
-void C_RunComparisons::Paint()
+void C_RunComparisons::RebuildText()
 {
-    if (!GetRunComparisons())
-        return;
-
-    // MOM_TODO: Linear maps will have checkpoints, which rid the exit velocity stat, which affects maxTall
-    int maxTall = GetMaximumTall();
-    int newY = m_iDefaultYPos + (m_iDefaultTall - maxTall);
-    if (!m_bLoadedBogusComparison)
-        SetPos(m_iDefaultXPos, newY);  // Dynamic placement, only when it's not bogus
-    SetPanelSize(m_iMaxWide, maxTall); // Dynamic sizing
+    m_iTextCount = 0;
 
     // Get player current stage
     int currentStage = GetCurrentZone();
@@ -662,22 +660,14 @@ void C_RunComparisons::Paint()
     //  Vel   (+/- XXX.XX)
     //  Sync? etc
 
-    surface()->DrawSetTextFont(m_hTextFont);
-    surface()->DrawSetTextColor(GetFgColor());
     // Print "Comparing against: X"
-    char fullCompareString[BUFSIZELOCL];
-    Q_snprintf(fullCompareString, BUFSIZELOCL, "%s%s",
-               compareLocalized, //"Compare against: "
-               GetRunComparisons()->runName);
+    ComparisonText_t &compareAgainst = AddText(text_xpos, text_ypos, GetFgColor(), 0);
+    compareAgainst.m_Text.Format("%s%s",
+                                 compareLocalized, //"Compare against: "
+                                 GetRunComparisons()->runName);
 
     // Check to see if this updates max width
-    SetMaxWide(UTIL_ComputeStringWidth(m_hTextFont, fullCompareString));
-
-    wchar_t compareUnicode[BUFSIZELOCL];
-    ANSI_TO_UNICODE(fullCompareString, compareUnicode);
-
-    surface()->DrawSetTextPos(text_xpos, text_ypos);
-    surface()->DrawPrintText(compareUnicode, wcslen(compareUnicode));
+    SetMaxWide(compareAgainst.m_Text.GetWidth(m_hTextFont));
 
     int yToIncrementBy = surface()->GetFontTall(m_hTextFont) + 2; //+2 for padding
     int Y = text_ypos + yToIncrementBy;
@@ -693,19 +683,12 @@ void C_RunComparisons::Paint()
             if (m_pRunData)
                 bIsLinear = C_MomentumPlayer::GetLocalMomPlayer() && C_MomentumPlayer::GetLocalMomPlayer()->m_iLinearTracks[m_pRunData->m_iCurrentTrack];
             const wchar_t *pwZoneStr = CConstructLocalizedString(bIsLinear ? m_wCheckpoint : m_wStage, i);
-            const size_t zoneStrLen = Q_wcslen(pwZoneStr);
-
-            Color fgColorOverride = GetFgColor();
-
-            if (m_bLoadedBogusComparison && (m_nCurrentBogusPulse & ZONE_LABELS))
-            {
-                fgColorOverride = Color(fgColorOverride.r(), fgColorOverride.g(), fgColorOverride.b(), bogus_alpha);
-            }
+            char zoneStr[BUFSIZELOCL];
+            g_pVGuiLocalize->ConvertUnicodeToANSI(pwZoneStr, zoneStr, sizeof(zoneStr));
 
             // print "Stage ## "
-            surface()->DrawSetTextColor(fgColorOverride);
-            surface()->DrawSetTextPos(text_xpos, Y);
-            surface()->DrawPrintText(pwZoneStr, zoneStrLen);
+            ComparisonText_t &zoneLabel = AddText(text_xpos, Y, GetFgColor(), ZONE_LABELS);
+            zoneLabel.m_Text.SetText(zoneStr);
 
             if (i == (currentStage - 1))
             {
@@ -717,12 +700,12 @@ void C_RunComparisons::Paint()
                 // print Time comparison
                 if (mom_comparisons_time_show_overall.GetBool())
                 {
-                    DrawComparisonString(TIME_OVERALL, i, Y);
+                    AddComparisonString(TIME_OVERALL, i, Y);
                     Y += yToIncrementBy;
                 }
                 if (mom_comparisons_time_show_perzone.GetBool())
                 {
-                    DrawComparisonString(ZONE_TIME, i, Y);
+                    AddComparisonString(ZONE_TIME, i, Y);
                     Y += yToIncrementBy;
                 }
 
@@ -731,25 +714,25 @@ void C_RunComparisons::Paint()
                 {
                     if (mom_comparisons_vel_show_avg.GetBool())
                     {
-                        DrawComparisonString(VELOCITY_AVERAGE, i, Y);
+                        AddComparisonString(VELOCITY_AVERAGE, i, Y);
                         Y += yToIncrementBy;
                     }
 
                     if (mom_comparisons_vel_show_max.GetBool())
                     {
-                        DrawComparisonString(VELOCITY_MAX, i, Y);
+                        AddComparisonString(VELOCITY_MAX, i, Y);
                         Y += yToIncrementBy;
                     }
 
                     if (mom_comparisons_vel_show_exit.GetBool())
                     {
-                        DrawComparisonString(VELOCITY_EXIT, i, Y);
+                        AddComparisonString(VELOCITY_EXIT, i, Y);
                         Y += yToIncrementBy;
                     }
 
                     if (mom_comparisons_vel_show_enter.GetBool())
                     {
-                        DrawComparisonString(VELOCITY_ENTER, i, Y);
+                        AddComparisonString(VELOCITY_ENTER, i, Y);
                         Y += yToIncrementBy;
                     }
                 }
@@ -759,25 +742,25 @@ void C_RunComparisons::Paint()
                 {
                     if (mom_comparisons_sync_show_sync1.GetBool())
                     {
-                        DrawComparisonString(ZONE_SYNC1, i, Y);
+                        AddComparisonString(ZONE_SYNC1, i, Y);
                         Y += yToIncrementBy;
                     }
                     if (mom_comparisons_sync_show_sync2.GetBool())
                     {
-                        DrawComparisonString(ZONE_SYNC2, i, Y);
+                        AddComparisonString(ZONE_SYNC2, i, Y);
                         Y += yToIncrementBy;
                     }
                 }
                 // print jumps
                 if (mom_comparisons_jumps_show.GetBool())
                 {
-                    DrawComparisonString(ZONE_JUMPS, i, Y);
+                    AddComparisonString(ZONE_JUMPS, i, Y);
                     Y += yToIncrementBy;
                 }
                 // print strafes
                 if (mom_comparisons_strafe_show.GetBool())
                 {
-                    DrawComparisonString(ZONE_STRAFES, i, Y);
+                    AddComparisonString(ZONE_STRAFES, i, Y);
                     Y += yToIncrementBy;
                 }
             }
@@ -785,39 +768,131 @@ void C_RunComparisons::Paint()
             {
                 // It's a stage before the very last one we've been to.
 
-                // This is done here and not through DrawComparisonString because
+                // This is done here and not through AddComparisonString because
                 // we only need to get the time comparison string, nothing else.
                 ComparisonString_t timeType = mom_comparisons_time_type.GetBool() ? ZONE_TIME : TIME_OVERALL;
                 char timeComparisonString[BUFSIZELOCL];
-                wchar_t timeComparisonStringUnicode[BUFSIZELOCL];
 
-                int newXPos = text_xpos                                           // Base starting X pos
-                              + UTIL_ComputeStringWidth(m_hTextFont, pwZoneStr) //"Stage ## "
-                              + 2;                                                // Padding
+                int newXPos = text_xpos                                  // Base starting X pos
+                              + zoneLabel.m_Text.GetWidth(m_hTextFont)  //"Stage ## "
+                              + 2;                                       // Padding
 
                 Color comparisonColor = Color(GetFgColor());
 
                 // Get just the comparison value, no actual value needed as it clutters up the panel
                 GetComparisonString(timeType, GetRunStats(), i, nullptr, timeComparisonString, &comparisonColor);
 
-                if (m_bLoadedBogusComparison && (m_nCurrentBogusPulse & ZONE_LABELS_COMP))
-                {
-                    comparisonColor = Color(comparisonColor.r(), comparisonColor.g(), comparisonColor.b(), bogus_alpha);
-                }
+                // print "          (+/- XX:XX.XX)" with colorization
+                ComparisonText_t &zoneComparison = AddText(newXPos, Y, comparisonColor, ZONE_LABELS_COMP);
+                zoneComparison.m_Text.SetText(timeComparisonString);
 
                 // See if this updates our max width.
-                SetMaxWide(newXPos + UTIL_ComputeStringWidth(m_hTextFont, timeComparisonString) + 2);
-
-                ANSI_TO_UNICODE(timeComparisonString, timeComparisonStringUnicode);
-
-                // print "          (+/- XX:XX.XX)" with colorization
-                surface()->DrawSetTextColor(comparisonColor);
-                surface()->DrawSetTextPos(newXPos, Y);
-                surface()->DrawPrintText(timeComparisonStringUnicode, wcslen(timeComparisonStringUnicode));
+                SetMaxWide(newXPos + zoneComparison.m_Text.GetWidth(m_hTextFont) + 2);
             }
 
-            // Increment the Y only when we draw things.
+            // Increment the Y only when we add things.
             Y += yToIncrementBy;
         }
     }
+
+    // MOM_TODO: Linear maps will have checkpoints, which rid the exit velocity stat, which affects maxTall
+    int maxTall = GetMaximumTall();
+    int newY = m_iDefaultYPos + (m_iDefaultTall - maxTall);
+    if (!m_bLoadedBogusComparison)
+        SetPos(m_iDefaultXPos, newY);  // Dynamic placement, only when it's not bogus
+    SetPanelSize(m_iMaxWide, maxTall); // Dynamic sizing
+}
+
+C_RunComparisons::ComparisonText_t &C_RunComparisons::AddText(int x, int y, const Color &color, int iPulseFlag)
+{
+    // Reuse the texts from the last rebuild, so unchanged ones skip their Unicode conversion and measuring
+    if (m_iTextCount == m_vecText.Count())
+        m_vecText.AddToTail();
+
+    ComparisonText_t &text = m_vecText[m_iTextCount++];
+    text.m_iXPos = x;
+    text.m_iYPos = y;
+    text.m_Color = color;
+    text.m_iPulseFlag = iPulseFlag;
+    return text;
+}
+
+// Everything the panel's text is built from. The zones before the last one only show their (final) time,
+// the last one shows everything, so that's all that has to be watched.
+void C_RunComparisons::TrackTextDependencies()
+{
+    const int currentZone = GetCurrentZone();
+    const int lastZone = currentZone - 1;
+    const int velType = m_cvarVelType.GetInt();
+    CMomRunStats *pStats = GetRunStats();
+
+    m_TextDeps.Track(currentZone);
+    m_TextDeps.Track(pStats);
+    m_TextDeps.Track(GetRunComparisons());
+    m_TextDeps.Track(m_iComparisonVersion);
+    m_TextDeps.Track(velType);
+    m_TextDeps.Track(m_pRunData ? m_pRunData->m_iCurrentTrack : -1);
+
+    if (pStats && lastZone > 0)
+    {
+        m_TextDeps.Track(pStats->GetZoneTicks(lastZone));
+        m_TextDeps.Track(pStats->GetZoneEnterTick(currentZone));
+        m_TextDeps.Track(pStats->GetZoneVelocityAvg(lastZone, velType));
+        m_TextDeps.Track(pStats->GetZoneVelocityMax(lastZone, velType));
+        m_TextDeps.Track(pStats->GetZoneExitSpeed(lastZone, velType));
+        m_TextDeps.Track(pStats->GetZoneEnterSpeed(lastZone, velType));
+        m_TextDeps.Track(pStats->GetZoneStrafeSyncAvg(lastZone));
+        m_TextDeps.Track(pStats->GetZoneStrafeSync2Avg(lastZone));
+        m_TextDeps.Track(pStats->GetZoneJumps(lastZone));
+        m_TextDeps.Track(pStats->GetZoneStrafes(lastZone));
+    }
+
+    const int settings = mom_comparisons_time_show_overall.GetBool() | mom_comparisons_time_show_perzone.GetBool() << 1 |
+                         mom_comparisons_time_type.GetBool() << 2 | mom_comparisons_vel_show.GetBool() << 3 |
+                         mom_comparisons_vel_show_avg.GetBool() << 4 | mom_comparisons_vel_show_max.GetBool() << 5 |
+                         mom_comparisons_vel_show_enter.GetBool() << 6 | mom_comparisons_vel_show_exit.GetBool() << 7 |
+                         mom_comparisons_sync_show.GetBool() << 8 | mom_comparisons_sync_show_sync1.GetBool() << 9 |
+                         mom_comparisons_sync_show_sync2.GetBool() << 10 | mom_comparisons_jumps_show.GetBool() << 11 |
+                         mom_comparisons_strafe_show.GetBool() << 12 | mom_comparisons_format_output.GetBool() << 13;
+    m_TextDeps.Track(settings);
+    m_TextDeps.Track(mom_comparisons_max_zones.GetInt());
+
+    m_TextDeps.Track(m_hTextFont);
+    m_TextDeps.Track(GetFgColor().GetRawColor());
+    m_TextDeps.Track(m_cGain.GetRawColor());
+    m_TextDeps.Track(m_cLoss.GetRawColor());
+    m_TextDeps.Track(m_cTie.GetRawColor());
+    m_TextDeps.Track(format_spacing);
+    m_TextDeps.Track(text_xpos);
+    m_TextDeps.Track(text_ypos);
+}
+
+void C_RunComparisons::Paint()
+{
+    HUD_PROFILE_SCOPE("Comparisons", HUD_PROFILE_PAINT);
+
+    if (!GetRunComparisons())
+        return;
+
+    if (m_Throttle.ShouldUpdate())
+    {
+        TrackTextDependencies();
+        if (m_TextDeps.Changed())
+            RebuildText();
+    }
+
+    surface()->DrawSetTextFont(m_hTextFont);
+    for (int i = 0; i < m_iTextCount; i++)
+    {
+        const ComparisonText_t &text = m_vecText[i];
+
+        // We override the color here from HUD animations, if this is a bogus comparisons panel
+        Color color = text.m_Color;
+        if (m_bLoadedBogusComparison && (m_nCurrentBogusPulse & text.m_iPulseFlag))
+            color = Color(color.r(), color.g(), color.b(), bogus_alpha);
+
+        surface()->DrawSetTextColor(color);
+        surface()->DrawSetTextPos(text.m_iXPos, text.m_iYPos);
+        text.m_Text.Draw();
+    }
 }
@@ -2,6 +2,8 @@
 
 #include <vgui_controls/Panel.h>
 #include <hudelement.h>
+#include "hud_update.h"
+#include "mom_run_splits.h"
 #include "run/run_compare.h"
 
 class C_MomentumPlayer;
@@ -25,6 +27,8 @@ public:
     void FireGameEvent(IGameEvent *event) OVERRIDE;
 
     void LoadComparisons();
+    // Resolves the comparisons again, for when a new run was saved or one was deleted
+    void ReloadComparisons();
     void LoadBogusComparisons();
     bool LoadedComparison() const
     {
@@ -32,7 +36,7 @@ public:
     }
     void UnloadComparisons();
     void UnloadBogusComparisons();
-    void DrawComparisonString(ComparisonString_t, int stage, int Ypos);
+    void AddComparisonString(ComparisonString_t, int stage, int Ypos);
     void GetComparisonString(ComparisonString_t type, CMomRunStats *pStats, int zone, char *ansiActualBufferOut, char *ansiCompareBufferOut, Color *compareColorOut);
     void GetDiffColor(float diff, Color *into, bool positiveIsGain = true);
     int GetMaximumTall();
@@ -69,6 +73,9 @@ public:
         return m_bLoadedBogusComparison ? m_rcBogusComparison : m_rcCurrentComparison;
     }
 
+    // Bumped whenever the comparison's contents change, the comparison is refilled in place so its pointer doesn't
+    int GetComparisonVersion() const { return m_iComparisonVersion; }
+
     CMomRunStats *GetRunStats() const
     {
         return m_bLoadedBogusComparison ? m_pBogusRunStats : m_pRunStats;
@@ -87,6 +94,27 @@ protected:
 
 
 private:
+    // A piece of text on the panel. These are only rebuilt when what they show changes, Paint just draws them.
+    struct ComparisonText_t
+    {
+        CHudText m_Text;
+        int m_iXPos, m_iYPos;
+        Color m_Color;
+        int m_iPulseFlag; // The bogus pulse flag that overrides this text's alpha, 0 for none
+    };
+
+    // Copies the comparison run over once it (or the PB standing in for it) finished loading
+    void UpdateComparisonTarget();
+
+    void TrackTextDependencies();
+    void RebuildText();
+    ComparisonText_t &AddText(int x, int y, const Color &color, int iPulseFlag);
+
+    CUtlVector<ComparisonText_t> m_vecText;
+    int m_iTextCount;
+    CHudDependencies m_TextDeps;
+    CHudUpdateThrottle m_Throttle;
+
     wchar_t m_wStage[BUFSIZELOCL], m_wCheckpoint[BUFSIZELOCL];
     char compareLocalized[BUFSIZELOCL],
         stageTimeLocalized[BUFSIZELOCL], overallTimeLocalized[BUFSIZELOCL],
@@ -99,6 +127,7 @@ private:
     int m_iMaxWide, m_iWidestLabel, m_iWidestValue;
     bool m_bLoadedComparison, m_bLoadedBogusComparison;
     RunCompare_t *m_rcCurrentComparison, *m_rcBogusComparison;
+    int m_iComparisonVersion;
     //m_pRunStats points to the player's/bot's CMomRunStats::data member, but the bogus one needs its own data.
     CMomRunStats *m_pRunStats, *m_pBogusRunStats;
     C_MomRunEntityData *m_pRunData;
@@ -106,6 +135,11 @@ private:
 
     int m_iLoadedRunFlags; // Loaded comparison's run flags
     float m_fLoadedTickRate; // Loaded comparison's tick rate
+    int m_iLoadedTrack; // Loaded comparison's track
+    int m_iLoadedTarget; // ComparisonTarget_t that was asked for
+    int m_iTargetsVersion; // g_pComparisonTargets version the comparison was last updated for
+
+    CRunSplitTable m_Splits;
 
     ConVarRef m_cvarVelType;
 };
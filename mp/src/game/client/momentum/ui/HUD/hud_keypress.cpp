@@ -1,6 +1,7 @@
 ﻿#include "cbase.h"
 
 #include "hudelement.h"
+#include "hud_update.h"
 #include "iclientmode.h"
 #include "in_buttons.h"
 #include "input.h"
@@ -61,6 +62,8 @@ class CHudKeyPressDisplay : public CHudElement, public Panel
 
   private:
     int GetTextCenter(HFont font, wchar_t *wstring);
+    void UpdateLayout();
+    void DrawKey(const wchar_t *pwKey, int x, int y);
 
     bool m_bIsDucked;
     int m_nButtons, m_nDisabledButtons, m_nJumps;
@@ -77,6 +80,13 @@ class CHudKeyPressDisplay : public CHudElement, public Panel
     wchar_t m_pwM2[BUFSIZELOCL];
     float m_fJumpColorUntil;
     float m_fDuckColorUntil;
+
+    // Key positions only get measured again when the panel size, fonts or localization change
+    CHudDependencies m_LayoutDeps;
+    int m_iFwdX, m_iLeftX, m_iTurnLeftX, m_iBackX, m_iRightX, m_iTurnRightX, m_iStrafeX;
+    int m_iJumpX, m_iDuckX, m_iM1X, m_iM2X;
+
+    CHudText m_StrafeCountText, m_JumpCountText;
 };
 
 DECLARE_HUDELEMENT(CHudKeyPressDisplay);
@@ -115,6 +125,7 @@ void CHudKeyPressDisplay::Init()
 
     m_nButtons = 0;
     m_nDisabledButtons = 0;
+    m_LayoutDeps.Invalidate();
 }
 
 // Checks to see if this input was blocked, and if so, paint it red.
@@ -126,6 +137,14 @@ void CHudKeyPressDisplay::Init()
 
 void CHudKeyPressDisplay::Paint()
 {
+    HUD_PROFILE_SCOPE("KeyPresses", HUD_PROFILE_PAINT);
+
+    m_LayoutDeps.Track(GetWide());
+    m_LayoutDeps.Track(m_hTextFont);
+    m_LayoutDeps.Track(m_hWordTextFont);
+    if (m_LayoutDeps.Changed())
+        UpdateLayout();
+
     // create local variable so we can mutate it without worry
     int nButtons = m_nButtons;
     // do we need to invert the +left/+right due to negative yawspeed?
@@ -148,51 +167,40 @@ void CHudKeyPressDisplay::Paint()
     if (nButtons & IN_FORWARD)
     {
         CHECK_INPUT_P(IN_FORWARD);
-        surface()->DrawSetTextPos(GetTextCenter(m_hTextFont, m_pwFwd), top_row_ypos);
-        surface()->DrawPrintText(m_pwFwd, wcslen(m_pwFwd));
+        DrawKey(m_pwFwd, m_iFwdX, top_row_ypos);
     }
     if (nButtons & IN_MOVELEFT)
     {
         CHECK_INPUT_P(IN_MOVELEFT);
-        int text_left = GetTextCenter(m_hTextFont, m_pwLeft) - UTIL_ComputeStringWidth(m_hTextFont, m_pwLeft);
-        surface()->DrawSetTextPos(text_left, mid_row_ypos);
-        surface()->DrawPrintText(m_pwLeft, wcslen(m_pwLeft));
+        DrawKey(m_pwLeft, m_iLeftX, mid_row_ypos);
     }
     // Turning left with turnbind
     if (nButtons & IN_LEFT)
     {
         CHECK_INPUT_P(IN_RIGHT);
-        int text_left = GetTextCenter(m_hTextFont, m_pwLeft) - (UTIL_ComputeStringWidth(m_hTextFont, m_pwLeft) * 2);
-        surface()->DrawSetTextPos(text_left, mid_row_ypos);
-        surface()->DrawPrintText(m_pwLeft, wcslen(m_pwLeft));
+        DrawKey(m_pwLeft, m_iTurnLeftX, mid_row_ypos);
     }
     if (nButtons & IN_BACK)
     {
         CHECK_INPUT_P(IN_BACK);
-        surface()->DrawSetTextPos(GetTextCenter(m_hTextFont, m_pwBack), lower_row_ypos);
-        surface()->DrawPrintText(m_pwBack, wcslen(m_pwBack));
+        DrawKey(m_pwBack, m_iBackX, lower_row_ypos);
     }
     if (nButtons & IN_MOVERIGHT)
     {
         CHECK_INPUT_P(IN_MOVERIGHT);
-        int text_right = GetTextCenter(m_hTextFont, m_pwRight) + UTIL_ComputeStringWidth(m_hTextFont, m_pwRight);
-        surface()->DrawSetTextPos(text_right, mid_row_ypos);
-        surface()->DrawPrintText(m_pwRight, wcslen(m_pwRight));
+        DrawKey(m_pwRight, m_iRightX, mid_row_ypos);
     }
     // Turning right with turnbind
     if (nButtons & IN_RIGHT)
     {
         CHECK_INPUT_P(IN_RIGHT);
-        int text_right = GetTextCenter(m_hTextFont, m_pwRight) + (UTIL_ComputeStringWidth(m_hTextFont, m_pwRight) * 2);
-        surface()->DrawSetTextPos(text_right, mid_row_ypos);
-        surface()->DrawPrintText(m_pwRight, wcslen(m_pwRight));
+        DrawKey(m_pwRight, m_iTurnRightX, mid_row_ypos);
     }
 
     if (nButtons & IN_STRAFE)
     {
         CHECK_INPUT_P(IN_STRAFE);
-        surface()->DrawSetTextPos(GetTextCenter(m_hTextFont, m_pwStrafe), (lower_row_ypos + top_row_ypos) / 2.0f);
-        surface()->DrawPrintText(m_pwStrafe, wcslen(m_pwStrafe));
+        DrawKey(m_pwStrafe, m_iStrafeX, (lower_row_ypos + top_row_ypos) / 2.0f);
     }
 
     // reset text font for jump/duck
@@ -207,8 +215,7 @@ void CHudKeyPressDisplay::Paint()
 
         surface()->DrawSetTextColor((m_nDisabledButtons & IN_JUMP || m_nDisabledButtons & IN_BHOPDISABLED) ? m_Disabled
                                                                                                            : m_Normal);
-        surface()->DrawSetTextPos(GetTextCenter(m_hWordTextFont, m_pwJump), jump_row_ypos);
-        surface()->DrawPrintText(m_pwJump, wcslen(m_pwJump));
+        DrawKey(m_pwJump, m_iJumpX, jump_row_ypos);
     }
     if (nButtons & IN_DUCK || m_bIsDucked || gpGlobals->curtime < m_fDuckColorUntil)
     {
@@ -217,23 +224,18 @@ void CHudKeyPressDisplay::Paint()
             m_fDuckColorUntil = gpGlobals->curtime + KEYDRAW_MIN;
         }
         CHECK_INPUT_P(IN_DUCK);
-        surface()->DrawSetTextPos(GetTextCenter(m_hWordTextFont, m_pwDuck), duck_row_ypos);
-        surface()->DrawPrintText(m_pwDuck, wcslen(m_pwDuck));
+        DrawKey(m_pwDuck, m_iDuckX, duck_row_ypos);
     }
     // Add M1 and M2 buttons
     if (nButtons & IN_ATTACK)
     {
         CHECK_INPUT_P(IN_ATTACK);
-        int xposM1 = GetTextCenter(m_hWordTextFont, m_pwM1) - (UTIL_ComputeStringWidth(m_hWordTextFont, m_pwM1)) * 1.5;
-        surface()->DrawSetTextPos(xposM1, top_row_ypos);
-        surface()->DrawPrintText(m_pwM1, wcslen(m_pwM1));
+        DrawKey(m_pwM1, m_iM1X, top_row_ypos);
     }
     if (nButtons & IN_ATTACK2)
     {
         CHECK_INPUT_P(IN_ATTACK2);
-        int xposM2 = GetTextCenter(m_hWordTextFont, m_pwM2) + (UTIL_ComputeStringWidth(m_hWordTextFont, m_pwM2)) * 1.5;
-        surface()->DrawSetTextPos(xposM2, top_row_ypos);
-        surface()->DrawPrintText(m_pwM2, wcslen(m_pwM2));
+        DrawKey(m_pwM2, m_iM2X, top_row_ypos);
     }
     // ----------
     if (m_bShouldDrawCounts)
@@ -241,25 +243,20 @@ void CHudKeyPressDisplay::Paint()
         surface()->DrawSetTextColor(m_Normal); // Back to normal, counts don't get disabled
         surface()->DrawSetTextFont(m_hCounterTextFont);
 
-        wchar_t strafes[BUFSIZESHORT];
-        char cstr_strafes[BUFSIZESHORT];
-        Q_snprintf(cstr_strafes, sizeof(cstr_strafes), "( %i )", m_nStrafes);
-        g_pVGuiLocalize->ConvertANSIToUnicode(cstr_strafes, strafes, sizeof(strafes));
-
+        // Only reformatted when the counts change
+        m_StrafeCountText.Format("( %i )", m_nStrafes);
         surface()->DrawSetTextPos(strafe_count_xpos, mid_row_ypos);
-        surface()->DrawPrintText(strafes, wcslen(strafes));
-
-        wchar_t jumps[BUFSIZESHORT];
-        char cstr_jumps[BUFSIZESHORT];
-        Q_snprintf(cstr_jumps, sizeof(cstr_jumps), "( %i )", m_nJumps);
-        g_pVGuiLocalize->ConvertANSIToUnicode(cstr_jumps, jumps, sizeof(jumps));
+        m_StrafeCountText.Draw();
 
+        m_JumpCountText.Format("( %i )", m_nJumps);
         surface()->DrawSetTextPos(jump_count_xpos, jump_row_ypos);
-        surface()->DrawPrintText(jumps, wcslen(jumps));
+        m_JumpCountText.Draw();
     }
 }
 void CHudKeyPressDisplay::OnThink()
 {
+    HUD_PROFILE_SCOPE("KeyPresses", HUD_PROFILE_THINK);
+
     const auto pPlayer = C_MomentumPlayer::GetLocalMomPlayer();
     if (pPlayer)
     {
@@ -308,6 +305,8 @@ void CHudKeyPressDisplay::Reset()
     FIND_LOCALIZATION(m_pwDuck, "#MOM_Duck");
     FIND_LOCALIZATION(m_pwM1, "#MOM_M1");
     FIND_LOCALIZATION(m_pwM2, "#MOM_M2");
+
+    m_LayoutDeps.Invalidate();
 }
 
 int CHudKeyPressDisplay::GetTextCenter(HFont font, wchar_t *wstring)
@@ -315,6 +314,28 @@ int CHudKeyPressDisplay::GetTextCenter(HFont font, wchar_t *wstring)
     return GetWide() / 2 - UTIL_ComputeStringWidth(font, wstring) / 2;
 }
 
+void CHudKeyPressDisplay::UpdateLayout()
+{
+    m_iFwdX = GetTextCenter(m_hTextFont, m_pwFwd);
+    m_iLeftX = GetTextCenter(m_hTextFont, m_pwLeft) - UTIL_ComputeStringWidth(m_hTextFont, m_pwLeft);
+    m_iTurnLeftX = GetTextCenter(m_hTextFont, m_pwLeft) - (UTIL_ComputeStringWidth(m_hTextFont, m_pwLeft) * 2);
+    m_iBackX = GetTextCenter(m_hTextFont, m_pwBack);
+    m_iRightX = GetTextCenter(m_hTextFont, m_pwRight) + UTIL_ComputeStringWidth(m_hTextFont, m_pwRight);
+    m_iTurnRightX = GetTextCenter(m_hTextFont, m_pwRight) + (UTIL_ComputeStringWidth(m_hTextFont, m_pwRight) * 2);
+    m_iStrafeX = GetTextCenter(m_hTextFont, m_pwStrafe);
+
+    m_iJumpX = GetTextCenter(m_hWordTextFont, m_pwJump);
+    m_iDuckX = GetTextCenter(m_hWordTextFont, m_pwDuck);
+    m_iM1X = GetTextCenter(m_hWordTextFont, m_pwM1) - (UTIL_ComputeStringWidth(m_hWordTextFont, m_pwM1)) * 1.5;
+    m_iM2X = GetTextCenter(m_hWordTextFont, m_pwM2) + (UTIL_ComputeStringWidth(m_hWordTextFont, m_pwM2)) * 1.5;
+}
+
+void CHudKeyPressDisplay::DrawKey(const wchar_t *pwKey, int x, int y)
+{
+    surface()->DrawSetTextPos(x, y);
+    surface()->DrawPrintText(pwKey, wcslen(pwKey));
+}
+
 void CHudKeyPressDisplay::DrawKeyTemplates()
 {
     // first draw all keys on screen in a dark gray
@@ -322,22 +343,16 @@ void CHudKeyPressDisplay::DrawKeyTemplates()
     surface()->DrawSetTextFont(m_hTextFont);
     // fwd
     CHECK_INPUT_N(IN_FORWARD);
-    surface()->DrawSetTextPos(GetTextCenter(m_hTextFont, m_pwFwd), top_row_ypos);
-    surface()->DrawPrintText(m_pwFwd, wcslen(m_pwFwd));
+    DrawKey(m_pwFwd, m_iFwdX, top_row_ypos);
     // left
     CHECK_INPUT_N(IN_MOVELEFT);
-    int text_left = GetTextCenter(m_hTextFont, m_pwLeft) - UTIL_ComputeStringWidth(m_hTextFont, m_pwLeft);
-    surface()->DrawSetTextPos(text_left, mid_row_ypos);
-    surface()->DrawPrintText(m_pwLeft, wcslen(m_pwLeft));
+    DrawKey(m_pwLeft, m_iLeftX, mid_row_ypos);
     // back
     CHECK_INPUT_N(IN_BACK);
-    surface()->DrawSetTextPos(GetTextCenter(m_hTextFont, m_pwBack), lower_row_ypos);
-    surface()->DrawPrintText(m_pwBack, wcslen(m_pwBack));
+    DrawKey(m_pwBack, m_iBackX, lower_row_ypos);
     // right
     CHECK_INPUT_N(IN_MOVERIGHT);
-    int text_right = GetTextCenter(m_hTextFont, m_pwRight) + UTIL_ComputeStringWidth(m_hTextFont, m_pwRight);
-    surface()->DrawSetTextPos(text_right, mid_row_ypos);
-    surface()->DrawPrintText(m_pwRight, wcslen(m_pwRight));
+    DrawKey(m_pwRight, m_iRightX, mid_row_ypos);
 
     // reset text font for jump/duck
     surface()->DrawSetTextFont(m_hWordTextFont);
@@ -345,18 +360,12 @@ void CHudKeyPressDisplay::DrawKeyTemplates()
     // Bullrush is Bhop being disabled
     surface()->DrawSetTextColor((m_nDisabledButtons & IN_JUMP || m_nDisabledButtons & IN_BHOPDISABLED) ? m_Disabled
                                                                                                        : m_darkGray);
-    surface()->DrawSetTextPos(GetTextCenter(m_hWordTextFont, m_pwJump), jump_row_ypos);
-    surface()->DrawPrintText(m_pwJump, wcslen(m_pwJump));
+    DrawKey(m_pwJump, m_iJumpX, jump_row_ypos);
     // duck
     CHECK_INPUT_N(IN_DUCK);
-    surface()->DrawSetTextPos(GetTextCenter(m_hWordTextFont, m_pwDuck), duck_row_ypos);
-    surface()->DrawPrintText(m_pwDuck, wcslen(m_pwDuck));
+    DrawKey(m_pwDuck, m_iDuckX, duck_row_ypos);
     CHECK_INPUT_N(IN_ATTACK);
-    int xposM1 = GetTextCenter(m_hWordTextFont, m_pwM1) - (UTIL_ComputeStringWidth(m_hWordTextFont, m_pwM1)) * 1.5;
-    surface()->DrawSetTextPos(xposM1, top_row_ypos);
-    surface()->DrawPrintText(m_pwM1, wcslen(m_pwM1));
+    DrawKey(m_pwM1, m_iM1X, top_row_ypos);
     CHECK_INPUT_N(IN_ATTACK2);
-    int xposM2 = GetTextCenter(m_hWordTextFont, m_pwM2) + (UTIL_ComputeStringWidth(m_hWordTextFont, m_pwM2)) * 1.5;
-    surface()->DrawSetTextPos(xposM2, top_row_ypos);
-    surface()->DrawPrintText(m_pwM2, wcslen(m_pwM2));
+    DrawKey(m_pwM2, m_iM2X, top_row_ypos);
 }
\ No newline at end of file
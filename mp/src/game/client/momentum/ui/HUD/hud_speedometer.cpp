@@ -3,6 +3,7 @@
 #include "baseviewport.h"
 #include "hud_comparisons.h"
 #include "hud_macros.h"
+#include "hud_update.h"
 #include "hudelement.h"
 #include "iclientmode.h"
 #include "utlvector.h"
@@ -94,6 +95,15 @@ class CHudSpeedMeter : public CHudElement, public EditablePanel
 
     void DeactivateLabel(Label *label);
     void ActivateLabel(Label *label, int defaultHeight);
+    void UpdateLabelLayout();
+    void UpdateEnterSpeed();
+
+    // What the labels currently show, so they only get new text when it changes
+    int m_iDisplayedVel, m_iDisplayedHVel, m_iDisplayedLastJumpVel, m_iDisplayedUnits;
+    int m_iVisibleLabels; // Bits of the shown labels, the layout is redone when these change
+    CHudDependencies m_EnterSpeedDeps;
+    Color m_EnterSpeedCompareColor;
+    bool m_bEnterSpeedHasComparison;
 
     CMomRunStats *m_pRunStats;
     CMomRunEntityData *m_pRunEntData;
@@ -132,6 +142,11 @@ CHudSpeedMeter::CHudSpeedMeter(const char *pElementName)
     m_iRoundedHVel = 0;
     m_iRoundedLastJumpVel = 0;
 
+    m_iDisplayedVel = m_iDisplayedHVel = m_iDisplayedLastJumpVel = INT_MIN;
+    m_iDisplayedUnits = 0;
+    m_iVisibleLabels = -1;
+    m_bEnterSpeedHasComparison = false;
+
     m_pUnitsLabel = new Label(this, "UnitsLabel", "");
     m_pAbsSpeedoLabel = new Label(this, "AbsSpeedoLabel", "");
     m_pHorizSpeedoLabel = new Label(this, "HorizSpeedoLabel", "");
@@ -172,6 +187,10 @@ void CHudSpeedMeter::Reset()
     m_pStageEnterExitLabel->SetText("");
     m_pStageEnterExitComparisonLabel->SetText("");
     m_pLastJumpVelLabel->SetText("");
+
+    // Everything gets its text set again on the next think
+    m_iVisibleLabels = -1;
+    m_EnterSpeedDeps.Invalidate();
 }
 
 void CHudSpeedMeter::FireGameEvent(IGameEvent *pEvent)
@@ -215,10 +234,130 @@ void CHudSpeedMeter::ApplySchemeSettings(IScheme *pScheme)
     m_pStageEnterExitComparisonLabel->SetFont(m_pStageEnterExitLabel->GetFont()); // need to have same font
 
     m_defaultYPos = GetYPos();
+    m_iVisibleLabels = -1;
+    m_EnterSpeedDeps.Invalidate();
+}
+
+void CHudSpeedMeter::UpdateLabelLayout()
+{
+    int yIndent = 0;
+    if (!mom_hud_speedometer.GetBool())
+        yIndent += m_defaultAbsSpeedoLabelHeight;
+    if (!mom_hud_speedometer_horiz.GetBool())
+        yIndent += m_defaultHorizSpeedoLabelHeight;
+    if (!mom_hud_speedometer_lastjumpvel.GetBool())
+        yIndent += m_defaultLastJumpVelLabelHeight;
+    if (!mom_hud_speedometer_unit_labels.GetBool())
+        yIndent += m_defaultUnitsLabelHeight;
+    if (!mom_hud_speedometer_showenterspeed.GetBool())
+        yIndent += m_defaultStageEnterExitLabelHeight;
+    SetPos(GetXPos(), m_defaultYPos + yIndent);
+
+    if (mom_hud_speedometer.GetBool())
+        ActivateLabel(m_pAbsSpeedoLabel, m_defaultAbsSpeedoLabelHeight);
+    else
+        DeactivateLabel(m_pAbsSpeedoLabel);
+
+    if (mom_hud_speedometer_horiz.GetBool())
+        ActivateLabel(m_pHorizSpeedoLabel, m_defaultHorizSpeedoLabelHeight);
+    else
+        DeactivateLabel(m_pHorizSpeedoLabel);
+
+    if (mom_hud_speedometer_lastjumpvel.GetBool())
+        ActivateLabel(m_pLastJumpVelLabel, m_defaultLastJumpVelLabelHeight);
+    else
+        DeactivateLabel(m_pLastJumpVelLabel);
+
+    // if every speedometer is off, don't bother drawing unit labels
+    if (mom_hud_speedometer_unit_labels.GetBool() &&
+        (mom_hud_speedometer.GetBool() || mom_hud_speedometer_horiz.GetBool() ||
+         mom_hud_speedometer_lastjumpvel.GetBool() || mom_hud_speedometer_showenterspeed.GetBool()))
+    {
+        ActivateLabel(m_pUnitsLabel, m_defaultUnitsLabelHeight);
+    }
+    else
+    {
+        DeactivateLabel(m_pUnitsLabel);
+    }
+
+    if (!mom_hud_speedometer_showenterspeed.GetBool())
+    {
+        DeactivateLabel(m_pStageEnterExitLabel);
+        DeactivateLabel(m_pStageEnterExitComparisonLabel);
+    }
+
+    // Deactivating clears the text, make sure whatever is shown gets set again
+    m_iDisplayedVel = m_iDisplayedHVel = m_iDisplayedLastJumpVel = INT_MIN;
+    m_iDisplayedUnits = 0;
+    m_EnterSpeedDeps.Invalidate();
+}
+
+// Rebuilds the enter speed split strings and layout, only when the zone, the speed or the comparison changed
+void CHudSpeedMeter::UpdateEnterSpeed()
+{
+    const int iVelType = mom_hud_velocity_type.GetInt();
+    m_EnterSpeedDeps.Track(m_pRunEntData->m_iCurrentZone);
+    m_EnterSpeedDeps.Track(m_pRunStats);
+    m_EnterSpeedDeps.Track(m_pRunStats->GetZoneEnterSpeed(m_pRunEntData->m_iCurrentZone, iVelType));
+    m_EnterSpeedDeps.Track(iVelType);
+    m_EnterSpeedDeps.Track(g_pMOMRunCompare->GetComparisonVersion());
+    m_EnterSpeedDeps.Track(GetWide());
+    if (!m_EnterSpeedDeps.Changed())
+        return;
+
+    ActivateLabel(m_pStageEnterExitLabel, m_defaultStageEnterExitLabelHeight);
+    ActivateLabel(m_pStageEnterExitComparisonLabel, m_defaultStageEnterExitLabelHeight);
+
+    char enterVelUnrounded[BUFSIZELOCL], enterVelRounded[BUFSIZELOCL], enterVelComparisonUnrounded[BUFSIZELOCL],
+        enterVelComparisonRounded[BUFSIZELOCL];
+
+    m_EnterSpeedCompareColor = Color(0, 0, 0, 0);
+    g_pMOMRunCompare->GetComparisonString(VELOCITY_ENTER, m_pRunStats, m_pRunEntData->m_iCurrentZone,
+                                          enterVelUnrounded, enterVelComparisonUnrounded, &m_EnterSpeedCompareColor);
+    // Round velocity
+    Q_snprintf(enterVelRounded, BUFSIZELOCL, "%i", static_cast<int>(round(atof(enterVelUnrounded))));
+
+    m_bEnterSpeedHasComparison = g_pMOMRunCompare->LoadedComparison();
+
+    HFont labelFont = m_pStageEnterExitLabel->GetFont();
+    int spaceBetweenLabels = UTIL_ComputeStringWidth(labelFont, " ");
+    // compute the combined length of the enter/exit and comparison
+    int combinedLength = UTIL_ComputeStringWidth(labelFont, enterVelRounded);
+    if (m_bEnterSpeedHasComparison)
+    {
+        // Really gross way of ripping apart this string and
+        // making some sort of quasi-frankenstein string of the float as a rounded int
+        char firstThree[3];
+        Q_strncpy(firstThree, enterVelComparisonUnrounded, 3);
+        const char *compFloat = enterVelComparisonUnrounded;
+        Q_snprintf(enterVelComparisonRounded, BUFSIZELOCL, " %s %i)", firstThree,
+                   RoundFloatToInt(Q_atof(compFloat + 3)));
+
+        // Add the compare string to the length
+        combinedLength += spaceBetweenLabels + UTIL_ComputeStringWidth(labelFont, enterVelComparisonRounded);
+    }
+    int offsetXPos = 0 - ((GetWide() - combinedLength) / 2);
+
+    // split_xpos = GetWide() / 2 - (enterVelANSIWidth + increaseX) / 2;
+    m_pStageEnterExitLabel->SetPos(offsetXPos, m_pStageEnterExitLabel->GetYPos());
+    m_pStageEnterExitLabel->SetText(enterVelRounded);
+
+    // print comparison as well
+    if (m_bEnterSpeedHasComparison)
+    {
+        m_pStageEnterExitComparisonLabel->SetPos(spaceBetweenLabels, m_pStageEnterExitLabel->GetYPos());
+        m_pStageEnterExitComparisonLabel->SetText(enterVelComparisonRounded);
+    }
+    else // only print velocity
+    {
+        m_pStageEnterExitComparisonLabel->SetText("");
+    }
 }
 
 void CHudSpeedMeter::OnThink()
 {
+    HUD_PROFILE_SCOPE("Speedometer", HUD_PROFILE_THINK);
+
     const auto pPlayer = C_MomentumPlayer::GetLocalMomPlayer();
     if (pPlayer)
     {
@@ -260,21 +399,23 @@ void CHudSpeedMeter::OnThink()
             m_bRanFadeOutJumpSpeed = false;
         }
 
-        switch (mom_hud_speedometer_units.GetInt())
+        const wchar_t *pUnits;
+        const int iUnits = mom_hud_speedometer_units.GetInt();
+        switch (iUnits)
         {
         case 2:
             // 1 unit = 19.05mm -> 0.01905m -> 0.00001905Km(/s) -> 0.06858Km(/h)
             vel *= 0.06858f;
             hvel *= 0.06858f;
             lastJumpVel *= 0.06858f;
-            m_pUnitsLabel->SetText(L"KM/H");
+            pUnits = L"KM/H";
             break;
         case 3:
             // 1 unit = 0.75", 1 mile = 63360. 0.75 / 63360 ~~> 0.00001184"(/s) ~~> 0.04262MPH
             vel *= 0.04262f;
             hvel *= 0.04262f;
             lastJumpVel *= 0.04262f;
-            m_pUnitsLabel->SetText(L"MPH");
+            pUnits = L"MPH";
             break;
         case 4:
         {
@@ -283,16 +424,19 @@ void CHudSpeedMeter::OnThink()
             vel = (pPlayer->GetAbsVelocity().LengthSqr() / 2.0f +
                    gravity * (pPlayer->GetLocalOrigin().z - m_pRunEntData->m_flLastJumpZPos)) / gravity;
             hvel = vel;
-            m_pUnitsLabel->SetText(L"Energy");
+            pUnits = L"Energy";
             break;
         }
         case 1:
         default:
             // We do nothing but break out of the switch, as default vel is already in UPS
-            m_pUnitsLabel->SetText(L"UPS");
+            pUnits = L"UPS";
             break;
         }
 
+        if (HudValueChanged(m_iDisplayedUnits, iUnits))
+            m_pUnitsLabel->SetText(pUnits);
+
         // only called if we need to update color
         if (mom_hud_speedometer_colorize.GetInt())
         {
@@ -429,142 +573,55 @@ void CHudSpeedMeter::OnThink()
         m_pAbsSpeedoLabel->SetFgColor(m_CurrentColor);
         m_pHorizSpeedoLabel->SetFgColor(m_hCurrentColor);
 
+        const int iVisibleLabels = mom_hud_speedometer.GetBool() | mom_hud_speedometer_horiz.GetBool() << 1 |
+                                   mom_hud_speedometer_lastjumpvel.GetBool() << 2 |
+                                   mom_hud_speedometer_unit_labels.GetBool() << 3 |
+                                   mom_hud_speedometer_showenterspeed.GetBool() << 4;
+        if (HudValueChanged(m_iVisibleLabels, iVisibleLabels))
+            UpdateLabelLayout();
 
-        int yIndent = 0;
-        if (!mom_hud_speedometer.GetBool())
-            yIndent += m_defaultAbsSpeedoLabelHeight;
-        if (!mom_hud_speedometer_horiz.GetBool())
-            yIndent += m_defaultHorizSpeedoLabelHeight;
-        if (!mom_hud_speedometer_lastjumpvel.GetBool())
-            yIndent += m_defaultLastJumpVelLabelHeight;
-        if (!mom_hud_speedometer_unit_labels.GetBool())
-            yIndent += m_defaultUnitsLabelHeight;
-        if (!mom_hud_speedometer_showenterspeed.GetBool())
-            yIndent += m_defaultStageEnterExitLabelHeight;
-        SetPos(GetXPos(), m_defaultYPos + yIndent);
-
-        if (mom_hud_speedometer.GetBool())
-        {
-            ActivateLabel(m_pAbsSpeedoLabel, m_defaultAbsSpeedoLabelHeight);
-            char speedoValue[BUFSIZELOCL];
-            Q_snprintf(speedoValue, sizeof(speedoValue), "%i", m_iRoundedVel);
-            m_pAbsSpeedoLabel->SetText(speedoValue);
-        }
-        else
+        char szValue[BUFSIZELOCL];
+        if (mom_hud_speedometer.GetBool() && HudValueChanged(m_iDisplayedVel, m_iRoundedVel))
         {
-            DeactivateLabel(m_pAbsSpeedoLabel);
+            Q_snprintf(szValue, sizeof(szValue), "%i", m_iRoundedVel);
+            m_pAbsSpeedoLabel->SetText(szValue);
         }
 
-        if (mom_hud_speedometer_horiz.GetBool())
+        if (mom_hud_speedometer_horiz.GetBool() && HudValueChanged(m_iDisplayedHVel, m_iRoundedHVel))
         {
-            ActivateLabel(m_pHorizSpeedoLabel, m_defaultHorizSpeedoLabelHeight);
-            char hSpeedoValue[BUFSIZELOCL];
-            Q_snprintf(hSpeedoValue, sizeof(hSpeedoValue), "%i", m_iRoundedHVel);
-            m_pHorizSpeedoLabel->SetText(hSpeedoValue);
-        }
-        else
-        {
-            DeactivateLabel(m_pHorizSpeedoLabel);
+            Q_snprintf(szValue, sizeof(szValue), "%i", m_iRoundedHVel);
+            m_pHorizSpeedoLabel->SetText(szValue);
         }
 
         if (mom_hud_speedometer_lastjumpvel.GetBool())
         {
-            ActivateLabel(m_pLastJumpVelLabel, m_defaultLastJumpVelLabelHeight);
-            char lastJumpVelValue[BUFSIZELOCL];
-            Q_snprintf(lastJumpVelValue, sizeof(lastJumpVelValue), "%i", m_iRoundedLastJumpVel);
-            m_pLastJumpVelLabel->SetText(lastJumpVelValue);
+            if (HudValueChanged(m_iDisplayedLastJumpVel, m_iRoundedLastJumpVel))
+            {
+                Q_snprintf(szValue, sizeof(szValue), "%i", m_iRoundedLastJumpVel);
+                m_pLastJumpVelLabel->SetText(szValue);
+            }
             // Fade out last jump vel based on the lastJumpAlpha value
             m_LastJumpVelColor =
                 Color(m_LastJumpVelColor.r(), m_LastJumpVelColor.g(), m_LastJumpVelColor.b(), m_fLastJumpVelAlpha);
             m_pLastJumpVelLabel->SetFgColor(m_LastJumpVelColor);
         }
-        else
-        {
-            DeactivateLabel(m_pLastJumpVelLabel);
-        }
-
-        if (mom_hud_speedometer_unit_labels.GetBool())
-        {
-            ActivateLabel(m_pUnitsLabel, m_defaultUnitsLabelHeight);
-        }
-        else
-        {
-            DeactivateLabel(m_pUnitsLabel);
-        }
-        // if every speedometer is off, don't bother drawing unit labels
-        if (!mom_hud_speedometer.GetBool() && !mom_hud_speedometer_horiz.GetBool() &&
-            !mom_hud_speedometer_lastjumpvel.GetBool() && !mom_hud_speedometer_showenterspeed.GetBool() &&
-            mom_hud_speedometer_unit_labels.GetBool())
-        {
-            DeactivateLabel(m_pUnitsLabel);
-        }
 
         // Draw the enter speed split, if toggled on. Cannot be done in OnThink()
         if (mom_hud_speedometer_showenterspeed.GetBool() && m_pRunEntData && m_pRunEntData->m_bTimerRunning &&
             m_fStageStartAlpha > 0.0f)
         {
-            ActivateLabel(m_pStageEnterExitLabel, m_defaultStageEnterExitLabelHeight);
-            ActivateLabel(m_pStageEnterExitComparisonLabel, m_defaultStageEnterExitLabelHeight);
-
-            char enterVelUnrounded[BUFSIZELOCL], enterVelRounded[BUFSIZELOCL], enterVelComparisonUnrounded[BUFSIZELOCL],
-                enterVelComparisonRounded[BUFSIZELOCL];
-
-            Color compareColorFade = Color(0, 0, 0, 0);
-            Color compareColor = Color(0, 0, 0, 0);
+            UpdateEnterSpeed();
 
+            // The strings only change with the zone, but the colors fade out every frame
             Color fg = GetFgColor();
-            Color actualColorFade = Color(fg.r(), fg.g(), fg.b(), m_fStageStartAlpha);
-
-            g_pMOMRunCompare->GetComparisonString(VELOCITY_ENTER, m_pRunStats, m_pRunEntData->m_iCurrentZone,
-                                                  enterVelUnrounded, enterVelComparisonUnrounded, &compareColor);
-            // Round velocity
-            Q_snprintf(enterVelRounded, BUFSIZELOCL, "%i", static_cast<int>(round(atof(enterVelUnrounded))));
+            m_pStageEnterExitLabel->SetFgColor(Color(fg.r(), fg.g(), fg.b(), m_fStageStartAlpha));
 
-            bool loadedComparison = g_pMOMRunCompare->LoadedComparison();
-
-            HFont labelFont = m_pStageEnterExitLabel->GetFont();
-            int spaceBetweenLabels = UTIL_ComputeStringWidth(labelFont, " ");
-            // compute the combined length of the enter/exit and comparison
-            int combinedLength = UTIL_ComputeStringWidth(labelFont, enterVelRounded);
-            if (loadedComparison)
+            if (m_bEnterSpeedHasComparison)
             {
-                // Really gross way of ripping apart this string and
-                // making some sort of quasi-frankenstein string of the float as a rounded int
-                char firstThree[3];
-                Q_strncpy(firstThree, enterVelComparisonUnrounded, 3);
-                const char *compFloat = enterVelComparisonUnrounded;
-                Q_snprintf(enterVelComparisonRounded, BUFSIZELOCL, " %s %i)", firstThree,
-                           RoundFloatToInt(Q_atof(compFloat + 3)));
-
                 // Update the compare color to have the alpha defined by animations (fade out if 5+ sec)
-                compareColorFade.SetColor(compareColor.r(), compareColor.g(), compareColor.b(), m_fStageStartAlpha);
-
-                // Add the compare string to the length
-                combinedLength += spaceBetweenLabels + UTIL_ComputeStringWidth(labelFont, enterVelComparisonRounded);
+                m_pStageEnterExitComparisonLabel->SetFgColor(Color(m_EnterSpeedCompareColor.r(), m_EnterSpeedCompareColor.g(),
+                                                                   m_EnterSpeedCompareColor.b(), m_fStageStartAlpha));
             }
-            int offsetXPos = 0 - ((GetWide() - combinedLength) / 2);
-
-            // split_xpos = GetWide() / 2 - (enterVelANSIWidth + increaseX) / 2;
-            m_pStageEnterExitLabel->SetPos(offsetXPos, m_pStageEnterExitLabel->GetYPos());
-            m_pStageEnterExitLabel->SetFgColor(actualColorFade);
-            m_pStageEnterExitLabel->SetText(enterVelRounded);
-
-            // print comparison as well
-            if (loadedComparison)
-            {
-                m_pStageEnterExitComparisonLabel->SetPos(spaceBetweenLabels, m_pStageEnterExitLabel->GetYPos());
-                m_pStageEnterExitComparisonLabel->SetFgColor(compareColorFade);
-                m_pStageEnterExitComparisonLabel->SetText(enterVelComparisonRounded);
-            }
-            else // only print velocity
-            {
-                m_pStageEnterExitComparisonLabel->SetText("");
-            }
-        }
-        else if (!mom_hud_speedometer_showenterspeed.GetBool())
-        {
-            DeactivateLabel(m_pStageEnterExitLabel);
-            DeactivateLabel(m_pStageEnterExitComparisonLabel);
         }
     }
 }
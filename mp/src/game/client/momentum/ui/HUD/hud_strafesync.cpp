@@ -2,6 +2,7 @@
 
 #include "hud_numericdisplay.h"
 #include "hudelement.h"
+#include "hud_update.h"
 #include "clientmode.h"
 #include "util/mom_util.h"
 #include "hud_fillablebar.h"
@@ -70,6 +71,7 @@ class CHudStrafeSyncDisplay : public CHudElement, public CHudNumericDisplay
         m_localStrafeSync = 0;
         m_lastColor = normalColor;
         m_currentColor = normalColor;
+        m_Throttle.Force();
     }
     void ApplySchemeSettings(IScheme *pScheme) OVERRIDE
     {
@@ -80,6 +82,8 @@ class CHudStrafeSyncDisplay : public CHudElement, public CHudNumericDisplay
         increaseColor = GetSchemeColor("MOM.Speedometer.Increase", pScheme);
         decreaseColor = GetSchemeColor("MOM.Speedometer.Decrease", pScheme);
         digit_xpos_initial = digit_xpos;
+        m_LabelDeps.Invalidate();
+        m_Throttle.Force();
     }
     bool ShouldColorize() { return strafesync_colorize.GetInt() > 0; }
     void Paint() OVERRIDE;
@@ -95,6 +99,9 @@ class CHudStrafeSyncDisplay : public CHudElement, public CHudNumericDisplay
 
     float digit_xpos_initial;
 
+    CHudUpdateThrottle m_Throttle;
+    CHudDependencies m_LabelDeps;
+
   protected:
     CPanelAnimationVar(Color, _bgColor, "BgColor", "Blank");
 };
@@ -109,8 +116,10 @@ CHudStrafeSyncDisplay::CHudStrafeSyncDisplay(const char *pElementName): CHudElem
 
 void CHudStrafeSyncDisplay::OnThink()
 {
+    HUD_PROFILE_SCOPE("StrafeSync", HUD_PROFILE_THINK);
+
     const auto pPlayer = C_MomentumPlayer::GetLocalMomPlayer();
-    if (!pPlayer)
+    if (!pPlayer || !m_Throttle.ShouldUpdate())
         return;
 
     m_localStrafeSync = 0;
@@ -173,17 +182,25 @@ void CHudStrafeSyncDisplay::OnThink()
 }
 void CHudStrafeSyncDisplay::Paint()
 {
-    BaseClass::Paint();
+    HUD_PROFILE_SCOPE("StrafeSync", HUD_PROFILE_PAINT);
 
-    if (strafesync_type.GetInt() == 2)
-    {
-        SetLabelText(L"Sync 2");
-    }
-    else
+    m_LabelDeps.Track(strafesync_type.GetInt());
+    m_LabelDeps.Track(GetWide());
+    m_LabelDeps.Track(m_hTextFont);
+    if (m_LabelDeps.Changed())
     {
-        SetLabelText(L"Sync");
+        if (strafesync_type.GetInt() == 2)
+        {
+            SetLabelText(L"Sync 2");
+        }
+        else
+        {
+            SetLabelText(L"Sync");
+        }
+        text_xpos = GetWide() / 2 - UTIL_ComputeStringWidth(m_hTextFont, m_LabelText) / 2;
     }
-    text_xpos = GetWide() / 2 - UTIL_ComputeStringWidth(m_hTextFont, m_LabelText) / 2;
+
+    BaseClass::Paint();
 }
 
 //////////////////////////////////////////
@@ -208,6 +225,7 @@ class CHudStrafeSyncBar : public CHudElement, public CHudFillableBar
         m_localStrafeSync = 0;
         m_lastColor = normalColor;
         m_currentColor = normalColor;
+        m_Throttle.Force();
     }
     void ApplySchemeSettings(IScheme *pScheme) OVERRIDE
     {
@@ -216,6 +234,7 @@ class CHudStrafeSyncBar : public CHudElement, public CHudFillableBar
         normalColor = GetSchemeColor("MOM.Speedometer.Normal", pScheme);
         increaseColor = GetSchemeColor("MOM.Speedometer.Increase", pScheme);
         decreaseColor = GetSchemeColor("MOM.Speedometer.Decrease", pScheme);
+        m_Throttle.Force();
     }
     void Paint() OVERRIDE;
     bool ShouldColorize() { return strafesync_colorize.GetInt() > 0; }
@@ -228,6 +247,8 @@ class CHudStrafeSyncBar : public CHudElement, public CHudFillableBar
     Color m_lastColor;
     Color m_currentColor;
     Color normalColor, increaseColor, decreaseColor;
+
+    CHudUpdateThrottle m_Throttle;
 };
 
 DECLARE_NAMED_HUDELEMENT(CHudStrafeSyncBar, CHudSyncBar);
@@ -239,13 +260,17 @@ CHudStrafeSyncBar::CHudStrafeSyncBar(const char *pElementName) : CHudElement(pEl
 
 void CHudStrafeSyncBar::Paint()
 {
+    HUD_PROFILE_SCOPE("StrafeSyncBar", HUD_PROFILE_PAINT);
+
     BaseClass::Paint(m_currentColor);
 }
 
 void CHudStrafeSyncBar::OnThink()
 {
+    HUD_PROFILE_SCOPE("StrafeSyncBar", HUD_PROFILE_THINK);
+
     const auto pPlayer = C_MomentumPlayer::GetLocalMomPlayer();
-    if (!pPlayer)
+    if (!pPlayer || !m_Throttle.ShouldUpdate())
         return;
 
     const auto pRunEntData = pPlayer->GetCurrentUIEntData();
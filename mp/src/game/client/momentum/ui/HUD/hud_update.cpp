@@ -0,0 +1,189 @@
+#include "cbase.h"
+
+#include "hud_update.h"
+
+#include <vgui/ILocalize.h>
+#include <vgui/ISurface.h>
+#include <vgui_controls/Controls.h>
+
+#include "tier0/memdbgon.h"
+
+using namespace vgui;
+
+static MAKE_CONVAR(mom_hud_update_rate, "30", FLAG_HUD_CVAR,
+                   "Max number of times a second non-critical HUD elements (strafe sync, comparisons) refresh. "
+                   "0 = every frame\n", 0, 300);
+
+static MAKE_TOGGLE_CONVAR(mom_hud_profile, "0", FCVAR_DEVELOPMENTONLY,
+                          "Toggles collecting per-element HUD think/paint timings for mom_hud_profile_print.\n");
+
+bool CHudDependencies::Changed()
+{
+    CRC32_Final(&m_uHash);
+
+    const bool bChanged = !m_bValid || m_uHash != m_uLastHash;
+    m_uLastHash = m_uHash;
+    m_bValid = true;
+
+    CRC32_Init(&m_uHash);
+    return bChanged;
+}
+
+CHudText::CHudText() : m_iLength(0), m_iWidth(0), m_hWidthFont(INVALID_FONT)
+{
+    m_szText[0] = '\0';
+    m_wszText[0] = L'\0';
+}
+
+bool CHudText::SetText(const char *pText)
+{
+    if (FStrEq(m_szText, pText))
+        return false;
+
+    Q_strncpy(m_szText, pText, sizeof(m_szText));
+    ANSI_TO_UNICODE(m_szText, m_wszText);
+    m_iLength = Q_wcslen(m_wszText);
+    m_hWidthFont = INVALID_FONT;
+    return true;
+}
+
+bool CHudText::Format(const char *pFormat, ...)
+{
+    char szText[BUFSIZELOCL];
+    va_list args;
+    va_start(args, pFormat);
+    Q_vsnprintf(szText, sizeof(szText), pFormat, args);
+    va_end(args);
+
+    return SetText(szText);
+}
+
+int CHudText::GetWidth(HFont font)
+{
+    if (m_hWidthFont != font)
+    {
+        m_iWidth = UTIL_ComputeStringWidth(font, m_wszText);
+        m_hWidthFont = font;
+    }
+
+    return m_iWidth;
+}
+
+void CHudText::Draw() const
+{
+    surface()->DrawPrintText(m_wszText, m_iLength);
+}
+
+bool CHudUpdateThrottle::ShouldUpdate()
+{
+    const float flRate = mom_hud_update_rate.GetFloat();
+    if (flRate <= 0.0f)
+        return true;
+
+    const float flNow = gpGlobals->realtime;
+    const float flInterval = 1.0f / flRate;
+
+    // realtime can go backwards over a map change, don't get stuck waiting for it
+    if (flNow < m_flNextUpdate && m_flNextUpdate - flNow <= flInterval)
+        return false;
+
+    m_flNextUpdate = flNow + flInterval;
+    return true;
+}
+
+CHudProfiler::CHudProfiler() : CAutoGameSystemPerFrame("CHudProfiler"), m_iFrames(0), m_flFrameTime(0.0)
+{
+}
+
+void CHudProfiler::Update(float frametime)
+{
+    if (!IsEnabled())
+        return;
+
+    m_iFrames++;
+    m_flFrameTime += frametime;
+}
+
+int CHudProfiler::Register(const char *pszElement)
+{
+    FOR_EACH_VEC(m_vecElements, i)
+    {
+        if (FStrEq(m_vecElements[i].m_pszName, pszElement))
+            return i;
+    }
+
+    ElementTiming_t timing;
+    V_memset(&timing, 0, sizeof(timing));
+    timing.m_pszName = pszElement;
+    return m_vecElements.AddToTail(timing);
+}
+
+bool CHudProfiler::IsEnabled() const
+{
+    return mom_hud_profile.GetBool();
+}
+
+void CHudProfiler::AddTime(int iElement, HudProfileSection_t eSection, double flSeconds)
+{
+    ElementTiming_t &timing = m_vecElements[iElement];
+    timing.m_flTotal[eSection] += flSeconds;
+    timing.m_flMax[eSection] = Max(timing.m_flMax[eSection], flSeconds);
+    timing.m_iCalls[eSection]++;
+}
+
+void CHudProfiler::Print()
+{
+    if (!m_iFrames)
+    {
+        Msg("No HUD timings collected yet, turn on mom_hud_profile first.\n");
+        return;
+    }
+
+    const double flAvgFrame = m_flFrameTime / m_iFrames;
+    Msg("HUD timings over %i frames (avg frame %.3f ms), in ms per frame:\n", m_iFrames, flAvgFrame * 1000.0);
+    Msg("%-20s %10s %10s %10s %10s %8s\n", "Element", "Think avg", "Think max", "Paint avg", "Paint max", "% frame");
+
+    double flTotal = 0.0;
+    FOR_EACH_VEC(m_vecElements, i)
+    {
+        const ElementTiming_t &timing = m_vecElements[i];
+        const double flElementTotal = timing.m_flTotal[HUD_PROFILE_THINK] + timing.m_flTotal[HUD_PROFILE_PAINT];
+        flTotal += flElementTotal;
+
+        Msg("%-20s %10.4f %10.4f %10.4f %10.4f %7.2f%%\n", timing.m_pszName,
+            timing.m_flTotal[HUD_PROFILE_THINK] * 1000.0 / m_iFrames, timing.m_flMax[HUD_PROFILE_THINK] * 1000.0,
+            timing.m_flTotal[HUD_PROFILE_PAINT] * 1000.0 / m_iFrames, timing.m_flMax[HUD_PROFILE_PAINT] * 1000.0,
+            m_flFrameTime > 0.0 ? flElementTotal * 100.0 / m_flFrameTime : 0.0);
+    }
+
+    Msg("Total: %.4f ms per frame, %.2f%% of the frame time\n", flTotal * 1000.0 / m_iFrames,
+        m_flFrameTime > 0.0 ? flTotal * 100.0 / m_flFrameTime : 0.0);
+}
+
+void CHudProfiler::Reset()
+{
+    FOR_EACH_VEC(m_vecElements, i)
+    {
+        ElementTiming_t &timing = m_vecElements[i];
+        const char *pszName = timing.m_pszName;
+        V_memset(&timing, 0, sizeof(timing));
+        timing.m_pszName = pszName;
+    }
+
+    m_iFrames = 0;
+    m_flFrameTime = 0.0;
+}
+
+static CHudProfiler s_HudProfiler;
+CHudProfiler *g_pHudProfiler = &s_HudProfiler;
+
+CON_COMMAND_F(mom_hud_profile_print, "Prints the per-element HUD think/paint timings collected with mom_hud_profile.\n",
+              FCVAR_DEVELOPMENTONLY)
+{
+    g_pHudProfiler->Print();
+}
+
+CON_COMMAND_F(mom_hud_profile_reset, "Clears the collected HUD timings.\n", FCVAR_DEVELOPMENTONLY)
+{
+    g_pHudProfiler->Reset();
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "checksum_crc.h"
+#include "igamesystem.h"
+#include "mom_shareddefs.h"
+#include <vgui/VGUI.h>
+
+// Helpers for Momentum HUD elements to only redo work when what they show actually changes:
+// - CHudDependencies hashes the values an element's text/layout is built from, so it can tell when to rebuild
+// - CHudText keeps a formatted string with its Unicode conversion and width, redone only on change
+// - CHudUpdateThrottle limits non-critical elements to mom_hud_update_rate refreshes a second
+// - HUD_PROFILE_SCOPE times an element's think/paint for mom_hud_profile_print
+
+// Stores value into cached and returns true if it was different
+template <class T>
+inline bool HudValueChanged(T &cached, const T &value)
+{
+    if (cached == value)
+        return false;
+
+    cached = value;
+    return true;
+}
+
+// Track() everything the output depends on, then call Changed() to see if any of it differs from last time.
+// Only track plain values (ints, floats, handles, pointers), not structs with padding.
+class CHudDependencies
+{
+  public:
+    CHudDependencies() : m_uLastHash(0), m_bValid(false) { CRC32_Init(&m_uHash); }
+
+    template <class T>
+    void Track(const T &value) { CRC32_ProcessBuffer(&m_uHash, &value, sizeof(T)); }
+    void TrackString(const char *pStr) { CRC32_ProcessBuffer(&m_uHash, pStr, Q_strlen(pStr)); }
+
+    // True if the tracked values differ from the previous call (or Invalidate() was called). Starts the next set.
+    bool Changed();
+
+    // Makes the next Changed() return true, for things that can't be tracked (scheme reloads, localization)
+    void Invalidate() { m_bValid = false; }
+
+  private:
+    CRC32_t m_uHash, m_uLastHash;
+    bool m_bValid;
+};
+
+// A line of HUD text that only gets converted to Unicode and measured when it changes
+class CHudText
+{
+  public:
+    CHudText();
+
+    // Both return true if the text changed
+    bool SetText(const char *pText);
+    bool Format(PRINTF_FORMAT_STRING const char *pFormat, ...) FMTFUNCTION(2, 3);
+    void Clear() { SetText(""); }
+
+    const char *GetText() const { return m_szText; }
+    const wchar_t *GetUnicode() const { return m_wszText; }
+    int GetLength() const { return m_iLength; }
+
+    // Width of the text in the given font, measured once per text/font change
+    int GetWidth(vgui::HFont font);
+
+    // Draws at the current surface text position, color and font
+    void Draw() const;
+
+  private:
+    char m_szText[BUFSIZELOCL];
+    wchar_t m_wszText[BUFSIZELOCL];
+    int m_iLength;
+    int m_iWidth;
+    vgui::HFont m_hWidthFont;
+};
+
+// Lets a non-critical element skip refreshing until 1 / mom_hud_update_rate seconds have passed
+class CHudUpdateThrottle
+{
+  public:
+    CHudUpdateThrottle() : m_flNextUpdate(0.0f) {}
+
+    bool ShouldUpdate();
+    void Force() { m_flNextUpdate = 0.0f; }
+
+  private:
+    float m_flNextUpdate;
+};
+
+enum HudProfileSection_t
+{
+    HUD_PROFILE_THINK = 0,
+    HUD_PROFILE_PAINT,
+
+    HUD_PROFILE_COUNT
+};
+
+// Per-element think/paint timings, collected while mom_hud_profile is on
+class CHudProfiler : public CAutoGameSystemPerFrame
+{
+  public:
+    CHudProfiler();
+
+    void Update(float frametime) OVERRIDE;
+
+    int Register(const char *pszElement);
+    bool IsEnabled() const;
+    void AddTime(int iElement, HudProfileSection_t eSection, double flSeconds);
+
+    void Print();
+    void Reset();
+
+  private:
+    struct ElementTiming_t
+    {
+        const char *m_pszName;
+        double m_flTotal[HUD_PROFILE_COUNT];
+        double m_flMax[HUD_PROFILE_COUNT];
+        int m_iCalls[HUD_PROFILE_COUNT];
+    };
+
+    CUtlVector<ElementTiming_t> m_vecElements;
+    int m_iFrames;
+    double m_flFrameTime;
+};
+
+extern CHudProfiler *g_pHudProfiler;
+
+class CHudProfileScope
+{
+  public:
+    CHudProfileScope(int iElement, HudProfileSection_t eSection) : m_iElement(iElement), m_eSection(eSection)
+    {
+        m_flStart = g_pHudProfiler->IsEnabled() ? Plat_FloatTime() : 0.0;
+    }
+
+    ~CHudProfileScope()
+    {
+        if (m_flStart > 0.0)
+            g_pHudProfiler->AddTime(m_iElement, m_eSection, Plat_FloatTime() - m_flStart);
+    }
+
+  private:
+    int m_iElement;
+    HudProfileSection_t m_eSection;
+    double m_flStart;
+};
+
+// Put at the top of an element's OnThink/Paint, name is a string literal shared by every instance of the element
+#define HUD_PROFILE_SCOPE(name, section)                                                                               \
+    static const int s_iHudProfileElement = g_pHudProfiler->Register(name);                                            \
+    CHudProfileScope hudProfileScope(s_iHudProfileElement, section)
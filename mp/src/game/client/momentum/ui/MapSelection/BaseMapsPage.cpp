@@ -19,67 +19,6 @@
 
 using namespace vgui;
 
-// Sort functions
-static int __cdecl MapNameSortFunc(vgui::ListPanel *pPanel, const vgui::ListPanelItem &item1,
-                                   const vgui::ListPanelItem &item2)
-{
-    const char *string1 = item1.kv->GetString(KEYNAME_MAP_NAME);
-    const char *string2 = item2.kv->GetString(KEYNAME_MAP_NAME);
-    return Q_stricmp(string1, string2);
-}
-
-static int __cdecl MapPersonalBestSortFunc(vgui::ListPanel *pPanel, const vgui::ListPanelItem &item1,
-                                           const vgui::ListPanelItem &item2)
-{
-    const auto left = item1.kv->GetFloat(KEYNAME_MAP_PERSONAL_BEST_SORT);
-    const auto right = item2.kv->GetFloat(KEYNAME_MAP_PERSONAL_BEST_SORT);
-    if (left < right)
-        return -1;
-    if (right < left)
-        return 1;
-    return 0;
-}
-
-static int __cdecl MapWorldRecordSortFunc(vgui::ListPanel *pPanel, const vgui::ListPanelItem &item1,
-                                          const vgui::ListPanelItem &item2)
-{
-    const auto left = item1.kv->GetFloat(KEYNAME_MAP_WORLD_RECORD_SORT);
-    const auto right = item2.kv->GetFloat(KEYNAME_MAP_WORLD_RECORD_SORT);
-    if (left < right)
-        return -1;
-    if (right < left)
-        return 1;
-    return 0;
-}
-
-static int __cdecl MapLayoutSortFunc(vgui::ListPanel *pPanel, const vgui::ListPanelItem &item1,
-                                     const vgui::ListPanelItem &item2)
-{
-    const char *i1 = item1.kv->GetString(KEYNAME_MAP_LAYOUT);
-    const char *i2 = item2.kv->GetString(KEYNAME_MAP_LAYOUT);
-    return Q_stricmp(i1, i2);
-}
-
-static int __cdecl MapCreationDateSortFunc(vgui::ListPanel *pPanel, const vgui::ListPanelItem &item1,
-                                           const vgui::ListPanelItem &item2)
-{
-    const char *i1 = item1.kv->GetString(KEYNAME_MAP_CREATION_DATE_SORT);
-    const char *i2 = item2.kv->GetString(KEYNAME_MAP_CREATION_DATE_SORT);
-    return Q_stricmp(i1, i2);
-}
-
-static int __cdecl MapLastPlayedSortFunc(vgui::ListPanel *pPanel, const vgui::ListPanelItem &item1,
-                                         const vgui::ListPanelItem &item2)
-{
-    uint64 left = item1.kv->GetUint64(KEYNAME_MAP_LAST_PLAYED_SORT);
-    uint64 right = item2.kv->GetUint64(KEYNAME_MAP_LAST_PLAYED_SORT);
-    if (left < right)
-        return -1;
-    if (left == right)
-        return 0;
-    return 1;
-}
-
 //-----------------------------------------------------------------------------
 // Purpose: Constructor
 //-----------------------------------------------------------------------------
@@ -92,6 +31,7 @@ CBaseMapsPage::CBaseMapsPage(vgui::Panel *parent, const char *name) : PropertyPa
     SetSize(pWide, pTall);
 
     m_hFont = INVALID_FONT;
+    m_bRowsAdded = false;
     parent->AddActionSignalTarget(this);
 
     // Init UI
@@ -155,13 +95,8 @@ CBaseMapsPage::CBaseMapsPage(vgui::Panel *parent, const char *name) : PropertyPa
     m_pMapList->SetColumnTextAlignment(HEADER_WORLD_RECORD, Label::a_center);
     m_pMapList->SetColumnTextAlignment(HEADER_BEST_TIME, Label::a_center);
 
-    // Sort Functions
-    m_pMapList->SetSortFunc(HEADER_MAP_NAME, MapNameSortFunc);
-    m_pMapList->SetSortFunc(HEADER_WORLD_RECORD, MapWorldRecordSortFunc);
-    m_pMapList->SetSortFunc(HEADER_BEST_TIME, MapPersonalBestSortFunc);
-    m_pMapList->SetSortFunc(HEADER_MAP_LAYOUT, MapLayoutSortFunc);
-    m_pMapList->SetSortFunc(HEADER_DATE_CREATED, MapCreationDateSortFunc);
-    m_pMapList->SetSortFunc(HEADER_LAST_PLAYED, MapLastPlayedSortFunc);
+    // Rows come from m_vecRows and are sorted with CompareRows
+    m_pMapList->SetDataSource(this);
 
     // disable sort for certain columns
     m_pMapList->SetColumnSortable(HEADER_MAP_IMAGE, false);
@@ -182,6 +117,61 @@ CBaseMapsPage::~CBaseMapsPage() {}
 //-----------------------------------------------------------------------------
 int CBaseMapsPage::GetInvalidMapListID() { return m_pMapList->InvalidItemID(); }
 
+KeyValues *CBaseMapsPage::GetRowData(int row)
+{
+    if (!m_vecRows.IsValidIndex(row))
+        return nullptr;
+
+    const auto pData = MapSelectorDialog().GetMapListDataByID(m_vecRows[row]->m_uID);
+    return pData ? pData->m_pKv : nullptr;
+}
+
+unsigned int CBaseMapsPage::GetRowUserData(int row)
+{
+    return m_vecRows.IsValidIndex(row) ? m_vecRows[row]->m_uID : 0;
+}
+
+template <class T>
+static int CompareValues(const T &left, const T &right)
+{
+    return left < right ? -1 : (right < left);
+}
+
+int CBaseMapsPage::CompareRows(int column, int row1, int row2)
+{
+    const MapData *pLeft = m_vecRows[row1], *pRight = m_vecRows[row2];
+
+    // Same orders the list data's keys gave
+    switch (column)
+    {
+    case HEADER_MAP_IN_LIBRARY:
+        return CompareValues(pLeft->m_bInLibrary ? INDX_MAP_IN_LIBRARY : INDX_MAP_NOT_IN_LIBRARY,
+                             pRight->m_bInLibrary ? INDX_MAP_IN_LIBRARY : INDX_MAP_NOT_IN_LIBRARY);
+    case HEADER_MAP_IN_FAVORITES:
+        return CompareValues(pLeft->m_bInFavorites ? INDX_MAP_IN_FAVORITES : INDX_MAP_NOT_IN_FAVORITES,
+                             pRight->m_bInFavorites ? INDX_MAP_IN_FAVORITES : INDX_MAP_NOT_IN_FAVORITES);
+    case HEADER_MAP_NAME:
+        return Q_stricmp(pLeft->m_szMapName, pRight->m_szMapName);
+    case HEADER_MAP_LAYOUT:
+        return CompareValues(pLeft->m_MainTrack.m_bIsLinear ? INDX_MAP_IS_LINEAR : INDX_MAP_IS_STAGED,
+                             pRight->m_MainTrack.m_bIsLinear ? INDX_MAP_IS_LINEAR : INDX_MAP_IS_STAGED);
+    case HEADER_DIFFICULTY:
+        return CompareValues(pLeft->m_MainTrack.m_iDifficulty, pRight->m_MainTrack.m_iDifficulty);
+    case HEADER_WORLD_RECORD:
+        return CompareValues(pLeft->m_WorldRecord.m_bValid ? pLeft->m_WorldRecord.m_Run.m_fTime : 0.0f,
+                             pRight->m_WorldRecord.m_bValid ? pRight->m_WorldRecord.m_Run.m_fTime : 0.0f);
+    case HEADER_BEST_TIME:
+        return CompareValues(pLeft->m_PersonalBest.m_bValid ? pLeft->m_PersonalBest.m_Run.m_fTime : 0.0f,
+                             pRight->m_PersonalBest.m_bValid ? pRight->m_PersonalBest.m_Run.m_fTime : 0.0f);
+    case HEADER_DATE_CREATED:
+        return Q_stricmp(pLeft->m_Info.m_szCreationDate, pRight->m_Info.m_szCreationDate);
+    case HEADER_LAST_PLAYED:
+        return CompareValues(pLeft->m_tLastPlayed, pRight->m_tLastPlayed);
+    default:
+        return 0;
+    }
+}
+
 MapDisplay_t *CBaseMapsPage::GetMapDisplayByID(uint32 id)
 {
     if (m_mapMaps.Count() == 0)
@@ -242,74 +232,50 @@ void CBaseMapsPage::ApplyFilters(MapFilters_t filters) { OnApplyFilters(filters)
 
 void CBaseMapsPage::OnApplyFilters(MapFilters_t filters)
 {
-    // loop through all the maps checking filters
-    FOR_EACH_MAP_FAST(m_mapMaps, i)
+    // The map cache's index gives every cached map that passes, in ID order like m_mapMaps,
+    // so both can be walked together to build the rows
+    CUtlVector<uint32> vecPassing;
+    g_pMapCache->FindMaps(filters, vecPassing);
+
+    CUtlVector<MapData *> vecRows;
+    vecRows.EnsureCapacity(vecPassing.Count());
+
+    int iPassing = 0;
+    for (auto i = m_mapMaps.FirstInorder(); m_mapMaps.IsValidIndex(i); i = m_mapMaps.NextInorder(i))
     {
+        const uint32 uID = m_mapMaps.Key(i);
+        while (iPassing < vecPassing.Count() && vecPassing[iPassing] < uID)
+            iPassing++;
+
+        // Maps without list data yet get shown once they have it
         MapDisplay_t *pMap = &m_mapMaps[i];
-        // Now we can check the filters
-        if (!MapPassesFilters(pMap->m_pMap, filters))
+        if (!MapSelectorDialog().GetMapListDataByID(uID))
         {
-            m_pMapList->SetItemVisible(pMap->m_iListID, false);
-            pMap->m_bNeedsShown = true;
+            pMap->m_iListID = GetInvalidMapListID();
+            continue;
         }
-        else if (pMap->m_bNeedsShown)
-        {
-            m_pMapList->SetItemVisible(pMap->m_iListID, true);
-            pMap->m_bNeedsShown = false;
-        }
-    }
-
-    UpdateStatus();
-    m_pMapList->SortList();
-    InvalidateLayout();
-    Repaint();
-}
-
-bool CBaseMapsPage::MapPassesFilters(MapData *pMap, MapFilters_t filters)
-{
-    if (!pMap)
-        return false;
 
-    // Needs to pass map name filter
-    // compare the first few characters of the filter
-    const char *szMapNameFilter = filters.m_szMapName;
-    int count = Q_strlen(szMapNameFilter);
+        const bool bPasses = iPassing < vecPassing.Count() && vecPassing[iPassing] == uID &&
+                             !(filters.m_bHideCompleted && pMap->m_pMap->m_PersonalBest.m_bValid);
 
-    // strstr returns null if the substring is not in the base string
-    if (count && !Q_strstr(pMap->m_szMapName, szMapNameFilter))
-        return false;
-
-    // Difficulty
-    int iDiffLowBound = filters.m_iDifficultyLow;
-    int iDiffHighBound = filters.m_iDifficultyHigh;
-    bool bPassesLower = true;
-    bool bPassesHigher = true;
-    if (iDiffLowBound)
-    {
-        bPassesLower = pMap->m_MainTrack.m_iDifficulty >= iDiffLowBound;
+        pMap->m_iListID = bPasses ? vecRows.AddToTail(pMap->m_pMap) : GetInvalidMapListID();
+        pMap->m_bNeedsShown = false;
     }
-    if (iDiffHighBound)
-    {
-        bPassesHigher = pMap->m_MainTrack.m_iDifficulty <= iDiffHighBound;
-    }
-    if (!(bPassesLower && bPassesHigher))
-        return false;
 
-    // Game mode (if it's a surf/bhop/etc map or not)
-    int iGameModeFilter = filters.m_iGameMode;
-    if (iGameModeFilter && iGameModeFilter != pMap->m_eType)
-        return false;
+    bool bChanged = m_bRowsAdded || vecRows.Count() != m_vecRows.Count();
+    for (int i = 0; !bChanged && i < vecRows.Count(); i++)
+        bChanged = vecRows[i] != m_vecRows[i];
 
-    bool bHideCompleted = filters.m_bHideCompleted;
-    if (bHideCompleted && pMap->m_PersonalBest.m_bValid)
-        return false;
-
-    // Map layout (0 = all, 1 = show staged maps only, 2 = show linear maps only)
-    int iMapLayoutFilter = filters.m_iMapLayout;
-    if (iMapLayoutFilter && pMap->m_MainTrack.m_bIsLinear + 1 != iMapLayoutFilter)
-        return false;
+    if (!bChanged)
+        return;
 
-    return true;
+    m_bRowsAdded = false;
+    m_vecRows.Swap(vecRows);
+    m_pMapList->RefreshDataSource();
+    UpdateStatus();
+    m_pMapList->SortList();
+    InvalidateLayout();
+    Repaint();
 }
 
 //-----------------------------------------------------------------------------
@@ -389,19 +355,20 @@ void CBaseMapsPage::OnMapListDataUpdate(int mapID)
     {
         m_pMapList->ApplyItemChanges(pMapDisplay->m_iListID);
     }
-    else
+    else if (MapSelectorDialog().GetMapListDataByID(mapID))
     {
-        // Otherwise we need to add it
-        const auto pData = MapSelectorDialog().GetMapListDataByID(mapID);
-        if (pData)
+        // Otherwise we need to add it, unless the filters hid it
+        if (pMapDisplay->m_bNeedsShown)
         {
-            pMapDisplay->m_iListID = m_pMapList->AddItem(pData->m_pKv, mapID, false, false, false);
-        }
-        else
-        {
-            MapSelectorDialog().CreateMapListData(pMapDisplay->m_pMap);
+            pMapDisplay->m_iListID = m_vecRows.AddToTail(pMapDisplay->m_pMap);
+            m_pMapList->RefreshDataSource();
+            m_bRowsAdded = true;
         }
     }
+    else
+    {
+        MapSelectorDialog().CreateMapListData(pMapDisplay->m_pMap);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -432,11 +399,12 @@ void CBaseMapsPage::OnMapDownloadEnd(KeyValues *pKv)
 {
     uint32 id = pKv->GetInt("id");
     MapDisplay_t *map = GetMapDisplayByID(id);
-    if (map)
+    const auto pData = MapSelectorDialog().GetMapListDataByID(id);
+    if (map && pData)
     {
-        KeyValues *pKvInto = m_pMapList->GetItem(map->m_iListID);
-        pKvInto->SetColor("cellcolor", pKv->GetBool("error") ? m_cMapDLFailed : m_cMapDLSuccess);
-        m_pMapList->ApplyItemChanges(map->m_iListID);
+        pData->m_pKv->SetColor("cellcolor", pKv->GetBool("error") ? m_cMapDLFailed : m_cMapDLSuccess);
+        if (m_pMapList->IsValidItemID(map->m_iListID))
+            m_pMapList->ApplyItemChanges(map->m_iListID);
     }
 }
 
@@ -495,13 +463,25 @@ MapFilters_t CBaseMapsPage::GetFilters()
 //-----------------------------------------------------------------------------
 void CBaseMapsPage::RemoveMap(MapDisplay_t &map)
 {
-    if (m_pMapList->IsValidItemID(map.m_iListID))
+    MapData *pData = map.m_pMap;
+
+    const int iRow = m_vecRows.Find(pData);
+    if (m_vecRows.IsValidIndex(iRow))
     {
-        // find the row in the list and kill
-        m_pMapList->RemoveItem(map.m_iListID);
-        m_mapMaps.Remove(map.m_pMap->m_uID);
+        // find the row in the list and kill, the ones after it move up
+        m_vecRows.Remove(iRow);
+        for (int i = iRow; i < m_vecRows.Count(); i++)
+        {
+            MapDisplay_t *pDisplay = GetMapDisplayByID(m_vecRows[i]->m_uID);
+            if (pDisplay)
+                pDisplay->m_iListID = i;
+        }
+
+        m_pMapList->RefreshDataSource();
     }
 
+    m_mapMaps.Remove(pData->m_uID);
+
     UpdateStatus();
 }
 
@@ -511,6 +491,7 @@ void CBaseMapsPage::RemoveMap(MapDisplay_t &map)
 void CBaseMapsPage::ClearMapList()
 {
     m_mapMaps.RemoveAll();
+    m_vecRows.RemoveAll();
     m_pMapList->RemoveAll();
 }
 
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "IMapList.h"
+#include "vgui_controls/ListPanel.h"
 #include "vgui_controls/PropertyPage.h"
 
 class MapFilterPanel;
@@ -52,7 +53,7 @@ enum HEADERS
 //-----------------------------------------------------------------------------
 // Purpose: Base property page for all the games lists (internet/favorites/lan/etc.)
 //-----------------------------------------------------------------------------
-class CBaseMapsPage : public vgui::PropertyPage, public IMapList
+class CBaseMapsPage : public vgui::PropertyPage, public IMapList, public vgui::IListPanelDataSource
 {
     DECLARE_CLASS_SIMPLE(CBaseMapsPage, vgui::PropertyPage);
 
@@ -77,7 +78,6 @@ public:
     virtual MapFilters_t GetFilters();
     void ApplyFilters(MapFilters_t filters) OVERRIDE;
     virtual void OnApplyFilters(MapFilters_t filters);
-    virtual bool MapPassesFilters(MapData *pData, MapFilters_t filters);
 
     // Called when the Feeling Lucky button is pressed
     virtual void StartRandomMap() OVERRIDE;
@@ -94,6 +94,12 @@ public:
     // Modulecomm events passed in through the MapSelectorDialog
     MESSAGE_FUNC_PARAMS(OnMapDownloadEnd, "MapDownloadEnd", pKv);
     MESSAGE_FUNC_PARAMS(OnMapCacheUpdated, "MapCacheUpdated", pKv) {}
+
+    // IListPanelDataSource, the list's rows are m_vecRows
+    int GetRowCount() OVERRIDE { return m_vecRows.Count(); }
+    KeyValues *GetRowData(int row) OVERRIDE;
+    unsigned int GetRowUserData(int row) OVERRIDE;
+    int CompareRows(int column, int row1, int row2) OVERRIDE;
 protected:
     virtual void OnCommand(const char *command);
 
@@ -120,9 +126,13 @@ protected:
     CMapListPanel *m_pMapList;
 
     CUtlMap<uint32, MapDisplay_t> m_mapMaps;
+    // The maps shown in the list, the list panel sorts its own array of indices into this
+    CUtlVector<MapData *> m_vecRows;
 
 private:
     vgui::HFont m_hFont;
+    // Rows were added since the filters were last applied, so the rows need rebuilding even if no map's filter result changed
+    bool m_bRowsAdded;
 
     Color m_cMapDLFailed, m_cMapDLSuccess;
 };
\ No newline at end of file
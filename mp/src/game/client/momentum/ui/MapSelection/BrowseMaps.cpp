@@ -46,8 +46,8 @@ void CBrowseMaps::MapsQueryCallback(KeyValues *pKvResponse)
 
     if (pKvData)
     {
-        KeyValues *pMaps = pKvData->FindKey("maps");
-        if (g_pMapCache->AddMapsToCache(pMaps, MODEL_FROM_SEARCH_API_CALL))
+        const auto pMaps = static_cast<CUtlVector<MapData*>*>(pKvData->GetPtr("maps"));
+        if (pMaps && g_pMapCache->AddMapsToCache(*pMaps, MODEL_FROM_SEARCH_API_CALL))
         {
             GetNewMapList();
             
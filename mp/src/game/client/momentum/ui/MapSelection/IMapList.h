@@ -18,8 +18,9 @@ struct MapDisplay_t
         m_pMap = nullptr;
     }
     MapData *m_pMap;      // the map struct, containing the information for the map
-    int m_iListID;        // the VGUI2 list panel index for displaying this server
-    bool m_bNeedsShown, m_bNeedsUpdate;
+    int m_iListID;        // the row of this map in the list panel, -1 if it's filtered out
+    bool m_bNeedsShown;   // no filter pass has placed the map yet, so it's shown as soon as it has list data
+    bool m_bNeedsUpdate;
 };
 
 // Used by map filter panel
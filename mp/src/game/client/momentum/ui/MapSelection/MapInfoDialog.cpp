@@ -266,6 +266,7 @@ void CDialogMapInfo::FillMapInfo()
     m_pMapDescription->GotoTextStart();
 
     // Update images
+    m_pMapData->LoadDetails();
     if (m_pMapData->m_vecImages.Count() != m_pImageGallery->GetImageCount())
     {
         m_pImageGallery->RemoveAllImages();
@@ -121,8 +121,8 @@ CMapSelectorDialog::CMapSelectorDialog(VPANEL parent) : Frame(nullptr, "CMapSele
     // Listen for download events
     m_iDownloadQueueIndx = g_pModuleComms->ListenForEvent("map_download_queued", UtlMakeDelegate(this, &CMapSelectorDialog::OnMapDownloadQueued));
     m_iDownloadStartIndx = g_pModuleComms->ListenForEvent("map_download_start", UtlMakeDelegate(this, &CMapSelectorDialog::OnMapDownloadStart));
-    m_iDownloadSizeIndx = g_pModuleComms->ListenForEvent("map_download_size", UtlMakeDelegate(this, &CMapSelectorDialog::OnMapDownloadSize));
-    m_iDownloadProgressIndx = g_pModuleComms->ListenForEvent("map_download_progress", UtlMakeDelegate(this, &CMapSelectorDialog::OnMapDownloadProgress));
+    m_iDownloadSizeIndx = g_pModuleComms->ListenForEvent(UtlMakeDelegate(this, &CMapSelectorDialog::OnMapDownloadSize));
+    m_iDownloadProgressIndx = g_pModuleComms->ListenForEvent(UtlMakeDelegate(this, &CMapSelectorDialog::OnMapDownloadProgress));
     m_iDownloadEndIndx = g_pModuleComms->ListenForEvent("map_download_end", UtlMakeDelegate(this, &CMapSelectorDialog::OnMapDownloadEnd));
 }
 
@@ -151,8 +151,8 @@ CMapSelectorDialog::~CMapSelectorDialog()
     // Download events
     g_pModuleComms->RemoveListener("map_download_queued", m_iDownloadQueueIndx);
     g_pModuleComms->RemoveListener("map_download_start", m_iDownloadStartIndx);
-    g_pModuleComms->RemoveListener("map_download_size", m_iDownloadSizeIndx);
-    g_pModuleComms->RemoveListener("map_download_progress", m_iDownloadProgressIndx);
+    g_pModuleComms->RemoveListener(MapDownloadSizeEvent_t::EVENT, m_iDownloadSizeIndx);
+    g_pModuleComms->RemoveListener(MapDownloadProgressEvent_t::EVENT, m_iDownloadProgressIndx);
     g_pModuleComms->RemoveListener("map_download_end", m_iDownloadEndIndx);
 }
 
@@ -442,21 +442,21 @@ void CMapSelectorDialog::OnMapDownloadStart(KeyValues* pKv)
     UpdateMapInfoDialog(uID);
 }
 
-void CMapSelectorDialog::OnMapDownloadSize(KeyValues* pKv)
+void CMapSelectorDialog::OnMapDownloadSize(const MapDownloadSizeEvent_t &event)
 {
-    const auto indx = m_mapMapDownloads.Find(pKv->GetInt("id"));
+    const auto indx = m_mapMapDownloads.Find(event.m_uMapID);
     if (m_mapMapDownloads.IsValidIndex(indx))
     {
-        m_mapMapDownloads[indx]->SetDownloadSize(pKv->GetUint64("size"));
+        m_mapMapDownloads[indx]->SetDownloadSize(event.m_uSize);
     }
 }
 
-void CMapSelectorDialog::OnMapDownloadProgress(KeyValues* pKv)
+void CMapSelectorDialog::OnMapDownloadProgress(const MapDownloadProgressEvent_t &event)
 {
-    const auto indx = m_mapMapDownloads.Find(pKv->GetInt("id"));
+    const auto indx = m_mapMapDownloads.Find(event.m_uMapID);
     if (m_mapMapDownloads.IsValidIndex(indx))
     {
-        m_mapMapDownloads[indx]->SetDownloadProgress(pKv->GetInt("offset") + pKv->GetInt("size"));
+        m_mapMapDownloads[indx]->SetDownloadProgress(event.m_uDownloaded);
     }
     else
     {
@@ -5,6 +5,8 @@
 struct MapDisplay_t;
 struct MapFilters_t;
 struct MapData;
+struct MapDownloadSizeEvent_t;
+struct MapDownloadProgressEvent_t;
 class CMapContextMenu;
 class CDialogMapInfo;
 class CLibraryMaps;
@@ -102,8 +104,8 @@ class CMapSelectorDialog : public vgui::Frame
     // Callbacks for download
     void OnMapDownloadQueued(KeyValues *pKv);
     void OnMapDownloadStart(KeyValues *pKv);
-    void OnMapDownloadSize(KeyValues *pKv);
-    void OnMapDownloadProgress(KeyValues *pKv);
+    void OnMapDownloadSize(const MapDownloadSizeEvent_t &event);
+    void OnMapDownloadProgress(const MapDownloadProgressEvent_t &event);
     void OnMapDownloadEnd(KeyValues *pKv);
 
     bool IsMapDownloading(uint32 uMapID) const;
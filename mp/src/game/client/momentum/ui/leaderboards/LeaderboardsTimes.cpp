@@ -989,7 +989,7 @@ void CLeaderboardsTimes::OnConfirmDeleteReplay(int itemID, const char* file)
         m_bTimesNeedUpdate[TIMES_LOCAL] = true;
         if (m_pLocalLeaderboards->RemoveItem(itemID))
         {
-            g_pMOMRunCompare->LoadComparisons();
+            g_pMOMRunCompare->ReloadComparisons();
             FillLeaderboards(false);
         }
     }
@@ -7,11 +7,12 @@
 // world light data from the BSP itself, before entities are initialised on map
 // load.
 //
-// To find the brightest light at a point, all world lights are iterated.
-// Lights whose radii do not encompass our sample point are quickly rejected,
-// as are lights which are not in our PVS, or visible from the sample point.
-// If the sky light is visible from the sample point, then it shall supersede
-// all other world lights.
+// On map load the world lights are bucketed by the PVS clusters they are
+// visible from. To find the brightest light at a point, only the lights in
+// the PVS of the point's cluster are iterated. Lights whose radii do not
+// encompass our sample point are quickly rejected, as are lights which are not
+// visible from the sample point. If the sky light is visible from the sample
+// point, then it shall supersede all other world lights.
 //
 // Written: November 2011
 // Author: Saul Rennison
@@ -89,7 +90,7 @@ static float Engine_WorldLightDistanceFalloff(const dworldlight_t *wl, const Vec
 //-----------------------------------------------------------------------------
 // Purpose: initialise game system and members
 //-----------------------------------------------------------------------------
-CWorldLights::CWorldLights() : CAutoGameSystem("World lights")
+CWorldLights::CWorldLights() : CAutoGameSystem("World lights"), m_mapEntityLights(DefLessFunc(unsigned long))
 {
     m_nWorldLights = 0;
     m_pWorldLights = nullptr;
@@ -107,6 +108,13 @@ void CWorldLights::Clear()
         delete[] m_pWorldLights;
         m_pWorldLights = nullptr;
     }
+
+    m_vecClusterLightStart.Purge();
+    m_vecClusterLights.Purge();
+    m_vecSkyLights.Purge();
+    m_vecAllLights.Purge();
+    m_PVSScratch.Purge();
+    m_mapEntityLights.Purge();
 }
 
 //-----------------------------------------------------------------------------
@@ -169,7 +177,58 @@ void CWorldLights::LevelInitPreEntity()
     g_pFullFileSystem->Read(m_pWorldLights, lightLump.filelen, hFile);
     g_pFullFileSystem->Close(hFile);
 
-    DevMsg("CWorldLights: load successful (%d lights at 0x%p)\n", m_nWorldLights, m_pWorldLights);
+    BuildClusterLights();
+
+    DevMsg("CWorldLights: load successful (%d lights at 0x%p, %d cluster entries)\n", m_nWorldLights, m_pWorldLights,
+           m_vecClusterLights.Count());
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: bucket the world lights by the clusters that have them in their PVS
+//-----------------------------------------------------------------------------
+void CWorldLights::BuildClusterLights()
+{
+    for (int i = 0; i < m_nWorldLights; ++i)
+    {
+        const dworldlight_t &light = m_pWorldLights[i];
+        if (light.type == emit_skyambient)
+            continue;
+
+        if (light.type == emit_skylight)
+            m_vecSkyLights.AddToTail(i);
+        else
+            m_vecAllLights.AddToTail(i);
+    }
+
+    // Each light's cluster only has to be looked up once, the PVS bits are tested directly below
+    CUtlVector<int> vecLightClusters;
+    vecLightClusters.SetCount(m_vecAllLights.Count());
+    FOR_EACH_VEC(m_vecAllLights, i)
+        vecLightClusters[i] = g_pEngineServer->GetClusterForOrigin(m_pWorldLights[m_vecAllLights[i]].origin);
+
+    const int nClusters = g_pEngineServer->GetClusterCount();
+    m_vecClusterLightStart.EnsureCapacity(nClusters + 1);
+
+    for (int nCluster = 0; nCluster < nClusters; ++nCluster)
+    {
+        m_vecClusterLightStart.AddToTail(m_vecClusterLights.Count());
+
+        const int nPVSSize = g_pEngineServer->GetPVSForCluster(nCluster, 0, nullptr);
+        m_PVSScratch.SetCount(nPVSSize);
+        g_pEngineServer->GetPVSForCluster(nCluster, nPVSSize, m_PVSScratch.Base());
+
+        FOR_EACH_VEC(m_vecAllLights, i)
+        {
+            const int nLightCluster = vecLightClusters[i];
+            if (nLightCluster < 0 || (nLightCluster >> 3) >= nPVSSize)
+                continue;
+
+            if (m_PVSScratch[nLightCluster >> 3] & (1 << (nLightCluster & 7)))
+                m_vecClusterLights.AddToTail(m_vecAllLights[i]);
+        }
+    }
+
+    m_vecClusterLightStart.AddToTail(m_vecClusterLights.Count());
 }
 
 //-----------------------------------------------------------------------------
@@ -180,63 +239,91 @@ bool CWorldLights::GetBrightestLightSource(const Vector &vecPosition, Vector &ve
     if (!m_nWorldLights || !m_pWorldLights)
         return false;
 
-    // Default light position and brightness to zero
-    vecLightBrightness.Init();
-    vecLightPos.Init();
+    return FindBrightestLightSource(g_pEngineServer->GetClusterForOrigin(vecPosition), vecPosition, vecLightPos,
+                                    vecLightBrightness);
+}
 
-    // Find the size of the PVS for our current position
-    int nCluster = g_pEngineServer->GetClusterForOrigin(vecPosition);
-    int nPVSSize = g_pEngineServer->GetPVSForCluster(nCluster, 0, nullptr);
+//-----------------------------------------------------------------------------
+// Purpose: find the brightest light source for an entity, reusing the last
+//          result while the entity stays in the same cluster
+//-----------------------------------------------------------------------------
+bool CWorldLights::GetBrightestLightSource(const CBaseHandle &hEntity, const Vector &vecPosition, Vector &vecLightPos,
+                                           Vector &vecLightBrightness)
+{
+    if (!m_nWorldLights || !m_pWorldLights)
+        return false;
 
-    // Get the PVS at our position
-    byte *pvs = new byte[nPVSSize];
-    g_pEngineServer->GetPVSForCluster(nCluster, nPVSSize, pvs);
+    const int nCluster = g_pEngineServer->GetClusterForOrigin(vecPosition);
 
-    // Iterate through all the worldlights
-    for (int i = 0; i < m_nWorldLights; ++i)
+    auto indx = m_mapEntityLights.Find(hEntity.ToInt());
+    if (m_mapEntityLights.IsValidIndex(indx))
     {
-        dworldlight_t *light = &m_pWorldLights[i];
-
-        // Skip skyambient
-        if (light->type == emit_skyambient)
+        const CachedLight_t &cached = m_mapEntityLights[indx];
+        if (cached.m_nCluster == nCluster)
         {
-            // engine->Con_NPrintf(i, "%d: skyambient", i);
-            continue;
+            vecLightPos = cached.m_vecLightPos;
+            vecLightBrightness = cached.m_vecLightBrightness;
+            return cached.m_bFound;
         }
+    }
+    else
+    {
+        indx = m_mapEntityLights.Insert(hEntity.ToInt());
+    }
 
-        // Handle sun
-        if (light->type == emit_skylight)
-        {
-            // Calculate sun position
-            Vector vecAbsStart = vecPosition + Vector(0, 0, 30);
-            Vector vecAbsEnd = vecAbsStart - (light->normal * MAX_TRACE_LENGTH);
+    CachedLight_t &cached = m_mapEntityLights[indx];
+    cached.m_nCluster = nCluster;
+    cached.m_bFound = FindBrightestLightSource(nCluster, vecPosition, vecLightPos, vecLightBrightness);
+    cached.m_vecLightPos = vecLightPos;
+    cached.m_vecLightBrightness = vecLightBrightness;
+    return cached.m_bFound;
+}
 
-            trace_t tr;
-            UTIL_TraceLine(vecPosition, vecAbsEnd, MASK_OPAQUE, nullptr, COLLISION_GROUP_NONE, &tr);
+bool CWorldLights::FindBrightestLightSource(int nCluster, const Vector &vecPosition, Vector &vecLightPos, Vector &vecLightBrightness)
+{
+    // Default light position and brightness to zero
+    vecLightBrightness.Init();
+    vecLightPos.Init();
 
-            // If we didn't hit anything then we have a problem
-            if (!tr.DidHit())
-            {
-                // engine->Con_NPrintf(i, "%d: skylight: couldn't touch sky", i);
-                continue;
-            }
+    // Handle sun
+    FOR_EACH_VEC(m_vecSkyLights, i)
+    {
+        const dworldlight_t *light = &m_pWorldLights[m_vecSkyLights[i]];
 
-            // If we did hit something, and it wasn't the skybox, then skip
-            // this worldlight
-            if (!(tr.surface.flags & SURF_SKY) && !(tr.surface.flags & SURF_SKY2D))
-            {
-                // engine->Con_NPrintf(i, "%d: skylight: no sight to sun", i);
-                continue;
-            }
+        // Calculate sun position
+        Vector vecAbsStart = vecPosition + Vector(0, 0, 30);
+        Vector vecAbsEnd = vecAbsStart - (light->normal * MAX_TRACE_LENGTH);
 
-            // Act like we didn't find any valid worldlights, so the shadow
-            // manager uses the default shadow direction instead (should be the
-            // sun direction)
+        trace_t tr;
+        UTIL_TraceLine(vecPosition, vecAbsEnd, MASK_OPAQUE, nullptr, COLLISION_GROUP_NONE, &tr);
 
-            delete[] pvs;
+        // If we didn't hit anything then we have a problem
+        if (!tr.DidHit())
+            continue;
 
-            return false;
-        }
+        // If we did hit something, and it wasn't the skybox, then skip
+        // this worldlight
+        if (!(tr.surface.flags & SURF_SKY) && !(tr.surface.flags & SURF_SKY2D))
+            continue;
+
+        // Act like we didn't find any valid worldlights, so the shadow
+        // manager uses the default shadow direction instead (should be the
+        // sun direction)
+        return false;
+    }
+
+    // Only the lights in our PVS, or all of them if we're outside the world
+    const int *pLights = m_vecAllLights.Base();
+    int nLights = m_vecAllLights.Count();
+    if (nCluster >= 0 && nCluster + 1 < m_vecClusterLightStart.Count())
+    {
+        pLights = m_vecClusterLights.Base() + m_vecClusterLightStart[nCluster];
+        nLights = m_vecClusterLightStart[nCluster + 1] - m_vecClusterLightStart[nCluster];
+    }
+
+    for (int i = 0; i < nLights; ++i)
+    {
+        const dworldlight_t *light = &m_pWorldLights[pLights[i]];
 
         // Calculate square distance to this worldlight
         Vector vecDelta = light->origin - vecPosition;
@@ -245,17 +332,7 @@ bool CWorldLights::GetBrightestLightSource(const Vector &vecPosition, Vector &ve
 
         // Skip lights that are out of our radius
         if (flRadiusSqr > 0 && flDistSqr >= flRadiusSqr)
-        {
-            // engine->Con_NPrintf(i, "%d: out-of-radius (dist: %d, radius: %d)", i, sqrt(flDistSqr), light->radius);
-            continue;
-        }
-
-        // Is it out of our PVS?
-        if (!g_pEngineServer->CheckOriginInPVS(light->origin, pvs, nPVSSize))
-        {
-            // engine->Con_NPrintf(i, "%d: out of PVS", i);
             continue;
-        }
 
         // Calculate intensity at our position
         float flRatio = Engine_WorldLightDistanceFalloff(light, vecDelta);
@@ -263,10 +340,7 @@ bool CWorldLights::GetBrightestLightSource(const Vector &vecPosition, Vector &ve
 
         // Is this light more intense than the one we already found?
         if (vecIntensity.LengthSqr() <= vecLightBrightness.LengthSqr())
-        {
-            // engine->Con_NPrintf(i, "%d: too dim", i);
             continue;
-        }
 
         // Can we see the light?
         trace_t tr;
@@ -274,19 +348,11 @@ bool CWorldLights::GetBrightestLightSource(const Vector &vecPosition, Vector &ve
         UTIL_TraceLine(vecAbsStart, light->origin, MASK_OPAQUE, nullptr, COLLISION_GROUP_NONE, &tr);
 
         if (tr.DidHit())
-        {
-            // engine->Con_NPrintf(i, "%d: trace failed", i);
             continue;
-        }
 
         vecLightPos = light->origin;
         vecLightBrightness = vecIntensity;
-
-        // engine->Con_NPrintf(i, "%d: set (%.2f)", i, vecIntensity.Length());
     }
 
-    delete[] pvs;
-
-    // engine->Con_NPrintf(m_nWorldLights, "result: %d", !vecLightBrightness.IsZero());
     return !vecLightBrightness.IsZero();
-}
\ No newline at end of file
+}
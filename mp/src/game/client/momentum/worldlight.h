@@ -10,8 +10,10 @@
 #pragma once
 
 #include "igamesystem.h" // CAutoGameSystem
+#include "utlmap.h"
 
 class Vector;
+class CBaseHandle;
 struct dworldlight_t;
 
 //-----------------------------------------------------------------------------
@@ -28,6 +30,13 @@ class CWorldLights : public CAutoGameSystem
     //-------------------------------------------------------------------------
     bool GetBrightestLightSource(const Vector &vecPosition, Vector &vecLightPos, Vector &vecLightBrightness);
 
+    //-------------------------------------------------------------------------
+    // Same as above, but the result is kept for the entity until it moves
+    // into another PVS cluster
+    //-------------------------------------------------------------------------
+    bool GetBrightestLightSource(const CBaseHandle &hEntity, const Vector &vecPosition, Vector &vecLightPos,
+                                 Vector &vecLightBrightness);
+
     // CAutoGameSystem overrides
   public:
     bool Init() OVERRIDE;
@@ -38,8 +47,31 @@ class CWorldLights : public CAutoGameSystem
   private:
     void Clear();
 
+    // Buckets the lights by the PVS clusters that can see them
+    void BuildClusterLights();
+    bool FindBrightestLightSource(int nCluster, const Vector &vecPosition, Vector &vecLightPos, Vector &vecLightBrightness);
+
     int m_nWorldLights;
     dworldlight_t *m_pWorldLights;
+
+    // The lights in the PVS of cluster i are m_vecClusterLights[m_vecClusterLightStart[i]]
+    // up to m_vecClusterLights[m_vecClusterLightStart[i + 1]]. Sky lights are kept separately
+    // as they are checked with a trace instead of the PVS.
+    CUtlVector<int> m_vecClusterLightStart;
+    CUtlVector<int> m_vecClusterLights;
+    CUtlVector<int> m_vecSkyLights;
+    CUtlVector<int> m_vecAllLights; // For positions outside of any cluster
+
+    CUtlVector<byte> m_PVSScratch;
+
+    struct CachedLight_t
+    {
+        int m_nCluster;
+        bool m_bFound;
+        Vector m_vecLightPos;
+        Vector m_vecLightBrightness;
+    };
+    CUtlMap<unsigned long, CachedLight_t> m_mapEntityLights;
 };
 
 //-----------------------------------------------------------------------------
@@ -4,22 +4,58 @@
 #include "mom_player.h"
 #include "mom_triggers.h"
 #include "mapzones_build.h"
+#include "mapzones_file.h"
+#include "mom_replay_system.h"
 #include "fmtstr.h"
 
 #include "tier0/memdbgon.h"
 
-CON_COMMAND_F(mom_zone_generate, "Generates the .zon file for map zones.", FCVAR_MAPPING)
+CON_COMMAND_F(mom_zone_generate, "Generates the .zon file for map zones. Pass \"binary\" to write the binary format.", FCVAR_MAPPING)
 {
-    g_MapZoneSystem.SaveZonesToFile();
+    g_MapZoneSystem.SaveZonesToFile(args.ArgC() > 1 && FStrEq(args.Arg(1), "binary"));
+}
+
+CON_COMMAND_F(mom_zone_convert, "Converts a .zon file between the text and binary formats.\n"
+                                "Usage: mom_zone_convert <text|binary> [mapname]", FCVAR_MAPPING)
+{
+    if (args.ArgC() < 2 || !(FStrEq(args.Arg(1), "text") || FStrEq(args.Arg(1), "binary")))
+    {
+        Msg("Usage: mom_zone_convert <text|binary> [mapname]\n");
+        return;
+    }
+
+    const char *pMapName = args.ArgC() > 2 ? args.Arg(2) : gpGlobals->mapname.ToCStr();
+    if (!pMapName || !pMapName[0])
+    {
+        Warning("No map name given and no map is loaded!\n");
+        return;
+    }
+
+    char zoneFilePath[MAX_PATH];
+    V_ComposeFileName(MAP_FOLDER, pMapName, zoneFilePath, MAX_PATH);
+    V_SetExtension(zoneFilePath, EXT_ZONE_FILE, MAX_PATH);
+
+    CMapZoneFile zoneFile;
+    if (!zoneFile.LoadFromFile(zoneFilePath, "GAME"))
+    {
+        Warning("Failed to load zone file %s!\n", zoneFilePath);
+        return;
+    }
+
+    const bool bBinary = FStrEq(args.Arg(1), "binary");
+    if (zoneFile.SaveToFile(zoneFilePath, "MOD", bBinary))
+        Msg("Converted %s to the %s format.\n", zoneFilePath, bBinary ? "binary" : "text");
+    else
+        Warning("Failed to write zone file %s!\n", zoneFilePath);
 }
 
 class CMapZone
 {
   public:
-    CMapZone(int track, int zone, int type, const KeyValues *values);
+    CMapZone(int track, int zone, int type);
     ~CMapZone();
 
-    void SpawnZone();
+    void SpawnZone(const ZoneTriggerData_t &data, CMapZoneCollideCache *pCache);
 
     int GetType() const { return m_iType; }
 
@@ -27,28 +63,24 @@ class CMapZone
     int m_iType;
     int m_iTrack; // Track number
     int m_iZone; // Zone number
-    // KeyValues containing all the values describing the zone
-    KeyValues *m_pZoneValues;
 
     CBaseMomZoneTrigger *m_pTrigger;
 };
 
-CMapZone::CMapZone(const int track, const int zone, const int type, const KeyValues *values)
+CMapZone::CMapZone(const int track, const int zone, const int type)
 {
     m_iType = type;
     m_iTrack = track;
     m_iZone = zone;
-    m_pZoneValues = values->MakeCopy();
     m_pTrigger = nullptr;
 }
 
 CMapZone::~CMapZone()
 {
-    m_pZoneValues->deleteThis();
     m_pTrigger = nullptr;
 }
 
-void CMapZone::SpawnZone()
+void CMapZone::SpawnZone(const ZoneTriggerData_t &data, CMapZoneCollideCache *pCache)
 {
     char classname[64];
     g_MapZoneSystem.ZoneTypeToClass(m_iType, classname, sizeof(classname));
@@ -57,8 +89,7 @@ void CMapZone::SpawnZone()
 
     if (m_pTrigger)
     {
-        m_pZoneValues->SetInt("zoneNum", m_iZone);
-        if (!m_pTrigger->LoadFromKeyValues(m_pZoneValues))
+        if (!m_pTrigger->LoadFromZoneData(data))
         {
             Warning("Failed to load zone of type '%s' (Invalid zone data)", classname);
             Assert(false);
@@ -67,9 +98,21 @@ void CMapZone::SpawnZone()
 
         m_pTrigger->SetTrackNumber(m_iTrack);
 
-        CMomBaseZoneBuilder* pBaseBuilder = CreateZoneBuilderFromKeyValues(m_pZoneValues);
+        CMomBaseZoneBuilder* pBaseBuilder = CreateZoneBuilderFromZoneData(data);
+
+        const auto pPointBuilder = dynamic_cast<CMomPointZoneBuilder*>(pBaseBuilder);
+        if (pPointBuilder)
+        {
+            if (!pCache->RestoreZone(pPointBuilder))
+                pPointBuilder->BuildZone();
+
+            pCache->StoreZone(pPointBuilder);
+        }
+        else
+        {
+            pBaseBuilder->BuildZone();
+        }
 
-        pBaseBuilder->BuildZone();
         m_pTrigger->Spawn();
         pBaseBuilder->FinishZone(m_pTrigger);
 
@@ -146,7 +189,8 @@ void CMapZoneSystem::ClearMapZones()
 
 void CMapZoneSystem::LoadZonesFromSite(KeyValues *pKvTracks, CBaseEntity *pEnt)
 {
-    if (LoadZonesFromKeyValues(pKvTracks, true))
+    CMapZoneFile zoneFile;
+    if (zoneFile.LoadFromKeyValues(pKvTracks, true) && LoadZones(zoneFile))
     {
         m_bLoadedFromSite = true;
         const auto pPlayer = dynamic_cast<CMomentumPlayer*>(pEnt);
@@ -165,75 +209,58 @@ void CMapZoneSystem::LoadZonesFromFile()
     V_SetExtension(zoneFilePath, EXT_ZONE_FILE, MAX_PATH);
     DevLog("Looking for zone file: %s \n", zoneFilePath);
 
-    KeyValuesAD fileKV("tracks");
-    if (fileKV->LoadFromFile(filesystem, zoneFilePath, "GAME"))
+    CMapZoneFile zoneFile;
+    if (filesystem->FileExists(zoneFilePath, "GAME"))
     {
-        const auto bSuccess = LoadZonesFromKeyValues(fileKV, false);
+        const auto bSuccess = zoneFile.LoadFromFile(zoneFilePath, "GAME") && LoadZones(zoneFile);
         DevLog("%s map zone file %s!\n", bSuccess ? "Successfully loaded" : "Failed to load", zoneFilePath);
     }
 }
 
-bool CMapZoneSystem::LoadZonesFromKeyValues(KeyValues *pKvTracks, bool bFromSite)
+bool CMapZoneSystem::LoadZones(const CMapZoneFile &zoneFile)
 {
-    if (!pKvTracks || pKvTracks->IsEmpty())
+    if (zoneFile.IsEmpty())
         return false;
 
     ResetCounts();
     int globalZones = 0;
 
-    FOR_EACH_SUBKEY(pKvTracks, trackKV)
+    const double flStartTime = Plat_FloatTime();
+    m_CollideCache.Begin(g_ReplaySystem.GetMapHash(), zoneFile);
+
+    FOR_EACH_VEC(zoneFile.m_vecTriggers, i)
     {
-        const auto trackNum = bFromSite ? trackKV->GetInt("trackNum") : Q_atoi(trackKV->GetName());
-        if (trackNum >= -1 && trackNum < MAX_TRACKS)
+        const auto &trigger = *zoneFile.m_vecTriggers[i];
+        const auto trackNum = trigger.m_iTrack;
+        const auto zoneNum = trigger.m_iZone;
+        const auto zoneType = trigger.m_iType;
+
+        if (zoneType != ZONE_TYPE_STOP)
         {
-            KeyValues *toItr = bFromSite ? trackKV->FindKey("zones") : trackKV;
-            if (!toItr)
-                return false;
-            FOR_EACH_SUBKEY(toItr, zoneKV)
+            if (trackNum > -1 && trackNum < MAX_TRACKS)
             {
-                const auto zoneNum = zoneKV->GetInt("zoneNum");
-                if (zoneNum >= 0 && zoneNum < MAX_ZONES)
-                {
-                    const auto pKvTriggers = zoneKV->FindKey("triggers");
-                    if (!pKvTriggers)
-                        return false;
-                    FOR_EACH_SUBKEY(pKvTriggers, triggerKV)
-                    {
-                        const auto zoneType = triggerKV->GetInt("type", ZONE_TYPE_INVALID);
-
-                        if (zoneType <= ZONE_TYPE_INVALID || zoneType >= ZONE_TYPE_COUNT)
-                        {
-                            Warning("Error while reading zone file: Unknown map zone type %d!\n", zoneType);
-                            continue;
-                        }
-
-                        if (zoneType != ZONE_TYPE_STOP)
-                        {
-                            if (trackNum > -1 && trackNum < MAX_TRACKS)
-                            {
-                                if (trackNum > m_iHighestTrackNum)
-                                    m_iHighestTrackNum = trackNum;
-
-                                if (zoneNum > m_iZoneCount[trackNum])
-                                    m_iZoneCount[trackNum] = zoneNum;
-
-                                if (zoneType == ZONE_TYPE_CHECKPOINT)
-                                    m_iLinearTracks |= (1ULL << trackNum);
-                            }
-                            else if (trackNum == -1)
-                                globalZones++;
-                        }
-
-                        // Add element
-                        auto pMapZone = new CMapZone(trackNum, zoneNum, zoneType, triggerKV);
-                        pMapZone->SpawnZone();
-                        m_Zones.AddToTail(pMapZone);
-                    }
-                }
+                if (trackNum > m_iHighestTrackNum)
+                    m_iHighestTrackNum = trackNum;
+
+                if (zoneNum > m_iZoneCount[trackNum])
+                    m_iZoneCount[trackNum] = zoneNum;
+
+                if (zoneType == ZONE_TYPE_CHECKPOINT)
+                    m_iLinearTracks |= (1ULL << trackNum);
             }
+            else if (trackNum == -1)
+                globalZones++;
         }
+
+        // Add element
+        auto pMapZone = new CMapZone(trackNum, zoneNum, zoneType);
+        pMapZone->SpawnZone(trigger, &m_CollideCache);
+        m_Zones.AddToTail(pMapZone);
     }
 
+    m_CollideCache.End();
+    DevLog("Spawned %i zones in %.3f ms\n", m_Zones.Count(), (Plat_FloatTime() - flStartTime) * 1000.0);
+
     // Add in all the global zones, if we have any
     if (globalZones)
     {
@@ -246,24 +273,28 @@ bool CMapZoneSystem::LoadZonesFromKeyValues(KeyValues *pKvTracks, bool bFromSite
     return !m_Zones.IsEmpty();
 }
 
-void CMapZoneSystem::SaveZoneTrigger(CTriggerZone *pZoneTrigger, KeyValues *pKvInto)
+void CMapZoneSystem::SaveZoneTrigger(CTriggerZone *pZoneTrigger, CMapZoneFile &zoneFile, int track, int zone)
 {
     bool bSuccess = false;
-    const auto pKvTrigger = pKvInto->CreateNewKey();
-    if (pZoneTrigger->ToKeyValues(pKvTrigger))
+    const auto pTriggerData = zoneFile.AddTrigger(track, zone);
+    if (pZoneTrigger->ToZoneData(*pTriggerData))
     {
         auto pBuilder = CreateZoneBuilderFromExisting(pZoneTrigger);
 
-        bSuccess = pBuilder->Save(pKvTrigger);
+        bSuccess = pBuilder->Save(*pTriggerData);
 
         delete pBuilder;
     }
 
+    // The zone is saved under the zone it was grouped into
+    pTriggerData->m_iTrack = track;
+    pTriggerData->m_iZone = zone;
+
     if (!bSuccess)
     {
         Warning("Failed to save zone to file!\n");
-        pKvInto->RemoveSubKey(pKvTrigger);
-        pKvTrigger->deleteThis();
+        zoneFile.m_vecTriggers.FindAndRemove(pTriggerData);
+        delete pTriggerData;
     }
 }
 
@@ -295,7 +326,7 @@ inline void EnsureCount(T *vec, int count)
 }
 
 // May God have mercy on my soul
-void CMapZoneSystem::SaveZonesToFile()
+void CMapZoneSystem::SaveZonesToFile(bool bBinary /* = false*/)
 {
     CUtlVector<MapTrack*> vecTracks;
     CUtlVector<CTriggerZone*> versatileTriggers;
@@ -382,44 +413,28 @@ void CMapZoneSystem::SaveZonesToFile()
 
     if (highestTrack > -1)
     {
-        KeyValuesAD zoneKV("tracks");
+        CMapZoneFile zoneFile;
         for (int track = 0; track <= highestTrack; track++)
         {
-            const auto pKvTrack = new KeyValues(CFmtStr("%i", track));
             // Go through each zone and find our triggers
             for (int zone = 0; zone <= highestZoneForTrack[track]; zone++)
             {
                 if (vecTracks[track] && vecTracks[track]->m_Zones[zone] && !vecTracks[track]->m_Zones[zone]->m_Triggers.IsEmpty())
                 {
-                    const auto pZoneKV = new KeyValues(CFmtStr("%i", zone));
-                    pZoneKV->SetInt("zoneNum", zone);
-                    const auto pTriggersKv = new KeyValues("triggers");
                     FOR_EACH_VEC(vecTracks[track]->m_Zones[zone]->m_Triggers, i)
                     {
-                        SaveZoneTrigger(vecTracks[track]->m_Zones[zone]->m_Triggers[i], pTriggersKv);
+                        SaveZoneTrigger(vecTracks[track]->m_Zones[zone]->m_Triggers[i], zoneFile, track, zone);
                     }
-                    pZoneKV->AddSubKey(pTriggersKv);
-                    pKvTrack->AddSubKey(pZoneKV);
                 }
             }
-
-            // Save only if we're not empty
-            if (!pKvTrack->IsEmpty())
-            {
-                zoneKV->AddSubKey(pKvTrack);
-            }
-            else
-            {
-                pKvTrack->deleteThis();
-            }
         }
 
-        if (!zoneKV->IsEmpty() && gpGlobals->mapname.ToCStr())
+        if (!zoneFile.IsEmpty() && gpGlobals->mapname.ToCStr())
         {
             char zoneFilePath[MAX_PATH];
             V_ComposeFileName(MAP_FOLDER, gpGlobals->mapname.ToCStr(), zoneFilePath, MAX_PATH);
             V_SetExtension(zoneFilePath, EXT_ZONE_FILE, MAX_PATH);
-            zoneKV->SaveToFile(filesystem, zoneFilePath, "MOD");
+            zoneFile.SaveToFile(zoneFilePath, "MOD", bBinary);
         }
 
         vecTracks.PurgeAndDeleteElements();
@@ -1,9 +1,11 @@
 #pragma once
 
+#include "mapzones_cache.h"
 #include "mapzones_edit.h"
 #include "mom_shareddefs.h"
 
 class CMapZone;
+class CMapZoneFile;
 class CTriggerZone;
 
 class CMapZoneSystem : public CAutoGameSystemPerFrame
@@ -22,9 +24,9 @@ public:
     void ClearMapZones();
     void LoadZonesFromSite(KeyValues *pKvTracks, CBaseEntity *pEnt);
     void LoadZonesFromFile();
-    bool LoadZonesFromKeyValues(KeyValues *pKvTracks, bool bFromSite);
-    void SaveZoneTrigger(CTriggerZone *pZoneTrigger, KeyValues *pKvInto);
-    void SaveZonesToFile();
+    bool LoadZones(const CMapZoneFile &zoneFile);
+    void SaveZoneTrigger(CTriggerZone *pZoneTrigger, CMapZoneFile &zoneFile, int track, int zone);
+    void SaveZonesToFile(bool bBinary = false);
 
     CMapZoneEdit *GetZoneEditor() { return &m_Editor; }
 
@@ -41,6 +43,7 @@ private:
 
     bool m_bLoadedFromSite;
     CMapZoneEdit m_Editor;
+    CMapZoneCollideCache m_CollideCache;
     CUtlVector<CMapZone*> m_Zones;
 
     // The number of zones for a given track
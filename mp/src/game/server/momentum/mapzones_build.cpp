@@ -2,10 +2,16 @@
 
 #include "mom_triggers.h"
 #include "mapzones_build.h"
+#include "mapzones_file.h"
 #include "fmtstr.h"
 
 #include "tier0/memdbgon.h"
 
+// Smallest change of the picked height that redraws the point zone outline
+#define ZONE_LINE_CACHE_HEIGHT_EPSILON 0.1f
+// How long the point zone outline stays in the overlay, it's sent again a bit before that runs out
+#define ZONE_LINE_CACHE_LIFETIME 1.0f
+
 vertarray_t* vertarray_t::Create(int num)
 {
     Assert(num > 0);
@@ -70,6 +76,13 @@ CMomPointZoneBuilder::CMomPointZoneBuilder()
     m_bFreePhysCollide = false;
     m_pPhysCollide = nullptr;
 
+    m_iPointsRevision = 0;
+    m_iLineCacheRevision = -1;
+    m_bLineCacheClosed = false;
+    m_bLineCacheTop = false;
+    m_flLineCacheHeight = 0.0f;
+    m_dLineCacheDrawTime = -1.0;
+
     ResetMe();
 }
 
@@ -134,6 +147,7 @@ void CMomPointZoneBuilder::CopyPoints(const CUtlVector<Vector>& vec)
 {
     m_vPoints.Purge();
     m_vPoints.CopyArray(vec.Base(), vec.Count());
+    MarkPointsChanged();
 }
 
 void CMomPointZoneBuilder::FixPointOrder(CUtlVector<Vector> &points)
@@ -221,6 +235,7 @@ bool CMomPointZoneBuilder::BuildZone(CBasePlayer *pPlayer, const Vector *vecAim)
             p.z -= m_flHeight;
             m_vPoints[i] = p;
         }
+        MarkPointsChanged();
     }
 
     // Get the points relative to our center
@@ -262,6 +277,21 @@ bool CMomPointZoneBuilder::BuildZone(CBasePlayer *pPlayer, const Vector *vecAim)
     return m_pPhysCollide != nullptr;
 }
 
+void CMomPointZoneBuilder::SetCompiled(CPhysCollide *pCollide, const Vector &vecCenter, const Vector &vecMins, const Vector &vecMaxs)
+{
+    if (m_pPhysCollide && m_bFreePhysCollide)
+    {
+        physcollision->DestroyCollide(m_pPhysCollide);
+    }
+
+    m_pPhysCollide = pCollide;
+    m_bFreePhysCollide = true;
+
+    m_vecCenter = vecCenter;
+    m_vecMins = vecMins;
+    m_vecMaxs = vecMaxs;
+}
+
 bool CMomPointZoneBuilder::IsReady() const
 {
     return m_vPoints.Count() >= 3;
@@ -295,6 +325,8 @@ void CMomPointZoneBuilder::ResetMe()
     m_vecMaxs.Init(-FLT_MAX, -FLT_MAX, -FLT_MAX);
 
     m_vPoints.Purge();
+    MarkPointsChanged();
+    ClearLineCacheOverlay();
 }
 
 void CMomPointZoneBuilder::FinishZone(CBaseMomZoneTrigger *pEnt)
@@ -317,6 +349,7 @@ void CMomPointZoneBuilder::Add(CBasePlayer *pPlayer, const Vector &vecAim)
     if (!m_bGetHeight && !IsDone())
     {
         m_vPoints.AddToTail(vecAim);
+        MarkPointsChanged();
     }
 }
 
@@ -339,58 +372,17 @@ void CMomPointZoneBuilder::Remove(CBasePlayer *pPlayer, const Vector &vecAim)
     if (index != -1)
     {
         m_vPoints.Remove(index);
+        MarkPointsChanged();
     }
 }
 
 void CMomPointZoneBuilder::OnFrame(CBasePlayer *pPlayer, const Vector &vecAim)
 {
     int nPoints = m_vPoints.Count();
-    int i;
-
-    // Draw bottom
-    for (i = 0; i < nPoints-1; i++)
-    {
-        DrawZoneLine(m_vPoints[i], m_vPoints[i+1], -1.0f);
-    }
-
-    if (nPoints > 0 && (m_bGetHeight || IsDone()))
-    {
-        DrawZoneLine(m_vPoints[0], m_vPoints[nPoints-1], -1.0f);
-    }
-
 
-    // Draw top
-    if (m_bGetHeight)
-    {
-        float h = CMomBoxZoneBuilder::GetZoneHeightToPlayer(pPlayer, m_vPoints[0]);
-        Vector p0, p1;
-
-        // Draw top
-        for (i = 0; i < nPoints-1; i++)
-        {
-            p0 = m_vPoints[i];
-            p0.z += h;
-            p1 = m_vPoints[i+1];
-            p1.z += h;
-            DrawZoneLine(p0, p1, -1.0f);
-        }
-
-        p0 = m_vPoints[0];
-        p0.z += h;
-        p1 = m_vPoints[nPoints-1];
-        p1.z += h;
-
-        DrawZoneLine(p0, p1, -1.0f);
-
-
-        // Draw bottom to top
-        for (i = 0; i < nPoints; i++)
-        {
-            p1 = m_vPoints[i];
-            p1.z += h;
-            DrawZoneLine(m_vPoints[i], p1, -1.0f);
-        }
-    }
+    const bool bClosed = nPoints > 0 && (m_bGetHeight || IsDone());
+    const float h = m_bGetHeight ? CMomBoxZoneBuilder::GetZoneHeightToPlayer(pPlayer, m_vPoints[0]) : 0.0f;
+    DrawLineCache(UpdateLineCache(bClosed, m_bGetHeight, h));
 
 
     if (IsDone() || m_bGetHeight)
@@ -418,6 +410,98 @@ void CMomPointZoneBuilder::OnFrame(CBasePlayer *pPlayer, const Vector &vecAim)
     }
 }
 
+// Returns whether the outline changed
+bool CMomPointZoneBuilder::UpdateLineCache(bool bClosed, bool bDrawTop, float flTopHeight)
+{
+    // The height follows the view, so ignore the tiny changes from just holding the mouse still
+    if (m_iLineCacheRevision == m_iPointsRevision && m_bLineCacheClosed == bClosed && m_bLineCacheTop == bDrawTop &&
+        (!bDrawTop || CloseEnough(m_flLineCacheHeight, flTopHeight, ZONE_LINE_CACHE_HEIGHT_EPSILON)))
+        return false;
+
+    m_iLineCacheRevision = m_iPointsRevision;
+    m_bLineCacheClosed = bClosed;
+    m_bLineCacheTop = bDrawTop;
+    m_flLineCacheHeight = flTopHeight;
+
+    m_vecLineCache.RemoveAll();
+
+    const int nPoints = m_vPoints.Count();
+    int i;
+
+    // Bottom
+    for (i = 0; i < nPoints-1; i++)
+    {
+        m_vecLineCache.AddToTail(m_vPoints[i]);
+        m_vecLineCache.AddToTail(m_vPoints[i+1]);
+    }
+
+    if (bClosed)
+    {
+        m_vecLineCache.AddToTail(m_vPoints[0]);
+        m_vecLineCache.AddToTail(m_vPoints[nPoints-1]);
+    }
+
+    if (!bDrawTop || nPoints < 1)
+        return true;
+
+    Vector p0, p1;
+
+    // Top
+    for (i = 0; i < nPoints; i++)
+    {
+        p0 = m_vPoints[i];
+        p0.z += flTopHeight;
+        p1 = m_vPoints[(i+1) % nPoints];
+        p1.z += flTopHeight;
+        m_vecLineCache.AddToTail(p0);
+        m_vecLineCache.AddToTail(p1);
+    }
+
+    // Bottom to top
+    for (i = 0; i < nPoints; i++)
+    {
+        p1 = m_vPoints[i];
+        p1.z += flTopHeight;
+        m_vecLineCache.AddToTail(m_vPoints[i]);
+        m_vecLineCache.AddToTail(p1);
+    }
+
+    return true;
+}
+
+// The outline is sent to the overlay with a lifetime, and only sent again once it changed or is about to expire.
+// It goes straight to the overlay because NDebugOverlay::Line drops lines behind the player when they're sent.
+void CMomPointZoneBuilder::DrawLineCache(bool bChanged)
+{
+    if (!debugoverlay)
+        return;
+
+    const double dNow = Plat_FloatTime();
+    if (!bChanged && m_dLineCacheDrawTime >= 0.0 && dNow - m_dLineCacheDrawTime < ZONE_LINE_CACHE_LIFETIME * 0.9f)
+        return;
+
+    if (bChanged)
+        ClearLineCacheOverlay();
+
+    const Vector vecOffset(0.0f, 0.0f, 0.1f); // Same as DebugDrawLine
+    for (int i = 0; i < m_vecLineCache.Count(); i += 2)
+    {
+        debugoverlay->AddLineOverlay(m_vecLineCache[i] + vecOffset, m_vecLineCache[i + 1] + vecOffset, 255, 255, 255,
+                                     true, ZONE_LINE_CACHE_LIFETIME);
+    }
+
+    m_dLineCacheDrawTime = dNow;
+}
+
+void CMomPointZoneBuilder::ClearLineCacheOverlay()
+{
+    // Single overlays can't be removed, so the old outline has to go along with everything else.
+    // The rest of the zone editor draws for a frame at a time, so that just gets drawn again.
+    if (m_dLineCacheDrawTime >= 0.0 && debugoverlay)
+        debugoverlay->ClearAllOverlays();
+
+    m_dLineCacheDrawTime = -1.0;
+}
 
 bool CMomPointZoneBuilder::LoadFromZone(const CBaseMomZoneTrigger *pEnt)
 {
@@ -431,60 +515,37 @@ bool CMomPointZoneBuilder::LoadFromZone(const CBaseMomZoneTrigger *pEnt)
     return true;
 }
 
-bool CMomPointZoneBuilder::Load(KeyValues *pTriggerKV)
+bool CMomPointZoneBuilder::Load(const ZoneTriggerData_t &data)
 {
-    SetHeight(pTriggerKV->GetFloat("pointsHeight"));
-
-    const auto kvZPos = pTriggerKV->FindKey("pointsZPos");
-    if (!kvZPos)
+    if (!data.m_bPointZone || data.m_vecPoints.IsEmpty())
         return false;
 
-    const auto fZPos = kvZPos->GetFloat();
+    SetHeight(data.m_flPointsHeight);
 
-    auto sub = pTriggerKV->FindKey("points");
-    if (!sub)
-        return false;
-
-    auto s = sub->GetFirstSubKey();
-    if (!s)
-        return false;
-
-    do
+    m_vPoints.EnsureCapacity(data.m_vecPoints.Count());
+    FOR_EACH_VEC(data.m_vecPoints, i)
     {
-        const char* val = s->GetString();
-        if (val && *val)
-        {
-            Vector pos;
-            pos.Init(.0f, .0f, fZPos);
-            sscanf(val, "%f %f", &pos.x, &pos.y);
-
-            m_vPoints.AddToTail(pos);
-        }
+        m_vPoints.AddToTail(Vector(data.m_vecPoints[i].x, data.m_vecPoints[i].y, data.m_flPointsZPos));
     }
-    while ((s = s->GetNextKey()) != nullptr);
+    MarkPointsChanged();
 
     return true;
 }
 
-bool CMomPointZoneBuilder::Save(KeyValues *pTriggerKV)
+bool CMomPointZoneBuilder::Save(ZoneTriggerData_t &data)
 {
-    const auto pPoints = new KeyValues("points");
-    float *pZPos = nullptr;
-    for (int i = 0; i < m_vPoints.Count(); i++)
+    data.m_bPointZone = true;
+    data.m_vecPoints.RemoveAll();
+    data.m_vecPoints.EnsureCapacity(m_vPoints.Count());
+    FOR_EACH_VEC(m_vPoints, i)
     {
-        auto& pos = m_vPoints[i];
-
-        if (!pZPos)
-            pZPos = &pos.z;
-
-        pPoints->SetString(CFmtStrN<64>("p%i", i), CFmtStrN<64>("%.3f %.3f", pos.x, pos.y));
+        data.m_vecPoints.AddToTail(m_vPoints[i].AsVector2D());
     }
 
-    if (pZPos)
-        pTriggerKV->SetFloat("pointsZPos", *pZPos);
+    if (!m_vPoints.IsEmpty())
+        data.m_flPointsZPos = m_vPoints[0].z;
 
-    pTriggerKV->SetFloat("pointsHeight", m_flHeight);
-    pTriggerKV->AddSubKey(pPoints);
+    data.m_flPointsHeight = m_flHeight;
 
     return true;
 }
@@ -832,31 +893,24 @@ bool CMomBoxZoneBuilder::LoadFromZone(const CBaseMomZoneTrigger *pEnt)
     return true;
 }
 
-bool CMomBoxZoneBuilder::Load(KeyValues *kv)
+bool CMomBoxZoneBuilder::Load(const ZoneTriggerData_t &data)
 {
-    m_vecCenter = Vector(kv->GetFloat("xPos"), kv->GetFloat("yPos"), kv->GetFloat("zPos"));
-    m_angRot = QAngle(kv->GetFloat("xRot"), kv->GetFloat("yRot"), kv->GetFloat("zRot"));
-    m_vecMins = Vector(kv->GetFloat("xScaleMins"), kv->GetFloat("yScaleMins"), kv->GetFloat("zScaleMins"));
-    m_vecMaxs = Vector(kv->GetFloat("xScaleMaxs"), kv->GetFloat("yScaleMaxs"), kv->GetFloat("zScaleMaxs"));
+    m_vecCenter = data.m_vecBoxPos;
+    m_angRot = data.m_angBoxRot;
+    m_vecMins = data.m_vecBoxMins;
+    m_vecMaxs = data.m_vecBoxMaxs;
     SetBounds(m_vecCenter, m_vecMins, m_vecMaxs);
     m_flHeight = m_vecEnd.z - m_vecStart.z;
     return true;
 }
 
-bool CMomBoxZoneBuilder::Save(KeyValues *kv)
+bool CMomBoxZoneBuilder::Save(ZoneTriggerData_t &data)
 {
-    kv->SetFloat("xPos", m_vecCenter.x);
-    kv->SetFloat("yPos", m_vecCenter.y);
-    kv->SetFloat("zPos", m_vecCenter.z);
-    kv->SetFloat("xRot", m_angRot.x);
-    kv->SetFloat("yRot", m_angRot.y);
-    kv->SetFloat("zRot", m_angRot.z);
-    kv->SetFloat("xScaleMins", m_vecMins.x);
-    kv->SetFloat("yScaleMins", m_vecMins.y);
-    kv->SetFloat("zScaleMins", m_vecMins.z);
-    kv->SetFloat("xScaleMaxs", m_vecMaxs.x);
-    kv->SetFloat("yScaleMaxs", m_vecMaxs.y);
-    kv->SetFloat("zScaleMaxs", m_vecMaxs.z);
+    data.m_bPointZone = false;
+    data.m_vecBoxPos = m_vecCenter;
+    data.m_angBoxRot = m_angRot;
+    data.m_vecBoxMins = m_vecMins;
+    data.m_vecBoxMaxs = m_vecMaxs;
 
     return true;
 }
@@ -1038,10 +1092,10 @@ CMomBaseZoneBuilder *CreateZoneBuilderFromExisting(CBaseMomZoneTrigger *pEnt)
     }
 }
 
-CMomBaseZoneBuilder *CreateZoneBuilderFromKeyValues(KeyValues *kv)
+CMomBaseZoneBuilder *CreateZoneBuilderFromZoneData(const ZoneTriggerData_t &data)
 {
     CMomBaseZoneBuilder *pBuilder = nullptr;
-    if (kv->FindKey("points"))
+    if (data.m_bPointZone)
     {
         pBuilder = new CMomPointZoneBuilder();
     }
@@ -1052,7 +1106,7 @@ CMomBaseZoneBuilder *CreateZoneBuilderFromKeyValues(KeyValues *kv)
     }
 
     Assert(pBuilder);
-    pBuilder->Load(kv);
+    pBuilder->Load(data);
 
     return pBuilder;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 class CBaseMomZoneTrigger;
+struct ZoneTriggerData_t;
 
 // These are used for convenience-sake, only allocating once.
 
@@ -53,8 +54,8 @@ public:
 
 
     virtual bool LoadFromZone(const CBaseMomZoneTrigger *pEnt) { return false; }
-    virtual bool Load(KeyValues *kv) { return false; }
-    virtual bool Save(KeyValues *kv) { return false; }
+    virtual bool Load(const ZoneTriggerData_t &data) { return false; }
+    virtual bool Save(ZoneTriggerData_t &data) { return false; }
 
 
     virtual void Reset() = 0;
@@ -99,8 +100,8 @@ public:
 
 
     virtual bool LoadFromZone(const CBaseMomZoneTrigger *pEnt) OVERRIDE;
-    virtual bool Load(KeyValues *pTriggerKV) OVERRIDE;
-    virtual bool Save(KeyValues *pTriggerKV) OVERRIDE;
+    virtual bool Load(const ZoneTriggerData_t &data) OVERRIDE;
+    virtual bool Save(ZoneTriggerData_t &data) OVERRIDE;
 
 
     virtual void Reset() OVERRIDE;
@@ -117,6 +118,12 @@ public:
 
     CPhysCollide    *GetPhysCollide() const { return m_pPhysCollide; }
 
+    const Vector&   GetCenter() const { return m_vecCenter; }
+    const Vector&   GetMins() const { return m_vecMins; }
+    const Vector&   GetMaxs() const { return m_vecMaxs; }
+    // Use an already built phys collide (from the zone cache) instead of building one
+    void            SetCompiled(CPhysCollide *pCollide, const Vector &vecCenter, const Vector &vecMins, const Vector &vecMaxs);
+
     virtual float   GetHeight() const { return m_flHeight; }
     virtual void    SetHeight(float h) { m_flHeight = h; }
 
@@ -136,6 +143,12 @@ protected:
     void            FixPointOrder(CUtlVector<Vector> &points);
     void            DrawDebugLines(CMomHulls_t &hulls) const;
 
+    // Call whenever m_vPoints is modified, so the cached editor data gets rebuilt
+    void            MarkPointsChanged() { m_iPointsRevision++; }
+    bool            UpdateLineCache(bool bClosed, bool bDrawTop, float flTopHeight);
+    void            DrawLineCache(bool bChanged);
+    void            ClearLineCacheOverlay();
+
 
 private:
     CPhysCollide *m_pPhysCollide;
@@ -143,6 +156,15 @@ private:
 
 
     CUtlVector<Vector> m_vPoints;
+    int m_iPointsRevision;
+
+    // Editor outline as start/end pairs, only rebuilt when the points or the drawn shape change
+    CUtlVector<Vector> m_vecLineCache;
+    int m_iLineCacheRevision;
+    bool m_bLineCacheClosed;
+    bool m_bLineCacheTop;
+    float m_flLineCacheHeight;
+    double m_dLineCacheDrawTime; // When the outline was last sent to the overlay, -1 if it isn't showing
 
     Vector m_vecCenter;
     Vector m_vecMins;
@@ -171,8 +193,8 @@ public:
 
 
     virtual bool LoadFromZone(const CBaseMomZoneTrigger *pEnt) OVERRIDE;
-    virtual bool Load(KeyValues *kv) OVERRIDE;
-    virtual bool Save(KeyValues *kv) OVERRIDE;
+    virtual bool Load(const ZoneTriggerData_t &data) OVERRIDE;
+    virtual bool Save(ZoneTriggerData_t &data) OVERRIDE;
 
 
     virtual void Reset() OVERRIDE;
@@ -215,4 +237,4 @@ private:
 };
 
 CMomBaseZoneBuilder *CreateZoneBuilderFromExisting(CBaseMomZoneTrigger *pEnt);
-CMomBaseZoneBuilder *CreateZoneBuilderFromKeyValues(KeyValues *kv);
\ No newline at end of file
+CMomBaseZoneBuilder *CreateZoneBuilderFromZoneData(const ZoneTriggerData_t &data);
\ No newline at end of file
@@ -0,0 +1,204 @@
+#include "cbase.h"
+
+#include "filesystem.h"
+#include "mapzones_build.h"
+#include "mapzones_cache.h"
+#include "mapzones_file.h"
+#include "mom_shareddefs.h"
+#include "util/mom_util.h"
+
+#include "tier0/memdbgon.h"
+
+static MAKE_TOGGLE_CONVAR(mom_zone_cache_enable, "1", FCVAR_NONE,
+                          "Toggles caching the compiled collision of point zones to disk.\n");
+
+CMapZoneCollideCache::CMapZoneCollideCache()
+{
+    Reset();
+}
+
+void CMapZoneCollideCache::Reset()
+{
+    m_bActive = false;
+    m_bDirty = false;
+    m_szCachePath[0] = '\0';
+    m_szMapHash[0] = '\0';
+    m_szZoneHash[0] = '\0';
+
+    m_bufRead.Purge();
+    m_vecCompiled.RemoveAll();
+    m_iNextZone = 0;
+
+    m_iStoredZones = 0;
+    m_bufWrite.Purge();
+}
+
+void CMapZoneCollideCache::Begin(const char *pMapHash, const CMapZoneFile &zoneFile)
+{
+    Reset();
+
+    if (!mom_zone_cache_enable.GetBool() || !pMapHash || !pMapHash[0])
+        return;
+
+    // The binary form is the same no matter which format (or the site) the zones came from
+    CUtlBuffer bufZones;
+    zoneFile.SaveToBinary(bufZones);
+    if (!MomUtil::GetSHA1Hash(bufZones, m_szZoneHash, sizeof(m_szZoneHash)))
+        return;
+
+    Q_strncpy(m_szMapHash, pMapHash, sizeof(m_szMapHash));
+
+    V_ComposeFileName(ZONE_CACHE_PATH, gpGlobals->mapname.ToCStr(), m_szCachePath, sizeof(m_szCachePath));
+    V_SetExtension(m_szCachePath, ZONE_CACHE_EXT, sizeof(m_szCachePath));
+
+    m_bActive = true;
+
+    if (!ReadCache())
+    {
+        m_bufRead.Purge();
+        m_vecCompiled.RemoveAll();
+    }
+}
+
+bool CMapZoneCollideCache::ReadCache()
+{
+    if (!filesystem->ReadFile(m_szCachePath, "MOD", m_bufRead))
+        return false;
+
+    if (m_bufRead.GetUnsignedInt() != ZONE_CACHE_MAGIC || m_bufRead.GetUnsignedChar() != ZONE_CACHE_VERSION)
+        return false;
+
+    char szMapHash[41], szZoneHash[41];
+    m_bufRead.GetStringManualCharCount(szMapHash, sizeof(szMapHash));
+    m_bufRead.GetStringManualCharCount(szZoneHash, sizeof(szZoneHash));
+    if (!FStrEq(szMapHash, m_szMapHash) || !FStrEq(szZoneHash, m_szZoneHash))
+    {
+        DevLog("Zone collide cache %s is stale, it will be rebuilt\n", m_szCachePath);
+        return false;
+    }
+
+    const int iCount = m_bufRead.GetInt();
+    if (iCount < 0)
+        return false;
+
+    m_vecCompiled.EnsureCapacity(iCount);
+    for (int i = 0; i < iCount; i++)
+    {
+        CompiledZone_t zone;
+        zone.m_iRecordOffset = m_bufRead.TellGet();
+        m_bufRead.Get(&zone.m_vecCenter, sizeof(Vector));
+        m_bufRead.Get(&zone.m_vecMins, sizeof(Vector));
+        m_bufRead.Get(&zone.m_vecMaxs, sizeof(Vector));
+        zone.m_flHeight = m_bufRead.GetFloat();
+
+        zone.m_iPointCount = m_bufRead.GetInt();
+        zone.m_iPointsOffset = m_bufRead.TellGet();
+        m_bufRead.SeekGet(CUtlBuffer::SEEK_CURRENT, zone.m_iPointCount * sizeof(Vector));
+
+        zone.m_iCollideSize = m_bufRead.GetInt();
+        zone.m_iCollideOffset = m_bufRead.TellGet();
+        m_bufRead.SeekGet(CUtlBuffer::SEEK_CURRENT, zone.m_iCollideSize);
+        zone.m_iRecordSize = m_bufRead.TellGet() - zone.m_iRecordOffset;
+
+        if (!m_bufRead.IsValid() || zone.m_iPointCount < 3 || zone.m_iCollideSize <= 0)
+            return false;
+
+        m_vecCompiled.AddToTail(zone);
+    }
+
+    return true;
+}
+
+bool CMapZoneCollideCache::RestoreZone(CMomPointZoneBuilder *pBuilder)
+{
+    if (!m_bActive || m_bDirty || !m_vecCompiled.IsValidIndex(m_iNextZone))
+    {
+        m_bDirty = m_bActive;
+        return false;
+    }
+
+    const CompiledZone_t &zone = m_vecCompiled[m_iNextZone];
+
+    char *pBase = static_cast<char *>(m_bufRead.Base());
+    CPhysCollide *pCollide = physcollision->UnserializeCollide(pBase + zone.m_iCollideOffset, zone.m_iCollideSize, 0);
+    if (!pCollide)
+    {
+        m_bDirty = true;
+        return false;
+    }
+
+    CUtlVector<Vector> vecPoints;
+    vecPoints.CopyArray(reinterpret_cast<Vector *>(pBase + zone.m_iPointsOffset), zone.m_iPointCount);
+    pBuilder->CopyPoints(vecPoints);
+    pBuilder->SetHeight(zone.m_flHeight);
+    pBuilder->SetCompiled(pCollide, zone.m_vecCenter, zone.m_vecMins, zone.m_vecMaxs);
+
+    m_iNextZone++;
+    return true;
+}
+
+void CMapZoneCollideCache::StoreZone(CMomPointZoneBuilder *pBuilder)
+{
+    if (!m_bActive)
+        return;
+
+    // Restored from the cache, its entry is already there as it is
+    if (m_iStoredZones < m_iNextZone)
+    {
+        m_iStoredZones++;
+        return;
+    }
+
+    CPhysCollide *pCollide = pBuilder->GetPhysCollide();
+    if (!pCollide)
+    {
+        // Can't be restored on the next load either, so don't keep a cache that skips it
+        m_bActive = false;
+        return;
+    }
+
+    const CUtlVector<Vector> &vecPoints = pBuilder->GetPoints();
+
+    m_bufWrite.Put(&pBuilder->GetCenter(), sizeof(Vector));
+    m_bufWrite.Put(&pBuilder->GetMins(), sizeof(Vector));
+    m_bufWrite.Put(&pBuilder->GetMaxs(), sizeof(Vector));
+    m_bufWrite.PutFloat(pBuilder->GetHeight());
+
+    m_bufWrite.PutInt(vecPoints.Count());
+    m_bufWrite.Put(vecPoints.Base(), vecPoints.Count() * sizeof(Vector));
+
+    const int iCollideSize = physcollision->CollideSize(pCollide);
+    m_bufWrite.PutInt(iCollideSize);
+    m_bufWrite.EnsureCapacity(m_bufWrite.TellPut() + iCollideSize);
+    physcollision->CollideWrite(static_cast<char *>(m_bufWrite.PeekPut()), pCollide);
+    m_bufWrite.SeekPut(CUtlBuffer::SEEK_CURRENT, iCollideSize);
+
+    m_iStoredZones++;
+}
+
+void CMapZoneCollideCache::End()
+{
+    // Write it if a zone had to be built, or if there was no cache to read from yet
+    if (m_bActive && (m_bDirty || m_iStoredZones != m_vecCompiled.Count()))
+    {
+        CUtlBuffer buf;
+        buf.PutUnsignedInt(ZONE_CACHE_MAGIC);
+        buf.PutUnsignedChar(ZONE_CACHE_VERSION);
+        buf.PutString(m_szMapHash);
+        buf.PutString(m_szZoneHash);
+        buf.PutInt(m_iStoredZones);
+        if (m_iNextZone > 0)
+        {
+            const CompiledZone_t &first = m_vecCompiled[0], &last = m_vecCompiled[m_iNextZone - 1];
+            const char *pBase = static_cast<const char *>(m_bufRead.Base());
+            buf.Put(pBase + first.m_iRecordOffset, last.m_iRecordOffset + last.m_iRecordSize - first.m_iRecordOffset);
+        }
+        buf.Put(m_bufWrite.Base(), m_bufWrite.TellPut());
+
+        filesystem->CreateDirHierarchy(ZONE_CACHE_PATH, "MOD");
+        if (!filesystem->WriteFile(m_szCachePath, "MOD", buf))
+            Warning("Failed to write zone collide cache %s!\n", m_szCachePath);
+    }
+
+    Reset();
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "utlbuffer.h"
+
+class CMapZoneFile;
+class CMomPointZoneBuilder;
+
+#define ZONE_CACHE_PATH "cache/zones"
+#define ZONE_CACHE_EXT ".zcc"
+#define ZONE_CACHE_MAGIC 0x4343435A // "ZCCC"
+#define ZONE_CACHE_VERSION 1
+
+// Compiled collision for the point (polygon) zones of a map, so that they do not have to be
+// decomposed and turned into phys collides again on every level load.
+// One file per map, only valid for the map hash and zone data hash stored in its header.
+// Zones are stored in the order they are spawned from the zone data.
+class CMapZoneCollideCache
+{
+  public:
+    CMapZoneCollideCache();
+
+    // Prepares the cache for the given zone data, reading the compiled zones from disk if they exist
+    void Begin(const char *pMapHash, const CMapZoneFile &zoneFile);
+    // Writes the cache back to disk if any zone had to be built
+    void End();
+
+    // Restores the next point zone into the builder. Returns false if the zone has to be built.
+    bool RestoreZone(CMomPointZoneBuilder *pBuilder);
+    // Stores a built point zone, call this for every point zone in spawn order
+    void StoreZone(CMomPointZoneBuilder *pBuilder);
+
+  private:
+    struct CompiledZone_t
+    {
+        Vector m_vecCenter;
+        Vector m_vecMins;
+        Vector m_vecMaxs;
+        float m_flHeight;
+        int m_iPointsOffset;
+        int m_iPointCount;
+        int m_iCollideOffset;
+        int m_iCollideSize;
+        // Where the whole entry sits in the file, so restored zones can be written back as they are
+        int m_iRecordOffset;
+        int m_iRecordSize;
+    };
+
+    bool ReadCache();
+    void Reset();
+
+    bool m_bActive;
+    bool m_bDirty;
+    char m_szCachePath[MAX_PATH];
+    char m_szMapHash[41];
+    char m_szZoneHash[41];
+
+    // Read side, the collides are unserialized straight out of the file buffer
+    CUtlBuffer m_bufRead;
+    CUtlVector<CompiledZone_t> m_vecCompiled;
+    int m_iNextZone;
+
+    // Write side, every zone of this load. The restored zones always come first and aren't serialized
+    // again, only the ones built after them end up in m_bufWrite.
+    int m_iStoredZones;
+    CUtlBuffer m_bufWrite;
+};
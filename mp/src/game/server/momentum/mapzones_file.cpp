@@ -0,0 +1,395 @@
+#include "cbase.h"
+
+#include "filesystem.h"
+#include "fmtstr.h"
+#include "mapzones_file.h"
+#include "mom_shareddefs.h"
+#include "mom_triggers.h"
+
+#include "tier0/memdbgon.h"
+
+// Binary trigger flags
+#define ZONE_FLAG_POINTS (1 << 0)
+#define ZONE_FLAG_PROPS (1 << 1)
+#define ZONE_FLAG_LIMITING_SPEED (1 << 2)
+#define ZONE_FLAG_START_ON_JUMP (1 << 3)
+#define ZONE_FLAG_YAW (1 << 4)
+
+// Yaw value in the KeyValues format meaning "no look angles"
+#define ZONE_NO_LOOK_YAW -190.0f
+
+// A point zone needs at least a triangle to be built
+#define ZONE_MIN_POINTS 3
+
+ZoneTriggerData_t::ZoneTriggerData_t()
+{
+    m_iTrack = 0;
+    m_iZone = 0;
+    m_iType = ZONE_TYPE_INVALID;
+
+    m_bHasProps = false;
+    m_flSpeedLimit = 350.0f;
+    m_bLimitingSpeed = true;
+    m_bStartOnJump = true;
+    m_iSpeedLimitType = SPEED_NORMAL_LIMIT;
+    m_bHasYaw = false;
+    m_flYaw = 0.0f;
+
+    m_bPointZone = false;
+    m_flPointsZPos = 0.0f;
+    m_flPointsHeight = 0.0f;
+
+    m_vecBoxPos.Init();
+    m_angBoxRot.Init();
+    m_vecBoxMins.Init();
+    m_vecBoxMaxs.Init();
+}
+
+ZoneTriggerData_t *CMapZoneFile::AddTrigger(int track, int zone)
+{
+    const auto pTrigger = new ZoneTriggerData_t;
+    pTrigger->m_iTrack = track;
+    pTrigger->m_iZone = zone;
+    m_vecTriggers.AddToTail(pTrigger);
+    return pTrigger;
+}
+
+bool CMapZoneFile::LoadFromFile(const char *pFileName, const char *pPathID)
+{
+    CUtlBuffer buf;
+    if (!filesystem->ReadFile(pFileName, pPathID, buf))
+        return false;
+
+    if (buf.TellPut() >= (int)sizeof(uint32) && *static_cast<const uint32 *>(buf.PeekGet()) == ZONE_FILE_MAGIC)
+        return LoadFromBinary(buf);
+
+    KeyValuesAD fileKV("tracks");
+    buf.PutChar('\0');
+    if (!fileKV->LoadFromBuffer(pFileName, static_cast<const char *>(buf.Base()), filesystem, pPathID))
+        return false;
+
+    return LoadFromKeyValues(fileKV, false);
+}
+
+bool CMapZoneFile::SaveToFile(const char *pFileName, const char *pPathID, bool bBinary) const
+{
+    if (bBinary)
+    {
+        CUtlBuffer buf;
+        SaveToBinary(buf);
+        return filesystem->WriteFile(pFileName, pPathID, buf);
+    }
+
+    KeyValuesAD zoneKV("tracks");
+    SaveToKeyValues(zoneKV);
+    return !zoneKV->IsEmpty() && zoneKV->SaveToFile(filesystem, pFileName, pPathID);
+}
+
+bool CMapZoneFile::LoadFromKeyValues(KeyValues *pKvTracks, bool bFromSite)
+{
+    Clear();
+
+    if (!pKvTracks || pKvTracks->IsEmpty())
+        return false;
+
+    FOR_EACH_SUBKEY(pKvTracks, trackKV)
+    {
+        const auto trackNum = bFromSite ? trackKV->GetInt("trackNum") : Q_atoi(trackKV->GetName());
+        if (trackNum >= -1 && trackNum < MAX_TRACKS)
+        {
+            KeyValues *toItr = bFromSite ? trackKV->FindKey("zones") : trackKV;
+            if (!toItr)
+                return false;
+            FOR_EACH_SUBKEY(toItr, zoneKV)
+            {
+                const auto zoneNum = zoneKV->GetInt("zoneNum");
+                if (zoneNum >= 0 && zoneNum < MAX_ZONES)
+                {
+                    const auto pKvTriggers = zoneKV->FindKey("triggers");
+                    if (!pKvTriggers)
+                        return false;
+                    FOR_EACH_SUBKEY(pKvTriggers, triggerKV)
+                    {
+                        const auto zoneType = triggerKV->GetInt("type", ZONE_TYPE_INVALID);
+
+                        if (zoneType <= ZONE_TYPE_INVALID || zoneType >= ZONE_TYPE_COUNT)
+                        {
+                            Warning("Error while reading zone file: Unknown map zone type %d!\n", zoneType);
+                            continue;
+                        }
+
+                        const auto pTrigger = AddTrigger(trackNum, zoneNum);
+                        if (!LoadTriggerFromKeyValues(triggerKV, pTrigger))
+                        {
+                            Warning("Error while reading zone file: Invalid zone data for track %i zone %i!\n", trackNum, zoneNum);
+                            m_vecTriggers.FindAndRemove(pTrigger);
+                            delete pTrigger;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return !IsEmpty();
+}
+
+bool CMapZoneFile::LoadTriggerFromKeyValues(KeyValues *pKvTrigger, ZoneTriggerData_t *pTrigger)
+{
+    pTrigger->m_iType = pKvTrigger->GetInt("type", ZONE_TYPE_INVALID);
+
+    const auto pZoneProps = pKvTrigger->FindKey("zoneProps");
+    const auto pActualProps = pZoneProps ? pZoneProps->FindKey("properties") : nullptr;
+    if (pActualProps)
+    {
+        pTrigger->m_bHasProps = true;
+        pTrigger->m_flSpeedLimit = pActualProps->GetFloat("speed_limit", 350.0f);
+        pTrigger->m_bLimitingSpeed = pActualProps->GetBool("limiting_speed", true);
+        pTrigger->m_bStartOnJump = pActualProps->GetBool("start_on_jump", true);
+        pTrigger->m_iSpeedLimitType = pActualProps->GetInt("speed_limit_type", SPEED_NORMAL_LIMIT);
+
+        const float yaw = pActualProps->GetFloat("yaw", ZONE_NO_LOOK_YAW);
+        pTrigger->m_bHasYaw = !CloseEnough(yaw, ZONE_NO_LOOK_YAW);
+        pTrigger->m_flYaw = pTrigger->m_bHasYaw ? yaw : 0.0f;
+    }
+
+    const auto pPoints = pKvTrigger->FindKey("points");
+    if (pPoints)
+    {
+        pTrigger->m_bPointZone = true;
+        pTrigger->m_flPointsHeight = pKvTrigger->GetFloat("pointsHeight");
+
+        const auto kvZPos = pKvTrigger->FindKey("pointsZPos");
+        if (!kvZPos)
+            return false;
+
+        pTrigger->m_flPointsZPos = kvZPos->GetFloat();
+
+        FOR_EACH_VALUE(pPoints, pKvPoint)
+        {
+            const char *val = pKvPoint->GetString();
+            if (val && *val)
+            {
+                Vector2D pos(0.0f, 0.0f);
+                sscanf(val, "%f %f", &pos.x, &pos.y);
+                pTrigger->m_vecPoints.AddToTail(pos);
+            }
+        }
+
+        return pTrigger->m_vecPoints.Count() >= ZONE_MIN_POINTS;
+    }
+
+    pTrigger->m_vecBoxPos.Init(pKvTrigger->GetFloat("xPos"), pKvTrigger->GetFloat("yPos"), pKvTrigger->GetFloat("zPos"));
+    pTrigger->m_angBoxRot.Init(pKvTrigger->GetFloat("xRot"), pKvTrigger->GetFloat("yRot"), pKvTrigger->GetFloat("zRot"));
+    pTrigger->m_vecBoxMins.Init(pKvTrigger->GetFloat("xScaleMins"), pKvTrigger->GetFloat("yScaleMins"), pKvTrigger->GetFloat("zScaleMins"));
+    pTrigger->m_vecBoxMaxs.Init(pKvTrigger->GetFloat("xScaleMaxs"), pKvTrigger->GetFloat("yScaleMaxs"), pKvTrigger->GetFloat("zScaleMaxs"));
+    return true;
+}
+
+void CMapZoneFile::SaveToKeyValues(KeyValues *pKvTracks) const
+{
+    KeyValues *pKvZone = nullptr;
+    int iLastTrack = INT_MIN, iLastZone = INT_MIN;
+
+    FOR_EACH_VEC(m_vecTriggers, i)
+    {
+        const auto pTrigger = m_vecTriggers[i];
+        if (pTrigger->m_iTrack != iLastTrack || pTrigger->m_iZone != iLastZone)
+        {
+            const auto pKvTrack = pKvTracks->FindKey(CFmtStr("%i", pTrigger->m_iTrack), true);
+            pKvZone = pKvTrack->FindKey(CFmtStr("%i", pTrigger->m_iZone), true);
+            pKvZone->SetInt("zoneNum", pTrigger->m_iZone);
+
+            iLastTrack = pTrigger->m_iTrack;
+            iLastZone = pTrigger->m_iZone;
+        }
+
+        const auto pKvTriggers = pKvZone->FindKey("triggers", true);
+        SaveTriggerToKeyValues(pTrigger, pKvTriggers->CreateNewKey());
+    }
+}
+
+void CMapZoneFile::SaveTriggerToKeyValues(const ZoneTriggerData_t *pTrigger, KeyValues *pKvTrigger) const
+{
+    if (pTrigger->m_bHasProps)
+    {
+        // Structured like this because properties are another DB table for the site
+        // (not every trigger has properties)
+        const auto pZoneProps = new KeyValues("zoneProps");
+        const auto pActualProps = new KeyValues("properties");
+
+        pActualProps->SetFloat("speed_limit", pTrigger->m_flSpeedLimit);
+        pActualProps->SetBool("limiting_speed", pTrigger->m_bLimitingSpeed);
+        pActualProps->SetBool("start_on_jump", pTrigger->m_bStartOnJump);
+        pActualProps->SetInt("speed_limit_type", pTrigger->m_iSpeedLimitType);
+        if (pTrigger->m_bHasYaw)
+        {
+            pActualProps->SetFloat("yaw", pTrigger->m_flYaw);
+        }
+
+        pZoneProps->AddSubKey(pActualProps);
+        pKvTrigger->AddSubKey(pZoneProps);
+    }
+
+    pKvTrigger->SetInt("zoneNum", pTrigger->m_iZone);
+    pKvTrigger->SetInt("type", pTrigger->m_iType);
+
+    if (pTrigger->m_bPointZone)
+    {
+        const auto pPoints = new KeyValues("points");
+        FOR_EACH_VEC(pTrigger->m_vecPoints, i)
+        {
+            const Vector2D &pos = pTrigger->m_vecPoints[i];
+            pPoints->SetString(CFmtStrN<64>("p%i", i), CFmtStrN<64>("%.3f %.3f", pos.x, pos.y));
+        }
+
+        pKvTrigger->SetFloat("pointsZPos", pTrigger->m_flPointsZPos);
+        pKvTrigger->SetFloat("pointsHeight", pTrigger->m_flPointsHeight);
+        pKvTrigger->AddSubKey(pPoints);
+    }
+    else
+    {
+        pKvTrigger->SetFloat("xPos", pTrigger->m_vecBoxPos.x);
+        pKvTrigger->SetFloat("yPos", pTrigger->m_vecBoxPos.y);
+        pKvTrigger->SetFloat("zPos", pTrigger->m_vecBoxPos.z);
+        pKvTrigger->SetFloat("xRot", pTrigger->m_angBoxRot.x);
+        pKvTrigger->SetFloat("yRot", pTrigger->m_angBoxRot.y);
+        pKvTrigger->SetFloat("zRot", pTrigger->m_angBoxRot.z);
+        pKvTrigger->SetFloat("xScaleMins", pTrigger->m_vecBoxMins.x);
+        pKvTrigger->SetFloat("yScaleMins", pTrigger->m_vecBoxMins.y);
+        pKvTrigger->SetFloat("zScaleMins", pTrigger->m_vecBoxMins.z);
+        pKvTrigger->SetFloat("xScaleMaxs", pTrigger->m_vecBoxMaxs.x);
+        pKvTrigger->SetFloat("yScaleMaxs", pTrigger->m_vecBoxMaxs.y);
+        pKvTrigger->SetFloat("zScaleMaxs", pTrigger->m_vecBoxMaxs.z);
+    }
+}
+
+bool CMapZoneFile::LoadFromBinary(CUtlBuffer &buf)
+{
+    Clear();
+
+    if (buf.GetUnsignedInt() != ZONE_FILE_MAGIC)
+        return false;
+
+    const uint8 version = buf.GetUnsignedChar();
+    if (version != ZONE_FILE_VERSION)
+    {
+        Warning("Unsupported binary zone file version %i!\n", version);
+        return false;
+    }
+
+    const int iCount = buf.GetUnsignedShort();
+    m_vecTriggers.EnsureCapacity(iCount);
+    for (int i = 0; i < iCount; i++)
+    {
+        const int track = static_cast<signed char>(buf.GetChar());
+        const int zone = buf.GetUnsignedChar();
+        const auto pTrigger = AddTrigger(track, zone);
+
+        pTrigger->m_iType = static_cast<signed char>(buf.GetChar());
+        const uint8 flags = buf.GetUnsignedChar();
+
+        if (flags & ZONE_FLAG_PROPS)
+        {
+            pTrigger->m_bHasProps = true;
+            pTrigger->m_bLimitingSpeed = (flags & ZONE_FLAG_LIMITING_SPEED) != 0;
+            pTrigger->m_bStartOnJump = (flags & ZONE_FLAG_START_ON_JUMP) != 0;
+            pTrigger->m_flSpeedLimit = buf.GetFloat();
+            pTrigger->m_iSpeedLimitType = buf.GetUnsignedChar();
+
+            pTrigger->m_bHasYaw = (flags & ZONE_FLAG_YAW) != 0;
+            if (pTrigger->m_bHasYaw)
+                pTrigger->m_flYaw = buf.GetFloat();
+        }
+
+        if (flags & ZONE_FLAG_POINTS)
+        {
+            pTrigger->m_bPointZone = true;
+            pTrigger->m_flPointsZPos = buf.GetFloat();
+            pTrigger->m_flPointsHeight = buf.GetFloat();
+
+            const int iPoints = buf.GetUnsignedShort();
+            pTrigger->m_vecPoints.SetCount(iPoints);
+            buf.Get(pTrigger->m_vecPoints.Base(), iPoints * sizeof(Vector2D));
+        }
+        else
+        {
+            buf.Get(pTrigger->m_vecBoxPos.Base(), sizeof(Vector));
+            buf.Get(pTrigger->m_angBoxRot.Base(), sizeof(QAngle));
+            buf.Get(pTrigger->m_vecBoxMins.Base(), sizeof(Vector));
+            buf.Get(pTrigger->m_vecBoxMaxs.Base(), sizeof(Vector));
+        }
+
+        if (!buf.IsValid() || track < -1 || track >= MAX_TRACKS || zone >= MAX_ZONES ||
+            pTrigger->m_iType <= ZONE_TYPE_INVALID || pTrigger->m_iType >= ZONE_TYPE_COUNT)
+        {
+            Warning("Error while reading binary zone file: Invalid zone data at trigger %i!\n", i);
+            Clear();
+            return false;
+        }
+
+        // Same as the KeyValues format, a zone that can't be built is skipped rather than failing the whole file
+        if (pTrigger->m_bPointZone && pTrigger->m_vecPoints.Count() < ZONE_MIN_POINTS)
+        {
+            Warning("Error while reading zone file: Invalid zone data for track %i zone %i!\n", track, zone);
+            m_vecTriggers.FindAndRemove(pTrigger);
+            delete pTrigger;
+        }
+    }
+
+    return !IsEmpty();
+}
+
+void CMapZoneFile::SaveToBinary(CUtlBuffer &buf) const
+{
+    buf.PutUnsignedInt(ZONE_FILE_MAGIC);
+    buf.PutUnsignedChar(ZONE_FILE_VERSION);
+    buf.PutUnsignedShort(m_vecTriggers.Count());
+
+    FOR_EACH_VEC(m_vecTriggers, i)
+    {
+        const auto pTrigger = m_vecTriggers[i];
+
+        uint8 flags = 0;
+        if (pTrigger->m_bPointZone)
+            flags |= ZONE_FLAG_POINTS;
+        if (pTrigger->m_bHasProps)
+        {
+            flags |= ZONE_FLAG_PROPS;
+            if (pTrigger->m_bLimitingSpeed)
+                flags |= ZONE_FLAG_LIMITING_SPEED;
+            if (pTrigger->m_bStartOnJump)
+                flags |= ZONE_FLAG_START_ON_JUMP;
+            if (pTrigger->m_bHasYaw)
+                flags |= ZONE_FLAG_YAW;
+        }
+
+        buf.PutChar(pTrigger->m_iTrack);
+        buf.PutUnsignedChar(pTrigger->m_iZone);
+        buf.PutChar(pTrigger->m_iType);
+        buf.PutUnsignedChar(flags);
+
+        if (pTrigger->m_bHasProps)
+        {
+            buf.PutFloat(pTrigger->m_flSpeedLimit);
+            buf.PutUnsignedChar(pTrigger->m_iSpeedLimitType);
+            if (pTrigger->m_bHasYaw)
+                buf.PutFloat(pTrigger->m_flYaw);
+        }
+
+        if (pTrigger->m_bPointZone)
+        {
+            buf.PutFloat(pTrigger->m_flPointsZPos);
+            buf.PutFloat(pTrigger->m_flPointsHeight);
+            buf.PutUnsignedShort(pTrigger->m_vecPoints.Count());
+            buf.Put(pTrigger->m_vecPoints.Base(), pTrigger->m_vecPoints.Count() * sizeof(Vector2D));
+        }
+        else
+        {
+            buf.Put(pTrigger->m_vecBoxPos.Base(), sizeof(Vector));
+            buf.Put(pTrigger->m_angBoxRot.Base(), sizeof(QAngle));
+            buf.Put(pTrigger->m_vecBoxMins.Base(), sizeof(Vector));
+            buf.Put(pTrigger->m_vecBoxMaxs.Base(), sizeof(Vector));
+        }
+    }
+}
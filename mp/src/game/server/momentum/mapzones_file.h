@@ -0,0 +1,69 @@
+#pragma once
+
+#include "utlbuffer.h"
+
+// Binary .zon files start with this instead of a KeyValues token
+#define ZONE_FILE_MAGIC 0x4E4F5A4D // "MZON"
+#define ZONE_FILE_VERSION 1
+
+// Everything needed to spawn a single zone trigger.
+// Both the text (KeyValues) and binary .zon formats are read into and written from this.
+struct ZoneTriggerData_t
+{
+    ZoneTriggerData_t();
+
+    int m_iTrack;
+    int m_iZone;
+    int m_iType;
+
+    // Start zone properties ("zoneProps" in the KeyValues format)
+    bool m_bHasProps;
+    float m_flSpeedLimit;
+    bool m_bLimitingSpeed;
+    bool m_bStartOnJump;
+    int m_iSpeedLimitType;
+    bool m_bHasYaw;
+    float m_flYaw;
+
+    // Point zones, all points share the same Z
+    bool m_bPointZone;
+    float m_flPointsZPos;
+    float m_flPointsHeight;
+    CUtlVector<Vector2D> m_vecPoints;
+
+    // Box zones
+    Vector m_vecBoxPos;
+    QAngle m_angBoxRot;
+    Vector m_vecBoxMins;
+    Vector m_vecBoxMaxs;
+};
+
+// The contents of a .zon file, or the zones fetched from the site
+class CMapZoneFile
+{
+  public:
+    ~CMapZoneFile() { Clear(); }
+
+    void Clear() { m_vecTriggers.PurgeAndDeleteElements(); }
+    bool IsEmpty() const { return m_vecTriggers.IsEmpty(); }
+
+    // Creates a trigger entry at the end of the file
+    ZoneTriggerData_t *AddTrigger(int track, int zone);
+
+    // Loads either format, based on the first bytes of the file
+    bool LoadFromFile(const char *pFileName, const char *pPathID);
+    bool SaveToFile(const char *pFileName, const char *pPathID, bool bBinary) const;
+
+    bool LoadFromKeyValues(KeyValues *pKvTracks, bool bFromSite);
+    void SaveToKeyValues(KeyValues *pKvTracks) const;
+
+    bool LoadFromBinary(CUtlBuffer &buf);
+    void SaveToBinary(CUtlBuffer &buf) const;
+
+    // In spawn order, grouped by track and then zone
+    CUtlVector<ZoneTriggerData_t *> m_vecTriggers;
+
+  private:
+    bool LoadTriggerFromKeyValues(KeyValues *pKvTrigger, ZoneTriggerData_t *pTrigger);
+    void SaveTriggerToKeyValues(const ZoneTriggerData_t *pTrigger, KeyValues *pKvTrigger) const;
+};
@@ -4,6 +4,9 @@
 #include "buttons.h"
 #include "mom_player.h"
 #include "mom_system_gamemode.h"
+#include "mom_replay_system.h"
+#include "filesystem.h"
+#include "fmtstr.h"
 
 #include "tier0/memdbgon.h"
 
@@ -28,20 +31,41 @@ class CTeleportTriggerTraceEnum : public IEntityEnumerator
 
 CMOMBhopBlockFixSystem::CMOMBhopBlockFixSystem(const char* pName) : CAutoGameSystem(pName)
 {
-    SetDefLessFunc(m_mapBlocks);
+    ClearBhopBlocks();
+}
+
+void CMOMBhopBlockFixSystem::PostInit()
+{
+    filesystem->CreateDirHierarchy(BLOCKFIX_CACHE_PATH, "MOD");
 }
 
 void CMOMBhopBlockFixSystem::LevelInitPostEntity()
 {
     if (g_pGameModeSystem->GameModeIs(GAMEMODE_BHOP))
     {
-        FindBhopBlocks();
+        const char *pMapHash = g_ReplaySystem.GetMapHash();
+        if (!pMapHash[0])
+        {
+            FindBhopBlocks();
+        }
+        else if (!LoadBlocksFromCache(pMapHash))
+        {
+            FindBhopBlocks();
+            SaveBlocksToCache(pMapHash);
+        }
     }
 }
 
 void CMOMBhopBlockFixSystem::LevelShutdownPostEntity()
 {
-    m_mapBlocks.RemoveAll();
+    ClearBhopBlocks();
+}
+
+void CMOMBhopBlockFixSystem::ClearBhopBlocks()
+{
+    m_bitBlocks.ClearAll();
+    m_vecBlockIndexes.RemoveAll();
+    V_memset(m_Blocks, 0, sizeof(m_Blocks));
 }
 
 void CMOMBhopBlockFixSystem::FindBhopBlocks()
@@ -58,9 +82,6 @@ void CMOMBhopBlockFixSystem::FindBhopBlocks()
         if (startpos.z > endpos.z)
         {
             FindTeleport(pEntDoor, true);
-
-            if (m_mapBlocks.Count() == MAX_BHOPBLOCKS)
-                break;
         }
     }
     ent = nullptr;
@@ -75,9 +96,6 @@ void CMOMBhopBlockFixSystem::FindBhopBlocks()
         if (startpos.z > endpos.z && (pEntButton->HasSpawnFlags(SF_BUTTON_TOUCH_ACTIVATES)))
         {
             FindTeleport(pEntButton, false);
-
-            if (m_mapBlocks.Count() == MAX_BHOPBLOCKS)
-                break;
         }
     }
 }
@@ -135,10 +153,10 @@ void CMOMBhopBlockFixSystem::PlayerTouch(CBaseEntity *pPlayerEnt, CBaseEntity *p
     }
     else if (diff > BLOCK_TELEPORT) // We need to teleport the player.
     {
-        int idx = m_mapBlocks.Find(pBlock->entindex());
-        if (m_mapBlocks.IsValidIndex(idx))
+        const int idx = pBlock->entindex();
+        if (IsBhopBlock(idx))
         {
-            CBaseEntity *pEntTeleport = m_mapBlocks.Element(idx).m_pTeleportTrigger;
+            CBaseEntity *pEntTeleport = m_Blocks[idx].m_pTeleportTrigger;
             if (pEntTeleport)
             {
                 pEntTeleport->Touch(pPlayer);
@@ -183,8 +201,104 @@ void CMOMBhopBlockFixSystem::AddBhopBlock(CBaseEntity* pBlockEnt, CBaseEntity* p
     block.m_pBlockEntity = pBlockEnt;
     block.m_pTeleportTrigger = pTeleportEnt;
     block.m_bIsDoor = isDoor;
+
+    const int idx = pBlockEnt->entindex();
+    if (idx < 0 || idx >= MAX_EDICTS || m_bitBlocks.IsBitSet(idx))
+        return;
+
     AlterBhopBlock(block);
-    m_mapBlocks.Insert(pBlockEnt->entindex(), block);
+    m_Blocks[idx] = block;
+    m_bitBlocks.Set(idx);
+    m_vecBlockIndexes.AddToTail(idx);
+}
+
+void CMOMBhopBlockFixSystem::GetCacheFileName(const char *pMapHash, char *pOut, size_t outSize)
+{
+    CFmtStr fileName("%s-%s.dat", gpGlobals->mapname.ToCStr(), pMapHash);
+    V_ComposeFileName(BLOCKFIX_CACHE_PATH, fileName.Get(), pOut, outSize);
+}
+
+bool CMOMBhopBlockFixSystem::LoadBlocksFromCache(const char *pMapHash)
+{
+    char szPath[MAX_PATH];
+    GetCacheFileName(pMapHash, szPath, sizeof(szPath));
+
+    CUtlBuffer reader;
+    if (!filesystem->ReadFile(szPath, "MOD", reader))
+        return false;
+
+    if (reader.GetUnsignedInt() != BLOCKFIX_CACHE_MAGIC || reader.GetUnsignedChar() != BLOCKFIX_CACHE_VERSION)
+    {
+        DevWarning("Blockfix cache %s is out of date, rebuilding it...\n", szPath);
+        return false;
+    }
+
+    const int iCount = reader.GetInt();
+    if (iCount < 0 || iCount > MAX_EDICTS)
+        return false;
+
+    CUtlVector<bhop_block_t> vecBlocks;
+    vecBlocks.EnsureCapacity(iCount);
+    for (int i = 0; i < iCount; i++)
+    {
+        const int iBlockIndex = reader.GetInt();
+        const int iBlockHammerID = reader.GetInt();
+        const int iTeleportIndex = reader.GetInt();
+        const int iTeleportHammerID = reader.GetInt();
+        const bool bIsDoor = reader.GetUnsignedChar() != 0;
+
+        if (!reader.IsValid())
+            return false;
+
+        // Entity indexes of map entities are stable across loads of the same BSP, but make sure
+        // that the cache still describes the entities we actually have before trusting it
+        CBaseEntity *pBlockEnt = UTIL_EntityByIndex(iBlockIndex);
+        CBaseEntity *pTeleportEnt = UTIL_EntityByIndex(iTeleportIndex);
+        if (!pBlockEnt || !pTeleportEnt || pBlockEnt->m_iHammerID != iBlockHammerID ||
+            pTeleportEnt->m_iHammerID != iTeleportHammerID ||
+            !pBlockEnt->ClassMatches(bIsDoor ? "func_door" : "func_button"))
+        {
+            DevWarning("Blockfix cache %s does not match the map entities, rebuilding it...\n", szPath);
+            return false;
+        }
+
+        bhop_block_t block;
+        block.m_pBlockEntity = pBlockEnt;
+        block.m_pTeleportTrigger = pTeleportEnt;
+        block.m_bIsDoor = bIsDoor;
+        vecBlocks.AddToTail(block);
+    }
+
+    FOR_EACH_VEC(vecBlocks, i)
+    {
+        AddBhopBlock(vecBlocks[i].m_pBlockEntity, vecBlocks[i].m_pTeleportTrigger, vecBlocks[i].m_bIsDoor);
+    }
+
+    DevLog("Loaded %i bhop blocks from cache %s\n", iCount, szPath);
+    return true;
+}
+
+void CMOMBhopBlockFixSystem::SaveBlocksToCache(const char *pMapHash)
+{
+    CUtlBuffer buf;
+    buf.PutUnsignedInt(BLOCKFIX_CACHE_MAGIC);
+    buf.PutUnsignedChar(BLOCKFIX_CACHE_VERSION);
+    buf.PutInt(m_vecBlockIndexes.Count());
+
+    FOR_EACH_VEC(m_vecBlockIndexes, i)
+    {
+        const bhop_block_t &block = m_Blocks[m_vecBlockIndexes[i]];
+        buf.PutInt(block.m_pBlockEntity->entindex());
+        buf.PutInt(block.m_pBlockEntity->m_iHammerID);
+        buf.PutInt(block.m_pTeleportTrigger->entindex());
+        buf.PutInt(block.m_pTeleportTrigger->m_iHammerID);
+        buf.PutUnsignedChar(block.m_bIsDoor);
+    }
+
+    char szPath[MAX_PATH];
+    GetCacheFileName(pMapHash, szPath, sizeof(szPath));
+    if (!filesystem->WriteFile(szPath, "MOD", buf))
+        Warning("Failed to write blockfix cache %s!\n", szPath);
 }
 
 // override of IEntityEnumerator's EnumEntity() for our trigger teleport filter
@@ -1,26 +1,38 @@
 #pragma once
 
-#define MAX_BHOPBLOCKS 1024
+#include "bitvec.h"
+
 #define BLOCK_TELEPORT 0.11
 #define BLOCK_COOLDOWN 1.0
 
+#define BLOCKFIX_CACHE_PATH "cache/blockfix"
+#define BLOCKFIX_CACHE_MAGIC 0x4B4C4242 // "BBLK"
+#define BLOCKFIX_CACHE_VERSION 1
+
 class CMOMBhopBlockFixSystem : public CAutoGameSystem
 {
   public:
     CMOMBhopBlockFixSystem(const char *pName);
 
     // GameSystem overrides
+    void PostInit() OVERRIDE;
     void LevelInitPostEntity() OVERRIDE;
     void LevelShutdownPostEntity() OVERRIDE;
 
     // Called from player
-    bool IsBhopBlock(const int &entIndex) const { return (m_mapBlocks.Find(entIndex) != m_mapBlocks.InvalidIndex()); }
+    bool IsBhopBlock(const int &entIndex) const { return entIndex >= 0 && entIndex < MAX_EDICTS && m_bitBlocks.IsBitSet(entIndex); }
     void PlayerTouch(CBaseEntity *pPlayerEnt, CBaseEntity *pBlock);
 
   private:
     void FindBhopBlocks();
     void FindTeleport(CBaseEntity *pBlockEnt, bool isDoor);
     void AddBhopBlock(CBaseEntity *pBlockEnt, CBaseEntity *pTeleportEnt, bool isDoor);
+    void ClearBhopBlocks();
+
+    // Cache of the discovered blocks, keyed by the map hash
+    void GetCacheFileName(const char *pMapHash, char *pOut, size_t outSize);
+    bool LoadBlocksFromCache(const char *pMapHash);
+    void SaveBlocksToCache(const char *pMapHash);
 
   private:
     struct bhop_block_t
@@ -29,8 +41,13 @@ class CMOMBhopBlockFixSystem : public CAutoGameSystem
         CBaseEntity *m_pTeleportTrigger; // trigger_teleport under it
         bool m_bIsDoor;
     };
-    CUtlMap<int, bhop_block_t> m_mapBlocks;
     void AlterBhopBlock(bhop_block_t);
+
+    // Indexed by entindex of the block, bit set means m_Blocks[entindex] is valid
+    CBitVec<MAX_EDICTS> m_bitBlocks;
+    bhop_block_t m_Blocks[MAX_EDICTS];
+    // Dense list of entindexes of the blocks, in discovery order
+    CUtlVector<int> m_vecBlockIndexes;
 };
 
-extern CMOMBhopBlockFixSystem *g_MOMBlockFixer;
\ No newline at end of file
+extern CMOMBhopBlockFixSystem *g_MOMBlockFixer;
@@ -27,6 +27,10 @@
 
 #define AVERAGE_STATS_INTERVAL 0.1
 
+static MAKE_CONVAR(mom_stats_flush_interval, "0.5", FCVAR_NONE,
+                   "How often (in seconds) the per-tick run stats are sent to clients while in a zone. "
+                   "They are always sent on zone transitions.\n", 0.0f, 5.0f);
+
 static MAKE_TOGGLE_CONVAR(mom_practice_safeguard, "1", FCVAR_ARCHIVE | FCVAR_REPLICATED,
                           "Toggles the safeguard for enabling practice mode (not pressing any movement keys to enable). 0 = OFF, 1 = ON.\n");
 
@@ -189,7 +193,7 @@ static CMomentumPlayer *s_pPlayer = nullptr;
 CMomentumPlayer::CMomentumPlayer()
     : m_flStamina(0.0f),
       m_flLastVelocity(0.0f), m_nPerfectSyncTicks(0), m_nStrafeTicks(0), m_nAccelTicks(0),
-      m_nPrevButtons(0), m_flTweenVelValue(1.0f), m_bInAirDueToJump(false), m_iProgressNumber(-1), 
+      m_nPrevButtons(0), m_flNextStatsFlush(0.0f), m_flTweenVelValue(1.0f), m_bInAirDueToJump(false), m_iProgressNumber(-1), 
       m_cvarMapFinMoveEnable("mom_mapfinished_movement_enable")
 {
     m_bAllowUserTeleports = true;
@@ -198,6 +202,7 @@ CMomentumPlayer::CMomentumPlayer()
     m_iOldTrack = 0;
     m_iOldZone = 0;
     m_fLerpTime = 0.0f;
+    m_StatsAccum.Reset();
 
     m_bWasSpectating = false;
 
@@ -893,6 +898,9 @@ void CMomentumPlayer::OnZoneEnter(CTriggerZone *pTrigger)
     if (m_iObserverMode != OBS_MODE_NONE)
         return;
 
+    // Send what was accumulated so far before the current zone changes
+    FlushRunStats();
+
     // Zone-specific things first
     const auto iZoneType = pTrigger->GetZoneType();
     switch (iZoneType)
@@ -969,16 +977,7 @@ void CMomentumPlayer::OnZoneEnter(CTriggerZone *pTrigger)
                 m_RunStats.SetZoneTicks(zoneNum, g_pMomentumTimer->GetCurrentTime() - m_RunStats.GetZoneEnterTick(zoneNum));
 
                 // Ending velocity checks
-                float finalVel = endvel;
-                float finalVel2D = endvel2D;
-
-                if (endvel <= m_RunStats.GetZoneVelocityMax(0, false))
-                    finalVel = m_RunStats.GetZoneVelocityMax(0, false);
-
-                if (endvel2D <= m_RunStats.GetZoneVelocityMax(0, true))
-                    finalVel2D = m_RunStats.GetZoneVelocityMax(0, true);
-
-                m_RunStats.SetZoneVelocityMax(0, finalVel, finalVel2D);
+                AccumulateMaxVelocity(0, endvel, endvel2D);
                 m_RunStats.SetZoneExitSpeed(0, endvel, endvel2D);
 
                 // Stop the timer
@@ -1036,6 +1035,9 @@ void CMomentumPlayer::OnZoneExit(CTriggerZone *pTrigger)
     if (m_iObserverMode != OBS_MODE_NONE)
         return;
 
+    // Send what was accumulated so far before the current zone changes
+    FlushRunStats();
+
     // Zone-specific things first
     switch (pTrigger->GetZoneType())
     {
@@ -1129,6 +1131,9 @@ void CMomentumPlayer::PlayerThink()
     // this might be used in a later update
     // m_flLastVelocity = velocity;
 
+    if (gpGlobals->curtime >= m_flNextStatsFlush)
+        FlushRunStats();
+
     // think once per tick
     SetNextThink(gpGlobals->curtime + gpGlobals->interval_per_tick, "THINK_EVERY_TICK");
 }
@@ -1180,14 +1185,11 @@ void CMomentumPlayer::UpdateStrafes()
     if (!g_pMomentumTimer->IsRunning())
         return;
 
-    const auto currentZone = m_Data.m_iCurrentZone;
-    if (m_nButtons & IN_MOVELEFT && !(m_nPrevButtons & IN_MOVELEFT))
-    {
-        m_RunStats.SetZoneStrafes(0, m_RunStats.GetZoneStrafes(0) + 1);
-        m_RunStats.SetZoneStrafes(currentZone, m_RunStats.GetZoneStrafes(currentZone) + 1);
-    }
-    else if (m_nButtons & IN_MOVERIGHT && !(m_nPrevButtons & IN_MOVERIGHT))
+    if ((m_nButtons & IN_MOVELEFT && !(m_nPrevButtons & IN_MOVELEFT)) ||
+        (m_nButtons & IN_MOVERIGHT && !(m_nPrevButtons & IN_MOVERIGHT)))
     {
+        // Written straight away like the jumps, the keypress HUD shows the total as it happens
+        const auto currentZone = m_Data.m_iCurrentZone;
         m_RunStats.SetZoneStrafes(0, m_RunStats.GetZoneStrafes(0) + 1);
         m_RunStats.SetZoneStrafes(currentZone, m_RunStats.GetZoneStrafes(currentZone) + 1);
     }
@@ -1200,29 +1202,51 @@ void CMomentumPlayer::UpdateMaxVelocity()
     if (!g_pMomentumTimer->IsRunning())
         return;
 
-    int currentZone = m_Data.m_iCurrentZone;
-    float velocity = GetLocalVelocity().Length();
-    float velocity2D = GetLocalVelocity().Length2D();
-    float maxOverallVel = velocity;
-    float maxOverallVel2D = velocity2D;
+    const auto vel = GetLocalVelocity();
+    const float velocity = vel.Length();
+    const float velocity2D = vel.Length2D();
 
-    float maxCurrentVel = velocity;
-    float maxCurrentVel2D = velocity2D;
+    AccumulateMaxVelocity(0, velocity, velocity2D);
+    AccumulateMaxVelocity(m_Data.m_iCurrentZone, velocity, velocity2D);
+}
 
-    if (maxOverallVel <= m_RunStats.GetZoneVelocityMax(0, false))
-        maxOverallVel = m_RunStats.GetZoneVelocityMax(0, false);
+void CMomentumPlayer::AccumulateMaxVelocity(int zone, float vel3D, float vel2D)
+{
+    float *pMax = m_StatsAccum.m_flZoneVelocityMax[zone];
+    if (vel3D > pMax[0])
+    {
+        pMax[0] = vel3D;
+        m_StatsAccum.m_bitDirtyZones.Set(zone);
+    }
+    if (vel2D > pMax[1])
+    {
+        pMax[1] = vel2D;
+        m_StatsAccum.m_bitDirtyZones.Set(zone);
+    }
+}
 
-    if (maxOverallVel2D <= m_RunStats.GetZoneVelocityMax(0, true))
-        maxOverallVel2D = m_RunStats.GetZoneVelocityMax(0, true);
+void CMomentumPlayer::FlushRunStats()
+{
+    m_flNextStatsFlush = gpGlobals->curtime + mom_stats_flush_interval.GetFloat();
 
-    if (maxCurrentVel <= m_RunStats.GetZoneVelocityMax(currentZone, false))
-        maxCurrentVel = m_RunStats.GetZoneVelocityMax(currentZone, false);
+    for (int zone = m_StatsAccum.m_bitDirtyZones.FindNextSetBit(0); zone != -1;
+         zone = m_StatsAccum.m_bitDirtyZones.FindNextSetBit(zone + 1))
+    {
+        m_RunStats.SetZoneVelocityMax(zone, m_StatsAccum.m_flZoneVelocityMax[zone][0],
+                                      m_StatsAccum.m_flZoneVelocityMax[zone][1]);
 
-    if (maxCurrentVel2D <= m_RunStats.GetZoneVelocityMax(currentZone, true))
-        maxCurrentVel2D = m_RunStats.GetZoneVelocityMax(currentZone, true);
+        const int iCount = m_StatsAccum.m_iZoneAvgCount[zone];
+        if (iCount > 0)
+        {
+            const float flCount = float(iCount);
+            m_RunStats.SetZoneStrafeSyncAvg(zone, m_StatsAccum.m_flZoneTotalSync[zone] / flCount);
+            m_RunStats.SetZoneStrafeSync2Avg(zone, m_StatsAccum.m_flZoneTotalSync2[zone] / flCount);
+            m_RunStats.SetZoneVelocityAvg(zone, m_StatsAccum.m_flZoneTotalVelocity[zone][0] / flCount,
+                                          m_StatsAccum.m_flZoneTotalVelocity[zone][1] / flCount);
+        }
+    }
 
-    m_RunStats.SetZoneVelocityMax(0, maxOverallVel, maxOverallVel2D);
-    m_RunStats.SetZoneVelocityMax(currentZone, maxCurrentVel, maxCurrentVel2D);
+    m_StatsAccum.m_bitDirtyZones.ClearAll();
 }
 
 void CMomentumPlayer::ResetRunStats()
@@ -1234,40 +1258,30 @@ void CMomentumPlayer::ResetRunStats()
     m_nAccelTicks = 0;
     m_Data.m_flStrafeSync = 0;
     m_Data.m_flStrafeSync2 = 0;
+    m_StatsAccum.Reset();
     m_RunStats.Init(g_MapZoneSystem.GetZoneCount(m_Data.m_iCurrentTrack));
 }
+
 void CMomentumPlayer::CalculateAverageStats()
 {
     if (g_pMomentumTimer->IsRunning())
     {
-        int currentZone = m_Data.m_iCurrentZone;
-
-        m_flZoneTotalSync[currentZone] += m_Data.m_flStrafeSync;
-        m_flZoneTotalSync2[currentZone] += m_Data.m_flStrafeSync2;
-        m_flZoneTotalVelocity[currentZone][0] += GetLocalVelocity().Length();
-        m_flZoneTotalVelocity[currentZone][1] += GetLocalVelocity().Length2D();
-
-        m_nZoneAvgCount[currentZone]++;
-
-        m_RunStats.SetZoneStrafeSyncAvg(currentZone,
-                                        m_flZoneTotalSync[currentZone] / float(m_nZoneAvgCount[currentZone]));
-        m_RunStats.SetZoneStrafeSync2Avg(currentZone,
-                                         m_flZoneTotalSync2[currentZone] / float(m_nZoneAvgCount[currentZone]));
-        m_RunStats.SetZoneVelocityAvg(currentZone,
-                                      m_flZoneTotalVelocity[currentZone][0] / float(m_nZoneAvgCount[currentZone]),
-                                      m_flZoneTotalVelocity[currentZone][1] / float(m_nZoneAvgCount[currentZone]));
+        const int currentZone = m_Data.m_iCurrentZone;
+        const float flSync = m_Data.m_flStrafeSync, flSync2 = m_Data.m_flStrafeSync2;
+        const auto vel = GetLocalVelocity();
+        const float flVel = vel.Length(), flVel2D = vel.Length2D();
 
         // stage 0 is "overall" - also update these as well, no matter which stage we are on
-        m_flZoneTotalSync[0] += m_Data.m_flStrafeSync;
-        m_flZoneTotalSync2[0] += m_Data.m_flStrafeSync2;
-        m_flZoneTotalVelocity[0][0] += GetLocalVelocity().Length();
-        m_flZoneTotalVelocity[0][1] += GetLocalVelocity().Length2D();
-        m_nZoneAvgCount[0]++;
-
-        m_RunStats.SetZoneStrafeSyncAvg(0, m_flZoneTotalSync[currentZone] / float(m_nZoneAvgCount[currentZone]));
-        m_RunStats.SetZoneStrafeSync2Avg(0, m_flZoneTotalSync2[currentZone] / float(m_nZoneAvgCount[currentZone]));
-        m_RunStats.SetZoneVelocityAvg(0, m_flZoneTotalVelocity[currentZone][0] / float(m_nZoneAvgCount[currentZone]),
-                                      m_flZoneTotalVelocity[currentZone][1] / float(m_nZoneAvgCount[currentZone]));
+        const int zones[] = {0, currentZone};
+        for (const int zone : zones)
+        {
+            m_StatsAccum.m_flZoneTotalSync[zone] += flSync;
+            m_StatsAccum.m_flZoneTotalSync2[zone] += flSync2;
+            m_StatsAccum.m_flZoneTotalVelocity[zone][0] += flVel;
+            m_StatsAccum.m_flZoneTotalVelocity[zone][1] += flVel2D;
+            m_StatsAccum.m_iZoneAvgCount[zone]++;
+            m_StatsAccum.m_bitDirtyZones.Set(zone);
+        }
     }
 
     // think once per 0.1 second interval so we avoid making the totals extremely large
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "bitvec.h"
 #include "mom_ghostdefs.h"
 #include "mom_shareddefs.h"
 #include "GameEventListener.h"
@@ -28,6 +29,22 @@ struct SavedState_t
     int m_nSavedAccelTicks;
 };
 
+// Run stats that change every tick. They are accumulated here and only written to the networked
+// m_RunStats when the player flushes them (zone transitions, timer stop, and at a capped rate).
+struct RunStatsAccumulator_t
+{
+    void Reset() { V_memset(this, 0, sizeof(*this)); }
+
+    float m_flZoneVelocityMax[MAX_ZONES + 1][2];
+
+    // Sampled every AVERAGE_STATS_INTERVAL, averaged on flush
+    int m_iZoneAvgCount[MAX_ZONES + 1];
+    float m_flZoneTotalSync[MAX_ZONES + 1], m_flZoneTotalSync2[MAX_ZONES + 1], m_flZoneTotalVelocity[MAX_ZONES + 1][2];
+
+    // Zones that changed since the last flush
+    CBitVec<MAX_ZONES + 1> m_bitDirtyZones;
+};
+
 // The player can spend this many ticks in the air inside the start zone before their speed is limited
 #define MAX_AIRTIME_TICKS 15
 #define NUM_TICKS_TO_BHOP 10 // The number of ticks a player can be on a ground before considered "not bunnyhopping"
@@ -180,10 +197,9 @@ class CMomentumPlayer : public CBasePlayer, public CGameEventListener, public CM
     Vector GetPreviousOrigin(unsigned int previous_count = 0) const;
     void NewPreviousOrigin(Vector origin);
 
-    // for calc avg
-    int m_nZoneAvgCount[MAX_ZONES];
-    float m_flZoneTotalSync[MAX_ZONES], m_flZoneTotalSync2[MAX_ZONES], m_flZoneTotalVelocity[MAX_ZONES][2];
-    
+    // Writes the accumulated per-tick stats to m_RunStats
+    void FlushRunStats();
+
     //Overrode for the spectating GUI and weapon dropping
     bool ClientCommand(const CCommand &args) OVERRIDE;
     void MomentumWeaponDrop(CBaseCombatWeapon *pWeapon);
@@ -260,6 +276,7 @@ class CMomentumPlayer : public CBasePlayer, public CGameEventListener, public CM
     void UpdateRunSync();
     void UpdateStrafes();
     void UpdateMaxVelocity();
+    void AccumulateMaxVelocity(int zone, float vel3D, float vel2D);
     // slows down the player in a tween-y fashion
     void TweenSlowdownPlayer();
     void CalculateAverageStats();
@@ -319,6 +336,9 @@ class CMomentumPlayer : public CBasePlayer, public CGameEventListener, public CM
 
     int m_nPrevButtons;
 
+    RunStatsAccumulator_t m_StatsAccum;
+    float m_flNextStatsFlush;
+
     // Used by momentum triggers
     Vector m_vecPreviousOrigins[MAX_PREVIOUS_ORIGINS];
 
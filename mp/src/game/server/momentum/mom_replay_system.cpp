@@ -10,6 +10,7 @@
 #include "fmtstr.h"
 #include "steam/steam_api.h"
 #include "run/mom_replay_factory.h"
+#include "util/mom_file_hash.h"
 #include "util/mom_util.h"
 #include "filesystem.h"
 
@@ -48,10 +49,30 @@ void CMomentumReplaySystem::FrameUpdatePostEntityThink()
         UpdateRecordingParams();
 }
 
+void CMomentumReplaySystem::LevelInitPreEntity()
+{
+    // Hash the map while its entities spawn, GetMapHash waits on it
+    g_pFileHashCache->HashFileAsync(CFmtStr("maps/%s.bsp", gpGlobals->mapname.ToCStr()), "GAME");
+}
+
 void CMomentumReplaySystem::LevelInitPostEntity()
 {
-    if (!MomUtil::GetFileHash(m_szMapHash, sizeof(m_szMapHash), CFmtStr("maps/%s.bsp", gpGlobals->mapname.ToCStr())))
-        Warning("Could not generate a hash for the current map!!!\n");
+    GetMapHash();
+}
+
+const char *CMomentumReplaySystem::GetMapHash()
+{
+    // Other systems may ask for the hash before our LevelInitPostEntity is called
+    if (!m_szMapHash[0] && gpGlobals->mapname != NULL_STRING)
+    {
+        if (!MomUtil::GetFileHash(m_szMapHash, sizeof(m_szMapHash), CFmtStr("maps/%s.bsp", gpGlobals->mapname.ToCStr())))
+        {
+            m_szMapHash[0] = '\0';
+            Warning("Could not generate a hash for the current map!!!\n");
+        }
+    }
+
+    return m_szMapHash;
 }
 
 void CMomentumReplaySystem::LevelShutdownPostEntity()
@@ -15,6 +15,7 @@ public:
     // inherited member from CAutoGameSystemPerFrame
     void FrameUpdatePostEntityThink() OVERRIDE;
 
+    void LevelInitPreEntity() OVERRIDE;
     void LevelInitPostEntity() OVERRIDE;
     void LevelShutdownPostEntity() OVERRIDE;
 
@@ -43,6 +44,9 @@ public:
     const CMomReplayBase *GetPlaybackReplay() const { return m_pPlaybackReplay; }
     CMomReplayBase *GetPlaybackReplay() { return m_pPlaybackReplay; }
 
+    // SHA1 of the current map's BSP, computed on first use. Empty if it could not be generated.
+    const char *GetMapHash();
+
     //CMomRunStats *SavedRunStats() { return &m_SavedRunStats; }
 
   private:
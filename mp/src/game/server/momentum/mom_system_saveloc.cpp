@@ -12,9 +12,9 @@
 
 #include "tier0/memdbgon.h"
 
-#define SAVELOC_FILE_NAME "savedlocs.txt"
-
 MAKE_TOGGLE_CONVAR(mom_saveloc_save_between_sessions, "1", FCVAR_ARCHIVE, "Defines if savelocs should be saved between sessions of the same map.\n");
+MAKE_TOGGLE_CONVAR(mom_saveloc_rewind_enable, "0", FCVAR_ARCHIVE, "Toggles automatically taking snapshots of the player's state for mom_saveloc_rewind.\n");
+MAKE_CONVAR(mom_saveloc_rewind_interval, "33", FCVAR_ARCHIVE, "Number of ticks between automatic rewind snapshots.\n", 1, 1000);
 
 SavedLocation_t::SavedLocation_t(): crouched(false), pos(vec3_origin), vel(vec3_origin), ang(vec3_angle),
                                     gravityScale(1.0f), movementLagScale(1.0f), disabledButtons(0)
@@ -108,9 +108,132 @@ bool SavedLocation_t::Write(CUtlBuffer &mem)
     return write->WriteAsBinary(mem);
 }
 
-CMOMSaveLocSystem::CMOMSaveLocSystem(const char* pName): CAutoGameSystem(pName)
+void SavedLocation_t::SaveBinary(CUtlBuffer &buf) const
+{
+    buf.PutString(targetName);
+    buf.PutString(targetClassName);
+    buf.Put(&pos, sizeof(Vector));
+    buf.Put(&vel, sizeof(Vector));
+    buf.Put(&ang, sizeof(QAngle));
+    buf.PutUnsignedChar(crouched);
+    buf.PutFloat(gravityScale);
+    buf.PutFloat(movementLagScale);
+    buf.PutInt(disabledButtons);
+
+    // Hardly any savelocs have pending events, so only those pay for the KeyValues
+    buf.PutUnsignedChar(!entEventsState.m_vecEvents.IsEmpty());
+    if (!entEventsState.m_vecEvents.IsEmpty())
+    {
+        KeyValuesAD events("Events");
+        entEventsState.SaveToKeyValues(events);
+        events->WriteAsBinary(buf);
+    }
+}
+
+bool SavedLocation_t::LoadBinary(CUtlBuffer &buf)
+{
+    buf.GetStringManualCharCount(targetName, sizeof(targetName));
+    buf.GetStringManualCharCount(targetClassName, sizeof(targetClassName));
+    buf.Get(&pos, sizeof(Vector));
+    buf.Get(&vel, sizeof(Vector));
+    buf.Get(&ang, sizeof(QAngle));
+    crouched = buf.GetUnsignedChar() != 0;
+    gravityScale = buf.GetFloat();
+    movementLagScale = buf.GetFloat();
+    disabledButtons = buf.GetInt();
+
+    entEventsState.m_vecEvents.RemoveAll();
+    if (buf.GetUnsignedChar())
+    {
+        KeyValuesAD events("Events");
+        if (!events->ReadAsBinary(buf))
+            return false;
+
+        entEventsState.LoadFromKeyValues(events);
+    }
+
+    return buf.IsValid();
+}
+
+void RewindSnapshot_t::Capture(CMomentumPlayer *pPlayer)
 {
-    m_pSavedLocsKV = new KeyValues(pName);
+    pos = pPlayer->GetAbsOrigin();
+    vel = pPlayer->GetAbsVelocity();
+    ang = pPlayer->GetAbsAngles();
+    targetName = pPlayer->GetEntityName();
+    targetClassName = pPlayer->m_iClassname;
+    gravityScale = pPlayer->GetGravity();
+    movementLagScale = pPlayer->GetLaggedMovementValue();
+    disabledButtons = pPlayer->m_afButtonDisabled.Get();
+    crouched = pPlayer->m_Local.m_bDucked || pPlayer->m_Local.m_bDucking;
+}
+
+void RewindSnapshot_t::Teleport(CMomentumPlayer *pPlayer) const
+{
+    // Same as SavedLocation_t::Teleport, minus the entity events
+    pPlayer->SetName(targetName);
+    pPlayer->SetClassname(STRING(targetClassName));
+
+    if (crouched && !pPlayer->m_Local.m_bDucked)
+        pPlayer->ToggleDuckThisFrame(true);
+    else if (!crouched && pPlayer->m_Local.m_bDucked)
+        pPlayer->ToggleDuckThisFrame(false);
+
+    pPlayer->Teleport(&pos, &ang, &vel);
+
+    pPlayer->SetGravity(gravityScale);
+    pPlayer->DisableButtons(disabledButtons);
+    pPlayer->SetLaggedMovementValue(movementLagScale);
+}
+
+void CSavelocRewindBuffer::Clear()
+{
+    m_iNewest = -1;
+    m_iCount = 0;
+    m_iLastCaptureTick = 0;
+    m_bAtNewest = false;
+}
+
+void CSavelocRewindBuffer::Update(CMomentumPlayer *pPlayer, int iIntervalTicks)
+{
+    if (m_iCount > 0 && gpGlobals->tickcount - m_iLastCaptureTick < iIntervalTicks)
+        return;
+
+    m_iLastCaptureTick = gpGlobals->tickcount;
+    m_iNewest = (m_iNewest + 1) % SAVELOC_REWIND_SNAPSHOTS;
+    m_iCount = Min(m_iCount + 1, SAVELOC_REWIND_SNAPSHOTS);
+    m_bAtNewest = false;
+
+    m_Snapshots[m_iNewest].Capture(pPlayer);
+}
+
+bool CSavelocRewindBuffer::Rewind(CMomentumPlayer *pPlayer, int iSteps)
+{
+    // Rewinding again before a new snapshot was taken means going further back than the one we're at
+    if (m_bAtNewest)
+        iSteps++;
+
+    // The newest snapshot is one step back
+    const int iDrop = Min(iSteps - 1, m_iCount - 1);
+    if (m_iCount == 0 || iDrop < 0)
+        return false;
+
+    m_iNewest = (m_iNewest - iDrop + SAVELOC_REWIND_SNAPSHOTS) % SAVELOC_REWIND_SNAPSHOTS;
+    m_iCount -= iDrop;
+    m_bAtNewest = true;
+
+    // Wait a full interval before snapshotting where we rewound to
+    m_iLastCaptureTick = gpGlobals->tickcount;
+
+    m_Snapshots[m_iNewest].Teleport(pPlayer);
+    return true;
+}
+
+CMOMSaveLocSystem::CMOMSaveLocSystem(const char* pName): CAutoGameSystemPerFrame(pName)
+{
+    m_szMapName[0] = '\0';
+    m_bLoaded = true;
+    m_bDirty = false;
     m_iRequesting = 0;
     m_iCurrentSavelocIndx = -1;
     m_bUsingSavelocMenu = false;
@@ -118,102 +241,267 @@ CMOMSaveLocSystem::CMOMSaveLocSystem(const char* pName): CAutoGameSystem(pName)
 
 CMOMSaveLocSystem::~CMOMSaveLocSystem()
 {
-    if (m_pSavedLocsKV)
-        m_pSavedLocsKV->deleteThis();
-    m_pSavedLocsKV = nullptr;
+    m_rcSavelocs.PurgeAndDeleteElements();
 }
 
 void CMOMSaveLocSystem::PostInit()
 {
     g_pModuleComms->ListenForEvent("req_savelocs", UtlMakeDelegate(this, &CMOMSaveLocSystem::OnSavelocRequestEvent));
+
+    MigrateLegacySavelocs();
 }
 
 void CMOMSaveLocSystem::LevelInitPreEntity()
 {
-    // We don't check mom_savelocs_save_between_sessions because we want to be able to load savelocs from friends
-    DevLog("Loading savelocs from %s ...\n", SAVELOC_FILE_NAME);
+    // We don't check mom_savelocs_save_between_sessions because we want to be able to load savelocs from friends.
+    // Nothing is read until the savelocs are actually used, a lot of map loads never touch them.
+    Q_strncpy(m_szMapName, gpGlobals->mapname.ToCStr(), sizeof(m_szMapName));
+    m_bLoaded = false;
+    m_bDirty = false;
 
-    if (m_pSavedLocsKV)
-    {
-        //Remove the past loaded stuff
-        m_pSavedLocsKV->Clear();
-
-        // Note: This loading is going to contain all of the other maps' savelocs as well!
-        // Note: We are not in PostInit because if players edit their savelocs file (add
-        // savelocs from a friend or something), then we want to reload on map load again,
-        // and not force the player to restart the mod every time.
-        if (m_pSavedLocsKV->LoadFromFile(filesystem, SAVELOC_FILE_NAME, "MOD"))
-        {
-            DevLog("Loaded savelocs from %s!\n", SAVELOC_FILE_NAME);
+    // The timer HUD shows the count right away, which only takes the file's header
+    int iCurrent = -1, iCount = 0;
+    ReadMapFileHeader(m_szMapName, iCurrent, iCount);
+    FireUpdateEvent(iCount, Clamp(iCurrent, -1, iCount - 1));
+}
 
-            if (!m_pSavedLocsKV->IsEmpty())
-            {
-                KeyValues *kvMapSavelocs = m_pSavedLocsKV->FindKey(gpGlobals->mapname.ToCStr());
-                if (kvMapSavelocs && !kvMapSavelocs->IsEmpty())
-                {
-                    m_iCurrentSavelocIndx = kvMapSavelocs->GetInt("cur");
-
-                    KeyValues *kvCPs = kvMapSavelocs->FindKey("cps");
-                    if (!kvCPs) return;
-                    FOR_EACH_SUBKEY(kvCPs, kvCheckpoint)
-                    {
-                        SavedLocation_t *c = new SavedLocation_t();
-                        c->Load(kvCheckpoint);
-                        m_rcSavelocs.AddToTail(c);
-                    }
-
-                    // Fire the initial event
-                    FireUpdateEvent();
-                }
-            }
-        }
+void CMOMSaveLocSystem::LevelShutdownPreEntity()
+{
+    if (CMomentumPlayer::GetLocalPlayer() && mom_saveloc_save_between_sessions.GetBool())
+        SaveMapSavelocs();
+
+    // Remove all requesters if we had any
+    m_vecRequesters.RemoveAll();
+    m_bUsingSavelocMenu = false;
+    m_RewindBuffer.Clear();
+
+    m_rcSavelocs.PurgeAndDeleteElements();
+    m_iCurrentSavelocIndx = -1;
+    FireUpdateEvent();
+
+    // Between maps there is nothing to load
+    m_szMapName[0] = '\0';
+    m_bLoaded = true;
+    m_bDirty = false;
+}
+
+void CMOMSaveLocSystem::FrameUpdatePostEntityThink()
+{
+    if (!mom_saveloc_rewind_enable.GetBool())
+        return;
+
+    const auto pPlayer = CMomentumPlayer::GetLocalPlayer();
+    if (!pPlayer || !pPlayer->IsAlive() || pPlayer->IsObserver())
+        return;
+
+    m_RewindBuffer.Update(pPlayer, mom_saveloc_rewind_interval.GetInt());
+}
+
+void CMOMSaveLocSystem::RewindSnapshots(int iSteps)
+{
+    const auto pPlayer = CMomentumPlayer::GetLocalPlayer();
+    if (!pPlayer || !pPlayer->AllowUserTeleports() || iSteps < 1)
+        return;
+
+    if (!mom_saveloc_rewind_enable.GetBool())
+    {
+        Warning("Rewinding needs mom_saveloc_rewind_enable 1 to take snapshots first!\n");
+        return;
     }
+
+    // Check if the timer is running and if we should stop it
+    CheckTimer();
+
+    if (!m_RewindBuffer.Rewind(pPlayer, iSteps))
+        Warning("There are no snapshots to rewind to yet!\n");
+
+    FireUpdateEvent();
 }
 
-void CMOMSaveLocSystem::LevelShutdownPreEntity()
+void CMOMSaveLocSystem::GetMapFilePath(const char *pMapName, char *pOut, int outLen)
+{
+    Q_snprintf(pOut, outLen, "%s/%s%s", SAVELOC_PATH, pMapName, SAVELOC_FILE_EXT);
+}
+
+bool CMOMSaveLocSystem::ReadMapFileHeader(const char *pMapName, int &iCurrent, int &iCount)
+{
+    char szPath[MAX_PATH];
+    GetMapFilePath(pMapName, szPath, sizeof(szPath));
+
+    const FileHandle_t hFile = filesystem->Open(szPath, "rb", "MOD");
+    if (!hFile)
+        return false;
+
+    const int iHeaderSize = sizeof(uint32) + sizeof(uint8) + 2 * sizeof(int);
+    CUtlBuffer buf;
+    buf.EnsureCapacity(iHeaderSize);
+    const int iRead = filesystem->Read(buf.Base(), iHeaderSize, hFile);
+    filesystem->Close(hFile);
+    if (iRead != iHeaderSize)
+        return false;
+
+    buf.SeekPut(CUtlBuffer::SEEK_HEAD, iRead);
+    if (buf.GetUnsignedInt() != SAVELOC_FILE_MAGIC || buf.GetUnsignedChar() != SAVELOC_FILE_VERSION)
+        return false;
+
+    const int iFileCurrent = buf.GetInt();
+    const int iFileCount = buf.GetInt();
+    if (!buf.IsValid() || iFileCount < 0)
+        return false;
+
+    iCurrent = iFileCurrent;
+    iCount = iFileCount;
+    return true;
+}
+
+void CMOMSaveLocSystem::LoadMapSavelocs()
 {
-    if (CMomentumPlayer::GetLocalPlayer() && m_pSavedLocsKV && mom_saveloc_save_between_sessions.GetBool())
+    m_bLoaded = true;
+
+    if (!m_szMapName[0])
+        return;
+
+    char szPath[MAX_PATH];
+    GetMapFilePath(m_szMapName, szPath, sizeof(szPath));
+
+    CUtlBuffer buf;
+    if (!filesystem->ReadFile(szPath, "MOD", buf))
+        return;
+
+    if (buf.GetUnsignedInt() != SAVELOC_FILE_MAGIC || buf.GetUnsignedChar() != SAVELOC_FILE_VERSION)
+    {
+        Warning("Saveloc file %s is not a saveloc file or is of an unsupported version!\n", szPath);
+        return;
+    }
+
+    const int iCurrent = buf.GetInt();
+    const int iCount = buf.GetInt();
+
+    // Every saveloc takes more than a byte, so anything past that is a corrupt count, not worth allocating for
+    if (!buf.IsValid() || iCount < 0 || iCount > buf.GetBytesRemaining())
     {
-        DevLog("Saving map %s savelocs to %s ...\n", gpGlobals->mapname.ToCStr(), SAVELOC_FILE_NAME);
-        // Make the KV to save into and save into it
-        KeyValues *pKvMapSavelocs = new KeyValues(gpGlobals->mapname.ToCStr());
-        // Set the current index
-        pKvMapSavelocs->SetInt("cur", m_iCurrentSavelocIndx);
-
-        // Add all your savelocs
-        KeyValues *kvCPs = new KeyValues("cps");
-        FOR_EACH_VEC(m_rcSavelocs, i)
+        Warning("Saveloc file %s is corrupt, its saveloc count is %i!\n", szPath, iCount);
+        return;
+    }
+
+    m_rcSavelocs.EnsureCapacity(m_rcSavelocs.Count() + iCount);
+    for (int i = 0; i < iCount && buf.IsValid(); i++)
+    {
+        SavedLocation_t *pSaveloc = new SavedLocation_t;
+        if (!pSaveloc->LoadBinary(buf))
         {
-            char szCheckpointNum[10]; // 999 million savelocs is pretty generous
-            Q_snprintf(szCheckpointNum, sizeof(szCheckpointNum), "%09i", i); // %09 because '\0' is the last (10)
-            KeyValues *kvCP = new KeyValues(szCheckpointNum);
-            m_rcSavelocs[i]->Save(kvCP);
-            kvCPs->AddSubKey(kvCP);
+            Warning("Saveloc file %s is corrupt, only loaded %i of its %i savelocs!\n", szPath, i, iCount);
+            delete pSaveloc;
+            break;
         }
 
-        // Save them into the keyvalues
-        pKvMapSavelocs->AddSubKey(kvCPs);
-       
-        // Remove the map if it already exists in there
-        KeyValues *pExisting = m_pSavedLocsKV->FindKey(gpGlobals->mapname.ToCStr());
-        if (pExisting)
+        m_rcSavelocs.AddToTail(pSaveloc);
+    }
+
+    // Savelocs received from someone before this may already be in the list
+    if (m_iCurrentSavelocIndx < 0)
+        m_iCurrentSavelocIndx = Clamp(iCurrent, -1, m_rcSavelocs.Count() - 1);
+
+    DevLog("Loaded %i savelocs from %s!\n", m_rcSavelocs.Count(), szPath);
+
+    // Fire the initial event
+    FireUpdateEvent();
+}
+
+void CMOMSaveLocSystem::SaveMapSavelocs()
+{
+    if (!m_bLoaded || !m_bDirty || !m_szMapName[0])
+        return;
+
+    if (WriteMapFile(m_szMapName, m_rcSavelocs, m_iCurrentSavelocIndx))
+    {
+        DevLog("Saved map %s savelocs!\n", m_szMapName);
+        m_bDirty = false;
+    }
+}
+
+bool CMOMSaveLocSystem::WriteMapFile(const char *pMapName, const CUtlVector<SavedLocation_t *> &vecSavelocs, int iCurrent)
+{
+    char szPath[MAX_PATH];
+    GetMapFilePath(pMapName, szPath, sizeof(szPath));
+
+    if (vecSavelocs.IsEmpty())
+    {
+        if (filesystem->FileExists(szPath, "MOD"))
+            filesystem->RemoveFile(szPath, "MOD");
+        return true;
+    }
+
+    CUtlBuffer buf;
+    buf.PutUnsignedInt(SAVELOC_FILE_MAGIC);
+    buf.PutUnsignedChar(SAVELOC_FILE_VERSION);
+    buf.PutInt(iCurrent);
+    buf.PutInt(vecSavelocs.Count());
+    FOR_EACH_VEC(vecSavelocs, i)
+        vecSavelocs[i]->SaveBinary(buf);
+
+    filesystem->CreateDirHierarchy(SAVELOC_PATH, "MOD");
+    if (!filesystem->WriteFile(szPath, "MOD", buf))
+    {
+        Warning("Failed to write the saveloc file %s!\n", szPath);
+        return false;
+    }
+
+    return true;
+}
+
+void CMOMSaveLocSystem::MigrateLegacySavelocs()
+{
+    if (!filesystem->FileExists(SAVELOC_LEGACY_FILE_NAME, "MOD"))
+        return;
+
+    KeyValuesAD pKvLegacy("MOMSavelocSystem");
+    if (!pKvLegacy->LoadFromFile(filesystem, SAVELOC_LEGACY_FILE_NAME, "MOD"))
+    {
+        Warning("Failed to read %s, its savelocs were not migrated!\n", SAVELOC_LEGACY_FILE_NAME);
+        return;
+    }
+
+    int iMaps = 0;
+    bool bFailed = false;
+    CUtlVector<SavedLocation_t *> vecSavelocs;
+    FOR_EACH_SUBKEY(pKvLegacy, pKvMap)
+    {
+        char szPath[MAX_PATH];
+        GetMapFilePath(pKvMap->GetName(), szPath, sizeof(szPath));
+
+        // Anything already in the new format is newer than the legacy file
+        if (filesystem->FileExists(szPath, "MOD"))
+            continue;
+
+        KeyValues *pKvCPs = pKvMap->FindKey("cps");
+        if (!pKvCPs)
+            continue;
+
+        FOR_EACH_SUBKEY(pKvCPs, pKvCheckpoint)
         {
-            m_pSavedLocsKV->RemoveSubKey(pExisting);
-            pExisting->deleteThis();
+            SavedLocation_t *pSaveloc = new SavedLocation_t;
+            pSaveloc->Load(pKvCheckpoint);
+            vecSavelocs.AddToTail(pSaveloc);
         }
 
-        // Add the new one
-        m_pSavedLocsKV->AddSubKey(pKvMapSavelocs);
+        if (WriteMapFile(pKvMap->GetName(), vecSavelocs, pKvMap->GetInt("cur", -1)))
+            iMaps++;
+        else
+            bFailed = true;
 
-        // Save everything to file
-        if (m_pSavedLocsKV->SaveToFile(filesystem, SAVELOC_FILE_NAME, "MOD", true))
-            DevLog("Saved map %s savelocs to %s!\n", gpGlobals->mapname.ToCStr(), SAVELOC_FILE_NAME);
+        vecSavelocs.PurgeAndDeleteElements();
     }
 
-    // Remove all requesters if we had any
-    m_vecRequesters.RemoveAll();
-    m_bUsingSavelocMenu = false;
-    RemoveAllSavelocs();
+    if (bFailed)
+    {
+        Warning("Could not migrate every map's savelocs from %s, trying again next time!\n", SAVELOC_LEGACY_FILE_NAME);
+        return;
+    }
+
+    // Keep the old file around under another name instead of deleting anyone's savelocs
+    filesystem->RenameFile(SAVELOC_LEGACY_FILE_NAME, SAVELOC_LEGACY_MIGRATED_FILE_NAME, "MOD");
+    DevLog("Migrated the savelocs of %i maps from %s to %s/!\n", iMaps, SAVELOC_LEGACY_FILE_NAME, SAVELOC_PATH);
 }
 
 void CMOMSaveLocSystem::OnSavelocRequestEvent(KeyValues* pKv)
@@ -325,6 +613,9 @@ bool CMOMSaveLocSystem::ReadReceivedSavelocs(SavelocReqPacket *input, const uint
 
     if (input->saveloc_count > 0)
     {
+        EnsureLoaded();
+        m_bDirty = true;
+
         for (int i = 0; i < input->saveloc_count && input->dataBuf.IsValid(); i++)
         {
             auto newSavedLoc = new SavedLocation_t;
@@ -370,6 +661,9 @@ void CMOMSaveLocSystem::AddSaveloc(SavedLocation_t* saveloc)
     if (!saveloc)
         return;
 
+    EnsureLoaded();
+    m_bDirty = true;
+
     auto priorCount = m_rcSavelocs.Count();
     m_rcSavelocs.AddToTail(saveloc);
     if (m_iCurrentSavelocIndx == priorCount - 1)
@@ -382,9 +676,12 @@ void CMOMSaveLocSystem::AddSaveloc(SavedLocation_t* saveloc)
 
 void CMOMSaveLocSystem::RemoveCurrentSaveloc()
 {
+    EnsureLoaded();
     if (m_rcSavelocs.IsEmpty())
         return;
 
+    m_bDirty = true;
+
     auto prevCount = m_rcSavelocs.Count();
     m_rcSavelocs.PurgeAndDeleteElement(m_iCurrentSavelocIndx);
     // If there's one element left, we still need to decrease currentStep to -1
@@ -398,6 +695,9 @@ void CMOMSaveLocSystem::RemoveCurrentSaveloc()
 
 void CMOMSaveLocSystem::RemoveAllSavelocs()
 {
+    EnsureLoaded();
+    m_bDirty |= !m_rcSavelocs.IsEmpty();
+
     m_rcSavelocs.PurgeAndDeleteElements();
     m_iCurrentSavelocIndx = -1;
 
@@ -417,7 +717,7 @@ void CMOMSaveLocSystem::GotoNextSaveloc()
 
 void CMOMSaveLocSystem::GotoFirstSaveloc()
 {
-    if (!m_rcSavelocs.IsEmpty())
+    if (GetSavelocCount() > 0)
     {
         SetCurrentSavelocMenuIndex(0);
         TeleportToCurrentSaveloc();
@@ -446,6 +746,7 @@ void CMOMSaveLocSystem::GotoPrevSaveloc()
 
 void CMOMSaveLocSystem::TeleportToSavelocIndex(int indx)
 {
+    EnsureLoaded();
     const auto pPlayer = CMomentumPlayer::GetLocalPlayer();
     if (indx < 0 || indx > m_rcSavelocs.Count() || !pPlayer || !pPlayer->AllowUserTeleports())
         return;
@@ -456,12 +757,16 @@ void CMOMSaveLocSystem::TeleportToSavelocIndex(int indx)
 
 void CMOMSaveLocSystem::TeleportToCurrentSaveloc()
 {
+    EnsureLoaded();
     TeleportToSavelocIndex(m_iCurrentSavelocIndx);
     FireUpdateEvent();
 }
 
 void CMOMSaveLocSystem::SetUsingSavelocMenu(bool bIsUsingSLMenu)
 {
+    if (bIsUsingSLMenu)
+        EnsureLoaded();
+
     m_bUsingSavelocMenu = bIsUsingSLMenu;
     FireUpdateEvent();
 }
@@ -482,12 +787,17 @@ void CMOMSaveLocSystem::CheckTimer()
 }
 
 void CMOMSaveLocSystem::FireUpdateEvent() const
+{
+    FireUpdateEvent(m_rcSavelocs.Count(), m_iCurrentSavelocIndx);
+}
+
+void CMOMSaveLocSystem::FireUpdateEvent(int iCount, int iCurrent) const
 {
     const auto pEvent = gameeventmanager->CreateEvent("saveloc_upd8");
     if (pEvent)
     {
-        pEvent->SetInt("count", m_rcSavelocs.Count());
-        pEvent->SetInt("current", m_iCurrentSavelocIndx);
+        pEvent->SetInt("count", iCount);
+        pEvent->SetInt("current", iCurrent);
         pEvent->SetBool("using", m_bUsingSavelocMenu);
         gameeventmanager->FireEvent(pEvent);
     }
@@ -542,6 +852,12 @@ CON_COMMAND_F(mom_saveloc_remove_all, "Removes all of the created savelocs for t
 {
     g_pMOMSavelocSystem->RemoveAllSavelocs();
 }
+CON_COMMAND_F(mom_saveloc_rewind, "Teleports the player back through the automatic snapshots taken with "
+              "mom_saveloc_rewind_enable. Optional parameter is the number of snapshots to go back (default 1).\n",
+              FCVAR_CLIENTCMD_CAN_EXECUTE)
+{
+    g_pMOMSavelocSystem->RewindSnapshots(args.ArgC() > 1 ? Q_atoi(args[1]) : 1);
+}
 CON_COMMAND_F(mom_saveloc_close, "Closes the saveloc menu.\n", FCVAR_CLIENTCMD_CAN_EXECUTE)
 {
     g_pMOMSavelocSystem->SetUsingSavelocMenu(false);
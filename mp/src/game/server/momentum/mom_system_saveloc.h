@@ -5,6 +5,19 @@
 class CMomentumPlayer;
 class SavelocReqPacket;
 
+// One binary file of savelocs per map, only read when the map's savelocs are first needed
+#define SAVELOC_PATH "savelocs"
+#define SAVELOC_FILE_EXT ".sav"
+#define SAVELOC_FILE_MAGIC 0x434F4C53 // "SLOC"
+#define SAVELOC_FILE_VERSION 1
+
+// The KeyValues file that used to hold the savelocs of every map, migrated to the per-map files once
+#define SAVELOC_LEGACY_FILE_NAME "savedlocs.txt"
+#define SAVELOC_LEGACY_MIGRATED_FILE_NAME "savedlocs_migrated.txt"
+
+// Number of automatic rewind snapshots kept, the oldest get overwritten
+#define SAVELOC_REWIND_SNAPSHOTS 256
+
 // Saved Location used in the "Saveloc menu"
 struct SavedLocation_t
 {
@@ -34,9 +47,52 @@ struct SavedLocation_t
 
     bool Read(CUtlBuffer &mem);
     bool Write(CUtlBuffer &mem);
+
+    // Called when saving to / loading from the map's saveloc file
+    void SaveBinary(CUtlBuffer &buf) const;
+    bool LoadBinary(CUtlBuffer &buf);
+};
+
+// A plain copy of the player's movement state, what a saveloc holds minus the entity event queue
+struct RewindSnapshot_t
+{
+    Vector pos;
+    Vector vel;
+    QAngle ang;
+    string_t targetName;
+    string_t targetClassName;
+    float gravityScale;
+    float movementLagScale;
+    int disabledButtons;
+    bool crouched;
+
+    void Capture(CMomentumPlayer *pPlayer);
+    void Teleport(CMomentumPlayer *pPlayer) const;
+};
+
+// Fixed-size ring of snapshots taken automatically every few ticks, for rewinding without making savelocs
+class CSavelocRewindBuffer
+{
+public:
+    CSavelocRewindBuffer() { Clear(); }
+
+    void Clear();
+    int Count() const { return m_iCount; }
+
+    // Takes a snapshot if it's been long enough since the last one
+    void Update(CMomentumPlayer *pPlayer, int iIntervalTicks);
+    // Teleports the player iSteps snapshots back, the snapshots past it are dropped. Returns false if there are none.
+    bool Rewind(CMomentumPlayer *pPlayer, int iSteps);
+
+private:
+    RewindSnapshot_t m_Snapshots[SAVELOC_REWIND_SNAPSHOTS];
+    int m_iNewest; // Index of the newest snapshot
+    int m_iCount;
+    int m_iLastCaptureTick;
+    bool m_bAtNewest; // The player was rewound to the newest snapshot and hasn't had a new one taken since
 };
 
-class CMOMSaveLocSystem : public CAutoGameSystem
+class CMOMSaveLocSystem : public CAutoGameSystemPerFrame
 {
 public:
     CMOMSaveLocSystem(const char* pName);
@@ -44,6 +100,11 @@ public:
     void PostInit() OVERRIDE;
     void LevelInitPreEntity() OVERRIDE;
     void LevelShutdownPreEntity() OVERRIDE;
+    void FrameUpdatePostEntityThink() OVERRIDE;
+
+    // Rewind
+    // Teleports the player back through the automatic snapshots
+    void RewindSnapshots(int iSteps);
 
     // Online
     // Called when the UI wants to request savelocs
@@ -61,7 +122,7 @@ public:
 
     // Local
     // Gets the current menu Saveloc index
-    uint32 GetCurrentSavelocMenuIndex() const { return m_iCurrentSavelocIndx; }
+    uint32 GetCurrentSavelocMenuIndex() { EnsureLoaded(); return m_iCurrentSavelocIndx; }
     // Is the player currently using the saveloc menu?
     bool IsUsingSaveLocMenu() const { return m_bUsingSavelocMenu; }
     // Creates a saveloc on the location of the player
@@ -87,11 +148,11 @@ public:
     // Teleports the player to their current Saved Location
     void TeleportToCurrentSaveloc();
     // Sets the current saveloc (menu) to the desired one with that index
-    void SetCurrentSavelocMenuIndex(int iNewNum) { m_iCurrentSavelocIndx = iNewNum; }
+    void SetCurrentSavelocMenuIndex(int iNewNum) { EnsureLoaded(); m_iCurrentSavelocIndx = iNewNum; m_bDirty = true; }
     // Gets the total amount of menu savelocs
-    int GetSavelocCount() const { return m_rcSavelocs.Size(); }
+    int GetSavelocCount() { EnsureLoaded(); return m_rcSavelocs.Size(); }
     // Gets a saveloc given an index (number)
-    SavedLocation_t *GetSaveloc(int indx) { return indx > -1 && indx < m_rcSavelocs.Count() ? m_rcSavelocs[indx] : nullptr; }
+    SavedLocation_t *GetSaveloc(int indx) { EnsureLoaded(); return indx > -1 && indx < m_rcSavelocs.Count() ? m_rcSavelocs[indx] : nullptr; }
     // Sets wheter or not we're using the Saveloc Menu
     // WARNING! No verification is done. It is up to the caller to don't give false information
     void SetUsingSavelocMenu(bool bIsUsingSLMenu);
@@ -99,13 +160,28 @@ public:
 private:
     void CheckTimer(); // Check the timer to see if we should stop it
     void FireUpdateEvent() const; // Fire tan event to the UI when we change our saveloc vector in any way, or stop using the saveloc menu
+    void FireUpdateEvent(int iCount, int iCurrent) const;
     void UpdateRequesters(); // Update any requesters with the updated saveloc count
 
-    KeyValues *m_pSavedLocsKV;
+    // Loads the current map's savelocs the first time they're needed
+    void EnsureLoaded() { if (!m_bLoaded) LoadMapSavelocs(); }
+    void LoadMapSavelocs();
+    void SaveMapSavelocs();
+    static void GetMapFilePath(const char *pMapName, char *pOut, int outLen);
+    // Reads only the saveloc count and current index of the map's file, false if there is no valid file
+    static bool ReadMapFileHeader(const char *pMapName, int &iCurrent, int &iCount);
+    static bool WriteMapFile(const char *pMapName, const CUtlVector<SavedLocation_t *> &vecSavelocs, int iCurrent);
+    // Splits the old all-maps KeyValues file into per-map files
+    void MigrateLegacySavelocs();
+
+    char m_szMapName[MAX_MAP_NAME];
+    bool m_bLoaded; // The map's file was read (or there was none)
+    bool m_bDirty;  // Savelocs or the current index changed since they were loaded
     CUtlVector<uint64> m_vecRequesters;
     uint64 m_iRequesting; // The Steam ID of the person we are requesting savelocs from, if any
 
     CUtlVector<SavedLocation_t*> m_rcSavelocs;
+    CSavelocRewindBuffer m_RewindBuffer;
     int m_iCurrentSavelocIndx;
     bool m_bUsingSavelocMenu;
 };
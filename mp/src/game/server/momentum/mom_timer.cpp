@@ -133,6 +133,10 @@ void CMomentumTimer::Stop(CMomentumPlayer *pPlayer, bool bFinished /* = false */
     if (!m_bIsRunning)
         return;
 
+    // The replay copies the player's run stats, make sure they're up to date
+    if (pPlayer)
+        pPlayer->FlushRunStats();
+
     SetRunning(pPlayer, false);
 
     if (pPlayer)
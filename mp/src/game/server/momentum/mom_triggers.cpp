@@ -9,6 +9,7 @@
 #include "fmtstr.h"
 #include "mom_timer.h"
 #include "mom_modulecomms.h"
+#include "mapzones_file.h"
 
 #include "dt_utlvector_send.h"
 
@@ -144,15 +145,15 @@ bool CBaseMomZoneTrigger::TestCollision(const Ray_t& ray, unsigned mask, trace_t
     return true;
 }
 
-bool CBaseMomZoneTrigger::ToKeyValues(KeyValues *pKvInto)
+bool CBaseMomZoneTrigger::ToZoneData(ZoneTriggerData_t &dataInto)
 {
-    pKvInto->SetInt("type", GetZoneType());
+    dataInto.m_iType = GetZoneType();
     return true;
 }
 
-bool CBaseMomZoneTrigger::LoadFromKeyValues(KeyValues *pKvFrom)
+bool CBaseMomZoneTrigger::LoadFromZoneData(const ZoneTriggerData_t &dataFrom)
 {
-    if (pKvFrom->GetInt("type", ZONE_TYPE_INVALID) != GetZoneType())
+    if (dataFrom.m_iType != GetZoneType())
         return false;
 
     return true;
@@ -191,17 +192,17 @@ void CTriggerZone::OnEndTouch(CBaseEntity* pOther)
     BaseClass::OnEndTouch(pOther);
 }
 
-bool CTriggerZone::ToKeyValues(KeyValues* pKvInto)
+bool CTriggerZone::ToZoneData(ZoneTriggerData_t &dataInto)
 {
-    pKvInto->SetInt("zoneNum", m_iZoneNumber);
-    return BaseClass::ToKeyValues(pKvInto);
+    dataInto.m_iZone = m_iZoneNumber;
+    return BaseClass::ToZoneData(dataInto);
 }
 
-bool CTriggerZone::LoadFromKeyValues(KeyValues* kv)
+bool CTriggerZone::LoadFromZoneData(const ZoneTriggerData_t &dataFrom)
 {
-    m_iZoneNumber = kv->GetInt("zoneNum", -1);
+    m_iZoneNumber = dataFrom.m_iZone;
     if (m_iZoneNumber >= 0 && m_iZoneNumber < MAX_ZONES)
-        return BaseClass::LoadFromKeyValues(kv);
+        return BaseClass::LoadFromZoneData(dataFrom);
 
     return false;
 }
@@ -250,51 +251,37 @@ CTriggerTimerStart::CTriggerTimerStart()
 {
     m_iZoneNumber = 1;
 }
-bool CTriggerTimerStart::ToKeyValues(KeyValues *pKvInto)
+bool CTriggerTimerStart::ToZoneData(ZoneTriggerData_t &dataInto)
 {
-    // Structured like this because properties are another DB table for the site
+    // Saved as "zoneProps" because properties are another DB table for the site
     // (not every trigger has properties)
-    const auto pZoneProps = new KeyValues("zoneProps");
-    const auto pActualProps = new KeyValues("properties");
-
-    pActualProps->SetFloat("speed_limit", GetSpeedLimit());
-    pActualProps->SetBool("limiting_speed", IsLimitingSpeed());
-    pActualProps->SetBool("start_on_jump", StartOnJump());
-    pActualProps->SetInt("speed_limit_type", GetLimitSpeedType());
-    if (HasLookAngles())
-    {
-        pActualProps->SetFloat("yaw", m_angLook[YAW]);
-    }
-
-    pZoneProps->AddSubKey(pActualProps);
-    pKvInto->AddSubKey(pZoneProps);
-
-    return BaseClass::ToKeyValues(pKvInto);
+    dataInto.m_bHasProps = true;
+    dataInto.m_flSpeedLimit = GetSpeedLimit();
+    dataInto.m_bLimitingSpeed = IsLimitingSpeed();
+    dataInto.m_bStartOnJump = StartOnJump();
+    dataInto.m_iSpeedLimitType = GetLimitSpeedType();
+    dataInto.m_bHasYaw = HasLookAngles();
+    dataInto.m_flYaw = m_angLook[YAW];
+
+    return BaseClass::ToZoneData(dataInto);
 };
 
-bool CTriggerTimerStart::LoadFromKeyValues(KeyValues *zoneKV)
+bool CTriggerTimerStart::LoadFromZoneData(const ZoneTriggerData_t &dataFrom)
 {
-    if (BaseClass::LoadFromKeyValues(zoneKV))
+    if (BaseClass::LoadFromZoneData(dataFrom))
     {
-        const auto pZoneProps = zoneKV->FindKey("zoneProps");
-        if (!pZoneProps)
-            return false;
-
-        const auto pActualProps = pZoneProps->FindKey("properties");
-        if (!pActualProps)
+        if (!dataFrom.m_bHasProps)
             return false;
 
-        SetSpeedLimit(pActualProps->GetFloat("speed_limit", 350.0f));
-        SetIsLimitingSpeed(pActualProps->GetBool("limiting_speed", true));
-        SetStartOnJump(pActualProps->GetBool("start_on_jump", true));
-        SetLimitSpeedType(pActualProps->GetInt("speed_limit_type", SPEED_NORMAL_LIMIT));
+        SetSpeedLimit(dataFrom.m_flSpeedLimit);
+        SetIsLimitingSpeed(dataFrom.m_bLimitingSpeed);
+        SetStartOnJump(dataFrom.m_bStartOnJump);
+        SetLimitSpeedType(dataFrom.m_iSpeedLimitType);
 
-        const float nolook = -190.0f;
-        float yaw = pActualProps->GetFloat("yaw", nolook);
-        if (!CloseEnough(yaw, nolook))
+        if (dataFrom.m_bHasYaw)
         {
             SetHasLookAngles(true);
-            SetLookAngles(QAngle(0.0f, yaw, 0.0f));
+            SetLookAngles(QAngle(0.0f, dataFrom.m_flYaw, 0.0f));
         }
         else
         {
@@ -5,6 +5,8 @@
 #include "modelentities.h"
 #include "triggers.h"
 
+struct ZoneTriggerData_t;
+
 class CMomRunEntity;
 class CMomentumPlayer;
 
@@ -101,12 +103,12 @@ public:
     virtual bool TestCollision(const Ray_t &ray, unsigned int mask, trace_t &tr) OVERRIDE;
 
     // Override this function to have the game save this zone type to the .zon file
-    // If you override this make sure to also override LoadFromKeyValues to load values from .zon file
-    // Returns false by default to signify it was not saved (kvInto can be deleted)
-    virtual bool ToKeyValues(KeyValues *pKvInto);
+    // If you override this make sure to also override LoadFromZoneData to load values from .zon file
+    // Return false to signify it was not saved
+    virtual bool ToZoneData(ZoneTriggerData_t &dataInto);
     // Override this function to load zone specific values from .zon file
     // Return true to signify success
-    virtual bool LoadFromKeyValues(KeyValues *pKvFrom);
+    virtual bool LoadFromZoneData(const ZoneTriggerData_t &dataFrom);
 
     virtual int GetZoneType();
 
@@ -138,8 +140,8 @@ public:
     virtual void OnStartTouch(CBaseEntity* pOther) OVERRIDE;
     virtual void OnEndTouch(CBaseEntity* pOther) OVERRIDE;
 
-    virtual bool ToKeyValues(KeyValues* pKvInto) OVERRIDE;
-    virtual bool LoadFromKeyValues(KeyValues* kv) OVERRIDE;
+    virtual bool ToZoneData(ZoneTriggerData_t &dataInto) OVERRIDE;
+    virtual bool LoadFromZoneData(const ZoneTriggerData_t &dataFrom) OVERRIDE;
 
 protected:
     // The zone number of this zone. Keep in mind start timer triggers are always zone number 1,
@@ -216,8 +218,8 @@ class CTriggerTimerStart : public CTriggerZone
     int GetLimitSpeedType() const { return m_iLimitSpeedType; }
     void SetLimitSpeedType(const int type) { m_iLimitSpeedType = type; }
 
-    virtual bool ToKeyValues(KeyValues *pKvInto) OVERRIDE;
-    virtual bool LoadFromKeyValues(KeyValues *zoneKV) OVERRIDE;
+    virtual bool ToZoneData(ZoneTriggerData_t &dataInto) OVERRIDE;
+    virtual bool LoadFromZoneData(const ZoneTriggerData_t &dataFrom) OVERRIDE;
 
     int GetZoneType() OVERRIDE;
   private:
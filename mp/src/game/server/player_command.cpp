@@ -320,7 +320,7 @@ void CPlayerMove::PreventBounce(CBasePlayer *player, IMoveHelper *moveHelper, bo
 	{
 		Vector hullSizeNormal = VEC_HULL_MAX - VEC_HULL_MIN;
 		Vector hullSizeCrouch = VEC_DUCK_HULL_MAX - VEC_DUCK_HULL_MIN;
-		offset.z += g_pGameModeSystem->GetGameMode()->GetViewScale() * (hullSizeNormal - hullSizeCrouch).z;
+		offset.z += g_pGameModeSystem->GetMovementParams().m_flViewScale * (hullSizeNormal - hullSizeCrouch).z;
 	}
 
 	// CGameMovement::TryTouchGround
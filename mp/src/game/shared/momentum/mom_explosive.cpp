@@ -7,6 +7,8 @@
 #include "momentum/mom_player.h"
 #include "Sprite.h"
 #include "momentum/mom_triggers.h"
+#else
+#include "momentum/mom_effect_budget.h"
 #endif
 
 #include "tier0/memdbgon.h"
@@ -35,6 +37,7 @@ CMomExplosive::CMomExplosive()
 
 #ifdef CLIENT_DLL
     m_flSpawnTime = 0.0f;
+    m_bTrailBudgeted = false;
 #else
     m_fDamage = 0.0f;
 #endif
@@ -81,6 +84,25 @@ void CMomExplosive::OnDataChanged(DataUpdateType_t updateType)
     }
 }
 
+void CMomExplosive::UpdateOnRemove()
+{
+    if (m_bTrailBudgeted)
+    {
+        g_pEffectBudget->ReleaseEffect(EFFECT_BUDGET_TRAIL);
+        m_bTrailBudgeted = false;
+    }
+
+    BaseClass::UpdateOnRemove();
+}
+
+bool CMomExplosive::RequestTrailBudget()
+{
+    if (!m_bTrailBudgeted)
+        m_bTrailBudgeted = g_pEffectBudget->RequestEffect(EFFECT_BUDGET_TRAIL, GetAbsOrigin(), CEffectBudget::IsLocalPlayerEffect(this));
+
+    return m_bTrailBudgeted;
+}
+
 void CMomExplosive::InitializeInterpolationVelocity()
 {
     CInterpolatedVar<Vector> &interpolator = GetOriginInterpolator();
@@ -26,6 +26,7 @@ public:
 
     int DrawModel(int flags) override;
     void OnDataChanged(DataUpdateType_t updateType) override;
+    void UpdateOnRemove() override;
     
 #else
     virtual float GetDamageAmount() { return 0.0f; }
@@ -35,6 +36,12 @@ public:
     float GetDamage() const { return m_fDamage; }
 #endif
 
+#ifdef CLIENT_DLL
+protected:
+    // Call before creating a trail, false means the trail is over the effect budget
+    bool RequestTrailBudget();
+#endif
+
 private:
     // This gets sent to the client and placed in the client's interpolation history
     // so the projectile starts out moving right off the bat.
@@ -42,6 +49,8 @@ private:
 
 #ifdef CLIENT_DLL
     void InitializeInterpolationVelocity();
+
+    bool m_bTrailBudgeted; // Whether the trail counts against the effect budget
 #else
     float m_fDamage;
 #endif
@@ -33,7 +33,7 @@
 
 #define GROUND_FACTOR_MULTIPLIER 301.99337741082998788946739227784f // not used
 
-#define NON_JUMP_VELOCITY ((g_pGameModeSystem->IsTF2BasedMode()) ? 250.0f : 140.0f)
+#define NON_JUMP_VELOCITY (g_pGameModeSystem->GetMovementParams().m_flNonJumpVelocity)
 
 // remove this eventually
 ConVar sv_slope_fix("sv_slope_fix", "1");
@@ -665,7 +665,7 @@ bool CMomentumGameMovement::CanUnduck()
         Vector hullSizeNormal = VEC_HULL_MAX - VEC_HULL_MIN;
         Vector hullSizeCrouch = VEC_DUCK_HULL_MAX - VEC_DUCK_HULL_MIN;
 
-        newOrigin += -g_pGameModeSystem->GetGameMode()->GetViewScale() * (hullSizeNormal - hullSizeCrouch);
+        newOrigin += -g_pGameModeSystem->GetMovementParams().m_flViewScale * (hullSizeNormal - hullSizeCrouch);
     }
 
     UTIL_TraceHull(mv->GetAbsOrigin(), newOrigin, VEC_HULL_MIN, VEC_HULL_MAX, PlayerSolidMask(), player,
@@ -943,7 +943,7 @@ void CMomentumGameMovement::FinishUnDuck()
         Vector hullSizeNormal = VEC_HULL_MAX - VEC_HULL_MIN;
         Vector hullSizeCrouch = VEC_DUCK_HULL_MAX - VEC_DUCK_HULL_MIN;
 
-        Vector viewDelta = -g_pGameModeSystem->GetGameMode()->GetViewScale() * (hullSizeNormal - hullSizeCrouch);
+        Vector viewDelta = -g_pGameModeSystem->GetMovementParams().m_flViewScale * (hullSizeNormal - hullSizeCrouch);
 
         VectorAdd(newOrigin, viewDelta, newOrigin);
     }
@@ -972,7 +972,7 @@ void CMomentumGameMovement::FinishDuck()
     Vector hullSizeNormal = VEC_HULL_MAX - VEC_HULL_MIN;
     Vector hullSizeCrouch = VEC_DUCK_HULL_MAX - VEC_DUCK_HULL_MIN;
 
-    Vector viewDelta = g_pGameModeSystem->GetGameMode()->GetViewScale() * (hullSizeNormal - hullSizeCrouch);
+    Vector viewDelta = g_pGameModeSystem->GetMovementParams().m_flViewScale * (hullSizeNormal - hullSizeCrouch);
 
     player->SetViewOffset(GetPlayerViewOffset(true));
     player->AddFlag(FL_DUCKING);
@@ -1145,7 +1145,7 @@ bool CMomentumGameMovement::CheckJumpButton()
         return false;
     }
 
-    if (!g_pGameModeSystem->GetGameMode()->CanBhop())
+    if (!g_pGameModeSystem->GetMovementParams().m_bCanBhop)
     {
         PreventBunnyHopping();
     }
@@ -1406,7 +1406,7 @@ void CMomentumGameMovement::CategorizePosition()
                         // On modes that can't bhop, colliding before landing is better if it means they start sliding.
                         // If this check fails, we want to pretend they collided first and couldn't land,
                         // so we don't set the ground entity.
-                        if (g_pGameModeSystem->GetGameMode()->CanBhop() || vecNextVelocity.z <= NON_JUMP_VELOCITY)
+                        if (g_pGameModeSystem->GetMovementParams().m_bCanBhop || vecNextVelocity.z <= NON_JUMP_VELOCITY)
                         {
                             // Only update velocity as if we collided if it results in horizontal speed gain.
                             // Otherwise, we are probably going uphill and are actually trying to avoid this collision.
@@ -2012,7 +2012,7 @@ int CMomentumGameMovement::TryPlayerMove(Vector *pFirstDest, trace_t *pFirstTrac
 
                 if (sv_slope_fix.GetBool() && player->GetMoveType() == MOVETYPE_WALK &&
                     player->GetGroundEntity() == nullptr && player->GetWaterLevel() < WL_Waist &&
-                    g_pGameModeSystem->GetGameMode()->CanBhop())
+                    g_pGameModeSystem->GetMovementParams().m_bCanBhop)
                 {
                     bool bValidHit = !pm.allsolid && pm.fraction < 1.0f;
 
@@ -6,20 +6,54 @@
 #include "tier0/memdbgon.h"
 
 #ifdef CLIENT_DLL
-// The server will hook into this function to fire the event on the client (server -> client)
+// The server will hook into these functions to fire the event on the client (server -> client)
+// The firing side still owns the KeyValues
 DLL_EXPORT void FireEventFromServer(KeyValues *pKv)
 {
-    g_pModuleComms->OnEvent(pKv);
+    g_pModuleComms->DispatchEvent(pKv);
+}
+
+DLL_EXPORT void FireTypedEventFromServer(int event, const void *pData)
+{
+    g_pModuleComms->OnTypedEvent((ModuleEvent_t) event, pData);
 }
 #else
-// The client hooks into this function to pass an event to the server (client -> server)
+// The client hooks into these functions to pass an event to the server (client -> server)
 DLL_EXPORT void FireEventFromClient(KeyValues *pKv)
 {
-    g_pModuleComms->OnEvent(pKv);
+    g_pModuleComms->DispatchEvent(pKv);
+}
+
+DLL_EXPORT void FireTypedEventFromClient(int event, const void *pData)
+{
+    g_pModuleComms->OnTypedEvent((ModuleEvent_t) event, pData);
 }
 #endif //CLIENT_DLL
 
-ModuleCommunication::ModuleCommunication() : CAutoGameSystem("ModuleCommunication"), CallMeToFireEvent(nullptr)
+template <class T>
+static void DispatchTypedEvent(TypedEventListeners_t &listeners, const void *pData)
+{
+    const T &data = *static_cast<const T *>(pData);
+    FOR_EACH_LL(listeners, i)
+    {
+        CUtlDelegate<void (const T &)> listener;
+        listener.SetAbstractDelegate(listeners[i]);
+        listener(data);
+    }
+}
+
+// Calls the listeners of each typed event with its payload type, in ModuleEvent_t order
+typedef void (*TypedEventDispatchFn)(TypedEventListeners_t &listeners, const void *pData);
+static const TypedEventDispatchFn s_pTypedEventDispatchers[] =
+{
+    DispatchTypedEvent<MapDownloadSizeEvent_t>,      // MODULE_EVENT_MAP_DOWNLOAD_SIZE
+    DispatchTypedEvent<MapDownloadProgressEvent_t>,  // MODULE_EVENT_MAP_DOWNLOAD_PROGRESS
+    DispatchTypedEvent<ModuleCommsBenchmarkEvent_t>, // MODULE_EVENT_BENCHMARK
+};
+COMPILE_TIME_ASSERT(ARRAYSIZE(s_pTypedEventDispatchers) == MODULE_EVENT_COUNT);
+
+ModuleCommunication::ModuleCommunication() : CAutoGameSystem("ModuleCommunication"), CallMeToFireEvent(nullptr),
+    CallMeToFireTypedEvent(nullptr)
 {
 }
 
@@ -33,6 +67,15 @@ bool ModuleCommunication::Init()
 #endif
     ));
 
+    typedef void (*TypedEventFireFn)(int event, const void *pData);
+    CallMeToFireTypedEvent = (TypedEventFireFn) (GetProcAddress(
+#ifdef CLIENT_DLL
+        GetModuleHandle(SERVER_DLL_NAME), "FireTypedEventFromClient" // client -> server
+#else
+        GetModuleHandle(CLIENT_DLL_NAME), "FireTypedEventFromServer" // server -> client
+#endif
+    ));
+
     return true;
 }
 
@@ -40,20 +83,34 @@ void ModuleCommunication::Shutdown()
 {
     m_dictListeners.RemoveAll();
     m_vecListeners.PurgeAndDeleteElements();
+
+    for (int i = 0; i < MODULE_EVENT_COUNT; i++)
+        m_TypedListeners[i].RemoveAll();
 }
 
 
 void ModuleCommunication::FireEvent(KeyValues* pKv, EVENT_FIRE_TYPE type /* = FIRE_BOTH */)
 {
-    KeyValues *pCopy = type == FIRE_BOTH ? pKv->MakeCopy() : nullptr;
-
+    // Both sides get the same KeyValues, it's only deleted after they're done with it
     // This fires across the DLL boundary
     if (CallMeToFireEvent && (type == FIRE_BOTH || type == FIRE_FOREIGN_ONLY))
-        CallMeToFireEvent(pKv); // pKv->deleteThis is called in here
+        CallMeToFireEvent(pKv);
 
     // This fires it for the DLL we're currently on, allowing "local" listeners for events
     if (type == FIRE_BOTH || type == FIRE_LOCAL_ONLY)
-        OnEvent(type == FIRE_BOTH ? pCopy : pKv); //pCopy->deleteThis is called in here
+        DispatchEvent(pKv);
+
+    pKv->deleteThis();
+}
+
+void ModuleCommunication::FireTypedEvent(ModuleEvent_t event, const void *pData, EVENT_FIRE_TYPE type)
+{
+    // Same as above, the other DLL reads the payload straight from the caller
+    if (CallMeToFireTypedEvent && (type == FIRE_BOTH || type == FIRE_FOREIGN_ONLY))
+        CallMeToFireTypedEvent(event, pData);
+
+    if (type == FIRE_BOTH || type == FIRE_LOCAL_ONLY)
+        OnTypedEvent(event, pData);
 }
 
 int ModuleCommunication::ListenForEvent(const char* pName, CUtlDelegate<void (KeyValues*)> listener)
@@ -88,7 +145,25 @@ void ModuleCommunication::RemoveListener(const char *pName, int index)
 }
 
 
+void ModuleCommunication::RemoveListener(ModuleEvent_t event, int index)
+{
+    if (event >= 0 && event < MODULE_EVENT_COUNT && m_TypedListeners[event].IsValidIndex(index))
+        m_TypedListeners[event].Remove(index);
+}
+
+void ModuleCommunication::OnTypedEvent(ModuleEvent_t event, const void *pData)
+{
+    if (event >= 0 && event < MODULE_EVENT_COUNT)
+        s_pTypedEventDispatchers[event](m_TypedListeners[event], pData);
+}
+
 void ModuleCommunication::OnEvent(KeyValues* pKv)
+{
+    DispatchEvent(pKv);
+    pKv->deleteThis();
+}
+
+void ModuleCommunication::DispatchEvent(KeyValues* pKv)
 {
     // Find the event listeners for this particular event
     const auto found = m_dictListeners.Find(pKv->GetName());
@@ -105,10 +180,59 @@ void ModuleCommunication::OnEvent(KeyValues* pKv)
     {
         Warning("Trying to fire modulecom event %s with no registered listeners!\n", pKv->GetName());
     }
-
-    pKv->deleteThis();
 }
 
 //Expose this to the DLL
 static ModuleCommunication mod;
-ModuleCommunication *g_pModuleComms = &mod;
\ No newline at end of file
+ModuleCommunication *g_pModuleComms = &mod;
+
+#ifdef CLIENT_DLL
+class CModuleCommsBenchmarkListener
+{
+  public:
+    CModuleCommsBenchmarkListener() : m_iSum(0) {}
+
+    void OnKeyValuesEvent(KeyValues *pKv) { m_iSum += pKv->GetInt("value"); }
+    void OnTypedEvent(const ModuleCommsBenchmarkEvent_t &event) { m_iSum += event.m_iValue; }
+
+    int m_iSum;
+};
+
+CON_COMMAND_F(mom_modulecomms_benchmark, "Times firing local module events through KeyValues and as typed events.\n"
+                                         "Usage: mom_modulecomms_benchmark [iterations]\n", FCVAR_DEVELOPMENTONLY)
+{
+    const int iIterations = args.ArgC() > 1 ? Max(atoi(args[1]), 1) : 100000;
+
+    CModuleCommsBenchmarkListener listener;
+    const int iKvIndx = g_pModuleComms->ListenForEvent("modulecomms_benchmark", UtlMakeDelegate(&listener, &CModuleCommsBenchmarkListener::OnKeyValuesEvent));
+    const int iTypedIndx = g_pModuleComms->ListenForEvent(UtlMakeDelegate(&listener, &CModuleCommsBenchmarkListener::OnTypedEvent));
+
+    double flStart = Plat_FloatTime();
+    for (int i = 0; i < iIterations; i++)
+    {
+        KeyValues *pKv = new KeyValues("modulecomms_benchmark");
+        pKv->SetInt("value", i);
+        g_pModuleComms->FireEvent(pKv, FIRE_LOCAL_ONLY);
+    }
+    const double flKvTime = Plat_FloatTime() - flStart;
+    const int iKvSum = listener.m_iSum;
+
+    listener.m_iSum = 0;
+    flStart = Plat_FloatTime();
+    for (int i = 0; i < iIterations; i++)
+    {
+        ModuleCommsBenchmarkEvent_t event;
+        event.m_iValue = i;
+        g_pModuleComms->FireEvent(event, FIRE_LOCAL_ONLY);
+    }
+    const double flTypedTime = Plat_FloatTime() - flStart;
+
+    g_pModuleComms->RemoveListener("modulecomms_benchmark", iKvIndx);
+    g_pModuleComms->RemoveListener(ModuleCommsBenchmarkEvent_t::EVENT, iTypedIndx);
+
+    Msg("KeyValues: %.3f ms total, %.3f us per event\n", flKvTime * 1000.0, flKvTime * 1000000.0 / iIterations);
+    Msg("Typed:     %.3f ms total, %.3f us per event\n", flTypedTime * 1000.0, flTypedTime * 1000000.0 / iIterations);
+    if (iKvSum != listener.m_iSum)
+        Warning("The listeners saw different events!\n");
+}
+#endif
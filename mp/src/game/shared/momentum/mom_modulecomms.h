@@ -15,6 +15,43 @@ enum EVENT_FIRE_TYPE
     FIRE_LOCAL_ONLY
 };
 
+// Events with a POD payload struct, dispatched by ID without any KeyValues or name lookups, and
+// passed to listeners by reference without being copied. Each payload names its event with EVENT:
+//   g_pModuleComms->ListenForEvent(UtlMakeDelegate(this, &CFoo::OnProgress)); // void OnProgress(const MapDownloadProgressEvent_t &)
+//   g_pModuleComms->FireEvent(event, FIRE_LOCAL_ONLY);
+// New events go in this enum and in s_pTypedEventDispatchers in mom_modulecomms.cpp.
+enum ModuleEvent_t
+{
+    MODULE_EVENT_MAP_DOWNLOAD_SIZE = 0,
+    MODULE_EVENT_MAP_DOWNLOAD_PROGRESS,
+    MODULE_EVENT_BENCHMARK,
+
+    MODULE_EVENT_COUNT
+};
+
+struct MapDownloadSizeEvent_t
+{
+    static const ModuleEvent_t EVENT = MODULE_EVENT_MAP_DOWNLOAD_SIZE;
+    uint32 m_uMapID;
+    uint64 m_uSize;
+};
+
+struct MapDownloadProgressEvent_t
+{
+    static const ModuleEvent_t EVENT = MODULE_EVENT_MAP_DOWNLOAD_PROGRESS;
+    uint32 m_uMapID;
+    uint64 m_uDownloaded; // Bytes of the file on disk so far, including any resumed part
+};
+
+// Used by mom_modulecomms_benchmark
+struct ModuleCommsBenchmarkEvent_t
+{
+    static const ModuleEvent_t EVENT = MODULE_EVENT_BENCHMARK;
+    int m_iValue;
+};
+
+typedef CUtlLinkedList<CUtlAbstractDelegate> TypedEventListeners_t;
+
 struct EventListenerContainer
 {
     ~EventListenerContainer()
@@ -37,13 +74,33 @@ public:
     // type can control which way the event is fired, see EVENT_FIRE_TYPE
     void FireEvent(KeyValues *pKv, EVENT_FIRE_TYPE type = FIRE_BOTH);
     void OnEvent(KeyValues *pKv); // The event has been caught by the recieving end
+    void DispatchEvent(KeyValues *pKv); // Calls the listeners for the event, the caller still owns pKv
     int ListenForEvent(const char *pName, CUtlDelegate<void (KeyValues *)> listener);
     void RemoveListener(const char *pName, int index);
 
+    // Typed events, see ModuleEvent_t
+    template <class T>
+    void FireEvent(const T &data, EVENT_FIRE_TYPE type = FIRE_BOTH)
+    {
+        FireTypedEvent(T::EVENT, &data, type);
+    }
+    template <class T>
+    int ListenForEvent(CUtlDelegate<void (const T &)> listener)
+    {
+        return m_TypedListeners[T::EVENT].AddToTail(listener.GetAbstractDelegate());
+    }
+    void RemoveListener(ModuleEvent_t event, int index);
+    void OnTypedEvent(ModuleEvent_t event, const void *pData); // A typed event has been caught by the receiving end
+
 private:
+    void FireTypedEvent(ModuleEvent_t event, const void *pData, EVENT_FIRE_TYPE type);
+
     void (*CallMeToFireEvent)(KeyValues *pKv);
+    void (*CallMeToFireTypedEvent)(int event, const void *pData);
     CUtlDict<int> m_dictListeners;
     CUtlVector<EventListenerContainer*> m_vecListeners;
+
+    TypedEventListeners_t m_TypedListeners[MODULE_EVENT_COUNT];
 };
 
 extern ModuleCommunication *g_pModuleComms;
\ No newline at end of file
@@ -57,7 +57,7 @@ float CMomRocket::GetDrawDelayTime()
 
 void CMomRocket::CreateTrailParticles()
 {
-    if (!mom_rj_particle_trail_enable.GetBool())
+    if (!mom_rj_particle_trail_enable.GetBool() || !RequestTrailBudget())
         return;
 
     ParticleProp()->Create(g_pWeaponDef->GetWeaponParticle(WEAPON_ROCKETLAUNCHER, "RocketTrail"), PATTACH_POINT_FOLLOW, "trail");
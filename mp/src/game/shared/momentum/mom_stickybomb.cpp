@@ -15,6 +15,7 @@
 #include "momentum/mom_stickybomb_verts.h"
 #else
 #include "functionproxy.h"
+#include "momentum/mom_effect_budget.h"
 #endif
 
 #include "tier0/memdbgon.h"
@@ -142,7 +143,7 @@ float CMomStickybomb::GetDrawDelayTime()
 
 void CMomStickybomb::CreateTrailParticles()
 {
-    if (!mom_sj_particle_trail_enable.GetBool())
+    if (!mom_sj_particle_trail_enable.GetBool() || !RequestTrailBudget())
         return;
 
     ParticleProp()->Create(g_pWeaponDef->GetWeaponParticle(WEAPON_STICKYLAUNCHER, "StickybombTrail"), PATTACH_ABSORIGIN_FOLLOW);
@@ -168,7 +169,8 @@ void CMomStickybomb::Simulate()
 {
     if (!m_bPulsed && (gpGlobals->curtime - m_flSpawnTime) > (MOM_STICKYBOMB_ARMTIME - 0.25f))
     {
-        ParticleProp()->Create(g_pWeaponDef->GetWeaponParticle(WEAPON_STICKYLAUNCHER, "StickybombPulse"), PATTACH_ABSORIGIN_FOLLOW);
+        if (g_pEffectBudget->RequestEffect(EFFECT_BUDGET_PARTICLE, GetAbsOrigin(), CEffectBudget::IsLocalPlayerEffect(this)))
+            ParticleProp()->Create(g_pWeaponDef->GetWeaponParticle(WEAPON_STICKYLAUNCHER, "StickybombPulse"), PATTACH_ABSORIGIN_FOLLOW);
 
         m_bPulsed = true;
     }
@@ -178,8 +178,7 @@ void CGameMode_Tricksurf::SetGameModeVars()
 
 CGameModeSystem::CGameModeSystem() : CAutoGameSystem("CGameModeSystem")
 {
-    m_pCurrentGameMode = new CGameModeBase; // Unknown game mode
-    m_vecGameModes.AddToTail(m_pCurrentGameMode);
+    m_vecGameModes.AddToTail(new CGameModeBase); // Unknown game mode
     m_vecGameModes.AddToTail(new CGameMode_Surf);
     m_vecGameModes.AddToTail(new CGameMode_Bhop);
     m_vecGameModes.AddToTail(new CGameMode_KZ);
@@ -187,6 +186,8 @@ CGameModeSystem::CGameModeSystem() : CAutoGameSystem("CGameModeSystem")
     m_vecGameModes.AddToTail(new CGameMode_SJ);
     m_vecGameModes.AddToTail(new CGameMode_Tricksurf);
     m_vecGameModes.AddToTail(new CGameMode_Trikz);
+
+    SetCurrentGameMode(m_vecGameModes[GAMEMODE_UNKNOWN]);
 }
 
 CGameModeSystem::~CGameModeSystem()
@@ -215,9 +216,20 @@ IGameMode *CGameModeSystem::GetGameMode(int eMode) const
     return m_vecGameModes[eMode];
 }
 
+void CGameModeSystem::SetCurrentGameMode(IGameMode *pGameMode)
+{
+    m_pCurrentGameMode = pGameMode;
+
+    m_MovementParams.m_eType = pGameMode->GetType();
+    m_MovementParams.m_bTF2BasedMode = m_MovementParams.m_eType == GAMEMODE_RJ || m_MovementParams.m_eType == GAMEMODE_SJ;
+    m_MovementParams.m_bCanBhop = pGameMode->CanBhop();
+    m_MovementParams.m_flViewScale = pGameMode->GetViewScale();
+    m_MovementParams.m_flNonJumpVelocity = m_MovementParams.m_bTF2BasedMode ? 250.0f : 140.0f;
+}
+
 void CGameModeSystem::SetGameMode(GameMode_t eMode)
 {
-    m_pCurrentGameMode = m_vecGameModes[eMode];
+    SetCurrentGameMode(m_vecGameModes[eMode]);
 #ifdef CLIENT_DLL
     static ConVarRef mom_gamemode("mom_gamemode");
     // Throw the change to the server too
@@ -228,7 +240,7 @@ void CGameModeSystem::SetGameMode(GameMode_t eMode)
 void CGameModeSystem::SetGameModeFromMapName(const char *pMapName)
 {
     // Set to unknown for now
-    m_pCurrentGameMode = m_vecGameModes[GAMEMODE_UNKNOWN];
+    IGameMode *pGameMode = m_vecGameModes[GAMEMODE_UNKNOWN];
 
     if (pMapName)
     {
@@ -239,12 +251,14 @@ void CGameModeSystem::SetGameModeFromMapName(const char *pMapName)
             const auto strLen = Q_strlen(pPrefix);
             if (!Q_strnicmp(pPrefix, pMapName, strLen))
             {
-                m_pCurrentGameMode = m_vecGameModes[i];
+                pGameMode = m_vecGameModes[i];
                 break;
             }
         }
     }
 
+    SetCurrentGameMode(pGameMode);
+
 #ifdef CLIENT_DLL
     static ConVarRef mom_gamemode("mom_gamemode");
     // Throw the change to the server too
@@ -145,6 +145,17 @@ public:
     const char* GetGameModeCfg() override { return "trikz.cfg"; }
 };
 
+// The current game mode's movement parameters, resolved whenever the game mode changes so movement code
+// can read them every tick without going through the IGameMode virtuals
+struct MovementParams_t
+{
+    GameMode_t m_eType;
+    bool m_bTF2BasedMode;      // RJ || SJ
+    bool m_bCanBhop;
+    float m_flViewScale;
+    float m_flNonJumpVelocity; // Upwards speed past which the player can't be on the ground
+};
+
 class CGameModeSystem : public CAutoGameSystem
 {
 public:
@@ -161,9 +172,11 @@ public:
     IGameMode *GetGameMode(int eMode) const;
     /// Checks if the game mode is the given one.
     /// (convenience method; functionally equivalent to `GetGameMode()->GetType() == eCheck`)
-    bool GameModeIs(GameMode_t eCheck) const { return m_pCurrentGameMode->GetType() == eCheck; }
+    bool GameModeIs(GameMode_t eCheck) const { return m_MovementParams.m_eType == eCheck; }
     /// Another convenience method to check if the current game mode is a TF2-based one (RJ || SJ)
-    bool IsTF2BasedMode() const { return GameModeIs(GAMEMODE_RJ) || GameModeIs(GAMEMODE_SJ); }
+    bool IsTF2BasedMode() const { return m_MovementParams.m_bTF2BasedMode; }
+    /// Gets the current game mode's movement parameters
+    const MovementParams_t &GetMovementParams() const { return m_MovementParams; }
     /// Sets the game mode directly
     void SetGameMode(GameMode_t eMode);
     /// Sets the game mode from a map name (backup method)
@@ -172,8 +185,11 @@ public:
     void PrintGameModeVars();
 
 private:
+    void SetCurrentGameMode(IGameMode *pGameMode);
+
     IGameMode *m_pCurrentGameMode;
     CUtlVector<IGameMode*> m_vecGameModes;
+    MovementParams_t m_MovementParams;
 };
 
 extern CGameModeSystem *g_pGameModeSystem;
\ No newline at end of file
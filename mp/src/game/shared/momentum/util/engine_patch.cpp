@@ -16,8 +16,13 @@
 #define LALDIF(addr) ((uintptr_t)(addr) % getpagesize())
 #endif
 
+#include <emmintrin.h>
+
 #include "cbase.h"
+#include "filesystem.h"
+#include "utlbuffer.h"
 #include "util/os_utils.h"
+#include "util/mom_file_hash.h"
 #include "engine_patch.h"
 
 // Engine Patch format:
@@ -98,6 +103,10 @@ CEngineBinary::CEngineBinary() : CAutoGameSystem("CEngineBinary")
 
 void* CEngineBinary::m_pModuleBase = nullptr;
 size_t CEngineBinary::m_iModuleSize = 0;
+bool CEngineBinary::m_bPatternCacheLoaded = false;
+bool CEngineBinary::m_bPatternCacheDirty = false;
+char CEngineBinary::m_szEngineHash[41] = {};
+CUtlMap<CRC32_t, uint32> CEngineBinary::m_mapPatternOffsets(DefLessFunc(CRC32_t));
 
 // Get the engine's base address and size
 bool CEngineBinary::Init()
@@ -123,6 +132,13 @@ bool CEngineBinary::Init()
 void CEngineBinary::PostInit()
 {
     ApplyAllPatches();
+    SavePatternCache();
+}
+
+void CEngineBinary::Shutdown()
+{
+    // In case anything looked for patterns after the patches
+    SavePatternCache();
 }
 
 inline bool CEngineBinary::DataCompare(const char* data, const char* pattern, const char* mask)
@@ -140,15 +156,263 @@ inline bool CEngineBinary::DataCompare(const char* data, const char* pattern, co
 //---------------------------------------------------------------------------------------------------------
 void* CEngineBinary::FindPattern(const char* pattern, const char* mask, size_t offset)
 {
-    auto maskLength = strlen(mask);
-    for (size_t i = 0; i <= m_iModuleSize - maskLength; ++i)
+    EnginePattern_t search = { pattern, mask, offset, nullptr };
+    FindPatterns(&search, 1);
+    return search.m_pResult;
+}
+
+void CEngineBinary::FindPatterns(EnginePattern_t* pPatterns, int iCount)
+{
+    LoadPatternCache();
+
+    // Anything found on a previous launch of this engine build only needs to be checked
+    CUtlVector<EnginePattern_t*> vecToScan;
+    for (int i = 0; i < iCount; i++)
+    {
+        EnginePattern_t &pattern = pPatterns[i];
+        pattern.m_pResult = nullptr;
+
+        const auto indx = m_mapPatternOffsets.Find(GetPatternKey(pattern));
+        if (m_mapPatternOffsets.IsValidIndex(indx))
+        {
+            const uint32 iMatch = m_mapPatternOffsets[indx];
+            if (iMatch == ENGINE_PATTERN_NOT_FOUND)
+                continue;
+
+            const auto addr = reinterpret_cast<char*>(m_pModuleBase) + iMatch;
+            if (iMatch + strlen(pattern.m_pMask) <= m_iModuleSize && DataCompare(addr, pattern.m_pPattern, pattern.m_pMask))
+            {
+                pattern.m_pResult = addr + pattern.m_iOffset;
+                continue;
+            }
+        }
+
+        vecToScan.AddToTail(&pattern);
+    }
+
+    if (vecToScan.IsEmpty())
+        return;
+
+    CUtlVector<EnginePattern_t> vecScan;
+    vecScan.SetCount(vecToScan.Count());
+    FOR_EACH_VEC(vecToScan, i)
+        vecScan[i] = *vecToScan[i];
+
+    ScanForPatterns(vecScan.Base(), vecScan.Count());
+
+    FOR_EACH_VEC(vecToScan, i)
+    {
+        EnginePattern_t &pattern = *vecToScan[i];
+        pattern.m_pResult = vecScan[i].m_pResult;
+
+        uint32 iMatch = ENGINE_PATTERN_NOT_FOUND;
+        if (pattern.m_pResult)
+            iMatch = (reinterpret_cast<char*>(pattern.m_pResult) - pattern.m_iOffset) - reinterpret_cast<char*>(m_pModuleBase);
+
+        m_mapPatternOffsets.InsertOrReplace(GetPatternKey(pattern), iMatch);
+        m_bPatternCacheDirty = true;
+    }
+}
+
+// How often each byte shows up in x86 code, roughly; the anchor for a pattern is its least common fixed byte
+static int GetByteCommonness(uint8 byte)
+{
+    static const uint8 s_CommonBytes[] =
+    {
+        0x00, 0xFF, 0xCC, 0x8B, 0x89, 0x0F, 0x24, 0x83, 0x44, 0x45, 0x48, 0xE8, 0x04, 0x08, 0x01, 0x85,
+        0xC0, 0x10, 0x8D, 0x4C, 0x74, 0x75, 0x50, 0x55, 0x5D, 0xC3, 0xEB, 0x0C, 0xF3, 0xC7, 0x14, 0x18,
+    };
+
+    for (int i = 0; i < ARRAYSIZE(s_CommonBytes); i++)
     {
-        auto addr = reinterpret_cast<char*>(m_pModuleBase) + i;
-        if (DataCompare(addr, pattern, mask))
-            return reinterpret_cast<void*>(addr + offset);
+        if (s_CommonBytes[i] == byte)
+            return ARRAYSIZE(s_CommonBytes) - i;
     }
 
-    return nullptr;
+    return 0;
+}
+
+//---------------------------------------------------------------------------------------------------------
+// Searches the engine for all of the patterns at once. Each pattern is anchored on its least common fixed
+// byte, 16 bytes of the engine are compared against every anchor at a time with SSE2, and the whole
+// pattern is only compared where an anchor byte was found.
+//---------------------------------------------------------------------------------------------------------
+void CEngineBinary::ScanForPatterns(EnginePattern_t* pPatterns, int iCount)
+{
+    struct Anchor_t
+    {
+        size_t m_iAnchorPos;
+        size_t m_iLength;
+    };
+
+    CUtlVector<Anchor_t> vecAnchors;
+    vecAnchors.SetCount(iCount);
+
+    // Patterns by anchor byte, and the distinct anchor bytes
+    CUtlVector<int> vecByAnchorByte[256];
+    CUtlVector<uint8> vecAnchorBytes;
+
+    int iRemaining = 0;
+    for (int i = 0; i < iCount; i++)
+    {
+        const EnginePattern_t &pattern = pPatterns[i];
+        Anchor_t &anchor = vecAnchors[i];
+        anchor.m_iLength = strlen(pattern.m_pMask);
+        anchor.m_iAnchorPos = anchor.m_iLength;
+
+        for (size_t j = 0; j < anchor.m_iLength; j++)
+        {
+            if (pattern.m_pMask[j] != 'x')
+                continue;
+
+            if (anchor.m_iAnchorPos == anchor.m_iLength ||
+                GetByteCommonness(pattern.m_pPattern[j]) < GetByteCommonness(pattern.m_pPattern[anchor.m_iAnchorPos]))
+                anchor.m_iAnchorPos = j;
+        }
+
+        if (anchor.m_iAnchorPos == anchor.m_iLength || anchor.m_iLength > m_iModuleSize)
+        {
+            Warning("Engine pattern with mask \"%s\" has no fixed bytes or is too long, not searching for it\n", pattern.m_pMask);
+            continue;
+        }
+
+        const uint8 anchorByte = pattern.m_pPattern[anchor.m_iAnchorPos];
+        if (vecByAnchorByte[anchorByte].IsEmpty())
+            vecAnchorBytes.AddToTail(anchorByte);
+        vecByAnchorByte[anchorByte].AddToTail(i);
+        iRemaining++;
+    }
+
+    const auto pModule = reinterpret_cast<const uint8*>(m_pModuleBase);
+
+    // Checks every pattern anchored on the byte at iPos, returns true once all patterns are found
+    const auto CheckCandidates = [&](size_t iPos)
+    {
+        CUtlVector<int> &vecCandidates = vecByAnchorByte[pModule[iPos]];
+        FOR_EACH_VEC_BACK(vecCandidates, i)
+        {
+            EnginePattern_t &pattern = pPatterns[vecCandidates[i]];
+            const Anchor_t &anchor = vecAnchors[vecCandidates[i]];
+            if (iPos < anchor.m_iAnchorPos)
+                continue;
+
+            const size_t iStart = iPos - anchor.m_iAnchorPos;
+            if (iStart + anchor.m_iLength > m_iModuleSize)
+                continue;
+
+            const auto addr = reinterpret_cast<char*>(m_pModuleBase) + iStart;
+            if (DataCompare(addr, pattern.m_pPattern, pattern.m_pMask))
+            {
+                // Matches are found in address order, so this is the first one
+                pattern.m_pResult = addr + pattern.m_iOffset;
+                vecCandidates.FastRemove(i);
+                iRemaining--;
+            }
+        }
+
+        return iRemaining == 0;
+    };
+
+    if (!iRemaining)
+        return;
+
+    CUtlVector<__m128i> vecAnchorVecs;
+    FOR_EACH_VEC(vecAnchorBytes, i)
+        vecAnchorVecs.AddToTail(_mm_set1_epi8(static_cast<char>(vecAnchorBytes[i])));
+
+    size_t iPos = 0;
+    for (; iPos + 16 <= m_iModuleSize; iPos += 16)
+    {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pModule + iPos));
+        __m128i hits = _mm_setzero_si128();
+        FOR_EACH_VEC(vecAnchorVecs, i)
+            hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, vecAnchorVecs[i]));
+
+        int iMask = _mm_movemask_epi8(hits);
+        for (int iBit = 0; iMask; iBit++, iMask >>= 1)
+        {
+            if ((iMask & 1) && CheckCandidates(iPos + iBit))
+                return;
+        }
+    }
+
+    for (; iPos < m_iModuleSize; iPos++)
+    {
+        if (!vecByAnchorByte[pModule[iPos]].IsEmpty() && CheckCandidates(iPos))
+            return;
+    }
+}
+
+CRC32_t CEngineBinary::GetPatternKey(const EnginePattern_t& pattern)
+{
+    CRC32_t crc;
+    CRC32_Init(&crc);
+    const int iLength = Q_strlen(pattern.m_pMask);
+    CRC32_ProcessBuffer(&crc, pattern.m_pPattern, iLength);
+    CRC32_ProcessBuffer(&crc, pattern.m_pMask, iLength);
+    CRC32_Final(&crc);
+    return crc;
+}
+
+void CEngineBinary::LoadPatternCache()
+{
+    if (m_bPatternCacheLoaded)
+        return;
+
+    m_bPatternCacheLoaded = true;
+
+    // The hash of the engine binary is itself cached by its size and time, so this doesn't read it after the first launch
+    if (!g_pFileHashCache->GetFileHash(ENGINE_DLL_NAME, "EXECUTABLE_PATH", m_szEngineHash, sizeof(m_szEngineHash)))
+    {
+        m_szEngineHash[0] = '\0';
+        return;
+    }
+
+    CUtlBuffer buf;
+    if (!g_pFullFileSystem->ReadFile(ENGINE_PATTERN_CACHE_FILE, "MOD", buf))
+        return;
+
+    if (buf.GetUnsignedInt() != ENGINE_PATTERN_CACHE_MAGIC || buf.GetUnsignedChar() != ENGINE_PATTERN_CACHE_VERSION)
+        return;
+
+    char szHash[41];
+    buf.GetStringManualCharCount(szHash, sizeof(szHash));
+    const uint32 iModuleSize = buf.GetUnsignedInt();
+    if (!FStrEq(szHash, m_szEngineHash) || iModuleSize != m_iModuleSize)
+        return; // The engine was updated, everything has to be found again
+
+    const int iCount = buf.GetInt();
+    for (int i = 0; i < iCount && buf.IsValid(); i++)
+    {
+        const CRC32_t key = buf.GetUnsignedInt();
+        const uint32 iOffset = buf.GetUnsignedInt();
+        if (buf.IsValid())
+            m_mapPatternOffsets.InsertOrReplace(key, iOffset);
+    }
+}
+
+void CEngineBinary::SavePatternCache()
+{
+    if (!m_bPatternCacheDirty || !m_szEngineHash[0])
+        return;
+
+    CUtlBuffer buf;
+    buf.PutUnsignedInt(ENGINE_PATTERN_CACHE_MAGIC);
+    buf.PutUnsignedChar(ENGINE_PATTERN_CACHE_VERSION);
+    buf.PutString(m_szEngineHash);
+    buf.PutUnsignedInt(m_iModuleSize);
+    buf.PutInt(m_mapPatternOffsets.Count());
+    FOR_EACH_MAP_FAST(m_mapPatternOffsets, i)
+    {
+        buf.PutUnsignedInt(m_mapPatternOffsets.Key(i));
+        buf.PutUnsignedInt(m_mapPatternOffsets[i]);
+    }
+
+    g_pFullFileSystem->CreateDirHierarchy("cache", "MOD");
+    if (g_pFullFileSystem->WriteFile(ENGINE_PATTERN_CACHE_FILE, "MOD", buf))
+        m_bPatternCacheDirty = false;
+    else
+        Warning("Failed to write the engine pattern cache %s!\n", ENGINE_PATTERN_CACHE_FILE);
 }
 
 bool CEngineBinary::SetMemoryProtection(void* pAddress, size_t iLength, int iProtection)
@@ -180,14 +444,29 @@ bool CEngineBinary::SetMemoryProtection(void* pAddress, size_t iLength, int iPro
 void CEngineBinary::ApplyAllPatches()
 {
 #if !defined (OSX) // No OSX patches
-    for (int i = 0; i < sizeof(g_EnginePatches) / sizeof(*g_EnginePatches); i++)
-        g_EnginePatches[i].ApplyPatch();
+    const int iCount = sizeof(g_EnginePatches) / sizeof(*g_EnginePatches);
+    EnginePattern_t patterns[iCount];
+    for (int i = 0; i < iCount; i++)
+        g_EnginePatches[i].GetPattern(patterns[i]);
+
+    FindPatterns(patterns, iCount);
+
+    for (int i = 0; i < iCount; i++)
+        g_EnginePatches[i].ApplyPatch(patterns[i].m_pResult);
 #endif
 }
 
 CEngineBinary g_EngineBinary;
 
-void CEnginePatch::ApplyPatch()
+void CEnginePatch::GetPattern(EnginePattern_t& pattern) const
+{
+    pattern.m_pPattern = m_pSignature;
+    pattern.m_pMask = m_pMask;
+    pattern.m_iOffset = m_iOffset;
+    pattern.m_pResult = nullptr;
+}
+
+void CEnginePatch::ApplyPatch(void* addr)
 {
     if (!m_pPatch)
     {
@@ -195,8 +474,6 @@ void CEnginePatch::ApplyPatch()
         return;
     }
 
-    void* addr = CEngineBinary::FindPattern(m_pSignature, m_pMask, m_iOffset);
-
     if (addr)
     {
         auto pMemory = m_bImmediate ? (uintptr_t*)addr : *reinterpret_cast<uintptr_t**>(addr);
@@ -3,6 +3,28 @@
 //-----------------------------------------------------------------------------------
 #pragma once
 
+#include "checksum_crc.h"
+#include "utlmap.h"
+
+#ifdef CLIENT_DLL
+#define ENGINE_PATTERN_CACHE_FILE "cache/enginepatterns_client.dat"
+#else
+#define ENGINE_PATTERN_CACHE_FILE "cache/enginepatterns_server.dat"
+#endif
+#define ENGINE_PATTERN_CACHE_MAGIC 0x47495345 // "ESIG"
+#define ENGINE_PATTERN_CACHE_VERSION 2
+// Cached offset of a pattern that isn't in this engine build
+#define ENGINE_PATTERN_NOT_FOUND 0xFFFFFFFF
+
+// A signature to look for with CEngineBinary::FindPatterns
+struct EnginePattern_t
+{
+    const char *m_pPattern;
+    const char *m_pMask;
+    size_t m_iOffset;
+    void *m_pResult; // Address of the first match plus the offset, or nullptr if it wasn't found
+};
+
 class CEngineBinary : public CAutoGameSystem
 {
 public:
@@ -10,9 +32,14 @@ public:
 
     bool Init() OVERRIDE;
     void PostInit() OVERRIDE;
+    void Shutdown() OVERRIDE;
 
     static inline bool DataCompare(const char*, const char*, const char*);
     static void* FindPattern(const char*, const char*, size_t = 0);
+    // Finds all of the patterns in a single pass over the engine. Where each pattern was found (or that it
+    // wasn't) is cached per engine build, so the same patterns on an unchanged engine are only checked,
+    // not searched for. The cache is written after the patches are applied and on shutdown.
+    static void FindPatterns(EnginePattern_t *pPatterns, int iCount);
 
     static bool SetMemoryProtection(void*, size_t, int);
 
@@ -22,8 +49,20 @@ public:
 private:
     void ApplyAllPatches();
 
+    static void ScanForPatterns(EnginePattern_t *pPatterns, int iCount);
+    static CRC32_t GetPatternKey(const EnginePattern_t &pattern);
+
+    static void LoadPatternCache();
+    static void SavePatternCache();
+
     static void* m_pModuleBase;
     static size_t m_iModuleSize;
+
+    static bool m_bPatternCacheLoaded;
+    static bool m_bPatternCacheDirty;
+    static char m_szEngineHash[41];
+    // Pattern key -> offset of its match from the module base, or ENGINE_PATTERN_NOT_FOUND
+    static CUtlMap<CRC32_t, uint32> m_mapPatternOffsets;
 };
 
 enum PatchType
@@ -40,7 +79,9 @@ public:
     CEnginePatch(const char*, char*, char*, size_t, bool, float);
     CEnginePatch(const char*, char*, char*, size_t, bool, char*);
 
-    void ApplyPatch();
+    void GetPattern(EnginePattern_t &pattern) const;
+    // pAddress is where the signature was found, plus the patch offset
+    void ApplyPatch(void *pAddress);
 
 private:
     const char *m_sName;
@@ -0,0 +1,241 @@
+#include "cbase.h"
+
+#include "filesystem.h"
+#include "mom_file_hash.h"
+#include "utlbuffer.h"
+#include "vstdlib/jobthread.h"
+
+#include "tier0/valve_minmax_off.h"
+// These are wrapped by minmax_off/on due to Valve making a macro for min and max...
+#include "cryptopp/sha.h"
+// Now we can unwrap
+#include "tier0/valve_minmax_on.h"
+
+#include "tier0/memdbgon.h"
+
+static CMomFileHashCache s_FileHashCache;
+CMomFileHashCache *g_pFileHashCache = &s_FileHashCache;
+
+CMomFileHashCache::CMomFileHashCache() : CAutoGameSystem("CMomFileHashCache"), m_bLoaded(false), m_bDirty(false)
+{
+}
+
+void CMomFileHashCache::Shutdown()
+{
+    // The thread pool is still around here, unlike during static destruction
+    FOR_EACH_DICT_FAST(m_dictJobs, i)
+    {
+        FinishJob(i);
+    }
+
+    SaveCache();
+}
+
+void CMomFileHashCache::LevelShutdownPostEntity()
+{
+    SaveCache();
+}
+
+bool CMomFileHashCache::StatFile(const char *pFileName, const char *pPathID, char *pFullPath, size_t fullPathLen, FileHash_t &out)
+{
+    if (!g_pFullFileSystem->RelativePathToFullPath(pFileName, pPathID, pFullPath, fullPathLen, FILTER_CULLPACK))
+        return false;
+
+    V_FixSlashes(pFullPath);
+    out.m_iFileSize = g_pFullFileSystem->Size(pFullPath);
+    out.m_iFileTime = g_pFullFileSystem->GetFileTime(pFullPath);
+    out.m_szHash[0] = '\0';
+    return true;
+}
+
+const CMomFileHashCache::FileHash_t *CMomFileHashCache::FindCached(const char *pFullPath, const FileHash_t &stat)
+{
+    LoadCache();
+
+    const auto index = m_dictHashes.Find(pFullPath);
+    if (!m_dictHashes.IsValidIndex(index))
+        return nullptr;
+
+    const FileHash_t &cached = m_dictHashes[index];
+    if (cached.m_iFileSize != stat.m_iFileSize || cached.m_iFileTime != stat.m_iFileTime)
+        return nullptr;
+
+    return &cached;
+}
+
+void CMomFileHashCache::HashFileAsync(const char *pFileName, const char *pPathID)
+{
+    if (!g_pThreadPool || g_pThreadPool->NumThreads() == 0)
+        return;
+
+    HashJob_t *pJob = new HashJob_t;
+    if (!StatFile(pFileName, pPathID, pJob->m_szFullPath, sizeof(pJob->m_szFullPath), pJob->m_Result) ||
+        FindCached(pJob->m_szFullPath, pJob->m_Result) || m_dictJobs.HasElement(pJob->m_szFullPath))
+    {
+        delete pJob;
+        return;
+    }
+
+    pJob->m_bSuccess = false;
+    pJob->m_pJob = g_pThreadPool->QueueCall(this, &CMomFileHashCache::RunHashJob, pJob);
+    m_dictJobs.Insert(pJob->m_szFullPath, pJob);
+}
+
+void CMomFileHashCache::RunHashJob(HashJob_t *pJob)
+{
+    pJob->m_bSuccess = HashFile(pJob->m_szFullPath, pJob->m_Result.m_szHash, sizeof(pJob->m_Result.m_szHash));
+}
+
+void CMomFileHashCache::FinishJob(unsigned short jobIndex)
+{
+    HashJob_t *pJob = m_dictJobs[jobIndex];
+    pJob->m_pJob->WaitForFinishAndRelease();
+
+    if (pJob->m_bSuccess)
+    {
+        m_dictHashes.Remove(pJob->m_szFullPath);
+        m_dictHashes.Insert(pJob->m_szFullPath, pJob->m_Result);
+        m_bDirty = true;
+    }
+
+    m_dictJobs.RemoveAt(jobIndex);
+    delete pJob;
+}
+
+bool CMomFileHashCache::GetFileHash(const char *pFileName, const char *pPathID, char *pOut, size_t outLen)
+{
+    char szFullPath[MAX_PATH];
+    FileHash_t stat;
+    if (!StatFile(pFileName, pPathID, szFullPath, sizeof(szFullPath), stat))
+    {
+        // Packed or otherwise not on disk, nothing to key the cache on
+        return HashFile(pFileName, pOut, outLen, pPathID);
+    }
+
+    const auto jobIndex = m_dictJobs.Find(szFullPath);
+    if (m_dictJobs.IsValidIndex(jobIndex))
+        FinishJob(jobIndex);
+
+    const FileHash_t *pCached = FindCached(szFullPath, stat);
+    if (!pCached)
+    {
+        if (!HashFile(szFullPath, stat.m_szHash, sizeof(stat.m_szHash)))
+            return false;
+
+        m_dictHashes.Remove(szFullPath);
+        pCached = &m_dictHashes[m_dictHashes.Insert(szFullPath, stat)];
+        m_bDirty = true;
+    }
+
+    Q_strncpy(pOut, pCached->m_szHash, outLen);
+    return true;
+}
+
+void CMomFileHashCache::SetFileHash(const char *pFileName, const char *pPathID, const char *pHash)
+{
+    char szFullPath[MAX_PATH];
+    FileHash_t stat;
+    if (!StatFile(pFileName, pPathID, szFullPath, sizeof(szFullPath), stat))
+        return;
+
+    LoadCache();
+
+    Q_strncpy(stat.m_szHash, pHash, sizeof(stat.m_szHash));
+    m_dictHashes.Remove(szFullPath);
+    m_dictHashes.Insert(szFullPath, stat);
+    m_bDirty = true;
+}
+
+bool CMomFileHashCache::HashFile(const char *pFileName, char *pOut, size_t outLen, const char *pPathID /* = nullptr*/)
+{
+    const FileHandle_t hFile = g_pFullFileSystem->Open(pFileName, "rb", pPathID);
+    if (!hFile)
+        return false;
+
+    const unsigned int iFileSize = g_pFullFileSystem->Size(hFile);
+
+    CryptoPP::SHA1 hash;
+    CUtlMemory<byte> chunk(0, FILE_HASH_CHUNK_SIZE);
+
+    unsigned int iTotalRead = 0;
+    int iRead;
+    while ((iRead = g_pFullFileSystem->Read(chunk.Base(), FILE_HASH_CHUNK_SIZE, hFile)) > 0)
+    {
+        hash.Update(chunk.Base(), iRead);
+        iTotalRead += iRead;
+    }
+
+    g_pFullFileSystem->Close(hFile);
+
+    // A read error ends the loop early too, don't hand out (and cache) the hash of part of the file
+    if (iRead < 0 || iTotalRead != iFileSize)
+    {
+        Warning("Failed to read %s for hashing!\n", pFileName);
+        return false;
+    }
+
+    byte digest[CryptoPP::SHA1::DIGESTSIZE];
+    hash.Final(digest);
+    V_binarytohex(digest, sizeof(digest), pOut, outLen);
+    return true;
+}
+
+void CMomFileHashCache::LoadCache()
+{
+    if (m_bLoaded)
+        return;
+
+    m_bLoaded = true;
+
+    CUtlBuffer buf;
+    if (!g_pFullFileSystem->ReadFile(FILE_HASH_CACHE_FILE, "MOD", buf))
+        return;
+
+    if (buf.GetUnsignedInt() != FILE_HASH_CACHE_MAGIC || buf.GetUnsignedChar() != FILE_HASH_CACHE_VERSION)
+        return;
+
+    const int iCount = buf.GetInt();
+    for (int i = 0; i < iCount && buf.IsValid(); i++)
+    {
+        char szFullPath[MAX_PATH];
+        FileHash_t entry;
+        buf.GetStringManualCharCount(szFullPath, sizeof(szFullPath));
+        entry.m_iFileSize = buf.GetInt64();
+        entry.m_iFileTime = buf.GetInt64();
+        buf.GetStringManualCharCount(entry.m_szHash, sizeof(entry.m_szHash));
+
+        if (!buf.IsValid())
+            break;
+
+        // Drop the files that are gone, so the cache doesn't keep growing with every map ever played
+        if (g_pFullFileSystem->FileExists(szFullPath))
+            m_dictHashes.Insert(szFullPath, entry);
+        else
+            m_bDirty = true;
+    }
+}
+
+void CMomFileHashCache::SaveCache()
+{
+    if (!m_bDirty)
+        return;
+
+    m_bDirty = false;
+
+    CUtlBuffer buf;
+    buf.PutUnsignedInt(FILE_HASH_CACHE_MAGIC);
+    buf.PutUnsignedChar(FILE_HASH_CACHE_VERSION);
+    buf.PutInt(m_dictHashes.Count());
+    FOR_EACH_DICT_FAST(m_dictHashes, i)
+    {
+        const FileHash_t &entry = m_dictHashes[i];
+        buf.PutString(m_dictHashes.GetElementName(i));
+        buf.PutInt64(entry.m_iFileSize);
+        buf.PutInt64(entry.m_iFileTime);
+        buf.PutString(entry.m_szHash);
+    }
+
+    g_pFullFileSystem->CreateDirHierarchy("cache", "MOD");
+    if (!g_pFullFileSystem->WriteFile(FILE_HASH_CACHE_FILE, "MOD", buf))
+        Warning("Failed to write the file hash cache %s!\n", FILE_HASH_CACHE_FILE);
+}
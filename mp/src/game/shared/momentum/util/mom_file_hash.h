@@ -0,0 +1,80 @@
+#pragma once
+
+#include "igamesystem.h"
+#include "utldict.h"
+
+class CJob;
+
+#ifdef CLIENT_DLL
+#define FILE_HASH_CACHE_FILE "cache/filehashes_client.dat"
+#else
+#define FILE_HASH_CACHE_FILE "cache/filehashes_server.dat"
+#endif
+#define FILE_HASH_CACHE_MAGIC 0x48534846 // "FHSH"
+#define FILE_HASH_CACHE_VERSION 1
+
+// Size of the chunks files are streamed through the hash in
+#define FILE_HASH_CHUNK_SIZE (1024 * 1024)
+
+// SHA1 hashes of files, streamed through the hash in chunks instead of reading the whole file into memory.
+// Hashes are cached per full path along with the size and modification time of the file, in memory and on disk,
+// so getting the hash of an unchanged file again does not touch the file at all.
+// The cache file is written when a level shuts down and on shutdown, if a hash changed since it was last written.
+// Not thread safe, use it from the main thread only; the worker threads only ever touch their own job.
+class CMomFileHashCache : public CAutoGameSystem
+{
+  public:
+    CMomFileHashCache();
+
+    void Shutdown() OVERRIDE;
+    void LevelShutdownPostEntity() OVERRIDE;
+
+    // Starts hashing the file on a worker thread if it's not cached already.
+    // GetFileHash for the same file will wait on it.
+    void HashFileAsync(const char *pFileName, const char *pPathID);
+
+    // Gets the hash of the file, from the cache if the file did not change.
+    // Waits on the file's async hash if there is one, otherwise hashes it right away.
+    bool GetFileHash(const char *pFileName, const char *pPathID, char *pOut, size_t outLen);
+
+    // Caches a hash that was computed some other way, like while the file was being downloaded
+    void SetFileHash(const char *pFileName, const char *pPathID, const char *pHash);
+
+  private:
+    struct FileHash_t
+    {
+        int64 m_iFileTime;
+        int64 m_iFileSize;
+        char m_szHash[41];
+    };
+
+    struct HashJob_t
+    {
+        CJob *m_pJob;
+        char m_szFullPath[MAX_PATH];
+        FileHash_t m_Result;
+        bool m_bSuccess;
+    };
+
+    // Resolves the file and reads its size and time, returns false if it doesn't exist
+    bool StatFile(const char *pFileName, const char *pPathID, char *pFullPath, size_t fullPathLen, FileHash_t &out);
+    const FileHash_t *FindCached(const char *pFullPath, const FileHash_t &stat);
+
+    // Runs on a worker thread
+    void RunHashJob(HashJob_t *pJob);
+    static bool HashFile(const char *pFileName, char *pOut, size_t outLen, const char *pPathID = nullptr);
+
+    void FinishJob(unsigned short jobIndex);
+
+    // Loads the cache, dropping the entries of files that don't exist anymore
+    void LoadCache();
+    // Writes the cache if it changed
+    void SaveCache();
+
+    bool m_bLoaded;
+    bool m_bDirty;
+    CUtlDict<FileHash_t> m_dictHashes;
+    CUtlDict<HashJob_t *> m_dictJobs;
+};
+
+extern CMomFileHashCache *g_pFileHashCache;
@@ -4,6 +4,7 @@
 #include "filesystem.h"
 #include "utlbuffer.h"
 #include "mom_util.h"
+#include "mom_file_hash.h"
 #include "momentum/mom_shareddefs.h"
 #include "run/mom_replay_factory.h"
 #include "run/mom_replay_base.h"
@@ -363,39 +364,55 @@ CMomReplayBase *MomUtil::GetBestTime(const char *szMapName, float tickrate, int
 {
     if (szMapName)
     {
-        char path[MAX_PATH];
-        Q_snprintf(path, MAX_PATH, "%s/%s-*%s", RECORDING_PATH, szMapName, EXT_RECORDING_FILE);
-        V_FixSlashes(path);
+        CUtlStringList vecPaths;
+        FindReplayFiles(szMapName, vecPaths);
+        return GetBestTime(vecPaths, tickrate, trackNumber, flags);
+    }
+    return nullptr;
+}
 
-        CMomReplayBase *pFastest = nullptr;
+void MomUtil::FindReplayFiles(const char *szMapName, CUtlStringList &vecPathsOut)
+{
+    char path[MAX_PATH];
+    Q_snprintf(path, MAX_PATH, "%s/%s-*%s", RECORDING_PATH, szMapName, EXT_RECORDING_FILE);
+    V_FixSlashes(path);
 
-        FileFindHandle_t found;
-        const char *pFoundFile = filesystem->FindFirstEx(path, "MOD", &found);
-        while (pFoundFile)
-        {
-            // NOTE: THIS NEEDS TO BE MANUALLY CLEANED UP!
-            char pReplayPath[MAX_PATH];
-            V_ComposeFileName(RECORDING_PATH, pFoundFile, pReplayPath, MAX_PATH);
-
-            CMomReplayBase *pBase = g_ReplayFactory.LoadReplayFile(pReplayPath, false);
-            assert(pBase != nullptr);
-                
-            if (CheckReplayB(pFastest, pBase, tickrate, trackNumber, flags))
-            {
-                pFastest = pBase;
-            }
-            else // Not faster, get rid of it
-            {
-                delete pBase;
-            }
+    FileFindHandle_t found;
+    const char *pFoundFile = filesystem->FindFirstEx(path, "MOD", &found);
+    while (pFoundFile)
+    {
+        char pReplayPath[MAX_PATH];
+        V_ComposeFileName(RECORDING_PATH, pFoundFile, pReplayPath, MAX_PATH);
+        vecPathsOut.CopyAndAddToTail(pReplayPath);
 
-            pFoundFile = filesystem->FindNext(found);
-        }
+        pFoundFile = filesystem->FindNext(found);
+    }
+
+    filesystem->FindClose(found);
+}
 
-        filesystem->FindClose(found);
-        return pFastest;
+//!!! NOTE: The value returned here MUST BE DELETED, otherwise you get a memory leak!
+CMomReplayBase *MomUtil::GetBestTime(const CUtlStringList &vecPaths, float tickrate, int trackNumber, uint32 flags)
+{
+    CMomReplayBase *pFastest = nullptr;
+
+    FOR_EACH_VEC(vecPaths, i)
+    {
+        // NOTE: THIS NEEDS TO BE MANUALLY CLEANED UP!
+        CMomReplayBase *pBase = g_ReplayFactory.LoadReplayFile(vecPaths[i], false);
+        assert(pBase != nullptr);
+
+        if (CheckReplayB(pFastest, pBase, tickrate, trackNumber, flags))
+        {
+            pFastest = pBase;
+        }
+        else // Not faster, get rid of it
+        {
+            delete pBase;
+        }
     }
-    return nullptr;
+
+    return pFastest;
 }
 
 bool MomUtil::GetRunComparison(const char *szMapName, const float tickRate, const int trackNumber, const int flags, RunCompare_t *into)
@@ -479,11 +496,7 @@ bool MomUtil::GetSHA1Hash(const CUtlBuffer& buf, char* pOut, size_t outLen)
 
 bool MomUtil::GetFileHash(char* pOut, size_t outLen, const char *pFileName, const char *pPathID /* = "GAME"*/)
 {
-    CUtlBuffer fileBuffer;
-    if (g_pFullFileSystem->ReadFile(pFileName, pPathID, fileBuffer))
-        return GetSHA1Hash(fileBuffer, pOut, outLen);
-
-    return false;
+    return g_pFileHashCache->GetFileHash(pFileName, pPathID, pOut, outLen);
 }
 
 bool MomUtil::FileExists(const char* pFileName, const char* pFileHash, const char* pPathID /* = "GAME"*/)
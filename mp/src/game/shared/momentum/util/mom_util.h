@@ -3,6 +3,7 @@
 #include "run/run_stats.h"
 
 class CMomReplayBase;
+class CUtlStringList;
 struct RunCompare_t;
 
 namespace MomUtil
@@ -45,6 +46,10 @@ namespace MomUtil
     bool ISODateToTimeT(const char *pISODate, time_t *out);
 
     CMomReplayBase *GetBestTime(const char *szMapName, float tickrate, int trackNumber, uint32 flags = 0);
+    // The two halves of GetBestTime. Finding the replays uses the filesystem's find handles, so it has to stay on
+    // the main thread, but loading the found ones is fine to do anywhere.
+    void FindReplayFiles(const char *szMapName, CUtlStringList &vecPathsOut);
+    CMomReplayBase *GetBestTime(const CUtlStringList &vecPaths, float tickrate, int trackNumber, uint32 flags = 0);
     bool GetRunComparison(const char *szMapName, const float tickRate, const int trackNumber, const int flags, RunCompare_t *into);
     void FillRunComparison(const char *compareName, CMomRunStats *kvBestRun, RunCompare_t *into);
 
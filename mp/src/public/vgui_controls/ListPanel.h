@@ -7,6 +7,7 @@
 #pragma once
 
 #include "utllinkedlist.h"
+#include "utlmap.h"
 #include <vgui_controls/Panel.h>
 
 namespace vgui
@@ -53,6 +54,26 @@ typedef int __cdecl SortFunc(
 	const ListPanelItem &item1,
 	const ListPanelItem &item2 );
 
+//-----------------------------------------------------------------------------
+// Purpose: Supplies the rows of a ListPanel in data source mode. The list only
+//			keeps an array of row indices and asks for a row when it needs it
+//			(mostly when it's drawn), so big lists don't pay for an item per row.
+//			Item IDs in this mode are the source's row indices.
+//-----------------------------------------------------------------------------
+class IListPanelDataSource
+{
+public:
+	virtual int GetRowCount() = 0;
+
+	// Row data keyed like the data passed to AddItem. Owned by the source, and must stay valid
+	// until the source calls RefreshDataSource(), or ApplyItemChanges() for that row
+	virtual KeyValues *GetRowData( int row ) = 0;
+	virtual unsigned int GetRowUserData( int row ) = 0;
+
+	// Compares two rows on a column, like a SortFunc but on the source's own typed data
+	virtual int CompareRows( int column, int row1, int row2 ) = 0;
+};
+
 //-----------------------------------------------------------------------------
 // Purpose: A spread-sheet type data view, similar to MFC's 
 //-----------------------------------------------------------------------------
@@ -140,6 +161,14 @@ public:
 	virtual int InvalidItemID() const;
 	virtual bool IsValidItemID(int itemID);
 
+	// Switches the list to getting its rows from pDataSource instead of AddItem() (NULL switches back).
+	// Call RefreshDataSource() whenever the source's rows are added, removed or reordered; the
+	// selection follows rows by their user data. AddItem(), RemoveItem(), SetUserData(), SetItemVisible()
+	// and SetItemDisabled() don't apply in this mode, the source owns its rows.
+	void SetDataSource( IListPanelDataSource *pDataSource );
+	IListPanelDataSource *GetDataSource() const { return m_pDataSource; }
+	void RefreshDataSource();
+
 	// sets whether the dataitem is visible or not
 	// it is removed from the row list when it becomes invisible, but stays in the indexes
 	// this is much faster than a normal remove
@@ -270,6 +299,11 @@ private:
 	// adds the item into the column indexes
 	void IndexItem(int itemID);
 
+	// data source mode
+	void UpdateDataSourceRows();
+	FastSortListPanelItem *FindDataSourceItem( int itemID );
+	void PurgeDataSourceItems( bool bKeepSelected );
+
 	// Purpose: 
 	void UpdateSelection( vgui::MouseCode code, int x, int y, int row, int column );
 
@@ -319,6 +353,10 @@ private:
 	CUtlLinkedList<FastSortListPanelItem*, int>		m_DataItems;
 	CUtlVector<int>									m_VisibleItems;
 
+	IListPanelDataSource							*m_pDataSource;
+	// rows of the data source that have been asked for, by row index
+	CUtlMap<int, FastSortListPanelItem*, int>		m_DataSourceItems;
+
 	// set to true if the table needs to be sorted before it's drawn next
 	int 				m_iSortColumn;
 	int 				m_iSortColumnSecondary;
@@ -335,6 +373,7 @@ private:
 	int				m_iSelectedColumn;
 
 	bool 			m_bNeedsSort : 1;
+	bool			m_bDataSourceChanged : 1;
 	bool 			m_bSortAscending : 1;
 	bool 			m_bSortAscendingSecondary : 1;
 	bool			m_bCanSelectIndividualCells : 1;
@@ -32,6 +32,10 @@
 #include <vgui_controls/Menu.h>
 #include <vgui_controls/Tooltip.h>
 
+#include "tier0/valve_minmax_off.h"
+#include <algorithm>
+#include "tier0/valve_minmax_on.h"
+
 // memdbgon must be the last include file in a .cpp file
 #include "tier0/memdbgon.h"
 
@@ -476,6 +480,10 @@ ListPanel::ListPanel(Panel *parent, const char *panelName) : BaseClass(parent, p
 	m_bNeedsSort = false;
 	m_LastItemSelected = -1;
 
+	m_pDataSource = NULL;
+	m_bDataSourceChanged = false;
+	SetDefLessFunc( m_DataSourceItems );
+
 	m_pImageList = NULL;
 	m_bDeleteImageListWhenDone = false;
 	m_pEmptyListText = new Label(this, "EmptyListText", "");
@@ -881,6 +889,11 @@ int ListPanel::FindColumn(const char *columnName)
 //-----------------------------------------------------------------------------
 int ListPanel::AddItem( KeyValues *item, unsigned int userData, bool bScrollToItem, bool bSortOnAdd, bool bCopyData /* = true*/)
 {
+	// rows come from the data source in that mode
+	Assert( !m_pDataSource );
+	if ( m_pDataSource )
+		return InvalidItemID();
+
 	FastSortListPanelItem *newitem = new FastSortListPanelItem;
 	newitem->kv = bCopyData ? item->MakeCopy() : item;
     newitem->m_bDataCopied = bCopyData;
@@ -918,6 +931,11 @@ int ListPanel::AddItem( KeyValues *item, unsigned int userData, bool bScrollToIt
 //-----------------------------------------------------------------------------
 void ListPanel::SetUserData( int itemID, unsigned int userData )
 {
+	// the data source hands out the user data
+	Assert( !m_pDataSource );
+	if ( m_pDataSource )
+		return;
+
 	if ( !m_DataItems.IsValidIndex(itemID) )
 		return;
 
@@ -929,6 +947,16 @@ void ListPanel::SetUserData( int itemID, unsigned int userData )
 //-----------------------------------------------------------------------------
 int ListPanel::GetItemIDFromUserData( unsigned int userData )
 {
+	if ( m_pDataSource )
+	{
+		for ( int row = 0; row < m_pDataSource->GetRowCount(); row++ )
+		{
+			if ( m_pDataSource->GetRowUserData( row ) == userData )
+				return row;
+		}
+		return InvalidItemID();
+	}
+
 	FOR_EACH_LL( m_DataItems, itemID )
 	{
 		if (m_DataItems[itemID]->userData == userData)
@@ -943,6 +971,7 @@ int ListPanel::GetItemIDFromUserData( unsigned int userData )
 //-----------------------------------------------------------------------------
 int	ListPanel::GetItemCount( void )
 {
+	UpdateDataSourceRows();
 	return m_VisibleItems.Count();
 }
 
@@ -968,10 +997,11 @@ int ListPanel::GetItem(const char *itemName)
 //-----------------------------------------------------------------------------
 KeyValues *ListPanel::GetItem(int itemID)
 {
-	if ( !m_DataItems.IsValidIndex(itemID) )
+	ListPanelItem *pItem = GetItemData( itemID );
+	if ( !pItem )
 		return nullptr;
 
-	return m_DataItems[itemID]->kv;
+	return pItem->kv;
 }
 
 //-----------------------------------------------------------------------------
@@ -979,6 +1009,7 @@ KeyValues *ListPanel::GetItem(int itemID)
 //-----------------------------------------------------------------------------
 int ListPanel::GetItemCurrentRow(int itemID)
 {
+	UpdateDataSourceRows();
 	return m_VisibleItems.Find(itemID);
 }
 
@@ -988,7 +1019,10 @@ int ListPanel::GetItemCurrentRow(int itemID)
 //-----------------------------------------------------------------------------
 void ListPanel::SetItemDragData( int itemID, const KeyValues *data )
 {
-	ListPanelItem *pItem = m_DataItems[ itemID ];
+	ListPanelItem *pItem = GetItemData( itemID );
+	if ( !pItem )
+		return;
+
 	if ( pItem->m_pDragData )
 	{
 		pItem->m_pDragData->deleteThis();
@@ -1008,9 +1042,9 @@ void ListPanel::OnCreateDragData( KeyValues *msg )
 
 	for ( int i = 0; i < nCount; ++i )
 	{
-		int nItemID = GetSelectedItem( i );
+		ListPanelItem *pItem = GetItemData( GetSelectedItem( i ) );
 
-		KeyValues *pDragData = m_DataItems[ nItemID ]->m_pDragData;
+		KeyValues *pDragData = pItem ? pItem->m_pDragData : NULL;
 		if ( pDragData )
 		{
 			KeyValues *pDragDataCopy = pDragData->MakeCopy();
@@ -1019,8 +1053,8 @@ void ListPanel::OnCreateDragData( KeyValues *msg )
 	}
 
 	// Add the keys of the last item directly into the root also
-	int nLastItemID = GetSelectedItem( nCount - 1 );
-	KeyValues *pLastItemDrag = m_DataItems[ nLastItemID ]->m_pDragData;
+	ListPanelItem *pLastItem = GetItemData( GetSelectedItem( nCount - 1 ) );
+	KeyValues *pLastItemDrag = pLastItem ? pLastItem->m_pDragData : NULL;
 	if ( pLastItemDrag )
 	{
 		pLastItemDrag->CopySubkeys( msg );
@@ -1033,6 +1067,8 @@ void ListPanel::OnCreateDragData( KeyValues *msg )
 //-----------------------------------------------------------------------------
 int ListPanel::GetItemIDFromRow(int currentRow)
 {
+	UpdateDataSourceRows();
+
 	if (!m_VisibleItems.IsValidIndex(currentRow))
 		return -1;
 
@@ -1042,12 +1078,18 @@ int ListPanel::GetItemIDFromRow(int currentRow)
 
 int ListPanel::FirstItem() const
 {
+	if ( m_pDataSource )
+		return m_pDataSource->GetRowCount() > 0 ? 0 : InvalidItemID();
+
 	return m_DataItems.Head();
 }
 
 
 int ListPanel::NextItem( int iItem ) const
 {
+	if ( m_pDataSource )
+		return iItem + 1 < m_pDataSource->GetRowCount() ? iItem + 1 : InvalidItemID();
+
 	return m_DataItems.Next( iItem );
 }
 
@@ -1065,6 +1107,9 @@ int ListPanel::InvalidItemID() const
 //-----------------------------------------------------------------------------
 bool ListPanel::IsValidItemID(int itemID)
 {
+	if ( m_pDataSource )
+		return itemID >= 0 && itemID < m_pDataSource->GetRowCount();
+
 	return m_DataItems.IsValidIndex(itemID);
 }
 
@@ -1073,6 +1118,9 @@ bool ListPanel::IsValidItemID(int itemID)
 //-----------------------------------------------------------------------------
 ListPanelItem *ListPanel::GetItemData( int itemID )
 {
+	if ( m_pDataSource )
+		return FindDataSourceItem( itemID );
+
 	if ( !m_DataItems.IsValidIndex(itemID) )
 		return NULL;
 	
@@ -1084,10 +1132,11 @@ ListPanelItem *ListPanel::GetItemData( int itemID )
 //-----------------------------------------------------------------------------
 unsigned int ListPanel::GetItemUserData(int itemID)
 {
-	if ( !m_DataItems.IsValidIndex(itemID) )
+	ListPanelItem *pItem = GetItemData( itemID );
+	if ( !pItem )
 		return 0;
 
-	return m_DataItems[itemID]->userData;
+	return pItem->userData;
 }
 
 
@@ -1097,6 +1146,24 @@ unsigned int ListPanel::GetItemUserData(int itemID)
 //-----------------------------------------------------------------------------
 void ListPanel::ApplyItemChanges(int itemID)
 {
+	if ( m_pDataSource )
+	{
+		// forget the row so it's asked for again, right away if it has to stay selected
+		int i = m_DataSourceItems.Find( itemID );
+		if ( m_DataSourceItems.IsValidIndex( i ) )
+		{
+			CleanupItem( m_DataSourceItems[i] );
+			m_DataSourceItems.RemoveAt( i );
+
+			if ( m_SelectedItems.HasElement( itemID ) )
+			{
+				FindDataSourceItem( itemID );
+			}
+		}
+		InvalidateLayout();
+		return;
+	}
+
 	// reindex the item and then redraw
 	IndexItem(itemID);
 	InvalidateLayout();
@@ -1195,6 +1262,11 @@ void ListPanel::CleanupItem( FastSortListPanelItem *data )
 //-----------------------------------------------------------------------------
 void ListPanel::RemoveItem(int itemID)
 {
+	// the data source removes its own rows
+	Assert( !m_pDataSource );
+	if ( m_pDataSource )
+		return;
+
 	FastSortListPanelItem *data = (FastSortListPanelItem*) m_DataItems[itemID];
 	if (!data)
 		return;
@@ -1242,8 +1314,12 @@ void ListPanel::RemoveAll()
 
 	m_DataItems.RemoveAll();
 	m_VisibleItems.RemoveAll();
+	PurgeDataSourceItems( false );
 	ClearSelectedItems();
 
+	// the source still has its rows, they get asked for again
+	m_bDataSourceChanged = ( m_pDataSource != NULL );
+
 	InvalidateLayout();
 }
 
@@ -1317,7 +1393,7 @@ void ListPanel::ClearSelectedItems()
 //-----------------------------------------------------------------------------
 bool ListPanel::IsItemSelected( int itemID )
 {
-	return m_DataItems.IsValidIndex( itemID ) && m_SelectedItems.HasElement( itemID );
+	return IsValidItemID( itemID ) && m_SelectedItems.HasElement( itemID );
 }
 
 
@@ -1326,11 +1402,16 @@ bool ListPanel::IsItemSelected( int itemID )
 //-----------------------------------------------------------------------------
 void ListPanel::AddSelectedItem( int itemID )
 {
-	if ( !m_DataItems.IsValidIndex(itemID) )
+	if ( !IsValidItemID(itemID) )
 		return;
 
 	Assert( !m_SelectedItems.HasElement( itemID ) );
 
+	// selected data source rows keep their item, which is how the selection finds its rows again
+	// after the source changes
+	if ( m_pDataSource && !FindDataSourceItem( itemID ) )
+		return;
+
 	m_LastItemSelected = itemID;
 	m_SelectedItems.AddToTail( itemID );
 	PostActionSignal( new KeyValues("ItemSelected") );
@@ -1360,7 +1441,7 @@ void ListPanel::SetSelectedCell(int itemID, int col)
 	}
 
 	// make sure it's a valid cell
-	if ( !m_DataItems.IsValidIndex(itemID) )
+	if ( !IsValidItemID(itemID) )
 		return;
 	
 	if ( !m_CurrentColumns.IsValidIndex(col) )
@@ -1572,7 +1653,7 @@ Panel *ListPanel::GetCellRenderer(int itemID, int col)
             }
         }
 
-		FastSortListPanelItem *listItem = m_DataItems[ itemID ];
+		FastSortListPanelItem *listItem = (FastSortListPanelItem*) GetItemData( itemID );
 		if ( col == 0 &&
 			listItem->m_bImage && m_pImageList )
 		{
@@ -1636,6 +1717,8 @@ void ListPanel::PerformLayout()
 {
 	if ( m_CurrentColumns.Count() == 0 )
 		return;
+
+	UpdateDataSourceRows();
 	
 	if (m_bNeedsSort)
 	{
@@ -1894,6 +1977,8 @@ void ListPanel::OnSizeChanged(int wide, int tall)
 //-----------------------------------------------------------------------------
 void ListPanel::Paint()
 {
+	UpdateDataSourceRows();
+
 	if (m_bNeedsSort)
 	{
 		SortList();
@@ -1909,6 +1994,12 @@ void ListPanel::Paint()
 	int nTotalRows = m_VisibleItems.Count();
 	int nRowsPerPage = GetRowsPerPage();
 
+	// drop the data source rows that were scrolled past, the ones on screen are asked for again below
+	if ( m_pDataSource && m_DataSourceItems.Count() > max( 64, nRowsPerPage * 4 ) )
+	{
+		PurgeDataSourceItems( true );
+	}
+
 	// find the first visible item to display
 	int nStartItem = 0;
 	if (nRowsPerPage <= nTotalRows)
@@ -2261,7 +2352,7 @@ void ListPanel::OnKeyCodePressed(KeyCode code)
 	int nRowsPerPage = (int)GetRowsPerPage();
 
 	int nSelectedRow = 0;
-	if ( m_DataItems.IsValidIndex( m_LastItemSelected ) )
+	if ( IsValidItemID( m_LastItemSelected ) )
 	{
 		nSelectedRow = m_VisibleItems.Find( m_LastItemSelected );
 	}
@@ -2547,6 +2638,8 @@ void ListPanel::GetSortColumnEx( int &iPrimarySortColumn, int &iSecondarySortCol
 //-----------------------------------------------------------------------------
 void ListPanel::SortList( void )
 {
+	UpdateDataSourceRows();
+
 	m_bNeedsSort = false;
 
 	if ( m_VisibleItems.Count() <= 1 )
@@ -2567,76 +2660,117 @@ void ListPanel::SortList( void )
 		}
 	}
 
-	// get the required sorting functions
-	s_pCurrentSortingListPanel = this;
-
-	// setup globals for use in qsort
-	s_pSortFunc = FastSortFunc;
-	s_bSortAscending = m_bSortAscending;
-	s_pSortFuncSecondary = FastSortFunc;
-	s_bSortAscendingSecondary = m_bSortAscendingSecondary;
-
-	// walk the tree and set up the current indices
-	if (m_CurrentColumns.IsValidIndex(m_iSortColumn))
+	if ( m_pDataSource )
 	{
-		IndexRBTree_t &rbtree = m_ColumnsData[m_CurrentColumns[m_iSortColumn]].m_SortedTree;
-		unsigned int index = rbtree.FirstInorder();
-		unsigned int lastIndex = rbtree.LastInorder();
-		int prevDuplicateIndex = 0;
-		int sortValue = 1;
-		while (1)
+		// sort the row indices with the source's own comparisons, there's nothing indexed per row
+		if ( m_CurrentColumns.IsValidIndex( m_iSortColumn ) )
 		{
-			FastSortListPanelItem *dataItem = (FastSortListPanelItem*) rbtree[index].dataItem;
-			if (dataItem->visible)
+			IListPanelDataSource *pDataSource = m_pDataSource;
+			int iSortColumn = m_iSortColumn;
+			int iSortColumnSecondary = m_CurrentColumns.IsValidIndex( m_iSortColumnSecondary ) ? m_iSortColumnSecondary : -1;
+			bool bSortAscending = m_bSortAscending;
+			bool bSortAscendingSecondary = m_bSortAscendingSecondary;
+
+			std::sort( m_VisibleItems.begin(), m_VisibleItems.end(), [=]( int row1, int row2 )
 			{
-				// only increment the sort value if we're a different token from the previous
-				if (!prevDuplicateIndex || prevDuplicateIndex != rbtree[index].duplicateIndex)
+				int result = pDataSource->CompareRows( iSortColumn, row1, row2 );
+				if ( !bSortAscending )
 				{
-					sortValue++;
+					result = -result;
 				}
-				dataItem->primarySortIndexValue = sortValue;
-				prevDuplicateIndex = rbtree[index].duplicateIndex;
-			}
 
-			if (index == lastIndex)
-				break;
+				if ( result == 0 && iSortColumnSecondary != -1 )
+				{
+					result = pDataSource->CompareRows( iSortColumnSecondary, row1, row2 );
+					if ( !bSortAscendingSecondary )
+					{
+						result = -result;
+					}
+				}
+
+				// keep the source's order for rows that are the same, so we get consistent results
+				if ( result == 0 )
+				{
+					return row1 < row2;
+				}
 
-			index = rbtree.NextInorder(index);
+				return result < 0;
+			} );
 		}
 	}
-
-	// setup secondary indices
-	if (m_CurrentColumns.IsValidIndex(m_iSortColumnSecondary))
+	else
 	{
-		IndexRBTree_t &rbtree = m_ColumnsData[m_CurrentColumns[m_iSortColumnSecondary]].m_SortedTree;
-		unsigned int index = rbtree.FirstInorder();
-		unsigned int lastIndex = rbtree.LastInorder();
-		int sortValue = 1;
-		int prevDuplicateIndex = 0;
-		while (1)
-		{
-			FastSortListPanelItem *dataItem = (FastSortListPanelItem*) rbtree[index].dataItem;
-			if (dataItem->visible)
+		// get the required sorting functions
+		s_pCurrentSortingListPanel = this;
+
+		// setup globals for use in qsort
+		s_pSortFunc = FastSortFunc;
+		s_bSortAscending = m_bSortAscending;
+		s_pSortFuncSecondary = FastSortFunc;
+		s_bSortAscendingSecondary = m_bSortAscendingSecondary;
+
+		// walk the tree and set up the current indices
+		if (m_CurrentColumns.IsValidIndex(m_iSortColumn))
+		{
+			IndexRBTree_t &rbtree = m_ColumnsData[m_CurrentColumns[m_iSortColumn]].m_SortedTree;
+			unsigned int index = rbtree.FirstInorder();
+			unsigned int lastIndex = rbtree.LastInorder();
+			int prevDuplicateIndex = 0;
+			int sortValue = 1;
+			while (1)
 			{
-				// only increment the sort value if we're a different token from the previous
-				if (!prevDuplicateIndex || prevDuplicateIndex != rbtree[index].duplicateIndex)
+				FastSortListPanelItem *dataItem = (FastSortListPanelItem*) rbtree[index].dataItem;
+				if (dataItem->visible)
 				{
-					sortValue++;
+					// only increment the sort value if we're a different token from the previous
+					if (!prevDuplicateIndex || prevDuplicateIndex != rbtree[index].duplicateIndex)
+					{
+						sortValue++;
+					}
+					dataItem->primarySortIndexValue = sortValue;
+					prevDuplicateIndex = rbtree[index].duplicateIndex;
 				}
-				dataItem->secondarySortIndexValue = sortValue;
 
-				prevDuplicateIndex = rbtree[index].duplicateIndex;
+				if (index == lastIndex)
+					break;
+
+				index = rbtree.NextInorder(index);
 			}
+		}
 
-			if (index == lastIndex)
-				break;
+		// setup secondary indices
+		if (m_CurrentColumns.IsValidIndex(m_iSortColumnSecondary))
+		{
+			IndexRBTree_t &rbtree = m_ColumnsData[m_CurrentColumns[m_iSortColumnSecondary]].m_SortedTree;
+			unsigned int index = rbtree.FirstInorder();
+			unsigned int lastIndex = rbtree.LastInorder();
+			int sortValue = 1;
+			int prevDuplicateIndex = 0;
+			while (1)
+			{
+				FastSortListPanelItem *dataItem = (FastSortListPanelItem*) rbtree[index].dataItem;
+				if (dataItem->visible)
+				{
+					// only increment the sort value if we're a different token from the previous
+					if (!prevDuplicateIndex || prevDuplicateIndex != rbtree[index].duplicateIndex)
+					{
+						sortValue++;
+					}
+					dataItem->secondarySortIndexValue = sortValue;
+
+					prevDuplicateIndex = rbtree[index].duplicateIndex;
+				}
 
-			index = rbtree.NextInorder(index);
+				if (index == lastIndex)
+					break;
+
+				index = rbtree.NextInorder(index);
+			}
 		}
-	}
 
-	// quick sort the list
-	qsort(m_VisibleItems.Base(), (size_t) m_VisibleItems.Count(), (size_t) sizeof(int), AscendingSortFunc);
+		// quick sort the list
+		qsort(m_VisibleItems.Base(), (size_t) m_VisibleItems.Count(), (size_t) sizeof(int), AscendingSortFunc);
+	}
 
 	if ( screenPosition != -1 )
 	{
@@ -2658,6 +2792,147 @@ void ListPanel::SortList( void )
 	Repaint();
 }
 
+//-----------------------------------------------------------------------------
+// Purpose: Switches to getting the rows from a data source, or back to AddItem() with NULL
+//-----------------------------------------------------------------------------
+void ListPanel::SetDataSource( IListPanelDataSource *pDataSource )
+{
+	RemoveAll();
+
+	m_pDataSource = pDataSource;
+	m_bDataSourceChanged = ( pDataSource != NULL );
+
+	InvalidateLayout();
+	Repaint();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Called by the owner when the data source's rows changed. The rows
+//			are read again (and resorted) the next time they're needed
+//-----------------------------------------------------------------------------
+void ListPanel::RefreshDataSource()
+{
+	if ( !m_pDataSource )
+		return;
+
+	m_bDataSourceChanged = true;
+
+	InvalidateLayout();
+	Repaint();
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Rebuilds the row index array if the data source changed
+//-----------------------------------------------------------------------------
+void ListPanel::UpdateDataSourceRows()
+{
+	if ( !m_pDataSource || !m_bDataSourceChanged )
+		return;
+
+	m_bDataSourceChanged = false;
+
+	// row indices may have moved, so remember the selection by user data. Selected rows always
+	// have an item, so this doesn't need to ask the source, which has already changed
+	CUtlVector<unsigned int> selectedUserData;
+	unsigned int lastSelectedUserData = 0;
+	bool bHasLastSelected = false;
+	FOR_EACH_VEC( m_SelectedItems, i )
+	{
+		int index = m_DataSourceItems.Find( m_SelectedItems[i] );
+		if ( !m_DataSourceItems.IsValidIndex( index ) )
+			continue;
+
+		selectedUserData.AddToTail( m_DataSourceItems[index]->userData );
+		if ( m_SelectedItems[i] == m_LastItemSelected )
+		{
+			lastSelectedUserData = m_DataSourceItems[index]->userData;
+			bHasLastSelected = true;
+		}
+	}
+	int nPrevSelectedCount = m_SelectedItems.Count();
+
+	PurgeDataSourceItems( false );
+	m_SelectedItems.RemoveAll();
+	m_LastItemSelected = -1;
+
+	int nRows = m_pDataSource->GetRowCount();
+	m_VisibleItems.SetCount( nRows );
+	for ( int row = 0; row < nRows; row++ )
+	{
+		m_VisibleItems[row] = row;
+
+		if ( selectedUserData.Count() )
+		{
+			unsigned int userData = m_pDataSource->GetRowUserData( row );
+			if ( selectedUserData.HasElement( userData ) && FindDataSourceItem( row ) )
+			{
+				m_SelectedItems.AddToTail( row );
+				if ( bHasLastSelected && userData == lastSelectedUserData )
+				{
+					m_LastItemSelected = row;
+				}
+			}
+		}
+	}
+
+	if ( m_SelectedItems.Count() < nPrevSelectedCount )
+	{
+		PostActionSignal( new KeyValues("ItemDeselected") );
+	}
+
+	m_bNeedsSort = true;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Returns the item for a data source row, asking the source for it
+//			if it hasn't been yet
+//-----------------------------------------------------------------------------
+FastSortListPanelItem *ListPanel::FindDataSourceItem( int itemID )
+{
+	int index = m_DataSourceItems.Find( itemID );
+	if ( m_DataSourceItems.IsValidIndex( index ) )
+		return m_DataSourceItems[index];
+
+	if ( !IsValidItemID( itemID ) )
+		return NULL;
+
+	KeyValues *kv = m_pDataSource->GetRowData( itemID );
+	if ( !kv )
+		return NULL;
+
+	FastSortListPanelItem *newitem = new FastSortListPanelItem;
+	newitem->kv = kv;
+	newitem->m_bDataCopied = false;
+	newitem->userData = m_pDataSource->GetRowUserData( itemID );
+	newitem->m_pDragData = NULL;
+	newitem->m_bImage = kv->GetInt( "image" ) != 0 ? true : false;
+	newitem->m_nImageIndex = kv->GetInt( "image" );
+	newitem->m_nImageIndexSelected = kv->GetInt( "imageSelected" );
+	newitem->m_pIcon = reinterpret_cast< IImage * >( kv->GetPtr( "iconImage" ) );
+	newitem->visible = true;
+
+	m_DataSourceItems.Insert( itemID, newitem );
+	return newitem;
+}
+
+//-----------------------------------------------------------------------------
+// Purpose: Frees the data source row items, except the selected ones if asked
+//-----------------------------------------------------------------------------
+void ListPanel::PurgeDataSourceItems( bool bKeepSelected )
+{
+	int index = m_DataSourceItems.FirstInorder();
+	while ( m_DataSourceItems.IsValidIndex( index ) )
+	{
+		int next = m_DataSourceItems.NextInorder( index );
+		if ( !bKeepSelected || !m_SelectedItems.HasElement( m_DataSourceItems.Key( index ) ) )
+		{
+			CleanupItem( m_DataSourceItems[index] );
+			m_DataSourceItems.RemoveAt( index );
+		}
+		index = next;
+	}
+}
+
 //-----------------------------------------------------------------------------
 // Purpose: 
 //-----------------------------------------------------------------------------
@@ -2762,6 +3037,11 @@ void ListPanel::OnSetSortColumn(int column)
 //-----------------------------------------------------------------------------
 void ListPanel::SetItemVisible(int itemID, bool state)
 {
+	// the data source filters its own rows
+	Assert( !m_pDataSource );
+	if ( m_pDataSource )
+		return;
+
 	if ( !m_DataItems.IsValidIndex(itemID) )
 		return;
 
@@ -2799,6 +3079,10 @@ void ListPanel::SetItemVisible(int itemID, bool state)
 //-----------------------------------------------------------------------------
 bool ListPanel::IsItemVisible( int itemID )
 {
+	// the data source only has the rows it shows
+	if ( m_pDataSource )
+		return IsValidItemID( itemID );
+
 	if ( !m_DataItems.IsValidIndex(itemID) )
 		return false;
 
@@ -2812,6 +3096,11 @@ bool ListPanel::IsItemVisible( int itemID )
 //-----------------------------------------------------------------------------
 void ListPanel::SetItemDisabled(int itemID, bool state)
 {
+	// the data source sets "disabled" in the row data it returns
+	Assert( !m_pDataSource );
+	if ( m_pDataSource )
+		return;
+
 	if ( !m_DataItems.IsValidIndex(itemID) )
 		return;
 